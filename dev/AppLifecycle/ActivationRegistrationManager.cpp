@@ -35,22 +35,27 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         auto type = AssociationType::File;
         auto progId = ComputeProgId(appId, type);
 
-        RegisterProgId(progId.c_str(), L"", L"", displayName.c_str(), logo.c_str());
-        RegisterApplication(appId.c_str());
+        CurrentUserRegistryStore store;
+        RegistrationState state{ store };
+        RegisterProgId(state, progId.c_str(), L"", L"", displayName.c_str(), logo.c_str());
+        RegisterApplication(state, appId.c_str());
+
+        // The verbs live on the ProgId and are the same for every file type.
+        auto commandLine = GenerateCommandLine(exePath.c_str());
+        for (auto verb : supportedVerbs)
+        {
+            auto args = winrt::make<FileActivatedEventArgs>(verb.c_str(), c_commandLineArgumentFormat, true).as<IInternalValueMarshalable>();
+            auto command = commandLine + args->Serialize().AbsoluteUri().c_str();
+            RegisterVerb(state, progId, verb.c_str(), command);
+        }
 
         for (auto fileType : supportedFileTypes)
         {
-            RegisterFileExtension(fileType.c_str());
-            
-            for (auto verb : supportedVerbs)
-            {
-                auto args = winrt::make<FileActivatedEventArgs>(verb.c_str(), c_commandLineArgumentFormat, true).as<IInternalValueMarshalable>();
-                auto command = GenerateCommandLine(exePath.c_str()) + args->Serialize().AbsoluteUri().c_str();
-                RegisterVerb(progId, verb.c_str(), command);
-            }
-
-            RegisterAssociationHandler(appId, fileType.c_str(), type);
+            RegisterFileExtension(state, fileType.c_str());
+            RegisterAssociationHandler(state, appId, fileType.c_str(), type);
         }
+
+        state.Commit();
     }
 
     void ActivationRegistrationManager::RegisterForProtocolActivation(hstring const& schemeName,
@@ -135,28 +140,36 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         THROW_HR_IF(E_ILLEGAL_METHOD_CALL, HasIdentity());
         THROW_HR_IF(E_INVALIDARG, schemeName.empty());
 
-        RegisterProtocol(schemeName.c_str());
+        CurrentUserRegistryStore store;
+        RegistrationState state{ store };
+        RegisterProtocol(state, schemeName.c_str());
 
         auto appId = ComputeAppId(exePath.c_str());
         auto type = AssociationType::Protocol;
         auto progId = ComputeProgId(appId, type);
 
-        RegisterProgId(progId.c_str(), L"", appUserModelId.c_str(), displayName.c_str(),
+        RegisterProgId(state, progId.c_str(), L"", appUserModelId.c_str(), displayName.c_str(),
             logo.c_str());
 
         auto command = GenerateCommandLine(exePath.c_str()) + c_commandLineArgumentFormat;
-        RegisterVerb(progId.c_str(), c_openVerbName, command);
+        RegisterVerb(state, progId.c_str(), c_openVerbName, command);
 
-        RegisterApplication(appId.c_str());
-        RegisterAssociationHandler(appId, schemeName.c_str(), type);
+        RegisterApplication(state, appId.c_str());
+        RegisterAssociationHandler(state, appId, schemeName.c_str(), type);
+
+        state.Commit();
     }
 
     void ActivationRegistrationManager::RegisterEncodedLaunchCommand()
     {
-        RegisterProtocol(c_launchSchemeName);
+        CurrentUserRegistryStore store;
+        RegistrationState state{ store };
+        RegisterProtocol(state, c_launchSchemeName);
 
         auto delegateExecute = __uuidof(EncodedLaunchExecuteCommandFactory);
-        RegisterVerb(c_launchSchemeName, c_openVerbName, L"", &delegateExecute);
+        RegisterVerb(state, c_launchSchemeName, c_openVerbName, L"", &delegateExecute);
+
+        state.Commit();
     }
 
     void ActivationRegistrationManager::RegisterEncodedLaunchSupport(std::wstring const& appUserModelId,
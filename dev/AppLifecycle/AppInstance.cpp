@@ -83,22 +83,22 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         m_moduleName = ComputeAppId();
         m_processName = wil::str_printf<std::wstring>(L"%s_%d", m_moduleName.c_str(), processId);
 
-        m_instances.Init(m_moduleName + L"_Module");
-
-        // Wire up the Activated event.
-        std::wstring eventName = m_processName + c_activatedEventNameSuffix;
-        m_innerActivated.create(wil::EventOptions::ManualReset, eventName.c_str());
-
-        // This mutex should always be created first by the process it's associated with.
-        std::wstring mutexName = m_processName + L"_Mutex";
-        m_dataMutex.create(mutexName.c_str(), CREATE_MUTEX_INITIAL_OWNER, MUTEX_ALL_ACCESS);
-
-        wil::mutex_release_scope_exit releaseOnExit;
-        auto weak_this = get_weak();
+        // Other instances are often only enumerated (e.g. GetInstances, FindOrRegisterForKey) so their
+        // kernel objects are opened when first needed, see EnsureOpened().
         if (m_isCurrent)
         {
-            releaseOnExit = m_dataMutex.ReleaseMutex_scope_exit();
+            m_instances.Init(m_moduleName + c_processListNameSuffix);
+
+            // Wire up the Activated event.
+            std::wstring eventName = m_processName + c_activatedEventNameSuffix;
+            m_innerActivated.create(wil::EventOptions::ManualReset, eventName.c_str());
 
+            // This mutex should always be created first by the process it's associated with.
+            std::wstring mutexName = m_processName + L"_Mutex";
+            m_dataMutex.create(mutexName.c_str(), CREATE_MUTEX_INITIAL_OWNER, MUTEX_ALL_ACCESS);
+            auto releaseOnExit = m_dataMutex.ReleaseMutex_scope_exit();
+
+            auto weak_this = get_weak();
             auto onInnerActivated = [weak_this]
             {
                 // If this weak ref doesn't resolve it means the process is heading toward a terminal state.
@@ -111,102 +111,211 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
             };
 
             m_activationWatcher.create(m_innerActivated.get(), onInnerActivated);
+
+            m_key.Open(m_processName + L"_Key");
+            m_instances.Insert(processId, SharedProcessList::GetProcessStartTime(GetCurrentProcess()));
+            m_redirectionArgs.Init(m_processName + c_redirectionQueueNameSuffix);
         }
-        else
+    }
+
+    void AppInstance::EnsureOpened()
+    {
+        if (m_isCurrent)
         {
-            releaseOnExit = m_dataMutex.acquire();
+            return;
         }
 
-        m_key.Open(m_processName + L"_Key");
+        std::call_once(m_openOnce, [this]
+        {
+            std::wstring eventName = m_processName + c_activatedEventNameSuffix;
+            m_innerActivated.create(wil::EventOptions::ManualReset, eventName.c_str());
 
-        if (m_isCurrent)
+            std::wstring mutexName = m_processName + L"_Mutex";
+            m_dataMutex.create(mutexName.c_str(), CREATE_MUTEX_INITIAL_OWNER, MUTEX_ALL_ACCESS);
+            auto releaseOnExit = m_dataMutex.acquire();
+
+            m_key.Open(m_processName + L"_Key");
+            m_redirectionArgs.Init(m_processName + c_redirectionQueueNameSuffix);
+        });
+    }
+
+    bool AppInstance::TryWatchInstance(SharedProcessListRecord const& record)
+    {
+        std::lock_guard<std::mutex> lock(m_instanceWatchersLock);
+
+        // Already watching it? Then it's alive, or it died very recently and is on its way out of the list.
+        const auto key = std::make_pair(record.processId, record.startTime);
+        auto found = m_instanceWatchers.find(key);
+        if (found != m_instanceWatchers.end())
         {
-            m_instances.Insert(processId);
+            return !*found->second.terminated;
         }
-        else
-        {
-            m_instanceHandle.reset(OpenProcess(SYNCHRONIZE, FALSE, processId));
 
-            // Create a monitor thread to handle cleaning up this instance if the backing process terminates.
-            auto onInstanceTerminated = [weak_this]
-            {
-                auto strong_this{ weak_this.get() };
-                if (strong_this)
-                {
-                    strong_this->OnInstanceTerminated();
-                }
-            };
+        // Forget about instances that have terminated (we can't do that from their own watcher's callback).
+        for (auto iterator = m_instanceWatchers.begin(); iterator != m_instanceWatchers.end();)
+        {
+            iterator = (*iterator->second.terminated ? m_instanceWatchers.erase(iterator) : std::next(iterator));
+        }
 
-            m_terminationWatcher.create(m_instanceHandle.get(), onInstanceTerminated);
+        // Is it still around? And not some other process that's since been given the same process id?
+        wil::unique_handle process(::OpenProcess(SYNCHRONIZE | PROCESS_QUERY_LIMITED_INFORMATION, FALSE, record.processId));
+        if (!process || (SharedProcessList::GetProcessStartTime(process.get()) != record.startTime) ||
+            (WaitForSingleObject(process.get(), 0) == WAIT_OBJECT_0))
+        {
+            // Remove orphan.
+            m_instances.Remove(record.processId, record.startTime);
+            return false;
         }
 
-        m_redirectionArgs.Init(m_processName + L"_RedirectionQueue");
-    }
+        auto terminated = std::make_shared<std::atomic<bool>>(false);
+        auto onInstanceTerminated = [this, record, terminated]
+        {
+            // The watchers are owned by the current instance, which lives for the life of the process.
+            *terminated = true;
+            m_instances.Remove(record.processId, record.startTime);
+        };
 
-    void AppInstance::OnInstanceTerminated()
-    {
-        auto releaseOnExit = m_dataMutex.acquire();
-        m_instances.Remove(m_processId);
+        InstanceWatcher instanceWatcher;
+        instanceWatcher.watcher.create(process.get(), onInstanceTerminated);
+        instanceWatcher.terminated = std::move(terminated);
+        m_instanceWatchers.emplace(key, std::move(instanceWatcher));
+        return true;
     }
 
-    GUID AppInstance::DequeueRedirectionRequestId()
+    bool AppInstance::DequeueRedirectionRequest(GUID& id, std::wstring& payload)
     {
-        auto releaseOnExit = m_dataMutex.acquire();
-        auto id = m_redirectionArgs.Dequeue();
-        return id;
+        return m_redirectionArgs.TryDequeue(id, payload);
     }
 
-    void AppInstance::EnqueueRedirectionRequestId(GUID id)
+    void AppInstance::EnqueueRedirectionRequest(GUID id, std::wstring_view payload)
     {
-        auto releaseOnExit = m_dataMutex.acquire();
-        m_redirectionArgs.Enqueue(id);
+        // The queue is bounded. If it's full (e.g. a burst of redirections) wake the instance to drain it
+        // and give it a moment to catch up.
+        m_redirectionArgs.Enqueue(id, payload, [this] { m_innerActivated.SetEvent(); });
     }
 
     void AppInstance::ProcessRedirectionRequests()
     {
         m_innerActivated.ResetEvent();
 
-        GUID id;
-        while ((id = DequeueRedirectionRequestId()) != GUID_NULL)
+        // Apps handling ActivatedBatch get everything queued so far in one go.
+        if (m_activatedBatchEvent)
         {
-            wil::unique_cotaskmem_string idString;
-            THROW_IF_FAILED(StringFromCLSID(id, &idString));
-
-            auto name = wil::str_printf<std::wstring>(c_requestPacketNameFormat, m_processName.c_str(), idString.get());
+            ProcessRedirectionRequestsAsBatch();
+            return;
+        }
 
-            RedirectionRequest request;
-            request.Open(name);
-            auto args = request.UnmarshalArguments();
+        GUID id;
+        std::wstring payload;
+        while (DequeueRedirectionRequest(id, payload))
+        {
+            auto args = UnmarshalRedirectionRequest(id, payload);
 
             // Notify the app that the redirection request is here.
             m_activatedEvent(*this, args);
 
-            std::wstring eventName = name + c_activatedEventNameSuffix;
-            wil::unique_event cleanupEvent;
-            cleanupEvent.open(eventName.c_str());
-            if (cleanupEvent)
+            SignalRedirectionRequestProcessed(id);
+        }
+    }
+
+    void AppInstance::ProcessRedirectionRequestsAsBatch()
+    {
+        std::vector<std::pair<GUID, std::wstring>> requests;
+        GUID id;
+        std::wstring payload;
+        while (DequeueRedirectionRequest(id, payload))
+        {
+            requests.emplace_back(id, std::move(payload));
+        }
+        if (requests.empty())
+        {
+            return;
+        }
+
+        // Unmarshal the requests on this thread, the one raising the event, so the arguments are used in the
+        // apartment that created them. A request that can't be unmarshaled is dropped from the batch (rather
+        // than failing the rest of it).
+        std::vector<AppLifecycle::AppActivationArguments> batch;
+        batch.reserve(requests.size());
+        for (const auto& request : requests)
+        {
+            try
             {
-                // If the event is missing, it means the waiter gave up.  Ignore the error.
-                cleanupEvent.SetEvent();
+                batch.push_back(UnmarshalRedirectionRequest(request.first, request.second));
             }
+            CATCH_LOG();
+
+            // The sender can let go once we've read its request.
+            SignalRedirectionRequestProcessed(request.first);
+        }
+
+        if (!batch.empty())
+        {
+            m_activatedBatchEvent(*this, winrt::single_threaded_vector(std::move(batch)).GetView());
+        }
+    }
+
+    std::wstring AppInstance::GetRedirectionRequestName(GUID const& id)
+    {
+        wil::unique_cotaskmem_string idString;
+        THROW_IF_FAILED(StringFromCLSID(id, &idString));
+        return wil::str_printf<std::wstring>(c_requestPacketNameFormat, m_processName.c_str(), idString.get());
+    }
+
+    AppLifecycle::AppActivationArguments AppInstance::UnmarshalRedirectionRequest(GUID const& id, std::wstring const& payload)
+    {
+        if (!payload.empty())
+        {
+            // The arguments came inline. There's no section to open.
+            return RedirectionRequest::DeserializeArguments(payload);
+        }
+
+        RedirectionRequest request;
+        request.Open(GetRedirectionRequestName(id));
+        return request.UnmarshalArguments();
+    }
+
+    void AppInstance::SignalRedirectionRequestProcessed(GUID const& id)
+    {
+        if (id == GUID_NULL)
+        {
+            // Inline requests have no sender waiting on us.
+            return;
+        }
+
+        std::wstring eventName = GetRedirectionRequestName(id) + c_activatedEventNameSuffix;
+        wil::unique_event cleanupEvent;
+        cleanupEvent.open(eventName.c_str());
+        if (cleanupEvent)
+        {
+            // If the event is missing, it means the waiter gave up.  Ignore the error.
+            cleanupEvent.SetEvent();
         }
     }
 
     IAsyncAction AppInstance::QueueRequest(AppLifecycle::AppActivationArguments args)
     {
         auto strongThis{ get_strong() };
+        EnsureOpened();
 
         // Push this work onto a background thread.
         co_await resume_background();
 
         auto uninitOnExit = wil::CoInitializeEx();
 
+        // Small requests travel inline in the queue. No section or cleanup event to create, and no need to
+        // wait for the other instance to pick it up.
+        std::wstring uri;
+        if (RedirectionRequest::TrySerializeArguments(args, uri) && !uri.empty() && (uri.length() <= c_redirectionRequestInlinePayloadLength))
+        {
+            EnqueueRedirectionRequest(GUID_NULL, uri);
+            m_innerActivated.SetEvent();
+            co_return;
+        }
+
         GUID id;
         THROW_IF_FAILED(CoCreateGuid(&id));
-
-        wil::unique_cotaskmem_string idString;
-        THROW_IF_FAILED(StringFromCLSID(id, &idString));
-        auto name = wil::str_printf<std::wstring>(c_requestPacketNameFormat, m_processName.c_str(), idString.get());
+        auto name = GetRedirectionRequestName(id);
 
         RedirectionRequest request;
         request.Open(name);
@@ -217,7 +326,7 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         cleanupEvent.create(wil::EventOptions::ManualReset, eventName.c_str());
 
         // Enqueue the request and signal the other instance.
-        EnqueueRedirectionRequestId(id);
+        EnqueueRedirectionRequest(id, {});
         m_innerActivated.SetEvent();
 
         // Wait for the other instance to open the memory mapped file before exiting and cleaning our interest in it.
@@ -249,43 +358,17 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
     {
         IVector<Microsoft::Windows::AppLifecycle::AppInstance> instances{ winrt::single_threaded_vector<Microsoft::Windows::AppLifecycle::AppInstance>() };
 
-        // Grab the list of processes while under the lock, and then drop it since we'll be calling out to other code.
-        std::list<DWORD> pids;
+        // The list is read without a lock. Instances we're already watching need no further checks; the
+        // watcher removes them from the list when they terminate.
+        for (const auto& record : s_current->m_instances.GetAll())
         {
-            auto releaseOnExit = s_current->m_dataMutex.acquire();
-
-            for (uint32_t index = 0; index < s_current->m_instances.Size(); index++)
-            {
-                auto pid = s_current->m_instances[index];
-                if (pid == 0)
-                {
-                    continue;
-                }
-
-                pids.push_back(pid);
-            }
-        }
-
-        // Create the associated AppInstance objects while removing orphaned entries we find.
-        for (const auto& pid : pids)
-        {
-            if (GetCurrentProcessId() == pid)
+            if (GetCurrentProcessId() == record.processId)
             {
                 instances.Append(AppInstance::GetCurrent());
             }
-            else
+            else if (s_current->TryWatchInstance(record))
             {
-                wil::unique_handle process(::OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid));
-                if (process != nullptr)
-                {
-                    instances.Append(make<AppInstance>(pid));
-                }
-                else
-                {
-                    // Remove orphan.
-                    auto releaseOnExit = s_current->m_dataMutex.acquire();
-                    s_current->m_instances.Remove(pid);
-                }
+                instances.Append(make<AppInstance>(record.processId));
             }
         }
 
@@ -307,6 +390,7 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 
     void AppInstance::UnregisterKey()
     {
+        EnsureOpened();
         auto releaseOnExit = m_dataMutex.acquire();
         m_key.Reset();
         m_keyCreationMutex.reset();
@@ -382,6 +466,7 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 
     hstring AppInstance::Key()
     {
+        EnsureOpened();
         return winrt::hstring(m_key.Get());
     }
 
@@ -396,6 +481,16 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         m_activatedEvent.remove(token);
     }
 
+    event_token AppInstance::ActivatedBatch(EventHandler<IVectorView<Microsoft::Windows::AppLifecycle::AppActivationArguments>> const& handler)
+    {
+        return m_activatedBatchEvent.add(handler);
+    }
+
+    void AppInstance::ActivatedBatch(event_token const& token) noexcept
+    {
+        m_activatedBatchEvent.remove(token);
+    }
+
     bool AppInstance::TrySetKey(std::wstring const& key)
     {
         std::wstring mutexName = m_moduleName + L"_Mutex";
@@ -13,6 +13,12 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 {
     static const PCWSTR c_requestPacketNameFormat = L"%s_RedirectionRequest_%s";
     static const PCWSTR c_activatedEventNameSuffix = L"_ActivatedEvent";
+    // Versioned as the queue's layout (and locking) differs from earlier releases' _RedirectionQueue.
+    // Its mutex is named after it (<name>_Mutex) so is versioned too.
+    static const PCWSTR c_redirectionQueueNameSuffix = L"_RedirectionQueue2";
+    // Versioned as the process list's layout (and locking) differs from earlier releases' _Module. Its
+    // mutex is named after it too.
+    static const PCWSTR c_processListNameSuffix = L"_Module2";
 
     struct AppInstance : AppInstanceT<AppInstance>
     {
@@ -30,6 +36,8 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         winrt::Microsoft::Windows::AppLifecycle::AppActivationArguments GetActivatedEventArgs();
         winrt::event_token Activated(winrt::Windows::Foundation::EventHandler<Microsoft::Windows::AppLifecycle::AppActivationArguments> const& handler);
         void Activated(winrt::event_token const& token) noexcept;
+        winrt::event_token ActivatedBatch(winrt::Windows::Foundation::EventHandler<winrt::Windows::Foundation::Collections::IVectorView<Microsoft::Windows::AppLifecycle::AppActivationArguments>> const& handler);
+        void ActivatedBatch(winrt::event_token const& token) noexcept;
 
         hstring Key();
         bool IsCurrent() { return m_isCurrent; }
@@ -37,12 +45,17 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 
     private:
         winrt::Windows::Foundation::IAsyncAction QueueRequest(Microsoft::Windows::AppLifecycle::AppActivationArguments args);
-        void OnInstanceTerminated();
+        void EnsureOpened();
+        bool TryWatchInstance(SharedProcessListRecord const& record);
         void ProcessRedirectionRequests();
+        void ProcessRedirectionRequestsAsBatch();
+        std::wstring GetRedirectionRequestName(GUID const& id);
+        Microsoft::Windows::AppLifecycle::AppActivationArguments UnmarshalRedirectionRequest(GUID const& id, std::wstring const& payload);
+        void SignalRedirectionRequestProcessed(GUID const& id);
         bool TrySetKey(std::wstring const& key);
         Microsoft::Windows::AppLifecycle::AppInstance FindForKey(std::wstring const& key);
-        void EnqueueRedirectionRequestId(GUID id);
-        GUID DequeueRedirectionRequestId();
+        void EnqueueRedirectionRequest(GUID id, std::wstring_view payload);
+        bool DequeueRedirectionRequest(GUID& id, std::wstring& payload);
 
         // Named object prefixes used to scope.
         std::wstring m_moduleName;
@@ -52,6 +65,7 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         static winrt::com_ptr<AppInstance> s_current;
 
         winrt::event<winrt::Windows::Foundation::EventHandler<Microsoft::Windows::AppLifecycle::AppActivationArguments>> m_activatedEvent;
+        winrt::event<winrt::Windows::Foundation::EventHandler<winrt::Windows::Foundation::Collections::IVectorView<Microsoft::Windows::AppLifecycle::AppActivationArguments>>> m_activatedBatchEvent;
 
         bool m_isCurrent;
         uint32_t m_processId{ 0 };
@@ -63,8 +77,18 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         wil::unique_event m_innerActivated;
         wil::unique_event_watcher m_activationWatcher;
 
-        wil::unique_event_watcher m_terminationWatcher;
-        wil::unique_handle m_instanceHandle;
+        // Kernel objects for other instances are opened on first use.
+        std::once_flag m_openOnce;
+
+        // The current instance watches for the termination of the other instances it's seen, to remove them
+        // from m_instances, keyed by (process id, start time).
+        struct InstanceWatcher
+        {
+            wil::unique_event_watcher watcher;
+            std::shared_ptr<std::atomic<bool>> terminated;
+        };
+        std::mutex m_instanceWatchersLock;
+        std::map<std::pair<DWORD, uint64_t>, InstanceWatcher> m_instanceWatchers;
 
         SharedProcessList m_instances;
         RedirectionRequestQueue m_redirectionArgs;
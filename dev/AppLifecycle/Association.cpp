@@ -5,11 +5,6 @@
 
 namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 {
-    HKEY GetRegistrationRoot()
-    {
-        return HKEY_CURRENT_USER;
-    }
-
     bool IsFileExtension(const std::wstring& extension)
     {
         return (extension.at(0) == L'.');
@@ -99,16 +94,6 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         return path;
     }
 
-    wil::unique_hkey CreateAssocKey(const std::wstring& assoc, REGSAM samDesired)
-    {
-        auto path = CreateAssocKeyPath(assoc.c_str());
-        wil::unique_hkey key;
-
-        THROW_IF_WIN32_ERROR(::RegCreateKeyEx(GetRegistrationRoot(), path.c_str(), 0, nullptr, 0,
-            samDesired, nullptr, key.put(), nullptr));
-        return key;
-    }
-
     wil::unique_hkey OpenAssocKey(const std::wstring& assoc, REGSAM samDesired)
     {
         auto path = CreateAssocKeyPath(assoc.c_str());
@@ -119,34 +104,6 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         return key;
     }
 
-    bool AssocExists(const std::wstring& assoc)
-    {
-        auto path = CreateAssocKeyPath(assoc.c_str());
-        wil::unique_hkey key;
-        if (::RegOpenKeyEx(GetRegistrationRoot(), path.c_str(), 0, KEY_READ,
-            key.put()) == ERROR_SUCCESS)
-        {
-            return true;
-        }
-        return false;
-    }
-
-    bool AssocValueExists(const std::wstring& assoc, const std::wstring& value)
-    {
-        auto path = CreateAssocKeyPath(assoc.c_str());
-        wil::unique_hkey key;
-        if (::RegOpenKeyEx(GetRegistrationRoot(), path.c_str(), 0, KEY_READ, key.put())
-            == ERROR_SUCCESS)
-        {
-            if (::RegQueryValueEx(key.get(), value.c_str(), 0, nullptr, nullptr, nullptr)
-                == ERROR_SUCCESS)
-            {
-                return true;
-            }
-        }
-        return false;
-    }
-
     void DeleteAssocKey(const std::wstring& assoc)
     {
         auto path = CreateAssocKeyPath(assoc);
@@ -154,52 +111,38 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
     }
 
     // Registers a ProgId definition under the classes root in the registry.
-    wil::unique_hkey RegisterProgId(const std::wstring& progId, const std::wstring& defaultValue,
-        const std::wstring& appUserModelId, const std::wstring& applicationDisplayName,
-        const std::wstring& logo)
+    void RegisterProgId(RegistrationState& state, const std::wstring& progId,
+        const std::wstring& defaultValue, const std::wstring& appUserModelId,
+        const std::wstring& applicationDisplayName, const std::wstring& logo)
     {
         // Example: HKEY_CURRENT_USER\Software\Classes\<progId>
-        auto key = CreateAssocKey(progId, KEY_WRITE);
+        auto keyPath = CreateAssocKeyPath(progId);
+        state.AddKey(keyPath);
 
         if (!defaultValue.empty())
         {
             // Example: HKEY_CURRENT_USER\Software\Classes\<progId>\(Default)
-            THROW_IF_WIN32_ERROR(::RegSetValueEx(key.get(), nullptr, 0, REG_SZ,
-                reinterpret_cast<BYTE const*>(defaultValue.c_str()),
-                static_cast<uint32_t>((defaultValue.size() + 1) * sizeof(wchar_t))));
+            state.AddValue(keyPath, L"", defaultValue);
         }
 
         if (!applicationDisplayName.empty())
         {
             // Example: HKEY_CURRENT_USER\Software\Classes\<progId>\Application\ApplicationName
-            wil::unique_hkey applicationKey;
-            THROW_IF_WIN32_ERROR(::RegCreateKeyEx(key.get(), c_applicationKeyName, 0,
-                nullptr, 0, KEY_WRITE, nullptr, applicationKey.put(), nullptr));
-            THROW_IF_WIN32_ERROR(::RegSetValueEx(applicationKey.get(),
-                c_applicationNameValueName, 0, REG_SZ,
-                reinterpret_cast<BYTE const*>(applicationDisplayName.c_str()),
-                static_cast<uint32_t>((applicationDisplayName.size() + 1) * sizeof(wchar_t))));
+            state.AddValue(keyPath + L"\\" + c_applicationKeyName, c_applicationNameValueName,
+                applicationDisplayName);
         }
 
         if (!logo.empty())
         {
             // Example: HKEY_CURRENT_USER\Software\Classes\<progId>\DefaultIcon\(Default)
-            wil::unique_hkey defaultIconKey;
-            THROW_IF_WIN32_ERROR(::RegCreateKeyEx(key.get(), c_defaultIconKeyName, 0,
-                nullptr, 0, KEY_WRITE, nullptr, defaultIconKey.put(), nullptr));
-            THROW_IF_WIN32_ERROR(::RegSetValueEx(defaultIconKey.get(), nullptr, 0, REG_SZ,
-                reinterpret_cast<BYTE const*>(logo.c_str()),
-                static_cast<uint32_t>((logo.size() + 1) * sizeof(wchar_t))));
+            state.AddValue(keyPath + L"\\" + c_defaultIconKeyName, L"", logo);
         }
 
         if (!appUserModelId.empty())
         {
             // Example: HKEY_CURRENT_USER\Software\Classes\<progId>\AppUserModelId
-            THROW_IF_WIN32_ERROR(::RegSetValueEx(key.get(), c_appUserModelIdValueName, 0,
-                REG_SZ, reinterpret_cast<BYTE const*>(appUserModelId.c_str()),
-                static_cast<uint32_t>((appUserModelId.size() + 1) * sizeof(wchar_t))));
+            state.AddValue(keyPath, c_appUserModelIdValueName, appUserModelId);
         }
-        return key;
     }
 
     void UnregisterProgId(const std::wstring& progId)
@@ -213,26 +156,6 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         return std::wstring(c_applicationsKeyPath + appId + c_capabilitiesKeyPath);
     }
 
-    // Creates application defined capabilities key, and registers it as a RegisteredApplication.
-    wil::unique_hkey CreateApplicationKey(const std::wstring& appId, REGSAM samDesired)
-    {
-        // Example: HKEY_CURRENT_USER\Software\RegisterApplications\<appId>
-        wil::unique_hkey registeredAppsKey;
-        THROW_IF_WIN32_ERROR(::RegCreateKeyEx(GetRegistrationRoot(), c_registeredApplicationsKeyPath,
-            0, nullptr, 0, samDesired, nullptr, registeredAppsKey.put(), nullptr));
-
-        std::wstring applicationKeyPath = CreateApplicationKeyPath(appId);
-        wil::unique_hkey applicationKey;
-        THROW_IF_WIN32_ERROR(::RegCreateKeyEx(GetRegistrationRoot(), applicationKeyPath.c_str(),
-            0, nullptr, 0, samDesired, nullptr, applicationKey.put(), nullptr));
-
-        THROW_IF_WIN32_ERROR(::RegSetValueEx(registeredAppsKey.get(), appId.c_str(), 0, REG_SZ,
-            reinterpret_cast<BYTE const*>(applicationKeyPath.c_str()),
-            static_cast<uint32_t>((applicationKeyPath.size() + 1) * sizeof(wchar_t))));
-
-        return applicationKey;
-    }
-
     // Looks up and opens a RegisteredApplication's capability key based on the AppId.
     wil::unique_hkey OpenApplicationKey(const std::wstring& appId, REGSAM samDesired)
     {
@@ -256,9 +179,14 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         return applicationKey;
     }
 
-    void RegisterApplication(const std::wstring& appId)
+    // Creates application defined capabilities key, and registers it as a RegisteredApplication.
+    void RegisterApplication(RegistrationState& state, const std::wstring& appId)
     {
-        CreateApplicationKey(appId);
+        std::wstring applicationKeyPath = CreateApplicationKeyPath(appId);
+        state.AddKey(applicationKeyPath);
+
+        // Example: HKEY_CURRENT_USER\Software\RegisterApplications\<appId>
+        state.AddValue(c_registeredApplicationsKeyPath, appId, applicationKeyPath);
     }
 
     void UnregisterApplication(const std::wstring& appId)
@@ -275,29 +203,19 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         }
     }
 
-    void RegisterVerb(const std::wstring& progId, const std::wstring& verb, const std::wstring& command,
-        _In_opt_ const GUID* delegateExecute)
+    void RegisterVerb(RegistrationState& state, const std::wstring& progId, const std::wstring& verb,
+        const std::wstring& command, _In_opt_ const GUID* delegateExecute)
     {
         // Example: HKEY_CURRENT_USER\Software\Classes\<progId>\shell\<verb>\command
-        auto assocKey = OpenAssocKey(progId, KEY_WRITE);
-        auto key_path = wil::str_printf<std::wstring>(L"%s\\%s\\%s", c_shellKeyName, verb.c_str(), c_commandKeyName);
-        wil::unique_hkey key;
-
-        THROW_IF_WIN32_ERROR(::RegCreateKeyEx(assocKey.get(), key_path.c_str(), 0, nullptr, 0,
-            KEY_WRITE, nullptr, key.put(), nullptr));
-
-        THROW_IF_WIN32_ERROR(::RegSetValueEx(key.get(), nullptr, 0, REG_SZ,
-            reinterpret_cast<BYTE const*>(command.c_str()),
-            static_cast<uint32_t>((command.size() + 1) * sizeof(wchar_t))));
+        auto keyPath = wil::str_printf<std::wstring>(L"%s\\%s\\%s\\%s", CreateAssocKeyPath(progId).c_str(),
+            c_shellKeyName, verb.c_str(), c_commandKeyName);
+        state.AddValue(keyPath, L"", command);
 
         if (delegateExecute)
         {
             std::wstring delegateClsid{ LR"({????????-????-????-????-????????????})" };
             ::StringFromGUID2(*delegateExecute, delegateClsid.data(), 39);
-
-            THROW_IF_WIN32_ERROR(::RegSetValueEx(key.get(), c_delegateExecuteValueName, 0, REG_SZ,
-                reinterpret_cast<BYTE const*>(delegateClsid.c_str()),
-                static_cast<uint32_t>((delegateClsid.size() + 1) * sizeof(wchar_t))));
+            state.AddValue(keyPath, c_delegateExecuteValueName, delegateClsid);
         }
     }
 
@@ -309,15 +227,16 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         ::RegDeleteTree(GetRegistrationRoot(), key_path.c_str());
     }
 
-    void RegisterProtocol(const std::wstring& scheme)
+    void RegisterProtocol(RegistrationState& state, const std::wstring& scheme)
     {
-        if (AssocExists(scheme) && AssocValueExists(scheme, c_urlProtocolValueName))
+        auto keyPath = CreateAssocKeyPath(scheme);
+        if (state.KeyExists(keyPath) && state.ValueExists(keyPath, c_urlProtocolValueName))
         {
             // Protocol already exists.
             return;
         }
 
-        if (AssocExists(scheme))
+        if (state.KeyExists(keyPath))
         {
             // ProgId exists, but isn't a protocol.
             throw std::invalid_argument("scheme");
@@ -329,13 +248,10 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 
         // Example: HKEY_CURRENT_USER\Software\Classes\<scheme>
         std::wstring defaultValue = c_urlDefaultValuePrefix + scheme;
-        auto key = RegisterProgId(scheme, defaultValue);
+        RegisterProgId(state, scheme, defaultValue);
 
         // Example: HKEY_CURRENT_USER\Software\Classes\<scheme>\URL Protocol
-        std::wstring emptyValue{ L"" };
-        THROW_IF_WIN32_ERROR(::RegSetValueEx(key.get(), c_urlProtocolValueName, 0,
-            REG_SZ, reinterpret_cast<BYTE const*>(emptyValue.c_str()),
-            static_cast<uint32_t>((emptyValue.size() + 1) * sizeof(wchar_t))));
+        state.AddValue(keyPath, c_urlProtocolValueName, L"");
     }
 
     void UnregisterProtocol(const std::wstring& scheme)
@@ -343,14 +259,14 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         DeleteAssocKey(scheme);
     }
 
-    void RegisterFileExtension(const std::wstring& extension)
+    void RegisterFileExtension(RegistrationState& state, const std::wstring& extension)
     {
         if (!IsFileExtension(extension))
         {
             throw winrt::hresult_invalid_argument();
         }
 
-        CreateAssocKey(extension, KEY_WRITE);
+        state.AddKey(CreateAssocKeyPath(extension));
     }
 
     void UnregisterFileExtension(const std::wstring& extension)
@@ -382,50 +298,33 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         return subKeyPath;
     }
 
-    void RegisterAssociationHandler(const std::wstring& handlerAppId, const std::wstring& association,
-        AssociationType type)
+    // The association itself must already be part of the state, via RegisterProtocol or
+    // RegisterFileExtension.
+    void RegisterAssociationHandler(RegistrationState& state, const std::wstring& handlerAppId,
+        const std::wstring& association, AssociationType type)
     {
         if (type == AssociationType::File && !IsFileExtension(association))
         {
             throw std::invalid_argument("association");
         }
 
-        if (!AssocExists(association))
-        {
-            throw std::invalid_argument("association");
-        }
-
         // Enable the handler to be a part of user choice.
-        auto subKeyPath = CreateCapabilitySubKeyPath(type);
-        auto applicationKey = OpenApplicationKey(handlerAppId, KEY_READ | KEY_WRITE);
-
         // Example: HKEY_CURRENT_USER\Software\Microsoft\ReunionApplications\<appId>\Capabilities\[URLAssociations/FileAssociations]
-        wil::unique_hkey subKey;
-        THROW_IF_WIN32_ERROR(::RegCreateKeyEx(applicationKey.get(), subKeyPath.c_str(), 0, nullptr,
-            0, KEY_WRITE, nullptr, subKey.put(), nullptr));
+        auto subKeyPath = CreateApplicationKeyPath(handlerAppId) + L"\\" + CreateCapabilitySubKeyPath(type);
 
         // The entries here link a file extension or protocol scheme to a specific ProgId that handles the activation.
         // Example: Name: <association>
         // Example: Value: <progId>
         auto progId = ComputeProgId(handlerAppId, type);
-        THROW_IF_WIN32_ERROR(::RegSetValueEx(subKey.get(), association.c_str(), 0, REG_SZ,
-            reinterpret_cast<BYTE const*>(progId.c_str()),
-            static_cast<uint32_t>((progId.size() + 1) * sizeof(wchar_t))));
+        state.AddValue(subKeyPath, association, progId);
 
         // If it's a file type handler, it needs additional entries in order to be enumerated.
         if (type == AssociationType::File)
         {
-            wil::unique_hkey openWithKey;
-            auto assocKey = OpenAssocKey(association, KEY_WRITE);
-
             // Example: HKEY_CURRENT_USER\Software\Classes\<association>\OpenWithProgids
-            THROW_IF_WIN32_ERROR(::RegCreateKeyEx(assocKey.get(), c_openWithProgIdsKeyName,
-                0, nullptr, 0, KEY_WRITE, nullptr, openWithKey.put(), nullptr));
-
             // Example: Name: <progId>
             // Value is unused.
-            THROW_IF_WIN32_ERROR(::RegSetValueEx(openWithKey.get(), progId.c_str(), 0, REG_SZ,
-                nullptr, 0));
+            state.AddValue(CreateAssocKeyPath(association) + L"\\" + c_openWithProgIdsKeyName, progId, L"");
         }
     }
 
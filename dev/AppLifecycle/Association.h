@@ -2,6 +2,8 @@
 // Licensed under the MIT License. See LICENSE in the project root for license information.
 #pragma once
 
+#include "RegistrationState.h"
+
 namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 {
     // Association registry key values.
@@ -41,27 +43,25 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
     std::wstring ComputeProgId(AssociationType type);
     std::wstring ComputeProgId(const std::wstring& appId, AssociationType type);
     std::wstring CreateAssocKeyPath(const std::wstring& assoc);
-    wil::unique_hkey CreateAssocKey(const std::wstring& assoc, REGSAM samDesired = KEY_WRITE);
     wil::unique_hkey OpenAssocKey(const std::wstring& assoc, REGSAM samDesired = KEY_READ);
     void DeleteAssocKey(const std::wstring& assoc);
-    wil::unique_hkey RegisterProgId(const std::wstring& progId, const std::wstring& defaultValue = L"",
+    void RegisterProgId(RegistrationState& state, const std::wstring& progId, const std::wstring& defaultValue = L"",
         const std::wstring& appUserModelId = L"", const std::wstring& applicationDisplayName = L"",
         const std::wstring& logo = L"");
     void UnregisterProgId(const std::wstring& progId);
-    std::wstring CreateApplicationKeyPath();
-    wil::unique_hkey CreateApplicationKey(const std::wstring& progId, REGSAM samDesired = KEY_WRITE);
+    std::wstring CreateApplicationKeyPath(const std::wstring& appId);
     wil::unique_hkey OpenApplicationKey(const std::wstring& progId, REGSAM samDesired = KEY_READ);
-    void RegisterApplication(const std::wstring& appId);
+    void RegisterApplication(RegistrationState& state, const std::wstring& appId);
     void UnregisterApplication(const std::wstring& appId);
-    void RegisterVerb(const std::wstring& progId, const std::wstring& verb, const std::wstring& command,
-        _In_opt_ const GUID* delegateExecute = nullptr);
+    void RegisterVerb(RegistrationState& state, const std::wstring& progId, const std::wstring& verb,
+        const std::wstring& command, _In_opt_ const GUID* delegateExecute = nullptr);
     void UnregisterVerb(const std::wstring& progId, const std::wstring& verb);
-    void RegisterProtocol(const std::wstring& scheme);
+    void RegisterProtocol(RegistrationState& state, const std::wstring& scheme);
     void UnregisterProtocol(const std::wstring& scheme);
-    void RegisterFileExtension(const std::wstring& extension);
+    void RegisterFileExtension(RegistrationState& state, const std::wstring& extension);
     void UnregisterFileExtension(const std::wstring& extension);
-    void RegisterAssociationHandler(const std::wstring& handlerAppId, const std::wstring& association,
-        AssociationType type);
+    void RegisterAssociationHandler(RegistrationState& state, const std::wstring& handlerAppId,
+        const std::wstring& association, AssociationType type);
     void UnregisterAssociationHandler(const std::wstring& handlerAppId, const std::wstring& association,
         AssociationType type);
 }
@@ -14,20 +14,36 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         m_name = name;
     }
 
-    void RedirectionRequest::MarshalArguments(Microsoft::Windows::AppLifecycle::AppActivationArguments const& args)
+    bool RedirectionRequest::TrySerializeArguments(Microsoft::Windows::AppLifecycle::AppActivationArguments const& args, std::wstring& uri)
     {
         auto internalArgs = args.Data().try_as<IInternalValueMarshalable>();
-        bool supportInternalValueMarshaling = (internalArgs != nullptr);
-        
+        if (internalArgs == nullptr)
+        {
+            return false;
+        }
+
+        uri = internalArgs->Serialize().AbsoluteUri().c_str();
+        return true;
+    }
+
+    Microsoft::Windows::AppLifecycle::AppActivationArguments RedirectionRequest::DeserializeArguments(std::wstring_view uri)
+    {
+        ExtendedActivationKind kind;
+        winrt::Windows::Foundation::IInspectable args;
+        std::tie(kind, args) = DecodeActivatedEventArgs(winrt::Windows::Foundation::Uri{ uri });
+        return make<AppActivationArguments>(args.as<IActivatedEventArgs>());
+    }
+
+    void RedirectionRequest::MarshalArguments(Microsoft::Windows::AppLifecycle::AppActivationArguments const& args)
+    {
         ULONG streamSize{ 0 };
         std::wstring uri;
         com_ptr<::IUnknown> unk{ args.as<::IUnknown>() };
         const auto uuidofArgs = guid_of<AppActivationArguments>();
 
+        bool supportInternalValueMarshaling = TrySerializeArguments(args, uri);
         if (supportInternalValueMarshaling)
         {
-            uri = internalArgs->Serialize().AbsoluteUri().c_str();
-
             // Ensure supportInternalValueMarshaling's data is accounted for in the size.
             streamSize = static_cast<ULONG>((uri.length() + 1) * sizeof(wchar_t));
         }
@@ -85,11 +101,7 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         if (supportInternalValueMarshaling)
         {
             std::wstring_view uri_data{ reinterpret_cast<wchar_t*>(streamStart) };
-
-            ExtendedActivationKind kind;
-            winrt::Windows::Foundation::IInspectable args;
-            std::tie(kind, args) = DecodeActivatedEventArgs(winrt::Windows::Foundation::Uri{ uri_data });
-            return make<AppActivationArguments>(args.as<IActivatedEventArgs>());
+            return DeserializeArguments(uri_data);
         }
         else
         {
@@ -18,6 +18,10 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
         void MarshalArguments(winrt::Microsoft::Windows::AppLifecycle::AppActivationArguments const& args);
         winrt::Microsoft::Windows::AppLifecycle::AppActivationArguments UnmarshalArguments();
 
+        // Serialize the arguments to a URI if they support internal value marshaling, else return false.
+        static bool TrySerializeArguments(winrt::Microsoft::Windows::AppLifecycle::AppActivationArguments const& args, std::wstring& uri);
+        static winrt::Microsoft::Windows::AppLifecycle::AppActivationArguments DeserializeArguments(std::wstring_view uri);
+
     private:
         std::wstring m_name;
         SharedMemory<uint8_t> m_data;
@@ -2,137 +2,120 @@
 // Licensed under the MIT License. See LICENSE in the project root for license information.
 #pragma once
 #include "SharedMemory.h"
-#include "RedirectionRequest.h"
 #include <guiddef.h>
 
 namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 {
-    class RedirectionRequestQueue
+    const uint64_t c_redirectionRequestQueueCapacity{ 256 };
+    static_assert((c_redirectionRequestQueueCapacity & (c_redirectionRequestQueueCapacity - 1)) == 0, "Capacity must be a power of 2");
+
+    // Serialized arguments up to this many characters are carried in the queue itself.
+    const size_t c_redirectionRequestInlinePayloadLength{ 1020 };
+
+    // A producer finding the queue full wakes the consumer and retries this often before giving up.
+    const DWORD c_maxEnqueueRetries{ 100 };
+    const DWORD c_enqueueRetryDelayInMilliseconds{ 10 };
+
+    // Bounded ring of requests, shared by the processes redirecting to an instance (producers) and the
+    // instance itself (the consumer).
+    //
+    // A request is either a small payload (serialized arguments) stored inline in its cell, or the id of
+    // a RedirectionRequest holding the arguments in a memory section of its own.
+    //
+    // Shared memory starts zeroed, which is an empty queue.
+    struct RedirectionRequestQueueData
     {
-        struct QueueItem
+        struct Cell
         {
-            bool inUse{ false };
-            size_t next{ 0 };
-            GUID id{ 0 };
+            GUID id;
+            uint32_t payloadLength;
+            wchar_t payload[c_redirectionRequestInlinePayloadLength];
         };
 
+        uint64_t enqueuePosition;
+        uint64_t dequeuePosition;
+        Cell cells[c_redirectionRequestQueueCapacity];
+    };
+
+    // Processes running other builds may share the queue so its layout is versioned by its name
+    // (see c_redirectionQueueNameSuffix). Change the layout (e.g. the capacity or inline payload
+    // length) and the name has to change too.
+    static_assert(sizeof(RedirectionRequestQueueData) == 527376, "Layout changed. Version the queue's name");
+
+    // TStorage provides the memory shared across processes (Open(name), Get()) so the queue's
+    // independent of how it's shared. SharedMemory<> uses a named file mapping.
+    //
+    // The queue is not lock-free. Access is serialized by a named mutex (<name>_Mutex), held only to copy
+    // a cell in or out. A producer can die at any point (it's another process) and if it dies holding
+    // the mutex the next owner gets it as abandoned and carries on. A request is only visible once
+    // enqueuePosition moves past it (the last thing a producer does), so a half written request is
+    // never seen and its cell's simply reused.
+    template <typename TStorage>
+    class RedirectionRequestQueueT
+    {
     public:
         void Init(const std::wstring& name)
         {
-            m_name = name;
-
-            // We store the head pointer at the beginning of the memory, and then items in the queue after.
-            m_data.Open(name, (sizeof(QueueItem) * 4096) + sizeof(QueueItem*));
-            m_dataStart = reinterpret_cast<QueueItem*>(m_data.Get() + sizeof(size_t));
+            m_mutex.create((name + L"_Mutex").c_str(), 0, MUTEX_ALL_ACCESS);
+            m_data.Open(name);
         }
 
-        void Enqueue(const GUID& itemId)
+        // Returns false if the queue's full. Either itemId or payload is empty.
+        bool TryEnqueue(const GUID& itemId, std::wstring_view payload = {})
         {
-            auto newItem = AllocateItem();
-            auto cur = GetHead();
-
-            if (cur != nullptr)
-            {
-                // Zero is never a valid offset, as the offset 0 is our head pointer offset.
-                while (cur->next != 0)
-                {
-                    cur = FromOffset(cur->next);
-                }
-            }
+            THROW_HR_IF(E_INVALIDARG, payload.length() > c_redirectionRequestInlinePayloadLength);
 
-            if (cur == nullptr)
+            auto releaseOnExit = m_mutex.acquire();
+            auto& queue = *m_data.Get();
+            const auto position = queue.enqueuePosition;
+            if (position - queue.dequeuePosition >= c_redirectionRequestQueueCapacity)
             {
-                // Enqueueing head.
-                cur = newItem;
-                SetHead(newItem);
-            }
-            else
-            {
-                // Appending to the queue.
-                cur->next = ToOffset(newItem);
+                return false;
             }
 
-            newItem->inUse = true;
-            newItem->id = itemId;
-            newItem->next = 0;
+            auto& cell = queue.cells[position & (c_redirectionRequestQueueCapacity - 1)];
+            cell.id = itemId;
+            cell.payloadLength = static_cast<uint32_t>(payload.length());
+            std::copy(payload.begin(), payload.end(), cell.payload);
+            queue.enqueuePosition = position + 1;
+            return true;
         }
 
-        GUID Dequeue()
+        // Enqueue, waiting for room if the queue's full. Each retry calls wakeConsumer() (to drain it)
+        // then waits a moment for the consumer to catch up. Throws E_OUTOFMEMORY if it's still full.
+        template <typename TWakeConsumer>
+        void Enqueue(const GUID& itemId, std::wstring_view payload, TWakeConsumer&& wakeConsumer)
         {
-            auto head = GetHead();
-            if (head != nullptr)
+            for (DWORD attempt = 0; !TryEnqueue(itemId, payload); attempt++)
             {
-                SetHead(FromOffset(head->next));
-
-                head->inUse = false;
-                head->next = 0;
-
-                return head->id;
+                THROW_HR_IF(E_OUTOFMEMORY, attempt >= c_maxEnqueueRetries);
+                wakeConsumer();
+                Sleep(c_enqueueRetryDelayInMilliseconds);
             }
-
-            return GUID_NULL;
-        }
-
-    private:
-        size_t GetBaseAddress()
-        {
-            return reinterpret_cast<size_t>(m_data.Get());
         }
 
-        QueueItem* FromOffset(size_t offset)
+        // Returns false if the queue's empty.
+        bool TryDequeue(GUID& itemId, std::wstring& payload)
         {
-            if (offset == 0)
+            auto releaseOnExit = m_mutex.acquire();
+            auto& queue = *m_data.Get();
+            const auto position = queue.dequeuePosition;
+            if (position == queue.enqueuePosition)
             {
-                return nullptr;
+                return false;
             }
 
-            return reinterpret_cast<QueueItem*>(GetBaseAddress() + offset);
+            const auto& cell = queue.cells[position & (c_redirectionRequestQueueCapacity - 1)];
+            itemId = cell.id;
+            payload.assign(cell.payload, (std::min)(static_cast<size_t>(cell.payloadLength), c_redirectionRequestInlinePayloadLength));
+            queue.dequeuePosition = position + 1;
+            return true;
         }
 
-        size_t ToOffset(QueueItem* item)
-        {
-            size_t offset{ 0 };
-            if (item != nullptr)
-            {
-                offset = reinterpret_cast<size_t>(item) - GetBaseAddress();
-            }
-            return offset;
-        }
-
-        QueueItem* GetHead()
-        {
-            void** head = reinterpret_cast<void**>(m_data.Get());
-            if (*head == nullptr)
-            {
-                return nullptr;
-            }
-
-            return FromOffset(reinterpret_cast<size_t>(*head));
-        }
-
-        void SetHead(QueueItem* value)
-        {
-            // Store as offset, since it's a pointer into shared memory.
-            void** head = reinterpret_cast<void**>(m_data.Get());
-            (*head) = reinterpret_cast<void*>(ToOffset(value));
-        }
-
-        QueueItem* AllocateItem()
-        {
-            QueueItem* upperBounds = reinterpret_cast<QueueItem*>(m_data.Get()) + m_data.Size();
-            auto cur = m_dataStart;
-
-            while (cur < (upperBounds - sizeof(QueueItem)) && cur->inUse)
-            {
-                cur += sizeof(QueueItem);
-            }
-
-            THROW_HR_IF(E_OUTOFMEMORY, cur >= (upperBounds - sizeof(QueueItem)));
-            return cur;
-        }
-
-        std::wstring m_name;
-        QueueItem* m_dataStart{ nullptr };
-        SharedMemory<size_t> m_data;
+    private:
+        wil::unique_mutex m_mutex;
+        TStorage m_data;
     };
+
+    using RedirectionRequestQueue = RedirectionRequestQueueT<SharedMemory<RedirectionRequestQueueData>>;
 }
@@ -0,0 +1,180 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#include <pch.h>
+#include "RegistrationState.h"
+
+namespace winrt::Microsoft::Windows::AppLifecycle::implementation
+{
+    // A value can grow between RegQueryInfoKey and RegEnumValue. Re-reading with the new sizes
+    // handles that, but a writer that keeps growing values mustn't keep us here forever.
+    static const int c_maxReadKeyAttempts{ 3 };
+
+    HKEY GetRegistrationRoot()
+    {
+        return HKEY_CURRENT_USER;
+    }
+
+    static LSTATUS ReadStringValues(HKEY key, RegistryValueMap& values)
+    {
+        values.clear();
+
+        DWORD maxNameLength{};
+        DWORD maxDataSize{};
+        auto status = ::RegQueryInfoKey(key, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr,
+            &maxNameLength, &maxDataSize, nullptr, nullptr);
+        if (status != ERROR_SUCCESS)
+        {
+            return status;
+        }
+
+        std::wstring name(maxNameLength + 1, L'\0');
+        std::vector<BYTE> data(maxDataSize + sizeof(wchar_t));
+        for (DWORD index = 0; ; ++index)
+        {
+            auto nameLength = static_cast<DWORD>(name.size());
+            auto dataSize = static_cast<DWORD>(data.size());
+            DWORD type{};
+            status = ::RegEnumValue(key, index, name.data(), &nameLength, nullptr, &type,
+                data.data(), &dataSize);
+            if (status == ERROR_NO_MORE_ITEMS)
+            {
+                break;
+            }
+            else if (status != ERROR_SUCCESS)
+            {
+                return status;
+            }
+
+            if (type != REG_SZ)
+            {
+                continue;
+            }
+
+            std::wstring value(reinterpret_cast<const wchar_t*>(data.data()), dataSize / sizeof(wchar_t));
+            while (!value.empty() && (value.back() == L'\0'))
+            {
+                value.pop_back();
+            }
+            values[std::wstring(name.c_str(), nameLength)] = std::move(value);
+        }
+        return ERROR_SUCCESS;
+    }
+
+    bool CurrentUserRegistryStore::TryReadKey(const std::wstring& keyPath, RegistryValueMap& values)
+    {
+        values.clear();
+
+        wil::unique_hkey key;
+        auto status = ::RegOpenKeyEx(GetRegistrationRoot(), keyPath.c_str(), 0, KEY_QUERY_VALUE, key.put());
+        if (status == ERROR_FILE_NOT_FOUND)
+        {
+            return false;
+        }
+        THROW_IF_WIN32_ERROR(status);
+
+        for (int attempt = 0; attempt < c_maxReadKeyAttempts; ++attempt)
+        {
+            status = ReadStringValues(key.get(), values);
+            if (status != ERROR_MORE_DATA)
+            {
+                THROW_IF_WIN32_ERROR(status);
+                return true;
+            }
+        }
+        THROW_WIN32_MSG(ERROR_MORE_DATA, "%ls", keyPath.c_str());
+    }
+
+    void CurrentUserRegistryStore::WriteKey(const std::wstring& keyPath, const RegistryValueMap& values)
+    {
+        wil::unique_hkey key;
+        THROW_IF_WIN32_ERROR(::RegCreateKeyEx(GetRegistrationRoot(), keyPath.c_str(), 0, nullptr, 0,
+            KEY_SET_VALUE, nullptr, key.put(), nullptr));
+
+        for (auto& [name, data] : values)
+        {
+            THROW_IF_WIN32_ERROR(::RegSetValueEx(key.get(), name.empty() ? nullptr : name.c_str(), 0,
+                REG_SZ, reinterpret_cast<BYTE const*>(data.c_str()),
+                static_cast<uint32_t>((data.size() + 1) * sizeof(wchar_t))));
+        }
+    }
+
+    void RegistrationState::AddKey(const std::wstring& keyPath)
+    {
+        m_desired[keyPath];
+    }
+
+    void RegistrationState::AddValue(const std::wstring& keyPath, const std::wstring& valueName,
+        const std::wstring& data)
+    {
+        m_desired[keyPath][valueName] = data;
+    }
+
+    bool RegistrationState::KeyExists(const std::wstring& keyPath)
+    {
+        return GetCurrentKey(keyPath) != nullptr;
+    }
+
+    bool RegistrationState::ValueExists(const std::wstring& keyPath, const std::wstring& valueName)
+    {
+        auto values = GetCurrentKey(keyPath);
+        return values && (values->find(valueName) != values->end());
+    }
+
+    size_t RegistrationState::Commit()
+    {
+        size_t keysWritten{};
+        for (auto& [keyPath, desiredValues] : m_desired)
+        {
+            auto currentValues = GetCurrentKey(keyPath);
+
+            RegistryValueMap changes;
+            for (auto& [name, data] : desiredValues)
+            {
+                if (currentValues)
+                {
+                    auto current = currentValues->find(name);
+                    if ((current != currentValues->end()) && (current->second == data))
+                    {
+                        continue;
+                    }
+                }
+                changes[name] = data;
+            }
+
+            if (!currentValues || !changes.empty())
+            {
+                m_store.WriteKey(keyPath, changes);
+                ++keysWritten;
+
+                auto& current = m_current[keyPath];
+                if (!current)
+                {
+                    current.emplace();
+                }
+                for (auto& [name, data] : changes)
+                {
+                    (*current)[name] = data;
+                }
+            }
+        }
+
+        m_desired.clear();
+        return keysWritten;
+    }
+
+    const RegistryValueMap* RegistrationState::GetCurrentKey(const std::wstring& keyPath)
+    {
+        auto iterator = m_current.find(keyPath);
+        if (iterator == m_current.end())
+        {
+            RegistryValueMap values;
+            std::optional<RegistryValueMap> current;
+            if (m_store.TryReadKey(keyPath, values))
+            {
+                current = std::move(values);
+            }
+            iterator = m_current.emplace(keyPath, std::move(current)).first;
+        }
+        return iterator->second ? &*iterator->second : nullptr;
+    }
+}
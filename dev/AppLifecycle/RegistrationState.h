@@ -0,0 +1,75 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#pragma once
+
+#include <map>
+#include <optional>
+
+namespace winrt::Microsoft::Windows::AppLifecycle::implementation
+{
+    // Registry key paths and value names are case-insensitive.
+    struct RegistryNameLess
+    {
+        bool operator()(const std::wstring& left, const std::wstring& right) const
+        {
+            return CompareStringOrdinal(left.c_str(), static_cast<int>(left.size()), right.c_str(),
+                static_cast<int>(right.size()), TRUE) == CSTR_LESS_THAN;
+        }
+    };
+
+    HKEY GetRegistrationRoot();
+
+    // Value name -> string data. The default value of a key has an empty name.
+    using RegistryValueMap = std::map<std::wstring, std::wstring, RegistryNameLess>;
+
+    // Storage the registration diff is computed against and written to. Key paths are relative to
+    // the registration root.
+    struct RegistryStore
+    {
+        virtual ~RegistryStore() = default;
+
+        // Returns false if the key does not exist. Values that aren't strings are omitted, so they
+        // are always treated as out of date.
+        virtual bool TryReadKey(const std::wstring& keyPath, RegistryValueMap& values) = 0;
+
+        // Creates the key if needed and sets the given values. Values not listed are left untouched.
+        virtual void WriteKey(const std::wstring& keyPath, const RegistryValueMap& values) = 0;
+    };
+
+    // RegistryStore over GetRegistrationRoot().
+    struct CurrentUserRegistryStore : RegistryStore
+    {
+        bool TryReadKey(const std::wstring& keyPath, RegistryValueMap& values) override;
+        void WriteKey(const std::wstring& keyPath, const RegistryValueMap& values) override;
+    };
+
+    // The set of keys and values a registration needs. Register* builds the desired state up front,
+    // then Commit reads each affected key once and writes only what's missing or different, so
+    // registering the same thing again touches nothing.
+    class RegistrationState
+    {
+    public:
+        RegistrationState(RegistryStore& store) :
+            m_store(store)
+        {
+        }
+
+        void AddKey(const std::wstring& keyPath);
+        void AddValue(const std::wstring& keyPath, const std::wstring& valueName, const std::wstring& data);
+
+        // Current (not desired) state of the store.
+        bool KeyExists(const std::wstring& keyPath);
+        bool ValueExists(const std::wstring& keyPath, const std::wstring& valueName);
+
+        // Returns the number of keys written.
+        size_t Commit();
+
+    private:
+        const RegistryValueMap* GetCurrentKey(const std::wstring& keyPath);
+
+    private:
+        RegistryStore& m_store;
+        std::map<std::wstring, RegistryValueMap, RegistryNameLess> m_desired;
+        std::map<std::wstring, std::optional<RegistryValueMap>, RegistryNameLess> m_current;
+    };
+}
@@ -7,25 +7,78 @@
 namespace winrt::Microsoft::Windows::AppLifecycle::implementation
 {
     const auto c_maxInstanceCount{ 512 };
-    typedef DWORD SharedProcessListData[c_maxInstanceCount];
 
+    // Open addressed with linear probing. Twice the max instance count keeps probe sequences short.
+    const uint32_t c_processListCapacity{ 1024 };
+    static_assert((c_processListCapacity & (c_processListCapacity - 1)) == 0, "Capacity must be a power of 2");
+
+    struct SharedProcessListEntry
+    {
+        // 0 if free. startTime is only valid when this isn't.
+        uint32_t processId;
+        uint64_t startTime;
+    };
+
+    // Shared memory starts zeroed, which is an empty list.
+    struct SharedProcessListData
+    {
+        uint32_t count;
+        SharedProcessListEntry entries[c_processListCapacity];
+    };
+
+    // Processes running other builds may share the list so its layout is versioned by its name
+    // (see c_processListNameSuffix). Change the layout (e.g. the capacity) and the name has to change too.
+    static_assert(sizeof(SharedProcessListData) == 16392, "Layout changed. Version the list's name");
+
+    // An instance in the list. startTime (the process' creation time) tells the instance apart from a later
+    // process reusing its process id.
+    struct SharedProcessListRecord
+    {
+        DWORD processId;
+        uint64_t startTime;
+    };
+
+    // The instances of the app, shared by all of them. Insert and Remove find a process' entry by hashing
+    // its process id.
+    //
+    // Access is serialized by a named mutex (<name>_Mutex). Removing an entry shifts the rest of its probe
+    // sequence back (there are no tombstones) so probes stay short however many instances come and go.
+    // An instance can die at any point and if it dies holding the mutex the next owner gets it as
+    // abandoned and rebuilds the list from the entries present, dropping a half moved entry's duplicate
+    // and recounting them.
     class SharedProcessList
     {
     public:
-        void Init(const std::wstring& filename)
+        void Init(const std::wstring& name)
         {
-            m_data.Open(filename);
-            m_view = std::move(winrt::array_view<DWORD>(reinterpret_cast<SharedProcessListData>(*m_data.Get())));
+            m_mutex.create((name + L"_Mutex").c_str(), 0, MUTEX_ALL_ACCESS);
+            m_data.Open(name);
         }
 
-        void Insert(DWORD processId)
+        // A stale entry for the process id (left by an earlier process given the same id) is replaced.
+        void Insert(DWORD processId, uint64_t startTime)
         {
-            for (DWORD index = 0 ; index < m_view.size() ; index++)
+            THROW_HR_IF(E_INVALIDARG, processId == 0);
+
+            auto releaseOnExit = Lock();
+            auto& data = *m_data.Get();
+            for (uint32_t probe = 0; probe < c_processListCapacity; probe++)
             {
-                THROW_HR_IF(E_UNEXPECTED, m_view[index] == processId);
-                if (m_view[index] == 0)
+                auto& entry = data.entries[(Hash(processId) + probe) & (c_processListCapacity - 1)];
+                if (entry.processId == processId)
                 {
-                    m_view[index] = processId;
+                    THROW_HR_IF(E_UNEXPECTED, entry.startTime == startTime);
+                    entry.startTime = startTime;
+                    return;
+                }
+                if (entry.processId == 0)
+                {
+                    THROW_HR_IF(E_OUTOFMEMORY, data.count >= static_cast<uint32_t>(c_maxInstanceCount));
+
+                    // The entry only appears once its process id is written.
+                    entry.startTime = startTime;
+                    entry.processId = processId;
+                    data.count++;
                     return;
                 }
             }
@@ -33,30 +86,132 @@ namespace winrt::Microsoft::Windows::AppLifecycle::implementation
             THROW_HR(E_OUTOFMEMORY);
         }
 
-        void Remove(DWORD processId)
+        // startTime 0 matches any instance with the process id.
+        void Remove(DWORD processId, uint64_t startTime = 0)
         {
-            for (DWORD index = 0; index < m_view.size(); index++)
+            auto releaseOnExit = Lock();
+            auto& data = *m_data.Get();
+            for (uint32_t probe = 0; probe < c_processListCapacity; probe++)
             {
-                if (m_view[index] == processId)
+                const auto index = (Hash(processId) + probe) & (c_processListCapacity - 1);
+                const auto& entry = data.entries[index];
+                if (entry.processId == 0)
+                {
+                    // Not found.
+                    return;
+                }
+                if (entry.processId == processId)
                 {
-                    m_view[index] = 0;
+                    if ((startTime == 0) || (entry.startTime == startTime))
+                    {
+                        RemoveAt(data, index);
+                        data.count--;
+                    }
                     return;
                 }
             }
         }
 
-        const DWORD Size()
+        // Snapshot of the instances.
+        std::vector<SharedProcessListRecord> GetAll()
         {
-            return m_view.size();
+            auto releaseOnExit = Lock();
+            std::vector<SharedProcessListRecord> records;
+            for (const auto& entry : m_data.Get()->entries)
+            {
+                if (entry.processId != 0)
+                {
+                    records.push_back({ entry.processId, entry.startTime });
+                }
+            }
+            return records;
         }
 
-        const DWORD operator[](int index)
+        static uint64_t GetProcessStartTime(HANDLE process)
         {
-            return m_view[index];
+            FILETIME creationTime{};
+            FILETIME exitTime{};
+            FILETIME kernelTime{};
+            FILETIME userTime{};
+            THROW_IF_WIN32_BOOL_FALSE(GetProcessTimes(process, &creationTime, &exitTime, &kernelTime, &userTime));
+            return (static_cast<uint64_t>(creationTime.dwHighDateTime) << 32) | creationTime.dwLowDateTime;
         }
 
     private:
+        static uint32_t Hash(DWORD processId)
+        {
+            // Fibonacci hashing of the process id (sans its always-zero low bits).
+            return static_cast<uint32_t>(((processId >> 2) * 2654435769u) >> 22);
+        }
+
+        wil::mutex_release_scope_exit Lock()
+        {
+            DWORD status{};
+            auto releaseOnExit = m_mutex.acquire(&status);
+            if (status == WAIT_ABANDONED)
+            {
+                Rebuild(*m_data.Get());
+            }
+            return releaseOnExit;
+        }
+
+        // Empties the entry at index, moving later entries of the probe sequence back into the gap.
+        static void RemoveAt(SharedProcessListData& data, uint32_t index)
+        {
+            auto gap = index;
+            data.entries[gap].processId = 0;
+            for (auto next = (gap + 1) & (c_processListCapacity - 1); data.entries[next].processId != 0; next = (next + 1) & (c_processListCapacity - 1))
+            {
+                // An entry can move back to the gap if the gap's between its home and where it is now.
+                const auto home = Hash(data.entries[next].processId);
+                const auto distanceFromHome = (next - home) & (c_processListCapacity - 1);
+                const auto distanceFromGap = (next - gap) & (c_processListCapacity - 1);
+                if (distanceFromGap <= distanceFromHome)
+                {
+                    // Copy then empty, so dying part way leaves a duplicate (dropped by Rebuild) rather than a loss.
+                    data.entries[gap].startTime = data.entries[next].startTime;
+                    data.entries[gap].processId = data.entries[next].processId;
+                    data.entries[next].processId = 0;
+                    gap = next;
+                }
+            }
+        }
+
+        // Reinserts the entries present, e.g. after an instance died part way through an update.
+        static void Rebuild(SharedProcessListData& data)
+        {
+            std::vector<SharedProcessListRecord> records;
+            for (auto& entry : data.entries)
+            {
+                if (entry.processId != 0)
+                {
+                    records.push_back({ entry.processId, entry.startTime });
+                }
+            }
+            memset(&data, 0, sizeof(data));
+
+            for (const auto& record : records)
+            {
+                for (uint32_t probe = 0; probe < c_processListCapacity; probe++)
+                {
+                    auto& entry = data.entries[(Hash(record.processId) + probe) & (c_processListCapacity - 1)];
+                    if (entry.processId == record.processId)
+                    {
+                        // Duplicate.
+                        break;
+                    }
+                    if (entry.processId == 0)
+                    {
+                        entry.startTime = record.startTime;
+                        entry.processId = record.processId;
+                        data.count++;
+                        break;
+                    }
+                }
+            }
+        }
+
+        wil::unique_mutex m_mutex;
         SharedMemory<SharedProcessListData> m_data;
-        winrt::array_view<DWORD> m_view;
     };
 }
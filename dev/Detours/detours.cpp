@@ -11,6 +11,7 @@
 //#define DETOUR_DEBUG 1
 #define DETOURS_INTERNAL
 #include "detours.h"
+#include <stdlib.h>
 
 #if DETOURS_VERSION != 0x4c0c1   // 0xMAJORcMINORcPATCH
 #error detours.h version mismatch
@@ -1512,7 +1513,26 @@ struct DetourOperation
     PBYTE *             ppbPointer;
     PBYTE               pbTarget;
     PDETOUR_TRAMPOLINE  pTrampoline;
-    ULONG               dwPerm;
+};
+
+// A page of target code made writable by the pending transaction.  Each page
+// is protected once, however many targets it holds, and restored at the end.
+struct DetourPage
+{
+    DetourPage *        pNext;      // Next page, in ascending address order.
+    PBYTE               pbPage;
+    ULONG               dwPerm;     // Protection to restore.
+    PBYTE               pbLow;      // First byte patched on this page.
+    PBYTE               pbHigh;     // Byte after the last patched on this page.
+};
+
+// The range of code a suspended thread may be executing in that an operation
+// moves elsewhere, used to fix up the thread's instruction pointer.
+struct DetourPatchedRange
+{
+    ULONG_PTR           pbStart;
+    ULONG_PTR           pbEnd;
+    DetourOperation *   pOperation;
 };
 
 static BOOL                 s_fIgnoreTooSmall       = FALSE;
@@ -1523,6 +1543,7 @@ static LONG                 s_nPendingError         = NO_ERROR;
 static PVOID *              s_ppPendingError        = NULL;
 static DetourThread *       s_pPendingThreads       = NULL;
 static DetourOperation *    s_pPendingOperations    = NULL;
+static DetourPage *         s_pPendingPages         = NULL;
 
 //////////////////////////////////////////////////////////////////////////////
 //
@@ -1578,6 +1599,7 @@ _Benign_race_end_
 
     s_pPendingOperations = NULL;
     s_pPendingThreads = NULL;
+    s_pPendingPages = NULL;
     s_ppPendingError = NULL;
 
     // Make sure the trampoline pages are writable.
@@ -1586,6 +1608,103 @@ _Benign_race_end_
     return s_nPendingError;
 }
 
+static ULONG_PTR detour_page_size()
+{
+    static ULONG_PTR s_cbPage = 0;
+
+    if (s_cbPage == 0) {
+        SYSTEM_INFO si;
+        GetSystemInfo(&si);
+        s_cbPage = si.dwPageSize;
+    }
+    return s_cbPage;
+}
+
+static LONG detour_writable_target(PBYTE pbTarget, LONG cbTarget)
+{
+    // Make every page under the target writable, unless an earlier operation
+    // in this transaction already did.
+    ULONG_PTR cbPage = detour_page_size();
+    PBYTE pbEnd = pbTarget + cbTarget;
+    DetourPage **ppPage = &s_pPendingPages;
+
+    for (PBYTE pbPage = (PBYTE)((ULONG_PTR)pbTarget & ~(cbPage - 1));
+         pbPage < pbEnd; pbPage += cbPage) {
+
+        while (*ppPage != NULL && (*ppPage)->pbPage < pbPage) {
+            ppPage = &(*ppPage)->pNext;
+        }
+
+        DetourPage *p = *ppPage;
+        if (p == NULL || p->pbPage != pbPage) {
+            p = new NOTHROW DetourPage;
+            if (p == NULL) {
+                return ERROR_NOT_ENOUGH_MEMORY;
+            }
+
+            DWORD dwOld = 0;
+            if (!VirtualProtect(pbPage, cbPage, PAGE_EXECUTE_READWRITE, &dwOld)) {
+                LONG error = GetLastError();
+                delete p;
+                return error;
+            }
+
+            p->pbPage = pbPage;
+            p->dwPerm = dwOld;
+            p->pbLow = pbPage + cbPage;
+            p->pbHigh = pbPage;
+            p->pNext = *ppPage;
+            *ppPage = p;
+        }
+
+        PBYTE pbLow = (pbTarget > pbPage) ? pbTarget : pbPage;
+        PBYTE pbHigh = (pbEnd < pbPage + cbPage) ? pbEnd : pbPage + cbPage;
+        if (pbLow < p->pbLow) {
+            p->pbLow = pbLow;
+        }
+        if (pbHigh > p->pbHigh) {
+            p->pbHigh = pbHigh;
+        }
+    }
+    return NO_ERROR;
+}
+
+static void detour_restore_target_pages(BOOL fFlush)
+{
+    HANDLE hProcess = GetCurrentProcess();
+    ULONG_PTR cbPage = detour_page_size();
+
+    for (DetourPage *p = s_pPendingPages; p != NULL;) {
+        // Restore each run of adjacent pages with the same protection at once.
+        DetourPage *pLast = p;
+        while (pLast->pNext != NULL &&
+               pLast->pNext->pbPage == pLast->pbPage + cbPage &&
+               pLast->pNext->dwPerm == p->dwPerm) {
+            pLast = pLast->pNext;
+        }
+
+        // We don't care if this fails, because the code is still accessible.
+        DWORD dwOld;
+        if (!VirtualProtect(p->pbPage, (pLast->pbPage + cbPage) - p->pbPage, p->dwPerm, &dwOld)) {
+            // The run crosses allocations, so fall back to a page at a time.
+            for (DetourPage *q = p; q != pLast->pNext; q = q->pNext) {
+                VirtualProtect(q->pbPage, cbPage, q->dwPerm, &dwOld);
+            }
+        }
+        if (fFlush) {
+            FlushInstructionCache(hProcess, p->pbLow, pLast->pbHigh - p->pbLow);
+        }
+
+        DetourPage *pNext = pLast->pNext;
+        while (p != pNext) {
+            DetourPage *n = p->pNext;
+            delete p;
+            p = n;
+        }
+    }
+    s_pPendingPages = NULL;
+}
+
 LONG WINAPI DetourTransactionAbort()
 {
     if (s_nPendingThreadId != (LONG)GetCurrentThreadId()) {
@@ -1593,12 +1712,9 @@ LONG WINAPI DetourTransactionAbort()
     }
 
     // Restore all of the page permissions.
-    for (DetourOperation *o = s_pPendingOperations; o != NULL;) {
-        // We don't care if this fails, because the code is still accessible.
-        DWORD dwOld;
-        VirtualProtect(o->pbTarget, o->pTrampoline->cbRestore,
-                       o->dwPerm, &dwOld);
+    detour_restore_target_pages(FALSE);
 
+    for (DetourOperation *o = s_pPendingOperations; o != NULL;) {
         if (!o->fIsRemove) {
             if (o->pTrampoline) {
                 detour_free_trampoline(o->pTrampoline);
@@ -1655,6 +1771,66 @@ static LONG detour_align_from_target(PDETOUR_TRAMPOLINE pTrampoline, LONG obTarg
     return 0;
 }
 
+static void detour_patched_range(DetourOperation *o, DetourPatchedRange *pRange)
+{
+    pRange->pOperation = o;
+    if (o->fIsRemove) {
+        // A thread in the trampoline moves back to the restored target.
+        pRange->pbStart = (ULONG_PTR)o->pTrampoline;
+        pRange->pbEnd = pRange->pbStart + sizeof(o->pTrampoline);
+    }
+    else {
+        // A thread in the overwritten target bytes moves to the trampoline.
+        pRange->pbStart = (ULONG_PTR)o->pbTarget;
+        pRange->pbEnd = pRange->pbStart + o->pTrampoline->cbRestore;
+    }
+}
+
+static int __cdecl detour_compare_patched_ranges(const void *pv1, const void *pv2)
+{
+    const DetourPatchedRange *p1 = (const DetourPatchedRange *)pv1;
+    const DetourPatchedRange *p2 = (const DetourPatchedRange *)pv2;
+
+    if (p1->pbStart < p2->pbStart) {
+        return -1;
+    }
+    return (p1->pbStart > p2->pbStart) ? 1 : 0;
+}
+
+static DetourOperation * detour_find_patched_range(const DetourPatchedRange *pRanges,
+                                                   ULONG cRanges,
+                                                   ULONG_PTR pbCode)
+{
+    // Find the last range starting at or below pbCode.
+    ULONG lo = 0;
+    ULONG hi = cRanges;
+    while (lo < hi) {
+        ULONG mid = lo + (hi - lo) / 2;
+        if (pRanges[mid].pbStart <= pbCode) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    if (lo > 0 && pbCode < pRanges[lo - 1].pbEnd) {
+        return pRanges[lo - 1].pOperation;
+    }
+    return NULL;
+}
+
+static DetourOperation * detour_find_patched_operation(ULONG_PTR pbCode)
+{
+    for (DetourOperation *o = s_pPendingOperations; o != NULL; o = o->pNext) {
+        DetourPatchedRange range;
+        detour_patched_range(o, &range);
+        if (pbCode >= range.pbStart && pbCode < range.pbEnd) {
+            return o;
+        }
+    }
+    return NULL;
+}
+
 LONG WINAPI DetourTransactionCommitEx(_Out_opt_ PVOID **pppFailedPointer)
 {
     if (pppFailedPointer != NULL) {
@@ -1809,6 +1985,25 @@ LONG WINAPI DetourTransactionCommitEx(_Out_opt_ PVOID **pppFailedPointer)
         }
     }
 
+    // Sort the patched ranges so each suspended thread needs one lookup.  If
+    // there isn't memory for that, search the pending operations instead.
+    ULONG cRanges = 0;
+    for (o = s_pPendingOperations; o != NULL; o = o->pNext) {
+        cRanges++;
+    }
+
+    DetourPatchedRange *pRanges = NULL;
+    if (s_pPendingThreads != NULL && cRanges > 0) {
+        pRanges = new NOTHROW DetourPatchedRange[cRanges];
+        if (pRanges != NULL) {
+            ULONG n = 0;
+            for (o = s_pPendingOperations; o != NULL; o = o->pNext) {
+                detour_patched_range(o, &pRanges[n++]);
+            }
+            qsort(pRanges, cRanges, sizeof(pRanges[0]), detour_compare_patched_ranges);
+        }
+    }
+
     // Update any suspended threads.
     for (t = s_pPendingThreads; t != NULL; t = t->pNext) {
         CONTEXT cxt;
@@ -1839,52 +2034,44 @@ LONG WINAPI DetourTransactionCommitEx(_Out_opt_ PVOID **pppFailedPointer)
 typedef ULONG_PTR DETOURS_EIP_TYPE;
 
         if (GetThreadContext(t->hThread, &cxt)) {
-            for (o = s_pPendingOperations; o != NULL; o = o->pNext) {
+            ULONG_PTR pbCode = (ULONG_PTR)cxt.DETOURS_EIP;
+            o = (pRanges != NULL)
+                ? detour_find_patched_range(pRanges, cRanges, pbCode)
+                : detour_find_patched_operation(pbCode);
+
+            if (o != NULL) {
                 if (o->fIsRemove) {
-                    if (cxt.DETOURS_EIP >= (DETOURS_EIP_TYPE)(ULONG_PTR)o->pTrampoline &&
-                        cxt.DETOURS_EIP < (DETOURS_EIP_TYPE)((ULONG_PTR)o->pTrampoline
-                                                             + sizeof(o->pTrampoline))
-                       ) {
-
-                        cxt.DETOURS_EIP = (DETOURS_EIP_TYPE)
-                            ((ULONG_PTR)o->pbTarget
-                             + detour_align_from_trampoline(o->pTrampoline,
-                                                            (BYTE)(cxt.DETOURS_EIP
-                                                                   - (DETOURS_EIP_TYPE)(ULONG_PTR)
-                                                                   o->pTrampoline)));
-
-                        SetThreadContext(t->hThread, &cxt);
-                    }
-                }
-                else {
-                    if (cxt.DETOURS_EIP >= (DETOURS_EIP_TYPE)(ULONG_PTR)o->pbTarget &&
-                        cxt.DETOURS_EIP < (DETOURS_EIP_TYPE)((ULONG_PTR)o->pbTarget
-                                                             + o->pTrampoline->cbRestore)
-                       ) {
-
-                        cxt.DETOURS_EIP = (DETOURS_EIP_TYPE)
-                            ((ULONG_PTR)o->pTrampoline
-                             + detour_align_from_target(o->pTrampoline,
+                    cxt.DETOURS_EIP = (DETOURS_EIP_TYPE)
+                        ((ULONG_PTR)o->pbTarget
+                         + detour_align_from_trampoline(o->pTrampoline,
                                                         (BYTE)(cxt.DETOURS_EIP
                                                                - (DETOURS_EIP_TYPE)(ULONG_PTR)
-                                                               o->pbTarget)));
-
-                        SetThreadContext(t->hThread, &cxt);
-                    }
+                                                               o->pTrampoline)));
                 }
+                else {
+                    cxt.DETOURS_EIP = (DETOURS_EIP_TYPE)
+                        ((ULONG_PTR)o->pTrampoline
+                         + detour_align_from_target(o->pTrampoline,
+                                                    (BYTE)(cxt.DETOURS_EIP
+                                                           - (DETOURS_EIP_TYPE)(ULONG_PTR)
+                                                           o->pbTarget)));
+                }
+
+                SetThreadContext(t->hThread, &cxt);
             }
         }
 #undef DETOURS_EIP
     }
 
+    if (pRanges != NULL) {
+        delete[] pRanges;
+        pRanges = NULL;
+    }
+
     // Restore all of the page permissions and flush the icache.
-    HANDLE hProcess = GetCurrentProcess();
-    for (o = s_pPendingOperations; o != NULL;) {
-        // We don't care if this fails, because the code is still accessible.
-        DWORD dwOld;
-        VirtualProtect(o->pbTarget, o->pTrampoline->cbRestore, o->dwPerm, &dwOld);
-        FlushInstructionCache(hProcess, o->pbTarget, o->pTrampoline->cbRestore);
+    detour_restore_target_pages(TRUE);
 
+    for (o = s_pPendingOperations; o != NULL;) {
         if (o->fIsRemove && o->pTrampoline) {
             detour_free_trampoline(o->pTrampoline);
             o->pTrampoline = NULL;
@@ -2289,9 +2476,8 @@ LONG WINAPI DetourAttachEx(_Inout_ PVOID *ppPointer,
 
     (void)pbTrampoline;
 
-    DWORD dwOld = 0;
-    if (!VirtualProtect(pbTarget, cbTarget, PAGE_EXECUTE_READWRITE, &dwOld)) {
-        error = GetLastError();
+    error = detour_writable_target(pbTarget, cbTarget);
+    if (error != NO_ERROR) {
         DETOUR_BREAK();
         goto fail;
     }
@@ -2320,7 +2506,6 @@ LONG WINAPI DetourAttachEx(_Inout_ PVOID *ppPointer,
     o->ppbPointer = (PBYTE*)ppPointer;
     o->pTrampoline = pTrampoline;
     o->pbTarget = pbTarget;
-    o->dwPerm = dwOld;
     o->pNext = s_pPendingOperations;
     s_pPendingOperations = o;
 
@@ -2447,10 +2632,8 @@ LONG WINAPI DetourDetach(_Inout_ PVOID *ppPointer,
         }
     }
 
-    DWORD dwOld = 0;
-    if (!VirtualProtect(pbTarget, cbTarget,
-                        PAGE_EXECUTE_READWRITE, &dwOld)) {
-        error = GetLastError();
+    error = detour_writable_target(pbTarget, cbTarget);
+    if (error != NO_ERROR) {
         DETOUR_BREAK();
         goto fail;
     }
@@ -2459,7 +2642,6 @@ LONG WINAPI DetourDetach(_Inout_ PVOID *ppPointer,
     o->ppbPointer = (PBYTE*)ppPointer;
     o->pTrampoline = pTrampoline;
     o->pbTarget = pbTarget;
-    o->dwPerm = dwOld;
     o->pNext = s_pPendingOperations;
     s_pPendingOperations = o;
 
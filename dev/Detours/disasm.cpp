@@ -319,6 +319,16 @@ PVOID WINAPI DetourCopyInstruction(_In_opt_ PVOID pDst,
 {
     UNREFERENCED_PARAMETER(ppDstPool);  // x86 & x64 don't use a constant pool.
 
+#if DETOUR_DEBUG
+    // Check the opcode tables once, before the first decode.
+    static LONG s_lSanityChecked = 0;
+    if (InterlockedCompareExchange(&s_lSanityChecked, 1, 0) == 0 &&
+        !CDetourDis::SanityCheckSystem()) {
+        DETOUR_TRACE(("DetourCopyInstruction: disassembler sanity check failed\n"));
+        DETOUR_BREAK();
+    }
+#endif
+
     CDetourDis oDetourDisasm((PBYTE*)ppTarget, plExtra);
     return oDetourDisasm.CopyInstruction((PBYTE)pDst, (PBYTE)pSrc);
 }
@@ -334,6 +344,7 @@ CDetourDis::CDetourDis(_Out_opt_ PBYTE *ppbTarget, _Out_opt_ LONG *plExtra)
     m_bF3 = FALSE;
     m_bVex = FALSE;
     m_bEvex = FALSE;
+    m_nSegmentOverride = 0;
 
     m_ppbTarget = ppbTarget ? ppbTarget : &m_pbScratchTarget;
     m_plExtra = plExtra ? plExtra : &m_lScratchExtra;
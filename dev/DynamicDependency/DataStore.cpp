@@ -13,25 +13,180 @@
 
 #include <shlobj.h>
 
+static std::mutex g_logsLock;
+static std::list<MddCore::DataStoreLog> g_logs;
+
 MddCore::PackageDependency MddCore::DataStore::Load(PCWSTR packageDependencyId)
 {
-    std::filesystem::path relativeFilename{ L"DynamicDependency" };
-    relativeFilename /= std::wstring(packageDependencyId) + DataStore::fileExtension;
+    for (const auto& dataStorePath : { GetDataStorePathForUser(), GetDataStorePathForSystem() })
+    {
+        auto& log{ GetLog(dataStorePath) };
+        const auto filename{ GetJSONFilename(log, packageDependencyId) };
+        auto packageDependency{ log.Find(packageDependencyId) };
+        if (!!packageDependency)
+        {
+            // Older runtimes only know the JSON file. If one deleted it the package dependency is gone
+            if (JSONFileExists(filename.c_str()))
+            {
+                return packageDependency;
+            }
+            try
+            {
+                log.Delete(packageDependencyId);
+            }
+            CATCH_LOG_MSG("%ls", log.Filename().c_str());
+            continue;
+        }
 
-    auto filename{ GetDataStorePathForUser() };
-    filename /= relativeFilename;
-    wil::unique_hfile file{ OpenFileIfExists(filename.c_str()) };
-    if (!file)
+        // Not migrated (yet)?
+        packageDependency = LoadJSON(filename.c_str());
+        if (!!packageDependency)
+        {
+            return packageDependency;
+        }
+    }
+
+    // Not found
+    return PackageDependency();
+}
+
+void MddCore::DataStore::Save(
+    const MddCore::PackageDependency& packageDependency,
+    const MddCreatePackageDependencyOptions options)
+{
+    // Package depednencies with LifetimeKind.Process are never saved to disk. They live in memory and end with the process
+    if (packageDependency.LifetimeKind() == MddPackageDependencyLifetimeKind::Process)
+    {
+        return;
+    }
+
+    // Write the JSON file too, so older runtimes running side-by-side see it
+    auto& log{ GetLog(GetDataStorePath(options)) };
+    SaveJSON(GetJSONFilename(log, packageDependency.Id().c_str()).c_str(), packageDependency);
+    log.Put(packageDependency);
+}
+
+void MddCore::DataStore::Delete(PCWSTR packageDependencyId)
+{
+    for (const auto& dataStorePath : { GetDataStorePathForUser(), GetDataStorePathForSystem() })
+    {
+        auto& log{ GetLog(dataStorePath) };
+        const auto filename{ GetJSONFilename(log, packageDependencyId) };
+        const auto deletedJSON{ DeleteFileIfExists(filename.c_str()) };
+        if (log.Delete(packageDependencyId) || deletedJSON)
+        {
+            return;
+        }
+    }
+}
+
+MddCore::DataStoreLog& MddCore::DataStore::GetLog(const std::filesystem::path& dataStorePath)
+{
+    const auto filename{ dataStorePath / L"DynamicDependency" / DataStore::logFilename };
+
+    std::unique_lock<std::mutex> lock(g_logsLock);
+    for (auto& log : g_logs)
+    {
+        if (log.Filename() == filename)
+        {
+            return log;
+        }
+    }
+
+    // First use in this process. Bring over any package dependencies stored the old way
+    // and GC any that expired or were deleted by an older runtime since the scope was last used
+    auto& log{ g_logs.emplace_back(filename) };
+    MigrateJSON(log);
+    DeleteStale(log);
+    return log;
+}
+
+void MddCore::DataStore::MigrateJSON(MddCore::DataStoreLog& log)
+{
+    // Best effort. Anything not migrated is still found via LoadJSON().
+    // The JSON files are left in place for older (side-by-side) runtimes still reading them
+    std::error_code errorCode;
+    for (const auto& entry : std::filesystem::directory_iterator(log.Filename().parent_path(), errorCode))
+    {
+        const auto& filename{ entry.path() };
+        if (filename.extension() != DataStore::fileExtension)
+        {
+            continue;
+        }
+
+        try
+        {
+            // Already migrated (by an earlier process)?
+            const auto packageDependencyId{ filename.stem().wstring() };
+            if (!!log.Find(packageDependencyId.c_str()))
+            {
+                continue;
+            }
+
+            auto packageDependency{ LoadJSON(filename.c_str()) };
+            if (!!packageDependency)
+            {
+                log.Put(packageDependency);
+            }
+        }
+        CATCH_LOG_MSG("%ls", filename.c_str());
+    }
+}
+
+void MddCore::DataStore::DeleteStale(MddCore::DataStoreLog& log)
+{
+    // Best effort. Anything missed is GC'd when it's next loaded (see Load() and PackageDependencyManager::GetPackageDependencyInDataStore())
+    try
     {
-        filename = GetDataStorePathForSystem();
-        filename /= relativeFilename;
-        file.reset(OpenFileIfExists(filename.c_str()));
-        if (!file)
+        for (const auto& packageDependency : log.GetAll())
         {
-            // Not found
-            return PackageDependency();
+            const auto filename{ GetJSONFilename(log, packageDependency.Id().c_str()) };
+            if (packageDependency.IsExpired())
+            {
+                // Delete the JSON file too, else the next process' MigrateJSON() would bring it back
+                DeleteFileIfExists(filename.c_str());
+                log.Delete(packageDependency.Id().c_str());
+            }
+            else if (!JSONFileExists(filename.c_str()))
+            {
+                // Deleted by an older runtime
+                log.Delete(packageDependency.Id().c_str());
+            }
         }
     }
+    CATCH_LOG_MSG("%ls", log.Filename().c_str());
+}
+
+std::filesystem::path MddCore::DataStore::GetJSONFilename(
+    const MddCore::DataStoreLog& log,
+    PCWSTR packageDependencyId)
+{
+    return log.Filename().parent_path() / (std::wstring(packageDependencyId) + DataStore::fileExtension);
+}
+
+bool MddCore::DataStore::JSONFileExists(PCWSTR filename)
+{
+    const auto attributes{ ::GetFileAttributesW(filename) };
+    if (attributes == INVALID_FILE_ATTRIBUTES)
+    {
+        const auto lastError{ GetLastError() };
+        if ((lastError == ERROR_FILE_NOT_FOUND) || (lastError == ERROR_PATH_NOT_FOUND))
+        {
+            return false;
+        }
+        THROW_WIN32_MSG(lastError, "Error %d querying file %ls", lastError, filename);
+    }
+    return true;
+}
+
+MddCore::PackageDependency MddCore::DataStore::LoadJSON(PCWSTR filename)
+{
+    wil::unique_hfile file{ OpenFileIfExists(filename) };
+    if (!file)
+    {
+        // Not found
+        return PackageDependency();
+    }
 
     LARGE_INTEGER fileSize{};
     THROW_IF_WIN32_BOOL_FALSE(::GetFileSizeEx(file.get(), &fileSize));
@@ -55,50 +210,28 @@ MddCore::PackageDependency MddCore::DataStore::Load(PCWSTR packageDependencyId)
     bufferUtf8[bytesRead] = '\0';
     auto json{ bufferUtf8.get() };
 
-    return MddCore::PackageDependency::FromJSON(json);
+    // The id is the filename, not part of the JSON
+    auto packageDependency{ MddCore::PackageDependency::FromJSON(json) };
+    packageDependency.Id(std::filesystem::path(filename).stem().wstring());
+    return packageDependency;
 }
 
-void MddCore::DataStore::Save(
-    const MddCore::PackageDependency& packageDependency,
-    const MddCreatePackageDependencyOptions options)
+void MddCore::DataStore::SaveJSON(
+    PCWSTR filename,
+    const MddCore::PackageDependency& packageDependency)
 {
-    // Package depednencies with LifetimeKind.Process are never saved to disk. They live in memory and end with the process
-    if (packageDependency.LifetimeKind() == MddPackageDependencyLifetimeKind::Process)
-    {
-        return;
-    }
-
     auto json{ packageDependency.ToJSONUtf8() };
 
-    auto path{ GetDataStorePath(options) };
-    path /= L"DynamicDependency";
-    std::filesystem::create_directory(path);
+    std::filesystem::create_directories(std::filesystem::path(filename).parent_path());
 
-    auto filename{ path / (packageDependency.Id() + DataStore::fileExtension) };
-
-    wil::unique_hfile file{ ::CreateFileW(filename.c_str(), GENERIC_WRITE, FILE_SHARE_DELETE, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+    wil::unique_hfile file{ ::CreateFileW(filename, GENERIC_WRITE, FILE_SHARE_DELETE, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
     if (!file)
     {
-        THROW_LAST_ERROR_MSG("%ls", filename.c_str());
+        THROW_LAST_ERROR_MSG("%ls", filename);
     }
 
     DWORD bytesWritten{};
-    THROW_IF_WIN32_BOOL_FALSE_MSG(::WriteFile(file.get(), json.c_str(), static_cast<DWORD>(json.length()), &bytesWritten, nullptr), "%ls", filename.c_str());
-}
-
-void MddCore::DataStore::Delete(PCWSTR packageDependencyId)
-{
-    std::filesystem::path relativeFilename{ L"DynamicDependency" };
-    relativeFilename /= std::wstring(packageDependencyId) + DataStore::fileExtension;
-
-    auto filename{ GetDataStorePathForUser() };
-    filename /= relativeFilename;
-    if (!DeleteFileIfExists(filename.c_str()))
-    {
-        filename = GetDataStorePathForSystem();
-        filename /= relativeFilename;
-        DeleteFileIfExists(filename.c_str());
-    }
+    THROW_IF_WIN32_BOOL_FALSE_MSG(::WriteFile(file.get(), json.c_str(), static_cast<DWORD>(json.length()), &bytesWritten, nullptr), "%ls", filename);
 }
 
 bool MddCore::DataStore::DeleteFileIfExists(PCWSTR filename)
@@ -4,9 +4,20 @@
 #pragma once
 
 #include "PackageDependency.h"
+#include "DataStoreLog.h"
 
 namespace MddCore
 {
+    /// Package dependencies are stored in a DataStoreLog per scope (user, system).
+    ///
+    /// Older releases stored each package dependency in its own JSON file (<id>.mdd). These are
+    /// migrated into the log the first time the scope's log is used in a process, and read as a
+    /// fallback until then (or if migration fails, e.g. no write access to the system scope).
+    ///
+    /// Older runtimes running side-by-side only know the JSON files, so they stay the source of
+    /// truth for whether a package dependency exists: Save writes both, Delete deletes both, and a
+    /// log record whose JSON file is gone (deleted by an older runtime) is treated as deleted.
+    /// Expired package dependencies are GC'd the first time the scope's log is used.
     class DataStore
     {
     public:
@@ -15,6 +26,7 @@ namespace MddCore
 
     public:
         static constexpr PCWSTR fileExtension{ L".mdd" };
+        static constexpr PCWSTR logFilename{ L"PackageDependencies.log" };
 
         static MddCore::PackageDependency Load(PCWSTR packageDependencyId);
 
@@ -25,6 +37,24 @@ namespace MddCore
         static void Delete(PCWSTR packageDependencyId);
 
     private:
+        static MddCore::DataStoreLog& GetLog(const std::filesystem::path& dataStorePath);
+
+        static void MigrateJSON(MddCore::DataStoreLog& log);
+
+        static void DeleteStale(MddCore::DataStoreLog& log);
+
+        static std::filesystem::path GetJSONFilename(
+            const MddCore::DataStoreLog& log,
+            PCWSTR packageDependencyId);
+
+        static bool JSONFileExists(PCWSTR filename);
+
+        static MddCore::PackageDependency LoadJSON(PCWSTR filename);
+
+        static void SaveJSON(
+            PCWSTR filename,
+            const MddCore::PackageDependency& packageDependency);
+
         static bool DeleteFileIfExists(PCWSTR filename);
 
         static HANDLE OpenFileIfExists(PCWSTR filename);
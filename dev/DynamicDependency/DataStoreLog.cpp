@@ -0,0 +1,374 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "DataStoreLog.h"
+
+MddCore::PackageDependency MddCore::DataStoreLog::Find(PCWSTR packageDependencyId)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    wil::unique_hfile file{ OpenAndLock(false) };
+    if (!file)
+    {
+        // Not found
+        return MddCore::PackageDependency();
+    }
+    Refresh(file.get());
+
+    auto iterator{ m_index.find(ToKey(packageDependencyId)) };
+    if (iterator == m_index.end())
+    {
+        // Not found
+        return MddCore::PackageDependency();
+    }
+    return iterator->second.packageDependency;
+}
+
+std::vector<MddCore::PackageDependency> MddCore::DataStoreLog::GetAll()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    std::vector<MddCore::PackageDependency> packageDependencies;
+    wil::unique_hfile file{ OpenAndLock(false) };
+    if (file)
+    {
+        Refresh(file.get());
+
+        packageDependencies.reserve(m_index.size());
+        for (const auto& entry : m_index)
+        {
+            packageDependencies.push_back(entry.second.packageDependency);
+        }
+    }
+    return packageDependencies;
+}
+
+void MddCore::DataStoreLog::Put(const MddCore::PackageDependency& packageDependency)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    wil::unique_hfile file{ OpenAndLock(true) };
+    Refresh(file.get());
+    Append(file.get(), RecordType::Put, packageDependency.ToBinary());
+
+    if (ShouldCompact())
+    {
+        Compact();
+    }
+}
+
+bool MddCore::DataStoreLog::Delete(PCWSTR packageDependencyId)
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+
+    wil::unique_hfile file{ OpenAndLock(true) };
+    Refresh(file.get());
+    auto iterator{ m_index.find(ToKey(packageDependencyId)) };
+    if (iterator == m_index.end())
+    {
+        // Not found
+        return false;
+    }
+
+    // Delete records only need the id (the rest of the package dependency is ignored)
+    MddCore::PackageDependency deleted;
+    deleted.Id(iterator->second.packageDependency.Id());
+    Append(file.get(), RecordType::Delete, deleted.ToBinary());
+
+    if (ShouldCompact())
+    {
+        Compact();
+    }
+    return true;
+}
+
+std::vector<uint8_t> MddCore::DataStoreLog::EncodeRecord(
+    const RecordType type,
+    const std::vector<uint8_t>& payload)
+{
+    RecordHeader header{};
+    header.type = static_cast<uint32_t>(type);
+    header.payloadSize = static_cast<uint32_t>(payload.size());
+    header.checksum = Checksum(payload.data(), payload.size());
+
+    std::vector<uint8_t> record(sizeof(header) + payload.size());
+    memcpy(record.data(), &header, sizeof(header));
+    if (!payload.empty())
+    {
+        memcpy(record.data() + sizeof(header), payload.data(), payload.size());
+    }
+    return record;
+}
+
+size_t MddCore::DataStoreLog::DecodeRecords(
+    const uint8_t* data,
+    const size_t dataSize,
+    const std::function<void(RecordType, const uint8_t*, size_t, size_t)>& onRecord)
+{
+    size_t offset{};
+    while (dataSize - offset >= sizeof(RecordHeader))
+    {
+        RecordHeader header{};
+        memcpy(&header, data + offset, sizeof(header));
+        if ((header.type != static_cast<uint32_t>(RecordType::Put)) && (header.type != static_cast<uint32_t>(RecordType::Delete)))
+        {
+            break;
+        }
+        if (header.payloadSize > dataSize - offset - sizeof(header))
+        {
+            break;
+        }
+        const auto payload{ data + offset + sizeof(header) };
+        if (header.checksum != Checksum(payload, header.payloadSize))
+        {
+            break;
+        }
+
+        const auto recordSize{ sizeof(header) + header.payloadSize };
+        onRecord(static_cast<RecordType>(header.type), payload, header.payloadSize, recordSize);
+        offset += recordSize;
+    }
+    return offset;
+}
+
+uint64_t MddCore::DataStoreLog::Checksum(
+    const uint8_t* data,
+    const size_t dataSize)
+{
+    uint64_t hash{ 0xCBF29CE484222325ull };
+    for (size_t index=0; index < dataSize; ++index)
+    {
+        hash ^= data[index];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+std::wstring MddCore::DataStoreLog::ToKey(PCWSTR packageDependencyId)
+{
+    // Ids are case insensitive (like the per-id files they replace). Fold case the same way
+    // regardless of the CRT's locale, uppercasing as the file system does for names
+    const int length{ static_cast<int>(wcslen(packageDependencyId)) };
+    std::wstring key(length, L'\0');
+    if (length > 0)
+    {
+        THROW_LAST_ERROR_IF(::LCMapStringEx(LOCALE_NAME_INVARIANT, LCMAP_UPPERCASE, packageDependencyId, length,
+                                            key.data(), length, nullptr, nullptr, 0) == 0);
+    }
+    return key;
+}
+
+wil::unique_hfile MddCore::DataStoreLog::OpenAndLock(const bool forWrite)
+{
+    if (forWrite)
+    {
+        std::filesystem::create_directories(m_filename.parent_path());
+    }
+
+    // Compaction replaces the log. If that happens between opening and locking the log we've got
+    // the old (now deleted) file, so try again
+    for (;;)
+    {
+        const DWORD desiredAccess{ forWrite ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ };
+        const DWORD creationDisposition{ forWrite ? static_cast<DWORD>(OPEN_ALWAYS) : static_cast<DWORD>(OPEN_EXISTING) };
+        wil::unique_hfile file{ ::CreateFileW(m_filename.c_str(), desiredAccess, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, creationDisposition, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        if (!file)
+        {
+            const auto lastError{ GetLastError() };
+            if (!forWrite && ((lastError == ERROR_FILE_NOT_FOUND) || (lastError == ERROR_PATH_NOT_FOUND)))
+            {
+                return {};
+            }
+            THROW_WIN32_MSG(lastError, "Error %d opening file %ls", lastError, m_filename.c_str());
+        }
+
+        // Released when the handle is closed
+        OVERLAPPED overlapped{};
+        overlapped.Offset = MAXDWORD;
+        overlapped.OffsetHigh = MAXDWORD;
+        THROW_IF_WIN32_BOOL_FALSE_MSG(::LockFileEx(file.get(), forWrite ? LOCKFILE_EXCLUSIVE_LOCK : 0, 0, 1, 0, &overlapped), "%ls", m_filename.c_str());
+
+        FILE_STANDARD_INFO standardInfo{};
+        THROW_IF_WIN32_BOOL_FALSE(::GetFileInformationByHandleEx(file.get(), FileStandardInfo, &standardInfo, sizeof(standardInfo)));
+        if (!standardInfo.DeletePending && (standardInfo.NumberOfLinks > 0))
+        {
+            return file;
+        }
+    }
+}
+
+void MddCore::DataStoreLog::Refresh(HANDLE file)
+{
+    BY_HANDLE_FILE_INFORMATION fileInformation{};
+    THROW_IF_WIN32_BOOL_FALSE(::GetFileInformationByHandle(file, &fileInformation));
+    const uint64_t fileId{ (static_cast<uint64_t>(fileInformation.nFileIndexHigh) << 32) | fileInformation.nFileIndexLow };
+    const uint64_t fileSize{ (static_cast<uint64_t>(fileInformation.nFileSizeHigh) << 32) | fileInformation.nFileSizeLow };
+
+    // A different file (e.g. compacted by another process) or a shorter one (e.g. truncated torn tail) invalidates the index
+    if ((fileId != m_fileId) || (fileSize < m_scannedSize))
+    {
+        ResetIndex();
+        m_fileId = fileId;
+    }
+
+    if (m_scannedSize == 0)
+    {
+        if (fileSize < sizeof(LogHeader))
+        {
+            // New (or never completely initialized) log
+            return;
+        }
+
+        LogHeader header{};
+        LARGE_INTEGER offset{};
+        THROW_IF_WIN32_BOOL_FALSE(::SetFilePointerEx(file, offset, nullptr, FILE_BEGIN));
+        DWORD bytesRead{};
+        THROW_IF_WIN32_BOOL_FALSE(::ReadFile(file, &header, sizeof(header), &bytesRead, nullptr));
+        THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), (bytesRead != sizeof(header)) || (header.magic != c_magic), "%ls", m_filename.c_str());
+        THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_UNSUPPORTED_TYPE), header.version != c_version, "%ls version %u", m_filename.c_str(), header.version);
+        m_scannedSize = sizeof(header);
+    }
+
+    // Read whatever was appended since we last looked
+    const auto tailSize{ fileSize - m_scannedSize };
+    if (tailSize == 0)
+    {
+        return;
+    }
+    THROW_HR_IF_MSG(HRESULT_FROM_WIN32(ERROR_FILE_TOO_LARGE), tailSize > INT32_MAX, "%ls", m_filename.c_str());
+    std::vector<uint8_t> tail(static_cast<size_t>(tailSize));
+    LARGE_INTEGER offset{};
+    offset.QuadPart = static_cast<LONGLONG>(m_scannedSize);
+    THROW_IF_WIN32_BOOL_FALSE(::SetFilePointerEx(file, offset, nullptr, FILE_BEGIN));
+    DWORD bytesRead{};
+    THROW_IF_WIN32_BOOL_FALSE(::ReadFile(file, tail.data(), static_cast<DWORD>(tail.size()), &bytesRead, nullptr));
+
+    // Anything past the last valid record is a torn write. Leave it for the next append to truncate
+    m_scannedSize += DecodeRecords(tail.data(), bytesRead,
+        [&](RecordType type, const uint8_t* payload, size_t payloadSize, size_t recordSize)
+        {
+            Apply(type, payload, payloadSize, recordSize);
+        });
+}
+
+void MddCore::DataStoreLog::ResetIndex()
+{
+    m_index.clear();
+    m_fileId = 0;
+    m_scannedSize = 0;
+    m_liveBytes = 0;
+    m_deadBytes = 0;
+}
+
+void MddCore::DataStoreLog::Apply(
+    const RecordType type,
+    const uint8_t* payload,
+    const size_t payloadSize,
+    const size_t recordSize)
+{
+    auto packageDependency{ MddCore::PackageDependency::FromBinary(payload, payloadSize) };
+    auto key{ ToKey(packageDependency.Id().c_str()) };
+
+    // Whatever this record replaces (or deletes) is now dead weight
+    auto iterator{ m_index.find(key) };
+    if (iterator != m_index.end())
+    {
+        m_liveBytes -= iterator->second.recordSize;
+        m_deadBytes += iterator->second.recordSize;
+        m_index.erase(iterator);
+    }
+
+    if (type == RecordType::Put)
+    {
+        m_index.emplace(std::move(key), IndexEntry{ std::move(packageDependency), recordSize });
+        m_liveBytes += recordSize;
+    }
+    else
+    {
+        m_deadBytes += recordSize;
+    }
+}
+
+void MddCore::DataStoreLog::Append(
+    HANDLE file,
+    const RecordType type,
+    const std::vector<uint8_t>& payload)
+{
+    // Discard any torn tail and initialize a new log
+    LARGE_INTEGER offset{};
+    offset.QuadPart = static_cast<LONGLONG>(m_scannedSize);
+    THROW_IF_WIN32_BOOL_FALSE(::SetFilePointerEx(file, offset, nullptr, FILE_BEGIN));
+    THROW_IF_WIN32_BOOL_FALSE(::SetEndOfFile(file));
+    DWORD bytesWritten{};
+    if (m_scannedSize == 0)
+    {
+        const LogHeader header{ c_magic, c_version };
+        THROW_IF_WIN32_BOOL_FALSE_MSG(::WriteFile(file, &header, sizeof(header), &bytesWritten, nullptr), "%ls", m_filename.c_str());
+        m_scannedSize = sizeof(header);
+    }
+
+    const auto record{ EncodeRecord(type, payload) };
+    THROW_IF_WIN32_BOOL_FALSE_MSG(::WriteFile(file, record.data(), static_cast<DWORD>(record.size()), &bytesWritten, nullptr), "%ls", m_filename.c_str());
+    THROW_IF_WIN32_BOOL_FALSE_MSG(::FlushFileBuffers(file), "%ls", m_filename.c_str());
+
+    Apply(type, payload.data(), payload.size(), record.size());
+    m_scannedSize += record.size();
+}
+
+bool MddCore::DataStoreLog::ShouldCompact() const
+{
+    return (m_deadBytes >= c_compactionMinimumDeadBytes) && (m_deadBytes > m_liveBytes);
+}
+
+void MddCore::DataStoreLog::Compact() try
+{
+    // NOTE: Caller must hold m_lock and the log's exclusive lock
+
+    // Write the live records to a new file and, once that's safely on disk, swap it in for the log.
+    // If we crash before the swap the log is unchanged and the temporary file is overwritten next time
+    auto tempFilename{ m_filename };
+    tempFilename += L".tmp";
+    wil::unique_hfile tempFile{ ::CreateFileW(tempFilename.c_str(), GENERIC_READ | GENERIC_WRITE | DELETE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+    THROW_LAST_ERROR_IF_MSG(!tempFile, "%ls", tempFilename.c_str());
+
+    std::vector<uint8_t> data;
+    const LogHeader header{ c_magic, c_version };
+    data.insert(data.end(), reinterpret_cast<const uint8_t*>(&header), reinterpret_cast<const uint8_t*>(&header + 1));
+    for (const auto& entry : m_index)
+    {
+        const auto record{ EncodeRecord(RecordType::Put, entry.second.packageDependency.ToBinary()) };
+        data.insert(data.end(), record.begin(), record.end());
+    }
+    DWORD bytesWritten{};
+    THROW_IF_WIN32_BOOL_FALSE_MSG(::WriteFile(tempFile.get(), data.data(), static_cast<DWORD>(data.size()), &bytesWritten, nullptr), "%ls", tempFilename.c_str());
+    THROW_IF_WIN32_BOOL_FALSE_MSG(::FlushFileBuffers(tempFile.get()), "%ls", tempFilename.c_str());
+
+    // The file id survives the rename so we know the new log's already indexed
+    BY_HANDLE_FILE_INFORMATION fileInformation{};
+    THROW_IF_WIN32_BOOL_FALSE(::GetFileInformationByHandle(tempFile.get(), &fileInformation));
+
+    // Swap it in while we still hold the log's exclusive lock, so no one can append to the old log
+    // in the meantime. The log's open (by our caller and maybe other processes) but always with
+    // FILE_SHARE_DELETE, which a POSIX semantics rename needs to replace it. A plain rename
+    // (e.g. MoveFileEx) fails while the target's open. Anyone holding the old log notices it's
+    // gone when they lock it (see OpenAndLock())
+    const auto& filename{ m_filename.native() };
+    const auto renameInfoSize{ offsetof(FILE_RENAME_INFO, FileName) + ((filename.size() + 1) * sizeof(WCHAR)) };
+    std::unique_ptr<uint8_t[]> renameInfoBuffer{ std::make_unique<uint8_t[]>(renameInfoSize) };
+    auto renameInfo{ reinterpret_cast<FILE_RENAME_INFO*>(renameInfoBuffer.get()) };
+    renameInfo->Flags = FILE_RENAME_FLAG_REPLACE_IF_EXISTS | FILE_RENAME_FLAG_POSIX_SEMANTICS;
+    renameInfo->RootDirectory = nullptr;
+    renameInfo->FileNameLength = static_cast<DWORD>(filename.size() * sizeof(WCHAR));
+    memcpy(renameInfo->FileName, filename.c_str(), (filename.size() + 1) * sizeof(WCHAR));
+    THROW_IF_WIN32_BOOL_FALSE_MSG(::SetFileInformationByHandle(tempFile.get(), FileRenameInfoEx, renameInfo, static_cast<DWORD>(renameInfoSize)),
+                                  "%ls -> %ls", tempFilename.c_str(), m_filename.c_str());
+    tempFile.reset();
+
+    m_fileId = (static_cast<uint64_t>(fileInformation.nFileIndexHigh) << 32) | fileInformation.nFileIndexLow;
+    m_scannedSize = data.size();
+    m_liveBytes = data.size() - sizeof(header);
+    m_deadBytes = 0;
+}
+CATCH_LOG()
@@ -0,0 +1,137 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include "PackageDependency.h"
+
+namespace MddCore
+{
+/// Append-only log of package dependencies with an in-memory index.
+///
+/// Put and Delete append a record to the log. The index (id -> package dependency) is built by
+/// replaying the log and refreshed incrementally by reading only what was appended since the last
+/// refresh, so Find() is O(1) and GetAll() is O(n) with no per-id file I/O. The file layout is
+/// ~~~~~
+///   LogHeader
+///   { RecordHeader, BYTE[payloadSize] }...
+/// ~~~~~
+/// Each record carries a checksum of its payload. A record that's incomplete or fails its checksum
+/// (e.g. power lost mid-write) ends the log; the next append truncates it. When superseded records
+/// outweigh live ones the log is compacted into a temporary file which then replaces the log.
+///
+/// Multiple processes can share the log. Readers take a shared lock (and writers an exclusive lock)
+/// on a byte range beyond any real data, so only access to the log is serialized, not its content.
+class DataStoreLog
+{
+public:
+    DataStoreLog(const std::filesystem::path& filename) :
+        m_filename(filename)
+    {
+    }
+
+    ~DataStoreLog() = default;
+
+    DataStoreLog(const DataStoreLog&) = delete;
+    DataStoreLog& operator=(const DataStoreLog&) = delete;
+
+public:
+    const std::filesystem::path& Filename() const
+    {
+        return m_filename;
+    }
+
+    /// Return the package dependency or an empty PackageDependency if not found.
+    MddCore::PackageDependency Find(PCWSTR packageDependencyId);
+
+    std::vector<MddCore::PackageDependency> GetAll();
+
+    void Put(const MddCore::PackageDependency& packageDependency);
+
+    /// Return true if the package dependency was found (and deleted), else false.
+    bool Delete(PCWSTR packageDependencyId);
+
+public:
+    enum class RecordType : uint32_t
+    {
+        Put = 1,
+        Delete = 2,
+    };
+
+    static std::vector<uint8_t> EncodeRecord(
+        const RecordType type,
+        const std::vector<uint8_t>& payload);
+
+    /// Decode the complete and valid records at the start of data, calling onRecord(type, payload, payloadSize, recordSize)
+    /// for each. Returns the number of bytes decoded i.e. the offset of the first incomplete or invalid record.
+    static size_t DecodeRecords(
+        const uint8_t* data,
+        const size_t dataSize,
+        const std::function<void(RecordType, const uint8_t*, size_t, size_t)>& onRecord);
+
+    /// 64-bit FNV-1a
+    static uint64_t Checksum(
+        const uint8_t* data,
+        const size_t dataSize);
+
+private:
+    struct IndexEntry
+    {
+        MddCore::PackageDependency packageDependency;
+        size_t recordSize{};
+    };
+
+    static std::wstring ToKey(PCWSTR packageDependencyId);
+
+    /// Open the log and lock it. Returns an empty handle if opening for read and the log doesn't exist.
+    wil::unique_hfile OpenAndLock(const bool forWrite);
+
+    void Refresh(HANDLE file);
+
+    void ResetIndex();
+
+    void Apply(
+        const RecordType type,
+        const uint8_t* payload,
+        const size_t payloadSize,
+        const size_t recordSize);
+
+    void Append(
+        HANDLE file,
+        const RecordType type,
+        const std::vector<uint8_t>& payload);
+
+    bool ShouldCompact() const;
+
+    void Compact();
+
+private:
+    static constexpr uint32_t c_magic{ 0x4C44444D };  // 'MDDL'
+    static constexpr uint32_t c_version{ 1 };
+
+    // Compact once superseded records occupy at least this much of the log, and more than live records
+    static constexpr uint64_t c_compactionMinimumDeadBytes{ 64 * 1024 };
+
+    struct LogHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+    };
+
+    struct RecordHeader
+    {
+        uint32_t type;
+        uint32_t payloadSize;
+        uint64_t checksum;
+    };
+
+private:
+    std::mutex m_lock;
+    std::filesystem::path m_filename;
+    uint64_t m_fileId{};
+    uint64_t m_scannedSize{};
+    uint64_t m_liveBytes{};
+    uint64_t m_deadBytes{};
+    std::unordered_map<std::wstring, IndexEntry> m_index;
+};
+}
@@ -0,0 +1,23 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#if !defined(MDDPACKAGEGRAPHUPDATE_H)
+#define MDDPACKAGEGRAPHUPDATE_H
+
+DECLARE_HANDLE(MDD_PACKAGEGRAPHUPDATE_CONTEXT);
+
+/// Batch changes to the caller's package graph. PATH updates by MddAddPackageDependency()
+/// and MddRemovePackageDependency() are deferred until the last open batch is ended, so
+/// adding N package dependencies rewrites PATH once rather than N times.
+///
+/// @param packageGraphUpdateContext end the batch via MddEndPackageGraphUpdate().
+///
+/// @note The package graph is process-wide so changes by other threads are also deferred until then.
+STDAPI MddBeginPackageGraphUpdate(
+    _Out_ MDD_PACKAGEGRAPHUPDATE_CONTEXT* packageGraphUpdateContext) noexcept;
+
+/// End a batch started by MddBeginPackageGraphUpdate(), updating PATH if it's the last open batch.
+STDAPI_(void) MddEndPackageGraphUpdate(
+    _In_ MDD_PACKAGEGRAPHUPDATE_CONTEXT packageGraphUpdateContext) noexcept;
+
+#endif // MDDPACKAGEGRAPHUPDATE_H
@@ -6,6 +6,7 @@
 #include "msixdynamicdependency.h"
 
 #include "MddDetourPackageGraph.h"
+#include "MddPackageGraphUpdate.h"
 #include "PackageDependencyManager.h"
 #include "PackageGraphManager.h"
 
@@ -92,6 +93,30 @@ STDAPI_(void) MddRemovePackageDependency(
 }
 CATCH_LOG();
 
+STDAPI MddBeginPackageGraphUpdate(
+    _Out_ MDD_PACKAGEGRAPHUPDATE_CONTEXT* packageGraphUpdateContext) noexcept try
+{
+    // Dynamic Dependencies doesn't support elevation. See Issue #567 https://github.com/microsoft/ProjectReunion/issues/567
+    MddCore::FailFastIfElevated();
+
+    *packageGraphUpdateContext = nullptr;
+
+    // Dynamic Dependencies requires a non-packaged process
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED), AppModel::Identity::IsPackagedProcess());
+
+    auto batch{ std::make_unique<MddCore::PackageGraphManager::PathUpdateBatch>() };
+    *packageGraphUpdateContext = reinterpret_cast<MDD_PACKAGEGRAPHUPDATE_CONTEXT>(batch.release());
+    return S_OK;
+}
+CATCH_RETURN();
+
+STDAPI_(void) MddEndPackageGraphUpdate(
+    _In_ MDD_PACKAGEGRAPHUPDATE_CONTEXT packageGraphUpdateContext) noexcept
+{
+    // Destroying the batch applies any deferred PATH update (if it's the last open batch)
+    std::unique_ptr<MddCore::PackageGraphManager::PathUpdateBatch> batch{ reinterpret_cast<MddCore::PackageGraphManager::PathUpdateBatch*>(packageGraphUpdateContext) };
+}
+
 STDAPI MddGetResolvedPackageFullNameForPackageDependency(
     _In_ PCWSTR packageDependencyId,
     _Outptr_result_maybenull_ PWSTR* packageFullName) noexcept try
@@ -0,0 +1,86 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "PackageBestFit.h"
+
+std::wstring MddCore::PackageBestFit::Find(
+    MddCore::PackageCatalog& packageCatalog,
+    const MddCore::PackageDependency& packageDependency,
+    const MddCore::Architecture currentArchitecture)
+{
+    // Determine the packages in the family meeting the version and architecture filters
+    auto candidates{ packageCatalog.FindPackagesByFamily(packageDependency.PackageFamilyName()) };
+    const auto minVersion{ packageDependency.MinVersion().Version };
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+        [&](const MddCore::PackageCandidate& candidate)
+        {
+            return (candidate.version < minVersion) || !IsArchitectureAcceptable(candidate, packageDependency, currentArchitecture);
+        }), candidates.end());
+
+    // Rank them
+    const bool preferArchitectureSpecific{ packageDependency.Architectures() == MddPackageDependencyProcessorArchitectures::None };
+    std::sort(candidates.begin(), candidates.end(),
+        [&](const MddCore::PackageCandidate& lhs, const MddCore::PackageCandidate& rhs)
+        {
+            return IsBetterFit(lhs, rhs, preferArchitectureSpecific);
+        });
+
+    // The best fit is the highest ranked package whose status is OK. Usually that's the first one
+    // (and its status is cached) so check them in order on the caller's thread
+    for (const auto& candidate : candidates)
+    {
+        if (packageCatalog.IsPackageStatusOK(candidate))
+        {
+            return candidate.packageFullName;
+        }
+    }
+
+    // No package satisfies the package dependency
+    return std::wstring();
+}
+
+bool MddCore::PackageBestFit::IsBetterFit(
+    const MddCore::PackageCandidate& lhs,
+    const MddCore::PackageCandidate& rhs,
+    const bool preferArchitectureSpecific)
+{
+    // Higher version is always better
+    if (lhs.version != rhs.version)
+    {
+        return lhs.version > rhs.version;
+    }
+
+    // Architecture-specific is better than architecture-neutral
+    if (preferArchitectureSpecific)
+    {
+        const bool isLhsNeutral{ lhs.architecture == MddCore::Architecture::Neutral };
+        const bool isRhsNeutral{ rhs.architecture == MddCore::Architecture::Neutral };
+        if (isLhsNeutral != isRhsNeutral)
+        {
+            return isRhsNeutral;
+        }
+    }
+
+    // No meaningful difference but we still need a winner, and the same winner every time
+    return lhs.packageFullName < rhs.packageFullName;
+}
+
+bool MddCore::PackageBestFit::IsArchitectureAcceptable(
+    const MddCore::PackageCandidate& candidate,
+    const MddCore::PackageDependency& packageDependency,
+    const MddCore::Architecture currentArchitecture)
+{
+    if (candidate.architecture == MddCore::Architecture::Unknown)
+    {
+        return false;
+    }
+
+    // No architecture filter means neutral or the current process' architecture
+    if (packageDependency.Architectures() == MddPackageDependencyProcessorArchitectures::None)
+    {
+        return (candidate.architecture == MddCore::Architecture::Neutral) || (candidate.architecture == currentArchitecture);
+    }
+    return packageDependency.IsArchitectureInArchitectures(candidate.architecture);
+}
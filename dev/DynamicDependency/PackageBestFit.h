@@ -0,0 +1,44 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#if !defined(PACKAGEBESTFIT_H)
+#define PACKAGEBESTFIT_H
+
+#include "PackageCatalog.h"
+#include "PackageDependency.h"
+
+namespace MddCore
+{
+/// Select the package best satisfying a package dependency.
+///
+/// Candidates failing the version or architecture filters are discarded and the rest are ranked:
+/// highest version first, then (if the package dependency doesn't specify architectures)
+/// architecture-specific before architecture-neutral, then by package full name. The best fit is the
+/// highest ranked candidate whose status is OK.
+class PackageBestFit
+{
+public:
+    PackageBestFit() = delete;
+    ~PackageBestFit() = delete;
+
+    /// Return the best fit package's full name, or an empty string if no package satisfies the package dependency.
+    static std::wstring Find(
+        MddCore::PackageCatalog& packageCatalog,
+        const MddCore::PackageDependency& packageDependency,
+        const MddCore::Architecture currentArchitecture);
+
+    /// Return true if lhs is ranked ahead of rhs.
+    static bool IsBetterFit(
+        const MddCore::PackageCandidate& lhs,
+        const MddCore::PackageCandidate& rhs,
+        const bool preferArchitectureSpecific);
+
+private:
+    static bool IsArchitectureAcceptable(
+        const MddCore::PackageCandidate& candidate,
+        const MddCore::PackageDependency& packageDependency,
+        const MddCore::Architecture currentArchitecture);
+};
+}
+
+#endif // PACKAGEBESTFIT_H
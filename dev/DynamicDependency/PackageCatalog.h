@@ -0,0 +1,38 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#if !defined(PACKAGECATALOG_H)
+#define PACKAGECATALOG_H
+
+#include "MddCore.Architecture.h"
+
+namespace MddCore
+{
+// A package that could satisfy a package dependency
+struct PackageCandidate
+{
+    std::wstring packageFullName;
+    UINT64 version{};
+    MddCore::Architecture architecture{ MddCore::Architecture::Unknown };
+};
+
+/// Source of the packages considered when resolving a package dependency.
+///
+/// SystemPackageCatalog is backed by the packages registered to the user. Other implementations
+/// (e.g. an in-memory list of synthetic packages) let PackageBestFit be exercised without them.
+class PackageCatalog
+{
+public:
+    virtual ~PackageCatalog() = default;
+
+    /// Return the packages in the family.
+    virtual std::vector<MddCore::PackageCandidate> FindPackagesByFamily(
+        const std::wstring& packageFamilyName) = 0;
+
+    /// Return true if the package's status is OK to use the package.
+    virtual bool IsPackageStatusOK(
+        const MddCore::PackageCandidate& candidate) = 0;
+};
+}
+
+#endif // PACKAGECATALOG_H
@@ -22,34 +22,6 @@ void MddCore::PackageDependency::GenerateId()
     m_packageDependencyId.assign(idAsString + 1);
 }
 
-std::vector<std::wstring> MddCore::PackageDependency::FindPackagesByFamily() const
-{
-    UINT32 count{};
-    UINT32 bufferLength{};
-    const LONG rc{ FindPackagesByPackageFamily(m_packageFamilyName.c_str(), PACKAGE_FILTER_HEAD | PACKAGE_FILTER_DIRECT, &count, nullptr, &bufferLength, nullptr, nullptr) };
-    if (rc == ERROR_SUCCESS)
-    {
-        // The package family has no packages registered to the user
-        return std::vector<std::wstring>();
-    }
-    else if (rc != ERROR_INSUFFICIENT_BUFFER)
-    {
-        THROW_WIN32(rc);
-    }
-
-    auto packageFullNames{ wil::make_unique_cotaskmem<PWSTR[]>(count) };
-    auto buffer{ wil::make_unique_cotaskmem<WCHAR[]>(bufferLength) };
-    THROW_IF_WIN32_ERROR(FindPackagesByPackageFamily(m_packageFamilyName.c_str(), PACKAGE_FILTER_HEAD | PACKAGE_FILTER_DIRECT, &count, packageFullNames.get(), &bufferLength, buffer.get(), nullptr));
-
-    std::vector<std::wstring> packageFullNamesList;
-    for (UINT32 index=0; index < count; ++index)
-    {
-        const auto packageFullName{ packageFullNames[index] };
-        packageFullNamesList.push_back(std::wstring(packageFullName));
-    }
-    return packageFullNamesList;
-}
-
 std::wstring MddCore::PackageDependency::ToJSON() const
 {
     JSON::JsonObject json;
@@ -87,6 +59,77 @@ MddCore::PackageDependency MddCore::PackageDependency::FromJSON(PCSTR jsonUtf8)
     return FromJSON(utf8_to_hstring(jsonUtf8));
 }
 
+std::vector<uint8_t> MddCore::PackageDependency::ToBinary() const
+{
+    // Fixed size fields first then the strings (UINT32 length + UTF-16 characters, not null terminated)
+    const UINT32 architectures{ static_cast<UINT32>(m_packageDependencyProcessorArchitectures) };
+    const UINT32 lifetimeKind{ static_cast<UINT32>(m_lifetimeKind) };
+    const UINT32 options{ static_cast<UINT32>(m_options) };
+
+    std::vector<uint8_t> data;
+    AppendBinary(data, &m_minVersion.Version, sizeof(m_minVersion.Version));
+    AppendBinary(data, &architectures, sizeof(architectures));
+    AppendBinary(data, &lifetimeKind, sizeof(lifetimeKind));
+    AppendBinary(data, &options, sizeof(options));
+    AppendBinary(data, m_packageDependencyId);
+    AppendBinary(data, m_packageFamilyName);
+    AppendBinary(data, m_lifetimeArtifact);
+    return data;
+}
+
+MddCore::PackageDependency MddCore::PackageDependency::FromBinary(const uint8_t* data, const size_t dataSize)
+{
+    MddCore::PackageDependency packageDependency;
+
+    const auto dataEnd{ data + dataSize };
+    UINT32 architectures{};
+    UINT32 lifetimeKind{};
+    UINT32 options{};
+    ReadBinary(data, dataEnd, &packageDependency.m_minVersion.Version, sizeof(packageDependency.m_minVersion.Version));
+    ReadBinary(data, dataEnd, &architectures, sizeof(architectures));
+    ReadBinary(data, dataEnd, &lifetimeKind, sizeof(lifetimeKind));
+    ReadBinary(data, dataEnd, &options, sizeof(options));
+    ReadBinary(data, dataEnd, packageDependency.m_packageDependencyId);
+    ReadBinary(data, dataEnd, packageDependency.m_packageFamilyName);
+    ReadBinary(data, dataEnd, packageDependency.m_lifetimeArtifact);
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), data != dataEnd);
+
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), lifetimeKind > static_cast<UINT32>(MddPackageDependencyLifetimeKind::RegistryKey));
+    packageDependency.m_packageDependencyProcessorArchitectures = static_cast<MddPackageDependencyProcessorArchitectures>(architectures);
+    packageDependency.m_lifetimeKind = static_cast<MddPackageDependencyLifetimeKind>(lifetimeKind);
+    packageDependency.m_options = static_cast<MddCreatePackageDependencyOptions>(options);
+    return packageDependency;
+}
+
+void MddCore::PackageDependency::AppendBinary(std::vector<uint8_t>& data, const void* value, const size_t valueSize)
+{
+    const auto bytes{ static_cast<const uint8_t*>(value) };
+    data.insert(data.end(), bytes, bytes + valueSize);
+}
+
+void MddCore::PackageDependency::AppendBinary(std::vector<uint8_t>& data, const std::wstring& value)
+{
+    const UINT32 length{ static_cast<UINT32>(value.length()) };
+    AppendBinary(data, &length, sizeof(length));
+    AppendBinary(data, value.c_str(), value.length() * sizeof(value[0]));
+}
+
+void MddCore::PackageDependency::ReadBinary(const uint8_t*& data, const uint8_t* dataEnd, void* value, const size_t valueSize)
+{
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), static_cast<size_t>(dataEnd - data) < valueSize);
+    memcpy(value, data, valueSize);
+    data += valueSize;
+}
+
+void MddCore::PackageDependency::ReadBinary(const uint8_t*& data, const uint8_t* dataEnd, std::wstring& value)
+{
+    UINT32 length{};
+    ReadBinary(data, dataEnd, &length, sizeof(length));
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), static_cast<size_t>(dataEnd - data) / sizeof(WCHAR) < length);
+    value.assign(reinterpret_cast<PCWSTR>(data), length);
+    data += length * sizeof(WCHAR);
+}
+
 bool MddCore::PackageDependency::IsExpired() const
 {
     switch (m_lifetimeKind)
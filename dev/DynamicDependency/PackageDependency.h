@@ -224,8 +224,6 @@ public:
         return m_packageFullName;
     }
 
-    std::vector<std::wstring> FindPackagesByFamily() const;
-
     bool IsArchitectureInArchitectures(const MddCore::Architecture architecture) const
     {
         const auto architectureAsArchitectures{ ToArchitectures(architecture) };
@@ -258,6 +256,10 @@ public:
     static PackageDependency FromJSON(const winrt::hstring& json);
     static PackageDependency FromJSON(PCSTR jsonUtf8);
 
+    /// Compact binary form (including the id) used by DataStoreLog
+    std::vector<uint8_t> ToBinary() const;
+    static PackageDependency FromBinary(const uint8_t* data, const size_t dataSize);
+
     bool IsExpired() const;
 
 private:
@@ -272,6 +274,12 @@ private:
         const std::wstring& key,
         size_t& offsetToSubkey);
 
+private:
+    static void AppendBinary(std::vector<uint8_t>& data, const void* value, const size_t valueSize);
+    static void AppendBinary(std::vector<uint8_t>& data, const std::wstring& value);
+    static void ReadBinary(const uint8_t*& data, const uint8_t* dataEnd, void* value, const size_t valueSize);
+    static void ReadBinary(const uint8_t*& data, const uint8_t* dataEnd, std::wstring& value);
+
 private:
     static winrt::hstring ToString(const MddPackageDependencyLifetimeKind lifetimeKind);
 
@@ -5,9 +5,11 @@
 
 #include "PackageGraph.h"
 
+#include "PackageBestFit.h"
 #include "PackageGraphNode.h"
 #include "PackageDependencyManager.h"
 #include "PackageId.h"
+#include "SystemPackageCatalog.h"
 #include "WinRTModuleManager.h"
 
 #include <wil/win32_helpers.h>
@@ -40,18 +42,18 @@ HRESULT MddCore::PackageGraph::Add(
     MDD_PACKAGEDEPENDENCY_CONTEXT& context)
 {
     // Load the package's information
-    PackageGraphNode packageGraphNode(packageFullName, rank, packageDependencyId);
-    packageGraphNode.GenerateContext();
+    auto packageGraphNode{ std::make_shared<PackageGraphNode>(packageFullName, rank, packageDependencyId) };
+    packageGraphNode->GenerateContext();
 
     // Load the WinRT definitions (if any)
-    std::shared_ptr<MddCore::WinRTPackage> winrtPackage{ packageGraphNode.CreateWinRTPackage() };
+    std::shared_ptr<MddCore::WinRTPackage> winrtPackage{ packageGraphNode->CreateWinRTPackage() };
     winrtPackage->ParseAppxManifest();
 
     // Find the insertion point where to add the new package graph node to the package graph
     size_t index{};
     for (; index < m_packageGraphNodes.size(); ++index)
     {
-        auto& node{ m_packageGraphNodes[index] };
+        auto& node{ *m_packageGraphNodes[index] };
         if (node.Rank() < rank)
         {
             // Too soon. Keep looking
@@ -76,7 +78,7 @@ HRESULT MddCore::PackageGraph::Add(
                 // Append to items of this rank
                 for (size_t nextIndex=index+1; nextIndex < m_packageGraphNodes.size(); ++nextIndex)
                 {
-                    auto& nextNode{ m_packageGraphNodes[nextIndex] };
+                    auto& nextNode{ *m_packageGraphNodes[nextIndex] };
                     if (nextNode.Rank() > rank)
                     {
                         // Gotcha!
@@ -102,8 +104,8 @@ HRESULT MddCore::PackageGraph::Add(
     winrtPackage.reset();
 
     // The DLL Search Order must be updated when we update the package graph
-    auto& node{ m_packageGraphNodes[index] };
-    AddToDllSearchOrder(node);
+    auto& node{ *m_packageGraphNodes[index] };
+    AddToDllSearchOrder(node, index);
 
     context = node.Context();
     return S_OK;
@@ -138,62 +140,14 @@ HRESULT MddCore::PackageGraph::ResolvePackageDependency(
     MddAddPackageDependencyOptions /*options*/,
     wil::unique_process_heap_string& packageFullName)
 {
-    // Determine the packages in the family
-    const auto foundPackageFullNames{ packageDependency.FindPackagesByFamily() };
-
     // Find the best fit package in the family (if any)
-    MddCore::PackageId bestFit;
-    winrt::Windows::Management::Deployment::PackageManager packageManager;
-    for (const auto& candidatePackageFullName : foundPackageFullNames)
-    {
-        auto candidate{ MddCore::PackageId::FromPackageFullName(candidatePackageFullName.c_str()) };
-
-        // Do we already have a higher version under consideration?
-        if (bestFit && (bestFit.Version().Version > candidate.Version().Version))
-        {
-            continue;
-        }
-
-        // Package version must meet the minVersion filter
-        if (candidate.Version().Version < packageDependency.MinVersion().Version)
-        {
-            continue;
-        }
-
-        // Package architecture must meet the architecture filter
-        if (packageDependency.Architectures() == MddPackageDependencyProcessorArchitectures::None)
-        {
-            if (!IsPackageABetterFitPerArchitecture(bestFit, candidate))
-            {
-                continue;
-            }
-        }
-        else
-        {
-            if (!packageDependency.IsArchitectureInArchitectures(candidate.Architecture()))
-            {
-                continue;
-            }
-        }
-
-        // Package status must be OK to use a package
-        winrt::hstring currentUser;
-        auto package{ packageManager.FindPackageForUser(currentUser, candidate.PackageFullName()) };
-        auto status{ package.Status() };
-        if (!status.VerifyIsOK())
-        {
-            continue;
-        }
-
-        // The new candidate is better than the current champion
-        bestFit = std::move(candidate);
-    }
+    const auto bestFit{ MddCore::PackageBestFit::Find(MddCore::SystemPackageCatalog::Instance(), packageDependency, GetCurrentArchitecture()) };
 
     // Did we fail to find a match?
-    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_NOT_FOUND), bestFit.PackageFullName().empty());
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_NOT_FOUND), bestFit.empty());
 
     // We have a winner!
-    packageFullName = std::move(wil::make_process_heap_string(bestFit.PackageFullName().c_str()));
+    packageFullName = std::move(wil::make_process_heap_string(bestFit.c_str()));
     return S_OK;
 }
 
@@ -203,14 +157,17 @@ HRESULT MddCore::PackageGraph::Remove(
     for (size_t index=0; index < m_packageGraphNodes.size(); ++index)
     {
         auto& node{ m_packageGraphNodes[index] };
-        if (node.Context() == context)
+        if (node->Context() == context)
         {
             // Detach the node from the package graph before updating the DLL Search Order
             auto detachedNode{ std::move(node) };
             m_packageGraphNodes.erase(m_packageGraphNodes.begin() + index);
 
+            // Remove the package's WinRT information
+            MddCore::WinRTModuleManager::Remove(detachedNode->Context());
+
             // The DLL Search Order must be updated when we update the package graph
-            RemoveFromDllSearchOrder(detachedNode);
+            RemoveFromDllSearchOrder(*detachedNode, index);
 
             return S_OK;
         }
@@ -218,57 +175,34 @@ HRESULT MddCore::PackageGraph::Remove(
     RETURN_WIN32(ERROR_INVALID_HANDLE);
 }
 
-HRESULT MddCore::PackageGraph::GetPackageDependencyForContext(
-    _In_ MDD_PACKAGEDEPENDENCY_CONTEXT context,
-    wil::unique_process_heap_string& packageDependencyId)
+void MddCore::PackageGraph::BeginUpdate()
 {
-    for (size_t index=0; index < m_packageGraphNodes.size(); ++index)
-    {
-        auto& node{ m_packageGraphNodes[index] };
-        if (node.Context() == context)
-        {
-            packageDependencyId = wil::make_process_heap_string(node.Id().c_str());
-            return S_OK;
-        }
-    }
-    RETURN_WIN32(ERROR_INVALID_HANDLE);
+    ++m_updateDepth;
 }
 
-bool MddCore::PackageGraph::IsPackageABetterFitPerArchitecture(
-    const PackageId& bestFit,
-    const PackageId& candidate)
+void MddCore::PackageGraph::EndUpdate()
 {
-    // Is the package a contender?
-    const auto currentArchitecture{ GetCurrentArchitecture() };
-    if ((candidate.Architecture() != MddCore::Architecture::Neutral) && (candidate.Architecture() != currentArchitecture))
+    FAIL_FAST_HR_IF(E_UNEXPECTED, m_updateDepth == 0);
+    if ((--m_updateDepth == 0) && m_isPathUpdatePending)
     {
-        return false;
+        // PATH may be several changes behind the package graph so rebuild it (rather than splice)
+        m_isPathUpdatePending = false;
+        UpdatePath();
     }
+}
 
-    // Do we have a best-fit candidate yet?
-    if (!bestFit)
+void MddCore::PackageGraph::AddToDllSearchOrder(PackageGraphNode& package, const size_t index)
+{
+    // Update the PATH environment variable (or, if batching changes, when the batch ends)
+    if (m_updateDepth > 0)
     {
-        // We do now :-)
-        return true;
+        m_isPathUpdatePending = true;
     }
-
-    // Is the new package a better fit than the current champion?
-
-    // Architecture-specific is always better than architecture-neutral
-    if ((bestFit.Architecture() == MddCore::Architecture::Neutral) && (candidate.Architecture() != MddCore::Architecture::Neutral))
+    else if (!SplicePath(package, index, true))
     {
-        return false;
+        UpdatePath();
     }
 
-    // We have a new winner!
-    return true;
-}
-
-void MddCore::PackageGraph::AddToDllSearchOrder(PackageGraphNode& package)
-{
-    // Update the PATH environment variable
-    UpdatePath();
-
     // Update the AddDllDirectory list
     package.AddDllDirectories();
 }
@@ -312,7 +246,16 @@ void MddCore::PackageGraph::UpdatePath()
         if (m_pathListLastAddedToPath.empty())
         {
             // Nothing to remove so use the PATH environment variable as-is
-            newPath = std::move(path);
+            newPath = path;
+        }
+        else if (path == m_pathLastSet)
+        {
+            // PATH is as we left it so our previous pathlist is its prefix. Splice it out without searching for it
+            const auto oldPathListLength{ m_pathListLastAddedToPath.length() };
+            if (oldPathListLength < path.length())
+            {
+                newPath = path.substr(oldPathListLength + 1);
+            }
         }
         else
         {
@@ -363,21 +306,95 @@ void MddCore::PackageGraph::UpdatePath()
         }
     }
 
-    // Update the PATH enironment variable
-    PCWSTR newPathEnvironmentVariable{ (newPath.length() > 0 ? newPath.c_str() : nullptr) };
-    THROW_IF_WIN32_BOOL_FALSE(SetEnvironmentVariableW(L"PATH", newPathEnvironmentVariable));
+    // Update the PATH enironment variable (if it changed)
+    if (newPath != path)
+    {
+        PCWSTR newPathEnvironmentVariable{ (newPath.length() > 0 ? newPath.c_str() : nullptr) };
+        THROW_IF_WIN32_BOOL_FALSE(SetEnvironmentVariableW(L"PATH", newPathEnvironmentVariable));
+    }
+
+    // Remember the path list we added to PATH, and the resulting PATH, for future updates
+    m_pathListLastAddedToPath = std::move(pathList);
+    m_pathLastSet = std::move(newPath);
+}
+
+bool MddCore::PackageGraph::SplicePath(
+    const PackageGraphNode& package,
+    const size_t index,
+    const bool isAdded)
+{
+    // If PATH is as we left it our pathlist is its prefix, so we can splice the package's
+    // pathlist into (or out of) both at the same offset. No need to rebuild our pathlist
+    // or search PATH for it. Anything else is left to UpdatePath().
+    //
+    // Our pathlist is the nodes' pathlists delimited by ';' so adding or removing a node
+    // (when there's at least one other) adds or removes its pathlist and one ';'
+    const auto nodeCount{ m_packageGraphNodes.size() };
+    const auto otherNodeCount{ isAdded ? nodeCount - 1 : nodeCount };
+    if ((otherNodeCount == 0) || m_pathListLastAddedToPath.empty())
+    {
+        return false;
+    }
+    const auto& packagePathList{ package.PathList() };
+    if (!isAdded && (m_pathListLastAddedToPath.length() == packagePathList.length() + 1))
+    {
+        // Our new pathlist is empty
+        return false;
+    }
+
+    auto pathEnvironmentVariable{ wil::TryGetEnvironmentVariableW(L"PATH") };
+    if (!pathEnvironmentVariable || (m_pathLastSet != pathEnvironmentVariable.get()))
+    {
+        return false;
+    }
 
-    // Remember the path list we added to PATH for future updates
-    m_pathListLastAddedToPath = pathList;
+    // Where does the package's pathlist start in our pathlist?
+    size_t offset{};
+    for (size_t nodeIndex=0; nodeIndex < index; ++nodeIndex)
+    {
+        offset += m_packageGraphNodes[nodeIndex]->PathList().length() + 1;
+    }
+
+    std::wstring path{ m_pathLastSet };
+    std::wstring pathList{ m_pathListLastAddedToPath };
+    const bool isLast{ index == otherNodeCount };
+    if (isAdded)
+    {
+        // Insert it and its delimiter (after the previous node if it's last, else before the next node)
+        const auto insertOffset{ isLast ? offset - 1 : offset };
+        const auto insert{ isLast ? (L";" + packagePathList) : (packagePathList + L";") };
+        path.insert(insertOffset, insert);
+        pathList.insert(insertOffset, insert);
+    }
+    else
+    {
+        // Remove it and its delimiter (before it if it was last, else after it)
+        const auto eraseOffset{ isLast ? offset - 1 : offset };
+        path.erase(eraseOffset, packagePathList.length() + 1);
+        pathList.erase(eraseOffset, packagePathList.length() + 1);
+    }
+
+    THROW_IF_WIN32_BOOL_FALSE(SetEnvironmentVariableW(L"PATH", path.c_str()));
+
+    m_pathListLastAddedToPath = std::move(pathList);
+    m_pathLastSet = std::move(path);
+    return true;
 }
 
-void MddCore::PackageGraph::RemoveFromDllSearchOrder(PackageGraphNode& package)
+void MddCore::PackageGraph::RemoveFromDllSearchOrder(PackageGraphNode& package, const size_t index)
 {
     // Update the AddDllDirectory list
     package.RemoveDllDirectories();
 
-    // Update the PATH environment variable
-    UpdatePath();
+    // Update the PATH environment variable (or, if batching changes, when the batch ends)
+    if (m_updateDepth > 0)
+    {
+        m_isPathUpdatePending = true;
+    }
+    else if (!SplicePath(package, index, false))
+    {
+        UpdatePath();
+    }
 }
 
 std::wstring MddCore::PackageGraph::BuildPathList()
@@ -385,7 +402,7 @@ std::wstring MddCore::PackageGraph::BuildPathList()
     std::wstring pathlist;
     for (size_t index=0; index < m_packageGraphNodes.size(); ++index)
     {
-        const auto& node{ m_packageGraphNodes[index] };
+        const auto& node{ *m_packageGraphNodes[index] };
         if (index > 0)
         {
             pathlist += L';';
@@ -50,18 +50,17 @@ public:
         MDD_PACKAGEDEPENDENCY_CONTEXT context);
 
 public:
-    HRESULT GetPackageDependencyForContext(
-        _In_ MDD_PACKAGEDEPENDENCY_CONTEXT context,
-        wil::unique_process_heap_string& packageDependencyId);
+    /// Defer PATH updates until the matching EndUpdate(). Calls can be nested.
+    /// @see PackageGraphManager::PathUpdateBatch
+    void BeginUpdate();
 
-private:
-    static bool IsPackageABetterFitPerArchitecture(
-        const MddCore::PackageId& bestFit,
-        const MddCore::PackageId& candidate);
+    /// Apply the PATH update deferred since the outermost BeginUpdate() (if any).
+    void EndUpdate();
 
-    void AddToDllSearchOrder(PackageGraphNode& package);
+private:
+    void AddToDllSearchOrder(PackageGraphNode& package, const size_t index);
 
-    void RemoveFromDllSearchOrder(PackageGraphNode& package);
+    void RemoveFromDllSearchOrder(PackageGraphNode& package, const size_t index);
 
     inline static MddCore::Architecture GetCurrentArchitecture()
     {
@@ -80,17 +79,29 @@ private:
 
     void UpdatePath();
 
+    /// Splice the package's pathlist into (or out of) PATH, if PATH is as we last set it.
+    /// Returns false if not, and PATH should be rebuilt via UpdatePath().
+    bool SplicePath(
+        const PackageGraphNode& package,
+        const size_t index,
+        const bool isAdded);
+
     std::wstring BuildPathList();
 
 public:
-    const std::vector<MddCore::PackageGraphNode>& PackageGraphNodes() const
+    // Nodes are reference counted so PackageGraphManager can publish them in immutable
+    // snapshots of the package graph that outlive a subsequent Add() or Remove().
+    const std::vector<std::shared_ptr<MddCore::PackageGraphNode>>& PackageGraphNodes() const
     {
         return m_packageGraphNodes;
     }
 
 private:
-    std::vector<MddCore::PackageGraphNode> m_packageGraphNodes;
+    std::vector<std::shared_ptr<MddCore::PackageGraphNode>> m_packageGraphNodes;
     std::wstring m_pathListLastAddedToPath;
+    std::wstring m_pathLastSet;
+    UINT32 m_updateDepth{};
+    bool m_isPathUpdatePending{};
 };
 }
 
@@ -8,6 +8,8 @@
 std::mutex MddCore::PackageGraphManager::s_lock;
 MddCore::PackageGraph MddCore::PackageGraphManager::s_packageGraph;
 volatile ULONG MddCore::PackageGraphManager::s_generationId{};
+std::shared_ptr<const MddCore::PackageGraphManager::PackageGraphSnapshot> MddCore::PackageGraphManager::s_packageGraphSnapshot{ std::make_shared<const PackageGraphSnapshot>() };
+std::shared_ptr<const MddCore::PackageGraphManager::PackageInfoSnapshot> MddCore::PackageGraphManager::s_packageInfoSnapshots[c_packageInfoSnapshotsCount];
 
 UINT32 MddCore::PackageGraphManager::GetGenerationId()
 {
@@ -46,6 +48,7 @@ HRESULT MddCore::PackageGraphManager::AddToPackageGraph(
     RETURN_IF_FAILED(s_packageGraph.Add(packageDependencyId, rank, options, *context, packageFullName));
 
     IncrementGenerationId();
+    PublishPackageGraphSnapshot();
     return S_OK;
 }
 
@@ -62,15 +65,59 @@ void MddCore::PackageGraphManager::RemoveFromPackageGraph(
     (void) LOG_IF_FAILED(s_packageGraph.Remove(context));
 
     IncrementGenerationId();
+    PublishPackageGraphSnapshot();
+}
+
+MddCore::PackageGraphManager::PathUpdateBatch::PathUpdateBatch()
+{
+    std::unique_lock<std::mutex> lock(s_lock);
+
+    s_packageGraph.BeginUpdate();
+}
+
+MddCore::PackageGraphManager::PathUpdateBatch::~PathUpdateBatch()
+{
+    std::unique_lock<std::mutex> lock(s_lock);
+
+    try
+    {
+        s_packageGraph.EndUpdate();
+    }
+    CATCH_LOG();
 }
 
 HRESULT MddCore::PackageGraphManager::GetPackageDependencyForContext(
     _In_ MDD_PACKAGEDEPENDENCY_CONTEXT context,
     wil::unique_process_heap_string& packageDependencyId)
 {
-    std::unique_lock<std::mutex> lock(s_lock);
+    const auto packageGraph{ GetPackageGraphSnapshot() };
+    for (const auto& node : packageGraph->packageGraphNodes)
+    {
+        if (node->Context() == context)
+        {
+            packageDependencyId = wil::make_process_heap_string(node->Id().c_str());
+            return S_OK;
+        }
+    }
+    RETURN_WIN32(ERROR_INVALID_HANDLE);
+}
 
-    return s_packageGraph.GetPackageDependencyForContext(context, packageDependencyId);
+std::shared_ptr<const MddCore::PackageGraphManager::PackageGraphSnapshot> MddCore::PackageGraphManager::GetPackageGraphSnapshot()
+{
+    return std::atomic_load(&s_packageGraphSnapshot);
+}
+
+void MddCore::PackageGraphManager::PublishPackageGraphSnapshot()
+{
+    // NOTE: Caller must hold s_lock
+
+    // Readers may still hold the previous snapshot. Its nodes stay alive (and unmodified,
+    // apart from their DLL directory cookies) until the last reference is released.
+    auto snapshot{ std::make_shared<PackageGraphSnapshot>() };
+    snapshot->generationId = GetGenerationId();
+    const auto& packageGraphNodes{ s_packageGraph.PackageGraphNodes() };
+    snapshot->packageGraphNodes.assign(packageGraphNodes.begin(), packageGraphNodes.end());
+    std::atomic_store(&s_packageGraphSnapshot, std::shared_ptr<const PackageGraphSnapshot>(std::move(snapshot)));
 }
 
 // On success, bufferLength depends on packageInfoType:
@@ -82,6 +129,10 @@ HRESULT MddCore::PackageGraphManager::GetPackageDependencyForContext(
 //
 // On success but \c bufferLength is too small to hold all the data, we still set bufferLength to the
 // size needed for all this data but return ERROR_INSUFFICIENT_BUFFER (as an HRESULT).
+//
+// Results are served from an immutable snapshot of the package graph's answer for (flags, packageInfoType)
+// at the current GenerationId. Snapshots are only rebuilt when the package graph changes, so the common
+// size-then-fill call pattern doesn't walk the package graph. Neither path takes s_lock.
 HRESULT MddCore::PackageGraphManager::GetCurrentPackageInfo3(
     const UINT32 flags,
     PackageInfoType packageInfoType,
@@ -100,7 +151,75 @@ HRESULT MddCore::PackageGraphManager::GetCurrentPackageInfo3(
         *count = 0;
     }
 
-    std::unique_lock<std::mutex> lock(s_lock);
+    const auto snapshot{ GetPackageInfoSnapshot(flags, packageInfoType) };
+    RETURN_IF_FAILED_EXPECTED(snapshot->hr);
+
+    // Are we asked for the GenerationId?
+    if (packageInfoType == PackageInfoType_PackageInfoGeneration)
+    {
+        const bool insufficientSpace{ *bufferLength < sizeof(UINT32) };
+        *bufferLength = sizeof(UINT32);
+        RETURN_HR_IF_EXPECTED(HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER), insufficientSpace);
+
+        UINT32* generationId{ reinterpret_cast<UINT32*>(buffer) };
+        *generationId = snapshot->generationId;
+        return S_OK;
+    }
+
+    // Update the total 'count' (if any)
+    if (count)
+    {
+        *count = snapshot->count;
+    }
+
+    // Set bufferLength with the buffer size needed for all the data and fill buffer (if we can)
+    const auto isInsufficientBuffer{ *bufferLength < snapshot->bufferLength };
+    *bufferLength = snapshot->bufferLength;
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER), isInsufficientBuffer);
+
+    CopyPackageInfoSnapshotToBuffer(*snapshot, buffer);
+    return S_OK;
+}
+CATCH_RETURN();
+
+std::shared_ptr<const MddCore::PackageGraphManager::PackageInfoSnapshot> MddCore::PackageGraphManager::GetPackageInfoSnapshot(
+    const UINT32 flags,
+    const PackageInfoType packageInfoType)
+{
+    // Snapshots are never modified once published so readers only need the current package graph
+    // and an atomic load of the slot. A snapshot built for another GenerationId is simply replaced.
+    const auto packageGraph{ GetPackageGraphSnapshot() };
+    const auto index{ (flags ^ (static_cast<UINT32>(packageInfoType) * 0x9E3779B1u)) % c_packageInfoSnapshotsCount };
+    auto& slot{ s_packageInfoSnapshots[index] };
+
+    auto isCurrent = [&](const std::shared_ptr<const PackageInfoSnapshot>& snapshot)
+    {
+        return snapshot &&
+               (snapshot->flags == flags) &&
+               (snapshot->packageInfoType == packageInfoType) &&
+               (snapshot->generationId == packageGraph->generationId);
+    };
+
+    auto snapshot{ std::atomic_load(&slot) };
+    if (isCurrent(snapshot))
+    {
+        return snapshot;
+    }
+
+    snapshot = CreatePackageInfoSnapshot(*packageGraph, flags, packageInfoType);
+    std::atomic_store(&slot, snapshot);
+    return snapshot;
+}
+
+std::shared_ptr<const MddCore::PackageGraphManager::PackageInfoSnapshot> MddCore::PackageGraphManager::CreatePackageInfoSnapshot(
+    const PackageGraphSnapshot& packageGraph,
+    const UINT32 flags,
+    const PackageInfoType packageInfoType)
+{
+    auto snapshot{ std::make_shared<PackageInfoSnapshot>() };
+    snapshot->flags = flags;
+    snapshot->packageInfoType = packageInfoType;
+    snapshot->generationId = packageGraph.generationId;
 
     // Do we need Static and/or Dynamic items? NOTE: If neither are specified we need both
     const bool filterStatic{ WI_IsFlagSet(flags, PACKAGE_FILTER_STATIC) };
@@ -117,39 +236,34 @@ HRESULT MddCore::PackageGraphManager::GetCurrentPackageInfo3(
     // Then GetCurrentPackageInfo3() always returns APPMODEL_ERROR_NO_PACKAGE
     //
     // Preserve these behaviors for compatibility reasons.
-    if (s_packageGraph.PackageGraphNodes().empty() || (filterStatic && !filterDynamic))
+    if (packageGraph.packageGraphNodes.empty() || (filterStatic && !filterDynamic))
     {
-        return HRESULT_FROM_WIN32(APPMODEL_ERROR_NO_PACKAGE);
+        snapshot->hr = HRESULT_FROM_WIN32(APPMODEL_ERROR_NO_PACKAGE);
+        return snapshot;
     }
 
     // Are we asked for the GenerationId?
     if (packageInfoType == PackageInfoType_PackageInfoGeneration)
     {
-        const bool insufficientSpace{ *bufferLength < sizeof(UINT32) };
-        *bufferLength = sizeof(UINT32);
-        RETURN_HR_IF_EXPECTED(HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER), insufficientSpace);
-
-        UINT32* generationId{ reinterpret_cast<UINT32*>(buffer) };
-        *generationId = GetGenerationId();
-        return S_OK;
+        return snapshot;
+    }
+    if ((packageInfoType != PackageInfoType_PackageInfoInstallPath) &&
+        (packageInfoType != PackageInfoType_PackageInfoMutablePath) &&
+        (packageInfoType != PackageInfoType_PackageInfoEffectivePath) &&
+        (packageInfoType != PackageInfoType_PackageInfoMachineExternalPath) &&
+        (packageInfoType != PackageInfoType_PackageInfoUserExternalPath) &&
+        (packageInfoType != PackageInfoType_PackageInfoEffectiveExternalPath))
+    {
+        snapshot->hr = E_INVALIDARG;
+        return snapshot;
     }
-    RETURN_HR_IF(E_INVALIDARG, (packageInfoType != PackageInfoType_PackageInfoInstallPath) &&
-                               (packageInfoType != PackageInfoType_PackageInfoMutablePath) &&
-                               (packageInfoType != PackageInfoType_PackageInfoEffectivePath) &&
-                               (packageInfoType != PackageInfoType_PackageInfoMachineExternalPath) &&
-                               (packageInfoType != PackageInfoType_PackageInfoUserExternalPath) &&
-                               (packageInfoType != PackageInfoType_PackageInfoEffectiveExternalPath));
 
     // We manage the package graph as a list of nodes, where each contain contains information about 1+ package.
     //
     // Find all the packages across the package graph that match our filter criteria (see flags in
     // https://docs.microsoft.com/en-us/windows/win32/api/appmodel/nf-appmodel-getcurrentpackageinfo2).
     //
-    // Then compute the size needed for all the data.
-    //
-    // The if the buffer's big enough, serialize the data into buffer.
-    //
-    // Either way, set bufferLength with the buffer size needed for all the data.
+    // Then compute the size needed for all the data and serialize the data into the snapshot's buffer.
 
     wil::unique_cotaskmem_ptr<BYTE[]> staticPackageGraphBuffer;
     const PACKAGE_INFO* staticPackageInfo{};
@@ -158,24 +272,17 @@ HRESULT MddCore::PackageGraphManager::GetCurrentPackageInfo3(
 
     std::vector<const MddCore::PackageGraphNode*> matchingPackageInfo;
 
-    for (auto& packageGraphNode : s_packageGraph.PackageGraphNodes())
+    for (auto& packageGraphNode : packageGraph.packageGraphNodes)
     {
         // Does the node have any matching packages?
-        const auto countMatchingPackages{ packageGraphNode.CountMatchingPackages(flags, packageInfoType) };
+        const auto countMatchingPackages{ packageGraphNode->CountMatchingPackages(flags, packageInfoType) };
         if (countMatchingPackages > 0)
         {
-            matchingPackageInfo.push_back(&packageGraphNode);
+            matchingPackageInfo.push_back(packageGraphNode.get());
             dynamicPackagesCount += countMatchingPackages;
         }
     }
 
-    // Update the total 'count' (if any)
-    const auto totalPackagesCount{ staticPackagesCount + dynamicPackagesCount };
-    if (count)
-    {
-        *count = totalPackagesCount;
-    }
-
     // Return code needs special handling if we match zero packages (i.e. #Static=0, #Dynamic=0, *bufferLength=0):
     //
     // If there is no static or dynamic packages (i.e. unpackaged process with no DynamicDependencies)
@@ -189,30 +296,62 @@ HRESULT MddCore::PackageGraphManager::GetCurrentPackageInfo3(
     // Then GetCurrentPackageInfo* returns ERROR_SUCCESS.
     //
     // In all cases we're returning zero packages. Our return code depends on why we're returning none.
+    // The Static-but-not-Dynamic case was already handled above so matching none here is ERROR_SUCCESS
+    // with count=0 and bufferLength=0.
     //
     // Preserve these behaviors.
-    if (totalPackagesCount == 0)
+    snapshot->count = staticPackagesCount + dynamicPackagesCount;
+    if (snapshot->count == 0)
     {
-        // No matches!
-        *bufferLength = 0;
+        return snapshot;
+    }
 
-        // Do we need to tell our caller AppmodelErrorNoPackage?
-        if (filterStatic && !filterDynamic)
-        {
-            return HRESULT_FROM_WIN32(APPMODEL_ERROR_NO_PACKAGE);
-        }
-        return S_OK;
+    // Compute the buffer length needed then fill the snapshot's buffer
+    const auto bufferNeeded{ SerializePackageInfoToBuffer(flags, packageInfoType, 0, nullptr, matchingPackageInfo, dynamicPackagesCount, staticPackageInfo, staticPackagesCount) };
+    snapshot->buffer = std::make_unique<BYTE[]>(bufferNeeded);
+    snapshot->bufferLength = SerializePackageInfoToBuffer(flags, packageInfoType, bufferNeeded, snapshot->buffer.get(), matchingPackageInfo, dynamicPackagesCount, staticPackageInfo, staticPackagesCount);
+    FAIL_FAST_HR_IF(E_UNEXPECTED, snapshot->bufferLength != bufferNeeded);
+    return snapshot;
+}
+
+void MddCore::PackageGraphManager::CopyPackageInfoSnapshotToBuffer(
+    const PackageInfoSnapshot& snapshot,
+    void* buffer)
+{
+    if (snapshot.bufferLength == 0)
+    {
+        return;
     }
 
-    // Compute the buffer length used/needed and fill buffer (if we can)
-    auto bufferNeeded{ SerializePackageInfoToBuffer(flags, packageInfoType, *bufferLength, buffer, matchingPackageInfo, dynamicPackagesCount, staticPackageInfo, staticPackagesCount) };
-    const auto isInsufficientBuffer{ *bufferLength < bufferNeeded };
-    *bufferLength = bufferNeeded;
-    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER), isInsufficientBuffer);
+    // Copy the serialized data and point the strings at the caller's copy
+    const auto from{ snapshot.buffer.get() };
+    auto to{ static_cast<BYTE*>(buffer) };
+    memcpy(to, from, snapshot.bufferLength);
 
-    return S_OK;
+    auto packageInfo{ reinterpret_cast<PACKAGE_INFO*>(to) };
+    for (UINT32 index=0; index < snapshot.count; ++index, ++packageInfo)
+    {
+        RebaseString(packageInfo->path, from, to);
+        RebaseString(packageInfo->packageFullName, from, to);
+        RebaseString(packageInfo->packageFamilyName, from, to);
+        RebaseString(packageInfo->packageId.name, from, to);
+        RebaseString(packageInfo->packageId.publisher, from, to);
+        RebaseString(packageInfo->packageId.resourceId, from, to);
+        RebaseString(packageInfo->packageId.publisherId, from, to);
+    }
+}
+
+void MddCore::PackageGraphManager::RebaseString(
+    PWSTR& s,
+    const BYTE* from,
+    BYTE* to)
+{
+    if (s)
+    {
+        const auto offset{ reinterpret_cast<const BYTE*>(s) - from };
+        s = reinterpret_cast<PWSTR>(to + offset);
+    }
 }
-CATCH_RETURN();
 
 UINT32 MddCore::PackageGraphManager::SerializePackageInfoToBuffer(
     const UINT32 flags,
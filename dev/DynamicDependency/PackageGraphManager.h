@@ -39,6 +39,24 @@ public:
         _In_ MDD_PACKAGEDEPENDENCY_CONTEXT context,
         wil::unique_process_heap_string& packageDependencyId);
 
+public:
+    /// Batch changes to the package graph for the life of this object. PATH updates by AddToPackageGraph()
+    /// and RemoveFromPackageGraph() are deferred until the last open batch is destroyed (including by an
+    /// exception), so adding N package dependencies rewrites PATH once rather than N times. Each package's
+    /// DLL directories are still added (and removed) immediately.
+    ///
+    /// @note The package graph is process-wide so changes by other threads are also deferred until then.
+    class PathUpdateBatch
+    {
+    public:
+        PathUpdateBatch();
+
+        ~PathUpdateBatch();
+
+        PathUpdateBatch(const PathUpdateBatch&) = delete;
+        PathUpdateBatch& operator=(const PathUpdateBatch&) = delete;
+    };
+
 public:
     typedef LONG (WINAPI* GetCurrentPackageInfo3Function)(
         const UINT32 flags,
@@ -55,6 +73,50 @@ public:
         UINT32* count) noexcept;
 
 private:
+    // Immutable copy of the package graph published after every Add/Remove. Readers atomically
+    // load the current snapshot and never block behind (or on) changes to the package graph.
+    struct PackageGraphSnapshot
+    {
+        UINT32 generationId{};
+        std::vector<std::shared_ptr<const MddCore::PackageGraphNode>> packageGraphNodes;
+    };
+
+    static std::shared_ptr<const PackageGraphSnapshot> GetPackageGraphSnapshot();
+
+    static void PublishPackageGraphSnapshot();
+
+private:
+    // Immutable result of GetCurrentPackageInfo3 for a (flags, packageInfoType) pair at a given GenerationId.
+    // PWSTR fields in the serialized PACKAGE_INFO[] point into buffer and are rebased when copied out.
+    struct PackageInfoSnapshot
+    {
+        UINT32 flags{};
+        PackageInfoType packageInfoType{};
+        UINT32 generationId{};
+        HRESULT hr{};
+        UINT32 count{};
+        UINT32 bufferLength{};
+        std::unique_ptr<BYTE[]> buffer;
+    };
+
+    static std::shared_ptr<const PackageInfoSnapshot> GetPackageInfoSnapshot(
+        const UINT32 flags,
+        const PackageInfoType packageInfoType);
+
+    static std::shared_ptr<const PackageInfoSnapshot> CreatePackageInfoSnapshot(
+        const PackageGraphSnapshot& packageGraph,
+        const UINT32 flags,
+        const PackageInfoType packageInfoType);
+
+    static void CopyPackageInfoSnapshotToBuffer(
+        const PackageInfoSnapshot& snapshot,
+        void* buffer);
+
+    static void RebaseString(
+        PWSTR& s,
+        const BYTE* from,
+        BYTE* to);
+
     static UINT32 SerializePackageInfoToBuffer(
         const UINT32 flags,
         const PackageInfoType packageInfoType,
@@ -81,6 +143,10 @@ private:
     static std::mutex s_lock;
     static MddCore::PackageGraph s_packageGraph;
     static volatile ULONG s_generationId;
+    static std::shared_ptr<const PackageGraphSnapshot> s_packageGraphSnapshot;
+
+    static constexpr size_t c_packageInfoSnapshotsCount{ 16 };
+    static std::shared_ptr<const PackageInfoSnapshot> s_packageInfoSnapshots[c_packageInfoSnapshotsCount];
 };
 }
 
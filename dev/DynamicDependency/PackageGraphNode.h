@@ -116,7 +116,7 @@ public:
         return m_pathList;
     }
 
-    MDD_PACKAGEDEPENDENCY_CONTEXT Context()
+    MDD_PACKAGEDEPENDENCY_CONTEXT Context() const
     {
         return m_context;
     }
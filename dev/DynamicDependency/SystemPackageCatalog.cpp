@@ -0,0 +1,192 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "SystemPackageCatalog.h"
+
+#include "PackageId.h"
+
+MddCore::SystemPackageCatalog& MddCore::SystemPackageCatalog::Instance()
+{
+    // Never destroyed. Its PackageCatalog event handlers can't be revoked during DLL_PROCESS_DETACH
+    static MddCore::SystemPackageCatalog* s_instance{ new MddCore::SystemPackageCatalog() };
+    return *s_instance;
+}
+
+std::vector<MddCore::PackageCandidate> MddCore::SystemPackageCatalog::FindPackagesByFamily(
+    const std::wstring& packageFamilyName)
+{
+    const auto key{ ToKey(packageFamilyName) };
+    uint64_t generation{};
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        if (!Watch())
+        {
+            lock.unlock();
+            return FindCandidatesByFamily(packageFamilyName);
+        }
+
+        auto iterator{ m_families.find(key) };
+        if (iterator != m_families.end())
+        {
+            return iterator->second;
+        }
+        generation = m_generation;
+    }
+
+    auto candidates{ FindCandidatesByFamily(packageFamilyName) };
+
+    // Don't cache it if packages changed while we were looking
+    std::unique_lock<std::mutex> lock(m_lock);
+    if (generation == m_generation)
+    {
+        if (m_families.size() >= c_maxFamilies)
+        {
+            m_families.clear();
+        }
+        m_families[key] = candidates;
+    }
+    return candidates;
+}
+
+bool MddCore::SystemPackageCatalog::IsPackageStatusOK(
+    const MddCore::PackageCandidate& candidate)
+{
+    bool isWatching{};
+    uint64_t generation{};
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        isWatching = Watch();
+        if (isWatching && (m_statusOK.find(candidate.packageFullName) != m_statusOK.end()))
+        {
+            return true;
+        }
+        generation = m_generation;
+    }
+
+    winrt::Windows::Management::Deployment::PackageManager packageManager;
+    winrt::hstring currentUser;
+    auto package{ packageManager.FindPackageForUser(currentUser, candidate.packageFullName) };
+    if (!package || !package.Status().VerifyIsOK())
+    {
+        // Not cached. It's often transient (e.g. the package is being serviced)
+        return false;
+    }
+
+    if (isWatching)
+    {
+        // Don't cache it if packages changed while we were looking
+        std::unique_lock<std::mutex> lock(m_lock);
+        if (generation != m_generation)
+        {
+            return true;
+        }
+        if (m_statusOK.size() >= c_maxStatusOK)
+        {
+            m_statusOK.clear();
+        }
+        m_statusOK.insert(candidate.packageFullName);
+    }
+    return true;
+}
+
+bool MddCore::SystemPackageCatalog::Watch()
+{
+    // NOTE: Caller must hold m_lock
+
+    if (m_isWatchAttempted)
+    {
+        return !!m_packageCatalog;
+    }
+    m_isWatchAttempted = true;
+
+    try
+    {
+        // Our event handlers live in this DLL so it mustn't be unloaded while they're registered
+        HMODULE hmodule{};
+        THROW_IF_WIN32_BOOL_FALSE(::GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_PIN,
+                                                       reinterpret_cast<PCWSTR>(&MddCore::SystemPackageCatalog::Instance), &hmodule));
+
+        using namespace winrt::Windows::ApplicationModel;
+        auto packageCatalog{ PackageCatalog::OpenForCurrentUser() };
+        packageCatalog.PackageInstalling([this](const PackageCatalog&, const PackageInstallingEventArgs& args)
+            {
+                if (args.IsComplete())
+                {
+                    Invalidate();
+                }
+            });
+        packageCatalog.PackageUpdating([this](const PackageCatalog&, const PackageUpdatingEventArgs& args)
+            {
+                if (args.IsComplete())
+                {
+                    Invalidate();
+                }
+            });
+        packageCatalog.PackageUninstalling([this](const PackageCatalog&, const PackageUninstallingEventArgs& args)
+            {
+                if (args.IsComplete())
+                {
+                    Invalidate();
+                }
+            });
+        packageCatalog.PackageStatusChanged([this](const PackageCatalog&, const PackageStatusChangedEventArgs&)
+            {
+                Invalidate();
+            });
+        m_packageCatalog = std::move(packageCatalog);
+    }
+    CATCH_LOG();
+    return !!m_packageCatalog;
+}
+
+void MddCore::SystemPackageCatalog::Invalidate()
+{
+    std::unique_lock<std::mutex> lock(m_lock);
+    ++m_generation;
+    m_families.clear();
+    m_statusOK.clear();
+}
+
+std::vector<MddCore::PackageCandidate> MddCore::SystemPackageCatalog::FindCandidatesByFamily(
+    const std::wstring& packageFamilyName)
+{
+    UINT32 count{};
+    UINT32 bufferLength{};
+    const LONG rc{ FindPackagesByPackageFamily(packageFamilyName.c_str(), PACKAGE_FILTER_HEAD | PACKAGE_FILTER_DIRECT, &count, nullptr, &bufferLength, nullptr, nullptr) };
+    if (rc == ERROR_SUCCESS)
+    {
+        // The package family has no packages registered to the user
+        return std::vector<MddCore::PackageCandidate>();
+    }
+    else if (rc != ERROR_INSUFFICIENT_BUFFER)
+    {
+        THROW_WIN32(rc);
+    }
+
+    auto packageFullNames{ wil::make_unique_cotaskmem<PWSTR[]>(count) };
+    auto buffer{ wil::make_unique_cotaskmem<WCHAR[]>(bufferLength) };
+    THROW_IF_WIN32_ERROR(FindPackagesByPackageFamily(packageFamilyName.c_str(), PACKAGE_FILTER_HEAD | PACKAGE_FILTER_DIRECT, &count, packageFullNames.get(), &bufferLength, buffer.get(), nullptr));
+
+    std::vector<MddCore::PackageCandidate> candidates;
+    candidates.reserve(count);
+    for (UINT32 index=0; index < count; ++index)
+    {
+        const auto packageFullName{ packageFullNames[index] };
+        const auto packageId{ MddCore::PackageId::FromPackageFullName(packageFullName) };
+        candidates.push_back(MddCore::PackageCandidate{ std::wstring(packageFullName), packageId.Version().Version, packageId.Architecture() });
+    }
+    return candidates;
+}
+
+std::wstring MddCore::SystemPackageCatalog::ToKey(const std::wstring& name)
+{
+    // Package family names are case insensitive
+    std::wstring key{ name };
+    for (auto& c : key)
+    {
+        c = towlower(c);
+    }
+    return key;
+}
@@ -0,0 +1,57 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#if !defined(SYSTEMPACKAGECATALOG_H)
+#define SYSTEMPACKAGECATALOG_H
+
+#include "PackageCatalog.h"
+
+#include <unordered_set>
+
+namespace MddCore
+{
+/// The packages registered to the current user.
+///
+/// A family's candidates and the packages whose status is OK are cached until a package is
+/// installed, updated, uninstalled or its status changes, as reported by the user's
+/// Windows.ApplicationModel.PackageCatalog. If we can't watch for those changes nothing is cached.
+/// The caches are bounded; when full they're simply cleared.
+class SystemPackageCatalog : public MddCore::PackageCatalog
+{
+public:
+    static SystemPackageCatalog& Instance();
+
+    std::vector<MddCore::PackageCandidate> FindPackagesByFamily(
+        const std::wstring& packageFamilyName) override;
+
+    bool IsPackageStatusOK(
+        const MddCore::PackageCandidate& candidate) override;
+
+private:
+    SystemPackageCatalog() = default;
+
+    /// Start watching for package changes (if not already). Returns true if we're watching.
+    /// @note Caller must hold m_lock.
+    bool Watch();
+
+    void Invalidate();
+
+    static std::vector<MddCore::PackageCandidate> FindCandidatesByFamily(
+        const std::wstring& packageFamilyName);
+
+    static std::wstring ToKey(const std::wstring& name);
+
+private:
+    static constexpr size_t c_maxFamilies{ 64 };
+    static constexpr size_t c_maxStatusOK{ 256 };
+
+    std::mutex m_lock;
+    bool m_isWatchAttempted{};
+    uint64_t m_generation{};
+    winrt::Windows::ApplicationModel::PackageCatalog m_packageCatalog{ nullptr };
+    std::unordered_map<std::wstring, std::vector<MddCore::PackageCandidate>> m_families;
+    std::unordered_set<std::wstring> m_statusOK;
+};
+}
+
+#endif // SYSTEMPACKAGECATALOG_H
@@ -38,22 +38,30 @@ public:
         return MddCore::WinRT::ThreadingModel::Unknown;
     }
 
-    void* GetActivationFactory(
-        HSTRING className,
-        const std::wstring& activatableClassId,
-        REFIID iid)
+    wil::com_ptr<IActivationFactory> GetActivationFactory(
+        HSTRING className)
     {
         Load();
 
-        IActivationFactory* ifactory{};
-        THROW_IF_FAILED(m_dllGetActivationFactory(className, &ifactory));
+        wil::com_ptr<IActivationFactory> ifactory;
+        THROW_IF_FAILED(m_dllGetActivationFactory(className, ifactory.put()));
+        return ifactory;
+    }
+
+    // True if the inproc server was never loaded or its DllCanUnloadNow says nothing it created is in use.
+    // Servers without DllCanUnloadNow can't tell us, so they're never considered unloadable.
+    bool CanUnloadNow()
+    {
+        auto lock{ std::unique_lock<std::mutex>(m_lock) };
+
+        if (!m_dll)
+        {
+            return true;
+        }
 
-        //TODO optimize for IActivationFactory? See GetActivationFactory() in dev\UndockedRegFreeWinRT\catalog.cpp
-        void* factory{};
-        const auto hr{ ifactory->QueryInterface(iid, &factory) };
-        ifactory->Release();
-        THROW_IF_FAILED_MSG(hr, "Error 0x%X in ifactory->QueryInterface(%ls)", hr, activatableClassId.c_str());
-        return factory;
+        typedef HRESULT(__stdcall* DllCanUnloadNow)();
+        auto dllCanUnloadNow{ reinterpret_cast<DllCanUnloadNow>(GetProcAddress(m_dll.get(), "DllCanUnloadNow")) };
+        return dllCanUnloadNow && (dllCanUnloadNow() == S_OK);
     }
 
 public:
@@ -0,0 +1,33 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "WinRTManifestCache.h"
+
+std::mutex MddCore::WinRTManifestCache::s_lock;
+std::unordered_map<std::wstring, std::vector<MddCore::WinRTManifestActivatableClass>> MddCore::WinRTManifestCache::s_activatableClasses;
+
+bool MddCore::WinRTManifestCache::TryGet(
+    const std::wstring& packageFullName,
+    std::vector<MddCore::WinRTManifestActivatableClass>& activatableClasses)
+{
+    auto lock{ std::unique_lock<std::mutex>(s_lock) };
+
+    auto iterator{ s_activatableClasses.find(packageFullName) };
+    if (iterator == s_activatableClasses.end())
+    {
+        return false;
+    }
+    activatableClasses = iterator->second;
+    return true;
+}
+
+void MddCore::WinRTManifestCache::Add(
+    const std::wstring& packageFullName,
+    std::vector<MddCore::WinRTManifestActivatableClass> activatableClasses)
+{
+    auto lock{ std::unique_lock<std::mutex>(s_lock) };
+
+    s_activatableClasses.insert_or_assign(packageFullName, std::move(activatableClasses));
+}
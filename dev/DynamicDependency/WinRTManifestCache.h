@@ -0,0 +1,46 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#if !defined(WINRTMANIFESTCACHE_H)
+#define WINRTMANIFESTCACHE_H
+
+#include "MddWinRT.h"
+
+namespace MddCore
+{
+// An <InProcessServer>/<ActivatableClass> definition in a package's appxmanifest
+struct WinRTManifestActivatableClass
+{
+    std::wstring activatableClassId;
+    std::wstring path;
+    MddCore::WinRT::ThreadingModel threadingModel{ MddCore::WinRT::ThreadingModel::Unknown };
+};
+
+/// In-memory cache of the activatable classes defined in packages' appxmanifest.xml, keyed by package full name,
+/// so a package's manifest is parsed once per process no matter how often the package is added to the package graph.
+///
+/// A registered package's content is immutable, so a package full name always identifies the same manifest and
+/// there's nothing to revalidate. The cache lives only as long as the process and is never persisted.
+class WinRTManifestCache
+{
+public:
+    WinRTManifestCache() = delete;
+    ~WinRTManifestCache() = delete;
+
+    /// Get the package's activatable classes. Returns false if the package's manifest hasn't been cached.
+    static bool TryGet(
+        const std::wstring& packageFullName,
+        std::vector<MddCore::WinRTManifestActivatableClass>& activatableClasses);
+
+    /// Cache the activatable classes defined in the package's manifest.
+    static void Add(
+        const std::wstring& packageFullName,
+        std::vector<MddCore::WinRTManifestActivatableClass> activatableClasses);
+
+private:
+    static std::mutex s_lock;
+    static std::unordered_map<std::wstring, std::vector<MddCore::WinRTManifestActivatableClass>> s_activatableClasses;
+};
+}
+
+#endif // WINRTMANIFESTCACHE_H
@@ -7,13 +7,13 @@
 
 std::mutex MddCore::WinRTModuleManager::s_lock;
 std::vector<std::shared_ptr<MddCore::WinRTPackage>> MddCore::WinRTModuleManager::s_winrtPackages;
+std::vector<std::shared_ptr<MddCore::WinRTPackage>> MddCore::WinRTModuleManager::s_removedWinrtPackages;
+std::unordered_map<std::wstring_view, MddCore::WinRTModuleManager::ActivatableClass> MddCore::WinRTModuleManager::s_activatableClasses;
 
 bool MddCore::WinRTModuleManager::GetThreadingType(
     HSTRING className,
     ABI::Windows::Foundation::ThreadingType& threadingType)
 {
-    auto lock{ std::unique_lock<std::mutex>(s_lock) };
-
     auto threadingModel{ MddCore::WinRTModuleManager::GetThreadingModel(className) };
     if (threadingModel == MddCore::WinRT::ThreadingModel::Unknown)
     {
@@ -28,40 +28,56 @@ bool MddCore::WinRTModuleManager::GetThreadingType(
 MddCore::WinRT::ThreadingModel MddCore::WinRTModuleManager::GetThreadingModel(
     HSTRING className)
 {
-    if (!s_winrtPackages.empty())
+    ActivatableClass activatableClass;
+    if (!FindActivatableClass(className, activatableClass))
     {
-        std::wstring activatableClassId{ WindowsGetStringRawBuffer(className, nullptr) };
-        for (auto& winrtPackage : s_winrtPackages)
-        {
-            auto threadingModel{ winrtPackage->GetThreadingModel(activatableClassId) };
-            if (threadingModel != MddCore::WinRT::ThreadingModel::Unknown)
-            {
-                return threadingModel;
-            }
-        }
+        return MddCore::WinRT::ThreadingModel::Unknown;
     }
-    return MddCore::WinRT::ThreadingModel::Unknown;
+    return activatableClass.threadingModel;
 }
 
 void* MddCore::WinRTModuleManager::GetActivationFactory(
     HSTRING className,
     REFIID iid)
 {
-    auto lock{ std::unique_lock<std::mutex>(s_lock) };
+    ActivatableClass activatableClass;
+    if (!FindActivatableClass(className, activatableClass))
+    {
+        return nullptr;
+    }
 
-    if (!s_winrtPackages.empty())
+    // Ask the inproc server for the factory unless we already have it.
+    // NOTE: We don't hold s_lock while calling into the component as it may activate other classes.
+    auto ifactory{ std::move(activatableClass.activationFactory) };
+    if (!ifactory)
     {
-        std::wstring activatableClassId{ WindowsGetStringRawBuffer(className, nullptr) };
-        for (auto& winrtPackage : s_winrtPackages)
+        //TODO change to return shared_ptr<inprocModule> rather than void*factory
+        //     so the object (and its DLL) isn't destroyed while upstack is calling the factory*.
+        //     Or perhaps caller's changed to return shared_ptr<winrtPackage>? TBD
+        ifactory = activatableClass.inprocModule->GetActivationFactory(className);
+
+        // Only agile factories can be handed out to any apartment so only they're cached
+        if (ifactory.try_query<IAgileObject>())
         {
-            auto factory{ winrtPackage->GetActivationFactory(className, activatableClassId, iid) };
-            if (factory)
+            auto lock{ std::unique_lock<std::mutex>(s_lock) };
+
+            // The package graph may have changed while we weren't looking. Only cache the factory
+            // if the class is still provided by the same inproc server
+            UINT32 classNameLength{};
+            PCWSTR classNameBuffer{ WindowsGetStringRawBuffer(className, &classNameLength) };
+            auto iterator{ s_activatableClasses.find(std::wstring_view(classNameBuffer, classNameLength)) };
+            if ((iterator != s_activatableClasses.end()) && (iterator->second.inprocModule == activatableClass.inprocModule))
             {
-                return factory;
+                iterator->second.activationFactory = ifactory;
             }
         }
     }
-    return nullptr;
+
+    //TODO optimize for IActivationFactory? See GetActivationFactory() in dev\UndockedRegFreeWinRT\catalog.cpp
+    void* factory{};
+    const auto hr{ ifactory->QueryInterface(iid, &factory) };
+    THROW_IF_FAILED_MSG(hr, "Error 0x%X in ifactory->QueryInterface(%ls)", hr, WindowsGetStringRawBuffer(className, nullptr));
+    return factory;
 }
 
 void MddCore::WinRTModuleManager::Insert(
@@ -78,4 +94,118 @@ void MddCore::WinRTModuleManager::Insert(
     {
         s_winrtPackages.push_back(std::move(winrtPackage));
     }
+
+    RebuildActivatableClassIndex();
+}
+
+void MddCore::WinRTModuleManager::Remove(
+    MDD_PACKAGEDEPENDENCY_CONTEXT context)
+{
+    {
+        auto lock{ std::unique_lock<std::mutex>(s_lock) };
+
+        for (size_t index=0; index < s_winrtPackages.size(); ++index)
+        {
+            if (s_winrtPackages[index]->Context() == context)
+            {
+                // Stop resolving the package's classes but keep its inproc servers loaded.
+                // Objects they created may still be in use.
+                s_removedWinrtPackages.push_back(std::move(s_winrtPackages[index]));
+                s_winrtPackages.erase(s_winrtPackages.begin() + index);
+
+                RebuildActivatableClassIndex();
+                break;
+            }
+        }
+    }
+
+    ReleaseRemovedPackages();
+}
+
+bool MddCore::WinRTModuleManager::FindActivatableClass(
+    HSTRING className,
+    ActivatableClass& activatableClass)
+{
+    UINT32 classNameLength{};
+    PCWSTR classNameBuffer{ WindowsGetStringRawBuffer(className, &classNameLength) };
+
+    auto lock{ std::unique_lock<std::mutex>(s_lock) };
+
+    auto iterator{ s_activatableClasses.find(std::wstring_view(classNameBuffer, classNameLength)) };
+    if (iterator == s_activatableClasses.end())
+    {
+        return false;
+    }
+    activatableClass = iterator->second;
+    return true;
+}
+
+void MddCore::WinRTModuleManager::ReleaseRemovedPackages()
+{
+    // Removed packages are no longer in the activatable class index, so the only other references to them are
+    // held by activations that looked up a class before the package was removed. Once those are done the package
+    // can go, unloading its inproc servers, provided each server's DllCanUnloadNow agrees. Packages that can't
+    // go yet are checked again the next time a package is removed, so the list only holds packages whose
+    // servers still have objects alive (or can't tell us).
+    std::vector<std::shared_ptr<MddCore::WinRTPackage>> unreferencedPackages;
+    {
+        auto lock{ std::unique_lock<std::mutex>(s_lock) };
+
+        for (auto iterator{ s_removedWinrtPackages.begin() }; iterator != s_removedWinrtPackages.end();)
+        {
+            if (iterator->use_count() == 1)
+            {
+                unreferencedPackages.push_back(std::move(*iterator));
+                iterator = s_removedWinrtPackages.erase(iterator);
+            }
+            else
+            {
+                ++iterator;
+            }
+        }
+    }
+
+    // NOTE: We don't hold s_lock while calling into the components.
+    std::vector<std::shared_ptr<MddCore::WinRTPackage>> inUsePackages;
+    for (auto& winrtPackage : unreferencedPackages)
+    {
+        if (!winrtPackage->CanUnloadNow())
+        {
+            inUsePackages.push_back(std::move(winrtPackage));
+        }
+    }
+    unreferencedPackages.clear();
+
+    if (!inUsePackages.empty())
+    {
+        auto lock{ std::unique_lock<std::mutex>(s_lock) };
+        s_removedWinrtPackages.insert(s_removedWinrtPackages.end(), std::make_move_iterator(inUsePackages.begin()), std::make_move_iterator(inUsePackages.end()));
+    }
+}
+
+void MddCore::WinRTModuleManager::RebuildActivatableClassIndex()
+{
+    // NOTE: Caller must hold s_lock
+
+    // Map every activatable class to the inproc server providing it. Packages are ordered per the package graph
+    // so the first package defining a class wins. Keys refer to the inproc server's activatableClassId strings,
+    // which live as long as their package (kept alive by the entry).
+    //
+    // Any cached activation factories are dropped as the class may now be provided by a different package.
+    std::unordered_map<std::wstring_view, ActivatableClass> activatableClasses;
+    for (auto& winrtPackage : s_winrtPackages)
+    {
+        for (auto& inprocModule : winrtPackage->InprocModules())
+        {
+            for (const auto& [activatableClassId, threadingModel] : inprocModule.InprocServers())
+            {
+                ActivatableClass activatableClass;
+                activatableClass.winrtPackage = winrtPackage;
+                activatableClass.inprocModule = &inprocModule;
+                activatableClass.threadingModel = threadingModel;
+                activatableClasses.emplace(activatableClassId, std::move(activatableClass));
+            }
+        }
+    }
+    s_activatableClasses = std::move(activatableClasses);
 }
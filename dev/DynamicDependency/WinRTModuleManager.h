@@ -28,9 +28,31 @@ public:
         size_t index,
         std::shared_ptr<MddCore::WinRTPackage>& winrtPackage);
 
+    static void Remove(
+        MDD_PACKAGEDEPENDENCY_CONTEXT context);
+
+private:
+    struct ActivatableClass
+    {
+        std::shared_ptr<MddCore::WinRTPackage> winrtPackage;
+        MddCore::WinRTInprocModule* inprocModule{};
+        MddCore::WinRT::ThreadingModel threadingModel{ MddCore::WinRT::ThreadingModel::Unknown };
+        wil::com_ptr<IActivationFactory> activationFactory;
+    };
+
+    static bool FindActivatableClass(
+        HSTRING className,
+        ActivatableClass& activatableClass);
+
+    static void RebuildActivatableClassIndex();
+
+    static void ReleaseRemovedPackages();
+
 private:
     static std::mutex s_lock;
     static std::vector<std::shared_ptr<MddCore::WinRTPackage>> s_winrtPackages;
+    static std::vector<std::shared_ptr<MddCore::WinRTPackage>> s_removedWinrtPackages;
+    static std::unordered_map<std::wstring_view, ActivatableClass> s_activatableClasses;
 };
 }
 
@@ -5,54 +5,7 @@
 
 #include "WinRTPackage.h"
 
-MddCore::WinRT::ThreadingModel MddCore::WinRTPackage::GetThreadingModel(
-    const std::wstring& activatableClassId)
-{
-    // Find the activation factory
-    if (!m_inprocModules.empty())
-    {
-        for (size_t index = 0; index < m_inprocModules.size(); ++index)
-        {
-            auto& inprocModule{ m_inprocModules[index] };
-
-            auto threadingModel{ inprocModule.Find(activatableClassId) };
-            if (threadingModel != MddCore::WinRT::ThreadingModel::Unknown)
-            {
-                return threadingModel;
-            }
-        }
-    }
-
-    // Not found
-    return MddCore::WinRT::ThreadingModel::Unknown;
-}
-
-void* MddCore::WinRTPackage::GetActivationFactory(
-    HSTRING className,
-    const std::wstring& activatableClassId,
-    REFIID iid)
-{
-    // Find the activation factory
-    if (!m_inprocModules.empty())
-    {
-        for (size_t index = 0; index < m_inprocModules.size(); ++index)
-        {
-            auto& inprocModule{ m_inprocModules[index] };
-
-            auto threadingModel{ inprocModule.Find(activatableClassId) };
-            if (threadingModel != MddCore::WinRT::ThreadingModel::Unknown)
-            {
-                //TODO change to return shared_ptr<inprocModule> rather than void*factory
-                //     so the object (and its DLL) isn't destroyed while upstack is calling the factory*.
-                //     Or perhaps caller's changed to return shared_ptr<winrtPackage>? TBD
-                return inprocModule.GetActivationFactory(className, activatableClassId, iid);
-            }
-        }
-    }
-
-    // Not found
-    return nullptr;
-}
+#include "WinRTManifestCache.h"
 
 /// Parse a package's appxmanifest for WinRT inproc server definitions e.g.
 /// ~~~~~
@@ -73,8 +26,25 @@ void* MddCore::WinRTPackage::GetActivationFactory(
 /// <ActivatableClass>'s attributes:
 ///   * ActivatableClassId=string
 ///   * ThreadingModel = "both" | "STA" | "MTA"
+///
+/// The definitions are cached in memory by package full name (see WinRTManifestCache) so the XML is only parsed
+/// the first time the process adds the package.
 void MddCore::WinRTPackage::ParseAppxManifest()
 {
+    // Use the cached definitions if we've already parsed this package's manifest
+    std::vector<MddCore::WinRTManifestActivatableClass> activatableClasses;
+    if (MddCore::WinRTManifestCache::TryGet(m_packageFullName, activatableClasses))
+    {
+        for (const auto& activatableClass : activatableClasses)
+        {
+            MddCore::WinRTInprocModule winrtInProcModule;
+            winrtInProcModule.Path(activatableClass.path);
+            winrtInProcModule.AddInprocServer(activatableClass.activatableClassId, activatableClass.threadingModel);
+            AddInprocModule(winrtInProcModule);
+        }
+        return;
+    }
+
     std::filesystem::path filename{ m_packagePath };
     filename /= L"appxmanifest.xml";
     wil::com_ptr<IStream> appxManifestStream;
@@ -105,6 +75,16 @@ void MddCore::WinRTPackage::ParseAppxManifest()
             }
         }
     }
+
+    // Remember what we found for next time
+    for (const auto& inprocModule : m_inprocModules)
+    {
+        for (const auto& [activatableClassId, threadingModel] : inprocModule.InprocServers())
+        {
+            activatableClasses.push_back({ activatableClassId, inprocModule.Path(), threadingModel });
+        }
+    }
+    MddCore::WinRTManifestCache::Add(m_packageFullName, std::move(activatableClasses));
 }
 
 /// See ParseAppxManifest for <InProcessServer>'s schema
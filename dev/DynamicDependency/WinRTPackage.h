@@ -17,14 +17,17 @@ public:
 
     WinRTPackage(
         MDD_PACKAGEDEPENDENCY_CONTEXT context,
+        const std::wstring& packageFullName,
         const std::wstring& packagePath) :
         m_context(context),
+        m_packageFullName(packageFullName),
         m_packagePath(packagePath)
     {
     }
 
     WinRTPackage(WinRTPackage&& other) :
         m_context(std::move(other.m_context)),
+        m_packageFullName(std::move(other.m_packageFullName)),
         m_packagePath(std::move(other.m_packagePath))
     {
         for (auto& inprocModule : other.m_inprocModules)
@@ -35,13 +38,27 @@ public:
 
     ~WinRTPackage() = default;
 
-    MddCore::WinRT::ThreadingModel GetThreadingModel(
-        const std::wstring& activatableClassId);
+    MDD_PACKAGEDEPENDENCY_CONTEXT Context() const
+    {
+        return m_context;
+    }
+
+    std::vector<WinRTInprocModule>& InprocModules()
+    {
+        return m_inprocModules;
+    }
 
-    void* GetActivationFactory(
-        HSTRING className,
-        const std::wstring& activatableClassId,
-        REFIID iid);
+    bool CanUnloadNow()
+    {
+        for (auto& inprocModule : m_inprocModules)
+        {
+            if (!inprocModule.CanUnloadNow())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
 
     void ParseAppxManifest();
 
@@ -63,6 +80,7 @@ private:
 
 private:
     MDD_PACKAGEDEPENDENCY_CONTEXT m_context{};
+    std::wstring m_packageFullName;
     std::wstring m_packagePath;
     std::vector<WinRTInprocModule> m_inprocModules;
 };
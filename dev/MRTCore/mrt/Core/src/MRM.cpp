@@ -32,12 +32,32 @@ constexpr wchar_t c_defaultPriFilename[] = L"resources.pri";
 #define INDEX_RESOURCE_ID -1
 #define INDEX_RESOURCE_URI -2
 
-static HRESULT StringResultReleaseOwnershipBuffer(_Inout_ StringResult& result, _Outptr_ PWSTR* buffer)
+static ProviderResolver* GetResolver(_In_ void* resourceManager, _In_opt_ void* resourceContext)
 {
+    if (resourceContext == nullptr)
+    {
+        return reinterpret_cast<MrmObjects*>(resourceManager)->resolver;
+    }
+
+    return reinterpret_cast<ProviderResolver*>(resourceContext);
+}
+
+static HRESULT StringResultReleaseOwnershipBuffer(
+    _Inout_ StringResult& result,
+    _Outptr_ PWSTR* buffer,
+    _In_opt_ const ResolverBase* resolver = nullptr)
+{
+    bool needsCopy = (result.GetType() == DefResultType_Reference);
+
     size_t localStringLength;
     PWSTR localString;
     // Make sure result owns the data
     RETURN_IF_FAILED(result.GetWritableRef(&localString, &localStringLength));
+
+    if (needsCopy && (resolver != nullptr))
+    {
+        resolver->NoteStringCopy(localStringLength * sizeof(wchar_t));
+    }
     // Release the ownership
     RETURN_IF_FAILED(result.ReleaseContents(buffer, &localStringLength));
 
@@ -47,12 +67,20 @@ static HRESULT StringResultReleaseOwnershipBuffer(_Inout_ StringResult& result,
 static HRESULT BlobResultReleaseOwnershipBuffer(
     _Inout_ BlobResult& result,
     _Outptr_result_bytebuffer_(*releasedBufferSizeInBytes) void** releasedBuffer,
-    _Out_ UINT32* releasedBufferSizeInBytes)
+    _Out_ UINT32* releasedBufferSizeInBytes,
+    _In_opt_ const ResolverBase* resolver = nullptr)
 {
+    bool needsCopy = (result.GetType() == DefResultType_Reference);
+
     size_t localSize;
     // Make sure result owns the data
     RETURN_HR_IF(E_OUTOFMEMORY, result.GetWritableRef(&localSize) == nullptr);
 
+    if (needsCopy && (resolver != nullptr))
+    {
+        resolver->NoteBlobCopy(localSize);
+    }
+
     // Release the ownership
     size_t sizeInBytes;
     RETURN_IF_FAILED(result.ReleaseContents(releasedBuffer, &sizeInBytes));
@@ -60,6 +88,29 @@ static HRESULT BlobResultReleaseOwnershipBuffer(
     return S_OK;
 }
 
+// Returns S_OK with a reference into the PRI file, or S_FALSE with a copy the caller must free with MrmFreeResource
+// when the blob isn't backed by the file (only a reference stays valid after the blob result goes away).
+static HRESULT BlobResultGetReferenceOrCopy(
+    _Inout_ BlobResult& result,
+    _Out_ MrmResourceData* data,
+    _In_opt_ const ResolverBase* resolver = nullptr)
+{
+    data->data = nullptr;
+    data->size = 0;
+
+    if (result.GetType() != DefResultType_Reference)
+    {
+        RETURN_IF_FAILED(BlobResultReleaseOwnershipBuffer(result, &data->data, &data->size, resolver));
+        return S_FALSE;
+    }
+
+    size_t sizeInBytes;
+    const void* ref = result.GetRef(&sizeInBytes);
+    RETURN_IF_FAILED(SizeTToUInt32(sizeInBytes, &data->size));
+    data->data = const_cast<void*>(ref);
+    return S_OK;
+}
+
 static HRESULT GetQualifierInfoFromCandidateImpl(
     _In_ MrmObjects* resourceManager,
     _In_ const ResourceCandidateResult* candidate,
@@ -187,15 +238,7 @@ static HRESULT LoadResourceCandidate(
 
     MrmObjects* resourceManagerObjects = reinterpret_cast<MrmObjects*>(resourceManager);
 
-    ProviderResolver* resolver;
-    if (resourceContext == nullptr)
-    {
-        resolver = resourceManagerObjects->resolver;
-    }
-    else
-    {
-        resolver = reinterpret_cast<ProviderResolver*>(resourceContext);
-    }
+    ProviderResolver* resolver = GetResolver(resourceManager, resourceContext);
 
     NamedResourceResult namedResource;
 
@@ -343,7 +386,7 @@ static HRESULT LoadStringResource(
     }
 
     // This ensures the string result holds a copy of the data we can return to the caller, not a pointer to the PRI file.
-    RETURN_IF_FAILED(StringResultReleaseOwnershipBuffer(stringResult, resourceString));
+    RETURN_IF_FAILED(StringResultReleaseOwnershipBuffer(stringResult, resourceString, GetResolver(resourceManager, resourceContext)));
 
     return S_OK;
 }
@@ -369,8 +412,106 @@ static HRESULT LoadEmbeddedResource(
     }
 
     // This ensures the blob result holds a copy of the data we can return to the caller, not a pointer to the PRI file.
-    RETURN_IF_FAILED(BlobResultReleaseOwnershipBuffer(blobResult, &data->data, &data->size));
+    RETURN_IF_FAILED(BlobResultReleaseOwnershipBuffer(blobResult, &data->data, &data->size, GetResolver(resourceManager, resourceContext)));
+
+    return S_OK;
+}
+
+static HRESULT LoadEmbeddedResourceView(
+    _In_ void* resourceManager,
+    _In_opt_ void* resourceContext,
+    _In_opt_ void* resourceMap,
+    int index,
+    _In_opt_ PCWSTR resourceIdOrUri,
+    _Out_ MrmResourceData* data)
+{
+    data->data = nullptr;
+    data->size = 0;
+
+    ResourceCandidateResult candidate;
+    RETURN_IF_FAILED(LoadResourceCandidate(resourceManager, resourceContext, resourceMap, index, resourceIdOrUri, &candidate, nullptr, nullptr, nullptr, nullptr));
+
+    BlobResult blobResult;
+    if (!candidate.TryGetBlobValue(&blobResult))
+    {
+        return HRESULT_FROM_WIN32(ERROR_MRM_RESOURCE_TYPE_MISMATCH);
+    }
+
+    // The blob result normally references the data section of the PRI file, which stays loaded for the lifetime of
+    // the resource manager, so we hand that reference out directly instead of making a copy.
+    return BlobResultGetReferenceOrCopy(blobResult, data, GetResolver(resourceManager, resourceContext));
+}
+
+struct MrmEmbeddedResourceObjects
+{
+    MrmResourceData data = {};
+    bool ownsData = false;
+};
+
+static void DestroyEmbeddedResource(_In_ MrmEmbeddedResourceObjects* embeddedResource)
+{
+    if (embeddedResource->ownsData)
+    {
+        MrmFreeResource(embeddedResource->data.data);
+    }
+
+    delete embeddedResource;
+}
+
+static HRESULT OpenEmbeddedResource(
+    _In_ void* resourceManager,
+    _In_opt_ void* resourceContext,
+    _In_opt_ void* resourceMap,
+    int index,
+    _In_opt_ PCWSTR resourceIdOrUri,
+    _Out_ MrmEmbeddedResourceHandle* embeddedResource,
+    _Out_opt_ UINT32* totalSize)
+{
+    *embeddedResource = nullptr;
+    if (totalSize != nullptr)
+    {
+        *totalSize = 0;
+    }
 
+    std::unique_ptr<MrmEmbeddedResourceObjects, decltype(&DestroyEmbeddedResource)> embeddedResourceObjects(
+        new (std::nothrow) MrmEmbeddedResourceObjects(), &DestroyEmbeddedResource);
+    RETURN_IF_NULL_ALLOC(embeddedResourceObjects);
+
+    // Resolve the candidate once; every read is then a slice of the same data.
+    HRESULT hr = LoadEmbeddedResourceView(resourceManager, resourceContext, resourceMap, index, resourceIdOrUri, &embeddedResourceObjects->data);
+    RETURN_IF_FAILED(hr);
+    embeddedResourceObjects->ownsData = (hr == S_FALSE);
+
+    if (totalSize != nullptr)
+    {
+        *totalSize = embeddedResourceObjects->data.size;
+    }
+
+    *embeddedResource = reinterpret_cast<MrmEmbeddedResourceHandle>(embeddedResourceObjects.release());
+    return S_OK;
+}
+
+static HRESULT ReadEmbeddedResource(
+    _In_ const MrmEmbeddedResourceObjects* embeddedResource,
+    UINT32 offset,
+    UINT32 bufferSize,
+    _Out_writes_bytes_to_(bufferSize, *bytesRead) void* buffer,
+    _Out_ UINT32* bytesRead)
+{
+    *bytesRead = 0;
+
+    const MrmResourceData& data = embeddedResource->data;
+    RETURN_HR_IF(E_BOUNDS, offset > data.size);
+
+    UINT32 bytesLeft = data.size - offset;
+    UINT32 bytesToCopy = (bufferSize < bytesLeft) ? bufferSize : bytesLeft;
+    if (bytesToCopy > 0)
+    {
+        RETURN_HR_IF_NULL(E_INVALIDARG, buffer);
+        CopyMemory(buffer, reinterpret_cast<const BYTE*>(data.data) + offset, bytesToCopy);
+    }
+
+    *bytesRead = bytesToCopy;
     return S_OK;
 }
 
@@ -383,6 +524,7 @@ static HRESULT LoadStringOrEmbeddedResource(
     _Out_ MrmType* resourceType,
     _Outptr_result_maybenull_ PWSTR* resourceString,
     _Out_ MrmResourceData* data,
+    bool embeddedDataAsView,
     _Outptr_opt_result_maybenull_ PWSTR* resourceName,
     _Out_opt_ UINT32* qualifierCount, 
     _Outptr_opt_result_buffer_(*qualifierCount) PWSTR** qualifierNames,
@@ -409,6 +551,7 @@ static HRESULT LoadStringOrEmbeddedResource(
     MrmEnvironment::ResourceValueType internalResourceType;
     RETURN_IF_FAILED(candidate.GetResourceValueType(&internalResourceType));
 
+    HRESULT hr = S_OK;
     if (MrmEnvironment::IsBinaryResourceValueType(internalResourceType))
     {
         BlobResult blobResult;
@@ -417,8 +560,18 @@ static HRESULT LoadStringOrEmbeddedResource(
             return E_UNEXPECTED;
         }
 
-        // This ensures the blob result holds a copy of the data we can return to the caller, not a pointer to the PRI file.
-        RETURN_IF_FAILED(BlobResultReleaseOwnershipBuffer(blobResult, &data->data, &data->size));
+        if (embeddedDataAsView)
+        {
+            // The caller asked for a pointer into the PRI file, which is valid as long as the resource manager is.
+            // Data that isn't backed by the file comes back as a copy, with S_FALSE.
+            hr = BlobResultGetReferenceOrCopy(blobResult, data, GetResolver(resourceManager, resourceContext));
+            RETURN_IF_FAILED(hr);
+        }
+        else
+        {
+            // This ensures the blob result holds a copy of the data we can return to the caller, not a pointer to the PRI file.
+            RETURN_IF_FAILED(BlobResultReleaseOwnershipBuffer(blobResult, &data->data, &data->size, GetResolver(resourceManager, resourceContext)));
+        }
 
         *resourceString = nullptr;
         *resourceType = MrmType_Embedded;
@@ -432,7 +585,7 @@ static HRESULT LoadStringOrEmbeddedResource(
         }
 
         // This ensures the string result holds a copy of the data we can return to the caller, not a pointer to the PRI file.
-        RETURN_IF_FAILED(StringResultReleaseOwnershipBuffer(stringResult, resourceString));
+        RETURN_IF_FAILED(StringResultReleaseOwnershipBuffer(stringResult, resourceString, GetResolver(resourceManager, resourceContext)));
 
         if (MrmEnvironment::IsStringResourceValueType(internalResourceType))
         {
@@ -453,9 +606,132 @@ static HRESULT LoadStringOrEmbeddedResource(
         *resourceName = name.release();
     }
 
+    return hr;
+}
+
+struct MrmPrefetchObjects
+{
+    void* resourceManager = nullptr;
+    void* resourceContext = nullptr;
+    const ResourceMapSubtree* resourceMap = nullptr;
+    UINT32 resourceCount = 0;
+    volatile LONG cancelled = 0;
+    HRESULT result = S_OK;
+    PTP_WORK work = nullptr;
+    wil::unique_event_nothrow completed;
+};
+
+static const ResourceMapSubtree* GetResourceMapSubtree(_In_ void* resourceManager, _In_opt_ void* resourceMap)
+{
+    if (resourceMap != nullptr)
+    {
+        return reinterpret_cast<ResourceMapSubtree*>(resourceMap);
+    }
+
+    const IResourceMapBase* internalResourceMap;
+    if (FAILED(reinterpret_cast<MrmObjects*>(resourceManager)->priFile->GetPrimaryResourceMap(&internalResourceMap)))
+    {
+        return nullptr;
+    }
+
+    return internalResourceMap->GetRootSubtree();
+}
+
+// Reads one byte from every page of the data so that the pages are resident by the time the data is really used.
+static void TouchPages(_In_reads_bytes_(sizeInBytes) const void* data, size_t sizeInBytes)
+{
+    const size_t pageSize = 4096;
+    const volatile BYTE* bytes = reinterpret_cast<const volatile BYTE*>(data);
+    for (size_t offset = 0; offset < sizeInBytes; offset += pageSize)
+    {
+        (void)bytes[offset];
+    }
+
+    if (sizeInBytes > 0)
+    {
+        (void)bytes[sizeInBytes - 1];
+    }
+}
+
+static HRESULT PrefetchResource(_In_ MrmPrefetchObjects* prefetch, UINT32 index)
+{
+    ResourceCandidateResult candidate;
+    RETURN_IF_FAILED(LoadResourceCandidate(
+        prefetch->resourceManager,
+        prefetch->resourceContext,
+        const_cast<ResourceMapSubtree*>(prefetch->resourceMap),
+        static_cast<int>(index),
+        nullptr,
+        &candidate,
+        nullptr,
+        nullptr,
+        nullptr,
+        nullptr));
+
+    MrmEnvironment::ResourceValueType internalResourceType;
+    RETURN_IF_FAILED(candidate.GetResourceValueType(&internalResourceType));
+
+    if (MrmEnvironment::IsBinaryResourceValueType(internalResourceType))
+    {
+        BlobResult blobResult;
+        if (candidate.TryGetBlobValue(&blobResult))
+        {
+            size_t sizeInBytes;
+            const void* ref = blobResult.GetRef(&sizeInBytes);
+            TouchPages(ref, sizeInBytes);
+        }
+    }
+    else
+    {
+        StringResult stringResult;
+        if (candidate.TryGetStringValue(&stringResult) && !stringResult.IsEmpty())
+        {
+            TouchPages(stringResult.GetRef(), stringResult.GetLength() * sizeof(wchar_t));
+        }
+    }
+
     return S_OK;
 }
 
+static void CALLBACK PrefetchWorkCallback(_Inout_ PTP_CALLBACK_INSTANCE, _Inout_opt_ PVOID context, _Inout_ PTP_WORK)
+{
+    MrmPrefetchObjects* prefetch = reinterpret_cast<MrmPrefetchObjects*>(context);
+
+    HRESULT hr = S_OK;
+    for (UINT32 i = 0; i < prefetch->resourceCount; i++)
+    {
+        if (InterlockedCompareExchange(&prefetch->cancelled, 0, 0) != 0)
+        {
+            hr = HRESULT_FROM_WIN32(ERROR_CANCELLED);
+            break;
+        }
+
+        // Resources without a candidate for this context are not an error, they are just not warmed up.
+        HRESULT resourceResult = PrefetchResource(prefetch, i);
+        if (FAILED(resourceResult) && (resourceResult != HRESULT_FROM_WIN32(ERROR_MRM_NO_MATCH_OR_DEFAULT_CANDIDATE)))
+        {
+            hr = resourceResult;
+            break;
+        }
+    }
+
+    prefetch->result = hr;
+    prefetch->completed.SetEvent();
+}
+
+static void DestroyPrefetch(_In_ MrmPrefetchObjects* prefetch)
+{
+    if (prefetch->work != nullptr)
+    {
+        InterlockedExchange(&prefetch->cancelled, 1);
+        WaitForThreadpoolWorkCallbacks(prefetch->work, FALSE);
+        CloseThreadpoolWork(prefetch->work);
+        prefetch->work = nullptr;
+    }
+
+    delete prefetch;
+}
+
 static void DestroyResourceManager(_In_ void* resourceManager)
 {
     MrmObjects* resourceManagerObjects = reinterpret_cast<MrmObjects*>(resourceManager);
@@ -745,6 +1021,61 @@ STDAPI MrmLoadEmbeddedResourceFromResourceUri(
     return S_OK;
 }
 
+STDAPI MrmLoadEmbeddedResourceView(
+    _In_ MrmManagerHandle resourceManager,
+    _In_opt_ MrmContextHandle resourceContext,
+    _In_opt_ MrmMapHandle resourceMap,
+    _In_ PCWSTR resourceId,
+    _Out_ MrmResourceData* data)
+{
+    return LoadEmbeddedResourceView(resourceManager, resourceContext, resourceMap, INDEX_RESOURCE_ID, resourceId, data);
+}
+
+STDAPI MrmLoadEmbeddedResourceViewFromResourceUri(
+    _In_ MrmManagerHandle resourceManager,
+    _In_opt_ MrmContextHandle resourceContext,
+    _In_ PCWSTR resourceUri,
+    _Out_ MrmResourceData* data)
+{
+    return LoadEmbeddedResourceView(resourceManager, resourceContext, nullptr, INDEX_RESOURCE_URI, resourceUri, data);
+}
+
+STDAPI MrmOpenEmbeddedResource(
+    _In_ MrmManagerHandle resourceManager,
+    _In_opt_ MrmContextHandle resourceContext,
+    _In_opt_ MrmMapHandle resourceMap,
+    _In_ PCWSTR resourceId,
+    _Out_ MrmEmbeddedResourceHandle* embeddedResource,
+    _Out_opt_ UINT32* totalSize)
+{
+    RETURN_IF_FAILED(OpenEmbeddedResource(
+        resourceManager, resourceContext, resourceMap, INDEX_RESOURCE_ID, resourceId, embeddedResource, totalSize));
+    return S_OK;
+}
+
+STDAPI MrmReadEmbeddedResource(
+    _In_ MrmEmbeddedResourceHandle embeddedResource,
+    UINT32 offset,
+    UINT32 bufferSize,
+    _Out_writes_bytes_to_(bufferSize, *bytesRead) void* buffer,
+    _Out_ UINT32* bytesRead)
+{
+    *bytesRead = 0;
+    RETURN_HR_IF_NULL(E_INVALIDARG, embeddedResource);
+
+    RETURN_IF_FAILED(ReadEmbeddedResource(
+        reinterpret_cast<const MrmEmbeddedResourceObjects*>(embeddedResource), offset, bufferSize, buffer, bytesRead));
+    return S_OK;
+}
+
+STDAPI_(void) MrmCloseEmbeddedResource(_In_opt_ MrmEmbeddedResourceHandle embeddedResource)
+{
+    if (embeddedResource != nullptr)
+    {
+        DestroyEmbeddedResource(reinterpret_cast<MrmEmbeddedResourceObjects*>(embeddedResource));
+    }
+}
+
 STDAPI MrmLoadStringOrEmbeddedResource(
     _In_ MrmManagerHandle resourceManager,
     _In_opt_ MrmContextHandle resourceContext,
@@ -755,10 +1086,23 @@ STDAPI MrmLoadStringOrEmbeddedResource(
     _Out_ MrmResourceData* data)
 {
     RETURN_IF_FAILED(LoadStringOrEmbeddedResource(
-        resourceManager, resourceContext, resourceMap, INDEX_RESOURCE_ID, resourceId, resourceType, resourceString, data, nullptr, nullptr, nullptr, nullptr));
+        resourceManager, resourceContext, resourceMap, INDEX_RESOURCE_ID, resourceId, resourceType, resourceString, data, false, nullptr, nullptr, nullptr, nullptr));
     return S_OK;
 }
 
+STDAPI MrmLoadStringOrEmbeddedResourceView(
+    _In_ MrmManagerHandle resourceManager,
+    _In_opt_ MrmContextHandle resourceContext,
+    _In_opt_ MrmMapHandle resourceMap,
+    _In_ PCWSTR resourceId,
+    _Out_ MrmType* resourceType,
+    _Outptr_result_maybenull_ PWSTR* resourceString,
+    _Out_ MrmResourceData* data)
+{
+    return LoadStringOrEmbeddedResource(
+        resourceManager, resourceContext, resourceMap, INDEX_RESOURCE_ID, resourceId, resourceType, resourceString, data, true, nullptr, nullptr, nullptr, nullptr);
+}
+
 STDAPI MrmLoadStringOrEmbeddedResourceWithQualifierValues(
     _In_ MrmManagerHandle resourceManager,
     _In_opt_ MrmContextHandle resourceContext,
@@ -780,6 +1124,7 @@ STDAPI MrmLoadStringOrEmbeddedResourceWithQualifierValues(
         resourceType, 
         resourceString, 
         data, 
+        false, 
         nullptr, 
         qualifierCount, 
         qualifierNames, 
@@ -796,7 +1141,7 @@ STDAPI MrmLoadStringOrEmbeddedFromResourceUri(
     _Out_ MrmResourceData* data)
 {
     RETURN_IF_FAILED(LoadStringOrEmbeddedResource(
-        resourceManager, resourceContext, nullptr, INDEX_RESOURCE_URI, resourceUri, resourceType, resourceString, data, nullptr, nullptr, nullptr, nullptr));
+        resourceManager, resourceContext, nullptr, INDEX_RESOURCE_URI, resourceUri, resourceType, resourceString, data, false, nullptr, nullptr, nullptr, nullptr));
     return S_OK;
 }
 
@@ -811,7 +1156,7 @@ STDAPI MrmLoadStringOrEmbeddedResourceByIndex(
     _Out_ MrmResourceData* data)
 {
     RETURN_IF_FAILED(LoadStringOrEmbeddedResource(
-        resourceManager, resourceContext, resourceMap, index, nullptr, resourceType, resourceString, data, resourceName, nullptr, nullptr, nullptr));
+        resourceManager, resourceContext, resourceMap, index, nullptr, resourceType, resourceString, data, false, resourceName, nullptr, nullptr, nullptr));
     return S_OK;
 }
 
@@ -837,6 +1182,7 @@ STDAPI MrmLoadStringOrEmbeddedResourceByIndexWithQualifierValues(
         resourceType, 
         resourceString, 
         data, 
+        false, 
         resourceName, 
         qualifierCount, 
         qualifierNames, 
@@ -844,6 +1190,117 @@ STDAPI MrmLoadStringOrEmbeddedResourceByIndexWithQualifierValues(
     return S_OK;
 }
 
+STDAPI_(void) MrmEnableStatistics(BOOL enable)
+{
+    _DefEnableStatistics(enable ? TRUE : FALSE);
+}
+
+STDAPI MrmGetStatistics(_In_ MrmManagerHandle resourceManager, _In_opt_ MrmContextHandle resourceContext, _Inout_ MrmStatistics* statistics)
+{
+    RETURN_HR_IF_NULL(E_INVALIDARG, statistics);
+    RETURN_HR_IF(E_INVALIDARG, statistics->cbSize < sizeof(*statistics));
+    RETURN_HR_IF_NULL(E_INVALIDARG, resourceManager);
+
+    ZeroMemory(statistics, sizeof(*statistics));
+    statistics->cbSize = sizeof(*statistics);
+
+    RESOLVER_STATISTICS resolverStatistics;
+    GetResolver(resourceManager, resourceContext)->GetStatistics(&resolverStatistics);
+
+    statistics->qualifierLookups = resolverStatistics.qualifierLookups;
+    statistics->qualifierCacheHits = resolverStatistics.qualifierCacheHits;
+    statistics->qualifierSetLookups = resolverStatistics.qualifierSetLookups;
+    statistics->qualifierSetCacheHits = resolverStatistics.qualifierSetCacheHits;
+    statistics->decisionLookups = resolverStatistics.decisionLookups;
+    statistics->decisionCacheHits = resolverStatistics.decisionCacheHits;
+    statistics->decisionEvaluations = resolverStatistics.decisionEvaluations;
+    statistics->cacheResets = resolverStatistics.cacheResets;
+    statistics->stringCopies = resolverStatistics.stringCopies;
+    statistics->blobCopies = resolverStatistics.blobCopies;
+    statistics->bytesCopied = resolverStatistics.bytesCopied;
+
+    LARGE_INTEGER frequency;
+    if (QueryPerformanceFrequency(&frequency) && (frequency.QuadPart != 0))
+    {
+        statistics->lockWaitTimeInMicroseconds = (resolverStatistics.lockWaitTicks * 1000000) / static_cast<UINT64>(frequency.QuadPart);
+    }
+
+    statistics->languageDistanceCalls = _DefGetLanguageDistanceCallCount();
+    statistics->stringBufferAllocations = StringResult::GetBufferAllocationCount();
+    statistics->blobBufferAllocations = BlobResult::GetBufferAllocationCount();
+
+    return S_OK;
+}
+
+STDAPI MrmResetStatistics(_In_ MrmManagerHandle resourceManager, _In_opt_ MrmContextHandle resourceContext)
+{
+    RETURN_HR_IF_NULL(E_INVALIDARG, resourceManager);
+
+    GetResolver(resourceManager, resourceContext)->ResetStatistics();
+    return S_OK;
+}
+
+STDAPI MrmPrefetch(
+    _In_ MrmManagerHandle resourceManager,
+    _In_opt_ MrmContextHandle resourceContext,
+    _In_opt_ MrmMapHandle resourceMap,
+    _Out_ MrmPrefetchHandle* prefetch)
+{
+    *prefetch = nullptr;
+    RETURN_HR_IF_NULL(E_INVALIDARG, resourceManager);
+
+    std::unique_ptr<MrmPrefetchObjects, decltype(&DestroyPrefetch)> prefetchObjects(new (std::nothrow) MrmPrefetchObjects(), &DestroyPrefetch);
+    RETURN_IF_NULL_ALLOC(prefetchObjects);
+
+    prefetchObjects->resourceManager = resourceManager;
+    prefetchObjects->resourceContext = resourceContext;
+    prefetchObjects->resourceMap = GetResourceMapSubtree(resourceManager, resourceMap);
+    RETURN_HR_IF_NULL(E_UNEXPECTED, prefetchObjects->resourceMap);
+
+    // Build the list of descendent resources here rather than on the worker, since the subtree builds it lazily and
+    // doesn't synchronize that with lookups made on other threads.
+    prefetchObjects->resourceCount = static_cast<UINT32>(prefetchObjects->resourceMap->GetNumDescendentResources());
+
+    RETURN_IF_FAILED(prefetchObjects->completed.create(wil::EventOptions::ManualReset));
+
+    prefetchObjects->work = CreateThreadpoolWork(PrefetchWorkCallback, prefetchObjects.get(), nullptr);
+    RETURN_LAST_ERROR_IF_NULL(prefetchObjects->work);
+    SubmitThreadpoolWork(prefetchObjects->work);
+
+    *prefetch = reinterpret_cast<MrmPrefetchHandle>(prefetchObjects.release());
+    return S_OK;
+}
+
+STDAPI MrmWaitForPrefetch(_In_ MrmPrefetchHandle prefetch, DWORD timeoutInMilliseconds)
+{
+    RETURN_HR_IF_NULL(E_INVALIDARG, prefetch);
+    MrmPrefetchObjects* prefetchObjects = reinterpret_cast<MrmPrefetchObjects*>(prefetch);
+
+    if (!prefetchObjects->completed.wait(timeoutInMilliseconds))
+    {
+        // Not an error, the prefetch is simply still running.
+        return HRESULT_FROM_WIN32(ERROR_TIMEOUT);
+    }
+
+    return prefetchObjects->result;
+}
+
+STDAPI_(void) MrmCancelPrefetch(_In_ MrmPrefetchHandle prefetch)
+{
+    if (prefetch != nullptr)
+    {
+        InterlockedExchange(&reinterpret_cast<MrmPrefetchObjects*>(prefetch)->cancelled, 1);
+    }
+}
+
+STDAPI_(void) MrmDestroyPrefetch(_In_opt_ MrmPrefetchHandle prefetch)
+{
+    if (prefetch != nullptr)
+    {
+        DestroyPrefetch(reinterpret_cast<MrmPrefetchObjects*>(prefetch));
+    }
+}
+
 STDAPI_(void*) MrmAllocateBuffer(size_t size) { return Def_Alloc(size); }
 
 STDAPI_(void) MrmFreeResource(_In_opt_ void* resource)
@@ -11,6 +11,8 @@ extern "C"
     DECLARE_HANDLE(MrmManagerHandle);
     DECLARE_HANDLE(MrmContextHandle);
     DECLARE_HANDLE(MrmMapHandle);
+    DECLARE_HANDLE(MrmPrefetchHandle);
+    DECLARE_HANDLE(MrmEmbeddedResourceHandle);
 
     enum MrmType
     {
@@ -26,6 +28,30 @@ extern "C"
         void* data;
     };
 
+    // Counters describing the work done to resolve resources. Resolver counters are cumulative for one context (or for
+    // the resource manager's default context); cache misses are lookups minus hits. The language distance and buffer
+    // allocation counters are process wide. Counters only advance while statistics are enabled with MrmEnableStatistics.
+    // Callers set cbSize to sizeof(MrmStatistics) before calling MrmGetStatistics.
+    struct MrmStatistics
+    {
+        UINT32 cbSize;
+        UINT64 qualifierLookups;
+        UINT64 qualifierCacheHits;
+        UINT64 qualifierSetLookups;
+        UINT64 qualifierSetCacheHits;
+        UINT64 decisionLookups;
+        UINT64 decisionCacheHits;
+        UINT64 decisionEvaluations;
+        UINT64 cacheResets;
+        UINT64 lockWaitTimeInMicroseconds;
+        UINT64 stringCopies;
+        UINT64 blobCopies;
+        UINT64 bytesCopied;
+        UINT64 languageDistanceCalls;
+        UINT64 stringBufferAllocations;
+        UINT64 blobBufferAllocations;
+    };
+
     STDAPI MrmCreateResourceManager(_In_ PCWSTR priFileName, _Out_ MrmManagerHandle* resourceManager);
     STDAPI_(void) MrmDestroyResourceManager(_In_opt_ MrmManagerHandle resourceManager);
 
@@ -71,6 +97,43 @@ extern "C"
         _In_ PCWSTR resourceUri,
         _Out_ MrmResourceData* data);
 
+    // The view APIs return a pointer directly into the loaded PRI file instead of a copy. The data is read-only, stays
+    // valid until the resource manager is destroyed, and must not be passed to MrmFreeResource. Data that isn't backed
+    // by the file is returned as a copy instead, with S_FALSE, and must be freed with MrmFreeResource.
+    STDAPI MrmLoadEmbeddedResourceView(
+        _In_ MrmManagerHandle resourceManager,
+        _In_opt_ MrmContextHandle resourceContext,
+        _In_opt_ MrmMapHandle resourceMap,
+        _In_ PCWSTR resourceId,
+        _Out_ MrmResourceData* data);
+
+    STDAPI MrmLoadEmbeddedResourceViewFromResourceUri(
+        _In_ MrmManagerHandle resourceManager,
+        _In_opt_ MrmContextHandle resourceContext,
+        _In_ PCWSTR resourceUri,
+        _Out_ MrmResourceData* data);
+
+    // Resolves an embedded resource once for reading in chunks. totalSize optionally receives the full size of the
+    // resource. The handle must not outlive the resource manager.
+    STDAPI MrmOpenEmbeddedResource(
+        _In_ MrmManagerHandle resourceManager,
+        _In_opt_ MrmContextHandle resourceContext,
+        _In_opt_ MrmMapHandle resourceMap,
+        _In_ PCWSTR resourceId,
+        _Out_ MrmEmbeddedResourceHandle* embeddedResource,
+        _Out_opt_ UINT32* totalSize);
+
+    // Copies at most bufferSize bytes of the resource, starting at offset, into the caller's buffer. Reading at the end
+    // of the data succeeds with *bytesRead set to 0; reading past it fails with E_BOUNDS.
+    STDAPI MrmReadEmbeddedResource(
+        _In_ MrmEmbeddedResourceHandle embeddedResource,
+        UINT32 offset,
+        UINT32 bufferSize,
+        _Out_writes_bytes_to_(bufferSize, *bytesRead) void* buffer,
+        _Out_ UINT32* bytesRead);
+
+    STDAPI_(void) MrmCloseEmbeddedResource(_In_opt_ MrmEmbeddedResourceHandle embeddedResource);
+
     STDAPI MrmLoadStringOrEmbeddedResource(
         _In_ MrmManagerHandle resourceManager,
         _In_opt_ MrmContextHandle resourceContext,
@@ -80,6 +143,18 @@ extern "C"
         _Outptr_result_maybenull_ PWSTR* resourceString,
         _Out_ MrmResourceData* data);
 
+    // Same as MrmLoadStringOrEmbeddedResource, but embedded data is returned as a view (see MrmLoadEmbeddedResourceView,
+    // including the S_FALSE copy case).
+    // String resources are still returned as a copy and must be freed with MrmFreeResource.
+    STDAPI MrmLoadStringOrEmbeddedResourceView(
+        _In_ MrmManagerHandle resourceManager,
+        _In_opt_ MrmContextHandle resourceContext,
+        _In_opt_ MrmMapHandle resourceMap,
+        _In_ PCWSTR resourceId,
+        _Out_ MrmType* resourceType,
+        _Outptr_result_maybenull_ PWSTR* resourceString,
+        _Out_ MrmResourceData* data);
+
     STDAPI MrmLoadStringOrEmbeddedResourceWithQualifierValues(
         _In_ MrmManagerHandle resourceManager,
         _In_opt_ MrmContextHandle resourceContext,
@@ -123,6 +198,26 @@ extern "C"
         _Outptr_result_buffer_(*qualifierCount) PWSTR** qualifierNames,
         _Outptr_result_buffer_(*qualifierCount) PWSTR** qualifierValues);
 
+    STDAPI_(void) MrmEnableStatistics(BOOL enable);
+    STDAPI MrmGetStatistics(_In_ MrmManagerHandle resourceManager, _In_opt_ MrmContextHandle resourceContext, _Inout_ MrmStatistics* statistics);
+    STDAPI MrmResetStatistics(_In_ MrmManagerHandle resourceManager, _In_opt_ MrmContextHandle resourceContext);
+
+    // Resolves every resource in the resource map (the primary resource map if none is given) for the given context on
+    // a thread pool thread, so that later lookups find the decision cache populated and the resource data paged in.
+    // The resource manager and context must outlive the prefetch. Destroying the prefetch cancels it and waits for the
+    // worker to stop.
+    STDAPI MrmPrefetch(
+        _In_ MrmManagerHandle resourceManager,
+        _In_opt_ MrmContextHandle resourceContext,
+        _In_opt_ MrmMapHandle resourceMap,
+        _Out_ MrmPrefetchHandle* prefetch);
+
+    // Returns the result of the prefetch once it completes, HRESULT_FROM_WIN32(ERROR_CANCELLED) if it was cancelled, or
+    // HRESULT_FROM_WIN32(ERROR_TIMEOUT) if it is still running after the timeout.
+    STDAPI MrmWaitForPrefetch(_In_ MrmPrefetchHandle prefetch, DWORD timeoutInMilliseconds);
+    STDAPI_(void) MrmCancelPrefetch(_In_ MrmPrefetchHandle prefetch);
+    STDAPI_(void) MrmDestroyPrefetch(_In_opt_ MrmPrefetchHandle prefetch);
+
     STDAPI_(void*) MrmAllocateBuffer(size_t size);
     STDAPI_(void) MrmFreeResource(_In_opt_ void* resource);
 
@@ -261,6 +261,85 @@ public:
         MrmDestroyResourceManager(resourceManager);
     }
 
+    TEST_METHOD(ReadEmbeddedResourceView)
+    {
+        MrmManagerHandle resourceManager;
+        VERIFY_ARE_EQUAL(MrmCreateResourceManager(L".\\resources.pri", &resourceManager), S_OK);
+
+        MrmResourceData resourceData {};
+        VERIFY_ARE_EQUAL(MrmLoadEmbeddedResource(resourceManager, nullptr, nullptr, L"Files/Controls/AlbumBasicInfoControl.xbf", &resourceData), S_OK);
+
+        MrmResourceData resourceView {};
+        VERIFY_ARE_EQUAL(MrmLoadEmbeddedResourceView(resourceManager, nullptr, nullptr, L"Files/Controls/AlbumBasicInfoControl.xbf", &resourceView), S_OK);
+        VERIFY_ARE_EQUAL(resourceView.size, 15002u);
+        VERIFY_ARE_EQUAL(0, memcmp(resourceData.data, resourceView.data, resourceView.size));
+
+        // The view points into the PRI file, so loading it again returns the same pointer.
+        MrmResourceData resourceViewFromUri {};
+        VERIFY_ARE_EQUAL(MrmLoadEmbeddedResourceViewFromResourceUri(resourceManager, nullptr, L"ms-resource://Microsoft.ZuneMusic/Files/Controls/AlbumBasicInfoControl.xbf", &resourceViewFromUri), S_OK);
+        VERIFY_ARE_EQUAL(resourceView.data, resourceViewFromUri.data);
+        VERIFY_ARE_EQUAL(resourceView.size, resourceViewFromUri.size);
+
+        MrmType resourceType;
+        wchar_t* resourceString;
+        MrmResourceData resourceViewOrString {};
+        VERIFY_ARE_EQUAL(MrmLoadStringOrEmbeddedResourceView(resourceManager, nullptr, nullptr, L"Files/Controls/AlbumBasicInfoControl.xbf", &resourceType, &resourceString, &resourceViewOrString), S_OK);
+        VERIFY_IS_TRUE(resourceType == MrmType_Embedded);
+        VERIFY_IS_NULL(resourceString);
+        VERIFY_ARE_EQUAL(resourceView.data, resourceViewOrString.data);
+
+        wchar_t* resourceString2;
+        VERIFY_ARE_EQUAL(MrmLoadStringOrEmbeddedResourceView(resourceManager, nullptr, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceType, &resourceString2, &resourceViewOrString), S_OK);
+        VERIFY_IS_TRUE(resourceType == MrmType_String);
+        VerifyStringEqual(resourceString2, L"Groove Music");
+
+        MrmFreeResource(resourceString2);
+        MrmFreeResource(resourceData.data);
+        MrmDestroyResourceManager(resourceManager);
+    }
+
+    TEST_METHOD(ReadEmbeddedResourceInChunks)
+    {
+        MrmManagerHandle resourceManager;
+        VERIFY_ARE_EQUAL(MrmCreateResourceManager(L".\\resources.pri", &resourceManager), S_OK);
+
+        MrmResourceData resourceView {};
+        VERIFY_ARE_EQUAL(MrmLoadEmbeddedResourceView(resourceManager, nullptr, nullptr, L"Files/Controls/AlbumBasicInfoControl.xbf", &resourceView), S_OK);
+
+        MrmEmbeddedResourceHandle embeddedResource;
+        UINT32 totalSize = 0;
+        VERIFY_ARE_EQUAL(MrmOpenEmbeddedResource(resourceManager, nullptr, nullptr, L"Files/Controls/AlbumBasicInfoControl.xbf", &embeddedResource, &totalSize), S_OK);
+        VERIFY_ARE_EQUAL(totalSize, 15002u);
+
+        BYTE chunk[4096];
+        UINT32 offset = 0;
+        for (;;)
+        {
+            UINT32 bytesRead;
+            VERIFY_ARE_EQUAL(MrmReadEmbeddedResource(embeddedResource, offset, sizeof(chunk), chunk, &bytesRead), S_OK);
+            if (bytesRead == 0)
+            {
+                break;
+            }
+
+            VERIFY_IS_LESS_THAN_OR_EQUAL(bytesRead, static_cast<UINT32>(sizeof(chunk)));
+            VERIFY_ARE_EQUAL(0, memcmp(reinterpret_cast<const BYTE*>(resourceView.data) + offset, chunk, bytesRead));
+            offset += bytesRead;
+        }
+        VERIFY_ARE_EQUAL(offset, 15002u);
+
+        UINT32 bytesRead;
+        VERIFY_ARE_EQUAL(MrmReadEmbeddedResource(embeddedResource, 15003u, sizeof(chunk), chunk, &bytesRead), E_BOUNDS);
+        VERIFY_ARE_EQUAL(bytesRead, 0u);
+
+        MrmCloseEmbeddedResource(embeddedResource);
+
+        VERIFY_ARE_EQUAL(MrmOpenEmbeddedResource(resourceManager, nullptr, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &embeddedResource, nullptr), HRESULT_FROM_WIN32(ERROR_MRM_RESOURCE_TYPE_MISMATCH));
+        VERIFY_IS_NULL(embeddedResource);
+
+        MrmDestroyResourceManager(resourceManager);
+    }
+
     TEST_METHOD(ReadEmbeddedResourceAsString_Fails)
     {
         MrmManagerHandle resourceManager;
@@ -599,6 +678,154 @@ public:
         }
     }
 
+    TEST_METHOD(Statistics)
+    {
+        MrmManagerHandle resourceManager;
+        VERIFY_ARE_EQUAL(MrmCreateResourceManager(L".\\resources.pri", &resourceManager), S_OK);
+
+        MrmContextHandle resourceContext;
+        VERIFY_ARE_EQUAL(MrmCreateResourceContext(resourceManager, &resourceContext), S_OK);
+
+        VERIFY_ARE_EQUAL(MrmGetStatistics(resourceManager, resourceContext, nullptr), E_INVALIDARG);
+
+        MrmStatistics statistics = {};
+        VERIFY_ARE_EQUAL(MrmGetStatistics(resourceManager, resourceContext, &statistics), E_INVALIDARG);
+
+        // Statistics are off by default, so lookups don't move the counters.
+        wchar_t* resourceString;
+        VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, nullptr, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceString), S_OK);
+        MrmFreeResource(resourceString);
+
+        statistics.cbSize = sizeof(statistics);
+        VERIFY_ARE_EQUAL(MrmGetStatistics(resourceManager, nullptr, &statistics), S_OK);
+        VERIFY_ARE_EQUAL(statistics.cbSize, static_cast<UINT32>(sizeof(statistics)));
+        VERIFY_ARE_EQUAL(statistics.decisionLookups, 0ull);
+        VERIFY_ARE_EQUAL(statistics.bytesCopied, 0ull);
+
+        MrmEnableStatistics(TRUE);
+        VERIFY_ARE_EQUAL(MrmGetStatistics(resourceManager, resourceContext, &statistics), S_OK);
+        VERIFY_ARE_EQUAL(statistics.decisionLookups, 0ull);
+
+        for (unsigned int i = 0; i < 2; i++)
+        {
+            VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, resourceContext, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceString), S_OK);
+            MrmFreeResource(resourceString);
+        }
+
+        VERIFY_ARE_EQUAL(MrmGetStatistics(resourceManager, resourceContext, &statistics), S_OK);
+        VERIFY_ARE_EQUAL(statistics.decisionLookups, 2ull);
+        VERIFY_ARE_EQUAL(statistics.decisionEvaluations, 1ull);
+        VERIFY_ARE_EQUAL(statistics.decisionCacheHits, 1ull);
+        VERIFY_ARE_EQUAL(statistics.stringCopies, 2ull);
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(statistics.bytesCopied, 2ull * wcslen(L"Groove Music") * sizeof(wchar_t));
+
+        // Lookups made through the context are not attributed to the resource manager's default context.
+        MrmStatistics managerStatistics = { sizeof(managerStatistics) };
+        VERIFY_ARE_EQUAL(MrmGetStatistics(resourceManager, nullptr, &managerStatistics), S_OK);
+        VERIFY_ARE_EQUAL(managerStatistics.decisionLookups, 0ull);
+
+        // Changing a qualifier resets the caches, so the next lookup has to evaluate the decision again.
+        VERIFY_ARE_EQUAL(MrmSetQualifier(resourceContext, L"Language", L"en-GB"), S_OK);
+        VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, resourceContext, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceString), S_OK);
+        MrmFreeResource(resourceString);
+
+        VERIFY_ARE_EQUAL(MrmGetStatistics(resourceManager, resourceContext, &statistics), S_OK);
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(statistics.cacheResets, 1ull);
+        VERIFY_ARE_EQUAL(statistics.decisionEvaluations, 2ull);
+
+        VERIFY_ARE_EQUAL(MrmResetStatistics(resourceManager, resourceContext), S_OK);
+        VERIFY_ARE_EQUAL(MrmGetStatistics(resourceManager, resourceContext, &statistics), S_OK);
+        VERIFY_ARE_EQUAL(statistics.decisionLookups, 0ull);
+        VERIFY_ARE_EQUAL(statistics.bytesCopied, 0ull);
+
+        MrmEnableStatistics(FALSE);
+        MrmDestroyResourceContext(resourceContext);
+        MrmDestroyResourceManager(resourceManager);
+    }
+
+    TEST_METHOD(StringAllocations)
+    {
+        MrmManagerHandle resourceManager;
+        VERIFY_ARE_EQUAL(MrmCreateResourceManager(L".\\resources.pri", &resourceManager), S_OK);
+
+        // Warm up the caches so that only the per-lookup work is measured.
+        wchar_t* resourceString;
+        VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, nullptr, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceString), S_OK);
+        MrmFreeResource(resourceString);
+
+        MrmEnableStatistics(TRUE);
+        MrmStatistics before = { sizeof(before) };
+        VERIFY_ARE_EQUAL(MrmGetStatistics(resourceManager, nullptr, &before), S_OK);
+
+        const unsigned int lookups = 10;
+        for (unsigned int i = 0; i < lookups; i++)
+        {
+            VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, nullptr, nullptr, L"resources/IDS_MANIFEST_MUSIC_APP_NAME", &resourceString), S_OK);
+            VerifyStringEqual(resourceString, L"Groove Music");
+            MrmFreeResource(resourceString);
+        }
+
+        // Short strings are kept inline, so the only allocation left is the copy handed to the caller.
+        MrmStatistics after = { sizeof(after) };
+        VERIFY_ARE_EQUAL(MrmGetStatistics(resourceManager, nullptr, &after), S_OK);
+        VERIFY_IS_LESS_THAN_OR_EQUAL(after.stringBufferAllocations - before.stringBufferAllocations, static_cast<UINT64>(lookups));
+
+        MrmEnableStatistics(FALSE);
+        MrmDestroyResourceManager(resourceManager);
+    }
+
+    TEST_METHOD(Prefetch)
+    {
+        MrmManagerHandle resourceManager;
+        VERIFY_ARE_EQUAL(MrmCreateResourceManager(L".\\resources.pri", &resourceManager), S_OK);
+
+        MrmContextHandle resourceContext;
+        VERIFY_ARE_EQUAL(MrmCreateResourceContext(resourceManager, &resourceContext), S_OK);
+
+        MrmMapHandle childResourceMap;
+        VERIFY_ARE_EQUAL(MrmGetChildResourceMap(resourceManager, nullptr, L"resources", &childResourceMap), S_OK);
+
+        UINT32 count;
+        VERIFY_ARE_EQUAL(MrmGetResourceCount(resourceManager, childResourceMap, &count), S_OK);
+
+        MrmEnableStatistics(TRUE);
+
+        MrmPrefetchHandle prefetch;
+        VERIFY_ARE_EQUAL(MrmPrefetch(resourceManager, resourceContext, childResourceMap, &prefetch), S_OK);
+        VERIFY_ARE_EQUAL(MrmWaitForPrefetch(prefetch, INFINITE), S_OK);
+        MrmDestroyPrefetch(prefetch);
+
+        MrmStatistics statistics = { sizeof(statistics) };
+        VERIFY_ARE_EQUAL(MrmGetStatistics(resourceManager, resourceContext, &statistics), S_OK);
+        VERIFY_IS_GREATER_THAN_OR_EQUAL(statistics.decisionLookups, static_cast<UINT64>(count));
+
+        // The decision for the resource was evaluated by the prefetch, so the lookup is served from the cache.
+        VERIFY_ARE_EQUAL(MrmResetStatistics(resourceManager, resourceContext), S_OK);
+        wchar_t* resourceString;
+        VERIFY_ARE_EQUAL(MrmLoadStringResource(resourceManager, resourceContext, childResourceMap, L"IDS_MANIFEST_MUSIC_APP_NAME", &resourceString), S_OK);
+        VerifyStringEqual(resourceString, L"Groove Music");
+        MrmFreeResource(resourceString);
+
+        VERIFY_ARE_EQUAL(MrmGetStatistics(resourceManager, resourceContext, &statistics), S_OK);
+        VERIFY_ARE_EQUAL(statistics.decisionEvaluations, 0ull);
+        VERIFY_ARE_EQUAL(statistics.decisionCacheHits, 1ull);
+
+        // A cancelled prefetch either finishes before it sees the cancellation or stops early.
+        VERIFY_ARE_EQUAL(MrmPrefetch(resourceManager, nullptr, nullptr, &prefetch), S_OK);
+        MrmCancelPrefetch(prefetch);
+        HRESULT hr = MrmWaitForPrefetch(prefetch, INFINITE);
+        VERIFY_IS_TRUE((hr == S_OK) || (hr == HRESULT_FROM_WIN32(ERROR_CANCELLED)));
+        MrmDestroyPrefetch(prefetch);
+
+        // Destroying a running prefetch cancels it and waits for it to stop.
+        VERIFY_ARE_EQUAL(MrmPrefetch(resourceManager, resourceContext, nullptr, &prefetch), S_OK);
+        MrmDestroyPrefetch(prefetch);
+
+        MrmEnableStatistics(FALSE);
+        MrmDestroyResourceContext(resourceContext);
+        MrmDestroyResourceManager(resourceManager);
+    }
+
     TEST_METHOD(GetFilePath)
     {
         wchar_t* path;
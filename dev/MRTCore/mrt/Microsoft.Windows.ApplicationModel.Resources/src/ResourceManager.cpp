@@ -57,19 +57,59 @@ winrt::event_token ResourceManager::ResourceNotFound(winrt::Windows::Foundation:
                                                      Microsoft::Windows::ApplicationModel::Resources::ResourceNotFoundEventArgs> const& handler)
 {
     slim_lock_guard const guard {m_lock};
+    ClearResolutionCache();
     return m_resourceNotFound.add(handler);
 }
 
 void ResourceManager::ResourceNotFound(winrt::event_token const& token) noexcept
 {
     slim_lock_guard const guard {m_lock};
+    ClearResolutionCache();
     m_resourceNotFound.remove(token);
 }
 
+std::wstring ResourceManager::GetResolutionCacheKey(Microsoft::Windows::ApplicationModel::Resources::ResourceContext const& context, hstring const& name)
+{
+    // The handler only sees the name and the context, so those are what the outcome depends on.
+    std::wstring key(name);
+    for (auto const& value : context.QualifierValues())
+    {
+        key.push_back(L'\0');
+        key.append(value.Key());
+        key.push_back(L'=');
+        key.append(value.Value());
+    }
+    return key;
+}
+
+void ResourceManager::ClearResolutionCache()
+{
+    // Caller must hold m_lock.
+    m_resolutionCache.clear();
+    m_resolutionCacheInUse = false;
+    ++m_resolutionCacheGeneration;
+}
+
 Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate ResourceManager::HandleResourceNotFound(
     Microsoft::Windows::ApplicationModel::Resources::ResourceContext context,
     hstring name)
 {
+    // Read before the handlers run: if they change while the event is being raised, the outcome is not cached.
+    uint64_t const generation = m_resolutionCacheGeneration;
+
+    std::wstring cacheKey;
+    if (m_resolutionCacheInUse)
+    {
+        cacheKey = GetResolutionCacheKey(context, name);
+
+        slim_lock_guard const guard {m_lock};
+        auto cached = m_resolutionCache.find(cacheKey);
+        if (cached != m_resolutionCache.end())
+        {
+            return cached->second;
+        }
+    }
+
     Microsoft::Windows::ApplicationModel::Resources::ResourceNotFoundEventArgs args = winrt::make<ResourceNotFoundEventArgs>(context, name);
     m_resourceNotFound(*this, args);
     Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate candidate = args.as<ResourceNotFoundEventArgs>()->GetResolvedCandidate();
@@ -78,6 +118,25 @@ Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate ResourceManag
         candidate.as<winrt::Microsoft::Windows::ApplicationModel::Resources::implementation::ResourceCandidate>()->SetQualifierValuesFromContext(context);
     }
 
+    if (args.IsResolutionCacheable())
+    {
+        if (cacheKey.empty())
+        {
+            cacheKey = GetResolutionCacheKey(context, name);
+        }
+
+        slim_lock_guard const guard {m_lock};
+        if (generation == m_resolutionCacheGeneration)
+        {
+            if (m_resolutionCache.size() >= c_maxResolutionCacheEntries)
+            {
+                m_resolutionCache.clear();
+            }
+            m_resolutionCache.insert_or_assign(std::move(cacheKey), candidate);
+            m_resolutionCacheInUse = true;
+        }
+    }
+
     return candidate;
 }
 } // namespace winrt::Microsoft::Windows::ApplicationModel::Resources::implementation
@@ -27,9 +27,22 @@ struct ResourceManager : ResourceManagerT<ResourceManager>
 
 private:
     ~ResourceManager();
+
+    std::wstring GetResolutionCacheKey(Microsoft::Windows::ApplicationModel::Resources::ResourceContext const& context, hstring const& name);
+    void ClearResolutionCache();
+
     MrmManagerHandle m_resourceManagerHandle = nullptr;
     slim_mutex m_lock;
 
+    // Outcomes of ResourceNotFound that a handler marked as cacheable, keyed by name and context
+    // qualifier values. A null candidate records that the name could not be resolved.
+    // Guarded by m_lock, and cleared whenever the set of handlers changes. Clearing bumps the generation, so a
+    // lookup whose handlers ran before the change doesn't put its outcome back into the cache.
+    static constexpr size_t c_maxResolutionCacheEntries = 256;
+    std::unordered_map<std::wstring, Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate> m_resolutionCache;
+    std::atomic<bool> m_resolutionCacheInUse = false;
+    std::atomic<uint64_t> m_resolutionCacheGeneration = 0;
+
     winrt::event<winrt::Windows::Foundation::TypedEventHandler<
         Microsoft::Windows::ApplicationModel::Resources::ResourceManager,
         Microsoft::Windows::ApplicationModel::Resources::ResourceNotFoundEventArgs>>
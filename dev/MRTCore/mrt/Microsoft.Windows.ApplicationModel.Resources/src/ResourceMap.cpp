@@ -67,7 +67,8 @@ Resources::ResourceCandidate ResourceMap::GetValueImpl(const Resources::Resource
     wchar_t* resourceString;
     MrmResourceData resourceData {};
 
-    HRESULT hr = MrmLoadStringOrEmbeddedResource(
+    // Embedded data is returned as a view into the PRI file, so the only copy made is the one owned by the candidate.
+    HRESULT hr = MrmLoadStringOrEmbeddedResourceView(
         m_resourceManagerHandle,
         resourceContext.as<Resources::implementation::ResourceContext>()->GetContextHandle(),
         m_resourceMapHandle,
@@ -94,14 +95,15 @@ Resources::ResourceCandidate ResourceMap::GetValueImpl(const Resources::Resource
     {
     case MrmType_Embedded:
     {
-        embedded_resoure_ptr resourceContainer(resourceData.data);
+        // S_FALSE means the data isn't backed by the PRI file and we got a copy, which we own.
+        embedded_resoure_ptr resourceContainer((hr == S_FALSE) ? resourceData.data : nullptr);
         return winrt::make<ResourceCandidate>(
             m_resourceManagerHandle,
             resourceContext.as<Resources::implementation::ResourceContext>()->GetContextHandle(),
             m_resourceMapHandle,
             static_cast<uint32_t>(-1),
             resource,
-            winrt::array_view<uint8_t>(reinterpret_cast<byte*>(resourceContainer.get()), reinterpret_cast<byte*>(resourceContainer.get()) + resourceData.size));
+            winrt::array_view<uint8_t const>(reinterpret_cast<const byte*>(resourceData.data), reinterpret_cast<const byte*>(resourceData.data) + resourceData.size));
     }
     case MrmType_String:
     {
@@ -152,6 +154,31 @@ Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate ResourceMap::
     return GetValueImpl(&context, resource, true);
 }
 
+winrt::Windows::Foundation::IAsyncAction ResourceMap::PrefetchAsync(Resources::ResourceContext context)
+{
+    auto strongThis = get_strong();
+    if (m_resourceManagerHandle == nullptr)
+    {
+        // Resources not managed by MRT have nothing to warm up.
+        co_return;
+    }
+
+    context.as<Resources::implementation::ResourceContext>()->Apply();
+
+    MrmPrefetchHandle prefetchHandle = nullptr;
+    winrt::check_hresult(MrmPrefetch(
+        m_resourceManagerHandle, context.as<Resources::implementation::ResourceContext>()->GetContextHandle(), m_resourceMapHandle, &prefetchHandle));
+
+    // The cancellation callback can outlive this coroutine, so it shares ownership of the prefetch.
+    std::shared_ptr<std::remove_pointer_t<MrmPrefetchHandle>> prefetch(prefetchHandle, MrmDestroyPrefetch);
+
+    auto cancellation = co_await winrt::get_cancellation_token();
+    cancellation.callback([prefetch]() { MrmCancelPrefetch(prefetch.get()); });
+
+    co_await winrt::resume_background();
+    winrt::check_hresult(MrmWaitForPrefetch(prefetch.get(), INFINITE));
+}
+
 IKeyValuePair<hstring, Resources::ResourceCandidate> ResourceMap::GetValueByIndexImpl(
     const Resources::ResourceContext* context,
     uint32_t index)
@@ -39,6 +39,8 @@ struct ResourceMap : ResourceMapT<ResourceMap>
     Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate TryGetValue(hstring const& resource);
     Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate TryGetValue(hstring const& resource, Microsoft::Windows::ApplicationModel::Resources::ResourceContext const& context);
 
+    winrt::Windows::Foundation::IAsyncAction PrefetchAsync(Microsoft::Windows::ApplicationModel::Resources::ResourceContext context);
+
 private:
     Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate GetValueImpl(
         const Microsoft::Windows::ApplicationModel::Resources::ResourceContext* context,
@@ -15,4 +15,8 @@ void ResourceNotFoundEventArgs::SetResolvedCandidate(Microsoft::Windows::Applica
 {
     m_candidate = candidate;
 }
+
+bool ResourceNotFoundEventArgs::IsResolutionCacheable() { return m_isResolutionCacheable; }
+
+void ResourceNotFoundEventArgs::IsResolutionCacheable(bool value) { m_isResolutionCacheable = value; }
 } // namespace winrt::Microsoft::Windows::ApplicationModel::Resources::implementation
@@ -17,6 +17,8 @@ struct ResourceNotFoundEventArgs : ResourceNotFoundEventArgsT<ResourceNotFoundEv
     Microsoft::Windows::ApplicationModel::Resources::ResourceContext Context();
     hstring Name();
     void SetResolvedCandidate(Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate const& candidate);
+    bool IsResolutionCacheable();
+    void IsResolutionCacheable(bool value);
 
     Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate GetResolvedCandidate() { return m_candidate; }
 
@@ -24,6 +26,7 @@ private:
     Microsoft::Windows::ApplicationModel::Resources::ResourceContext m_resourceContext = nullptr;
     hstring m_resourceName;
     Microsoft::Windows::ApplicationModel::Resources::ResourceCandidate m_candidate = nullptr;
+    bool m_isResolutionCacheable = false;
 };
 
 } // namespace winrt::Microsoft::Windows::ApplicationModel::Resources::implementation
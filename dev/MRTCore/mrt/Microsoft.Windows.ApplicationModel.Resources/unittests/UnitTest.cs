@@ -150,6 +150,47 @@ namespace ManagedTest
             Assert.IsNull(resourceCandidate);
         }
 
+        [TestMethod]
+        public void ResourceNotFoundCacheTest()
+        {
+            var resourceManager = new ResourceManager("resources.pri.standalone");
+            int handlerCalls = 0;
+            resourceManager.ResourceNotFound += (sender, args) =>
+            {
+                handlerCalls++;
+                if (args.Name == "abc")
+                {
+                    var candidate = new ResourceCandidate(ResourceCandidateKind.String, "abcValue");
+                    args.SetResolvedCandidate(candidate);
+                }
+                args.IsResolutionCacheable = (args.Name != "uncached");
+            };
+            var resourceMap = resourceManager.MainResourceMap.GetSubtree("resources");
+
+            // Resolved and unresolved outcomes are both reused once cached.
+            Assert.AreEqual(resourceMap.GetValue("abc").ValueAsString, "abcValue");
+            Assert.AreEqual(resourceMap.GetValue("abc").ValueAsString, "abcValue");
+            Assert.IsNull(resourceMap.TryGetValue("xyz"));
+            Assert.IsNull(resourceMap.TryGetValue("xyz"));
+            Assert.AreEqual(handlerCalls, 2);
+
+            // Handlers that don't opt in are raised every time.
+            Assert.IsNull(resourceMap.TryGetValue("uncached"));
+            Assert.IsNull(resourceMap.TryGetValue("uncached"));
+            Assert.AreEqual(handlerCalls, 4);
+
+            // A different context is a different cache entry.
+            var resourceContext = resourceManager.CreateResourceContext();
+            resourceContext.QualifierValues[KnownResourceQualifierName.Language] = "de-DE";
+            Assert.AreEqual(resourceMap.GetValue("abc", resourceContext).ValueAsString, "abcValue");
+            Assert.AreEqual(handlerCalls, 5);
+
+            // Changing the set of handlers discards cached outcomes.
+            resourceManager.ResourceNotFound += (sender, args) => { };
+            Assert.AreEqual(resourceMap.GetValue("abc").ValueAsString, "abcValue");
+            Assert.AreEqual(handlerCalls, 6);
+        }
+
         [TestMethod]
         public void DefaultResourceManagerTest()
         {
@@ -345,6 +386,26 @@ namespace ManagedTest
             Assert.AreEqual(candidate.Kind, ResourceCandidateKind.String);
         }
 
+        [TestMethod]
+        public void PrefetchWithContextTest()
+        {
+            var resourceManager = new ResourceManager("resources.pri.standalone");
+            var resourceMap = resourceManager.MainResourceMap.GetSubtree("Resources");
+            var resourceContext = resourceManager.CreateResourceContext();
+            resourceContext.QualifierValues[KnownResourceQualifierName.Language] = "en-GB";
+
+            resourceMap.PrefetchAsync(resourceContext).AsTask().Wait();
+
+            var candidate = resourceMap.GetValue("IDS_WHATS_NEW_1710_2_EQUALIZER_TITLE", resourceContext);
+            Assert.AreEqual(candidate.ValueAsString, "Equaliser");
+
+            // Cancelling after completion has no effect.
+            var prefetch = resourceMap.PrefetchAsync(resourceContext);
+            prefetch.AsTask().Wait();
+            prefetch.Cancel();
+            Assert.AreEqual(prefetch.Status, Windows.Foundation.AsyncStatus.Completed);
+        }
+
         [TestMethod]
         public void ResourceNotFoundWithContextTest()
         {
@@ -0,0 +1,244 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include <windows.h>
+#include <WexTestClass.h>
+
+#include "Helpers.h"
+
+#include "mrm/build/Base.h"
+#include "mrm/common/file/MrmFiles.h"
+#include "mrm/readers/FileLists.h"
+#include "mrm/build/FileListBuilder.h"
+
+using namespace WEX::Common;
+using namespace WEX::TestExecution;
+using namespace WEX::Logging;
+
+using namespace Microsoft::Resources;
+using namespace Microsoft::Resources::Build;
+
+namespace UnitTests
+{
+class FileListUnitTests : public WEX::TestClass<FileListUnitTests>
+{
+    TEST_CLASS(FileListUnitTests);
+
+    TEST_METHOD(PathLookupTests);
+    TEST_METHOD(LargePathLookupTests);
+};
+
+static const int NumLargeListFolders = 64;
+static const int NumLargeListFilesPerFolder = IFileList::MaxFileIndex / NumLargeListFolders;
+
+// Builds "App\Images\GroupNN\imageNNNNN.png" for numFolders groups of numFilesPerFolder files.
+static void BuildFileList(_In_ int numFolders, _In_ int numFilesPerFolder, _Inout_ BuildHelper* pBuilt)
+{
+    FileBuilder* pFileBuilder;
+    VERIFY_SUCCEEDED(FileBuilder::CreateInstance(gUniversalPriFileMagic, 1, &pFileBuilder));
+
+    FileListBuilder* pBuilder;
+    VERIFY_SUCCEEDED(FileListBuilder::CreateInstance(pFileBuilder, FileListBuilder::BuildUtf16Only, &pBuilder));
+
+    FolderInfo* pRoot;
+    FolderInfo* pImages;
+    VERIFY_SUCCEEDED(pBuilder->GetOrAddRootFolder(L"App", &pRoot));
+    VERIFY_SUCCEEDED(pRoot->GetOrAddSubfolder(L"Images", &pImages));
+
+    WCHAR name[MAX_PATH];
+    for (int iFolder = 0; iFolder < numFolders; iFolder++)
+    {
+        FolderInfo* pGroup;
+        VERIFY_SUCCEEDED(StringCchPrintf(name, ARRAYSIZE(name), L"Group%02d", iFolder));
+        VERIFY_SUCCEEDED(pImages->GetOrAddSubfolder(name, &pGroup));
+
+        for (int iFile = 0; iFile < numFilesPerFolder; iFile++)
+        {
+            FileInfo* pFile;
+            VERIFY_SUCCEEDED(StringCchPrintf(name, ARRAYSIZE(name), L"image%05d.png", (iFolder * numFilesPerFolder) + iFile));
+            VERIFY_SUCCEEDED(pGroup->GetOrAddFile(name, &pFile));
+        }
+    }
+
+    VERIFY_HRESULT(pBuilt->Build(pBuilder));
+
+    delete pBuilder;
+    delete pFileBuilder;
+}
+
+static void ToUpper(_Inout_ PWSTR pStr)
+{
+    for (; *pStr != L'\0'; pStr++)
+    {
+        *pStr = towupper(*pStr);
+    }
+}
+
+// Every path reported by GetFilePath and GetFolderPath must map back to the same index,
+// regardless of case.
+static void CheckPathRoundTrip(_In_ const FileFileList* pList)
+{
+    StringResult path;
+    WCHAR variant[MAX_PATH];
+
+    for (int folderIndex = 0; folderIndex < pList->GetTotalNumFolders(); folderIndex++)
+    {
+        int foundIndex = -1;
+        VERIFY_SUCCEEDED(pList->GetFolderPath(folderIndex, &path));
+        VERIFY(pList->TryGetFolderIndex(path.GetRef(), &foundIndex));
+        VERIFY_ARE_EQUAL(folderIndex, foundIndex);
+
+        VERIFY_SUCCEEDED(StringCchCopy(variant, ARRAYSIZE(variant), path.GetRef()));
+        ToUpper(variant);
+        VERIFY(pList->TryGetFolderIndex(variant, &foundIndex));
+        VERIFY_ARE_EQUAL(folderIndex, foundIndex);
+
+        VERIFY(!pList->TryGetFileIndex(path.GetRef(), &foundIndex));
+        VERIFY_ARE_EQUAL(-1, foundIndex);
+
+        // The tree walk behind the base class lookups must agree with the hashed index
+        size_t cchPath;
+        path.GetLength(&cchPath);
+        VERIFY_SUCCEEDED(StringCchPrintf(variant, ARRAYSIZE(variant), L"%s\\x", path.GetRef()));
+        int cchUsed = 0;
+        VERIFY(pList->TryGetPrefixFolderIndex(variant, &foundIndex, &cchUsed));
+        VERIFY_ARE_EQUAL(folderIndex, foundIndex);
+        VERIFY_ARE_EQUAL(static_cast<int>(cchPath) + 1, cchUsed);
+
+        int parentIndex = -1;
+        if (SUCCEEDED(pList->GetFolderParentFolderIndex(folderIndex, &parentIndex)))
+        {
+            VERIFY(pList->IFileList::TryGetFolderIndex(path.GetRef(), &foundIndex));
+            VERIFY_ARE_EQUAL(folderIndex, foundIndex);
+        }
+    }
+
+    for (int fileIndex = 1; fileIndex <= pList->GetTotalNumFiles(); fileIndex++)
+    {
+        int foundIndex = -1;
+        VERIFY_SUCCEEDED(pList->GetFilePath(fileIndex, &path));
+        VERIFY(pList->TryGetFileIndex(path.GetRef(), &foundIndex));
+        VERIFY_ARE_EQUAL(fileIndex, foundIndex);
+
+        VERIFY_SUCCEEDED(StringCchCopy(variant, ARRAYSIZE(variant), path.GetRef()));
+        ToUpper(variant);
+        VERIFY(pList->TryGetFileIndex(variant, &foundIndex));
+        VERIFY_ARE_EQUAL(fileIndex, foundIndex);
+
+        VERIFY(!pList->TryGetFolderIndex(path.GetRef(), &foundIndex));
+    }
+}
+
+void FileListUnitTests::PathLookupTests()
+{
+    BuildHelper built;
+    BuildFileList(3, 4, &built);
+
+    FileFileList* pList;
+    VERIFY_SUCCEEDED(FileFileList::CreateInstance(built.GetBuffer(), built.GetBufferSize(), &pList));
+    VERIFY_ARE_EQUAL(5, pList->GetTotalNumFolders());
+    VERIFY_ARE_EQUAL(12, pList->GetTotalNumFiles());
+
+    CheckPathRoundTrip(pList);
+
+    int index = 0;
+    VERIFY(pList->TryGetFolderIndex(L"app\\images\\group01", &index));
+    VERIFY(pList->TryGetFileIndex(L"App\\Images\\Group02\\IMAGE00011.PNG", &index));
+
+    // Paths must match a whole entry exactly, apart from case
+    VERIFY(!pList->TryGetFileIndex(L"App\\Images\\Group02\\image00012.png", &index));
+    VERIFY_ARE_EQUAL(-1, index);
+    VERIFY(!pList->TryGetFileIndex(L"App\\Images\\Group01\\image00011.png", &index));
+    VERIFY(!pList->TryGetFileIndex(L"App/Images/Group02/image00011.png", &index));
+    VERIFY(!pList->TryGetFileIndex(L"\\App\\Images\\Group02\\image00011.png", &index));
+    VERIFY(!pList->TryGetFileIndex(L"App\\Images\\Group02\\image00011.png\\", &index));
+    VERIFY(!pList->TryGetFileIndex(L"image00011.png", &index));
+    VERIFY(!pList->TryGetFileIndex(L"", &index));
+    VERIFY(!pList->TryGetFolderIndex(L"App\\Images\\", &index));
+    VERIFY(!pList->TryGetFolderIndex(L"App\\Images\\Group0", &index));
+    VERIFY(!pList->TryGetFolderIndex(L"App\\Images\\Group03", &index));
+
+    // Non-ASCII characters never match an ASCII name
+    VERIFY(!pList->TryGetFileIndex(L"App\\Images\\Group02\\image\u00e90011.png", &index));
+    VERIFY(!pList->TryGetFileIndex(L"App\\Images\\Group02\\image\u00c90011.png", &index));
+
+    // Folder names only match whole path segments
+    int cchUsed = 0;
+    VERIFY(pList->TryGetPrefixFolderIndex(L"App\\ImagesX\\Group01\\image00004.png", &index, &cchUsed));
+    VERIFY_ARE_EQUAL(0, index);
+    VERIFY_ARE_EQUAL(4, cchUsed);
+    VERIFY(!pList->TryGetPrefixFolderIndex(L"Ap\\Images\\", &index, &cchUsed));
+    VERIFY(!pList->TryGetPrefixFolderIndex(L"App", &index, &cchUsed));
+
+    VERIFY(!pList->TryGetFileIndex(nullptr, &index));
+    VERIFY(!pList->TryGetFolderIndex(nullptr, &index));
+
+    delete pList;
+}
+
+void FileListUnitTests::LargePathLookupTests()
+{
+    BuildHelper built;
+    BuildFileList(NumLargeListFolders, NumLargeListFilesPerFolder, &built);
+
+    FileFileList* pList;
+    VERIFY_SUCCEEDED(FileFileList::CreateInstance(built.GetBuffer(), built.GetBufferSize(), &pList));
+
+    const int numFiles = pList->GetTotalNumFiles();
+    VERIFY_ARE_EQUAL(NumLargeListFolders * NumLargeListFilesPerFolder, numFiles);
+
+    CheckPathRoundTrip(pList);
+
+    // Compare against a reverse lookup done by walking the file list, which is what
+    // callers had to do before TryGetFileIndex was backed by a hash.
+    static const int NumLinearLookups = 256;
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER start;
+    LARGE_INTEGER end;
+    StringResult path;
+    StringResult candidate;
+    String tmp;
+
+    QueryPerformanceFrequency(&frequency);
+
+    QueryPerformanceCounter(&start);
+    for (int i = 0; i < NumLinearLookups; i++)
+    {
+        int wantIndex = 1 + ((i * 7919) % numFiles);
+        VERIFY_SUCCEEDED(pList->GetFilePath(wantIndex, &path));
+
+        int foundIndex = -1;
+        for (int fileIndex = 1; fileIndex <= numFiles; fileIndex++)
+        {
+            VERIFY_SUCCEEDED(pList->GetFilePath(fileIndex, &candidate));
+            if (DefString_ICompare(candidate.GetRef(), path.GetRef()) == Def_Equal)
+            {
+                foundIndex = fileIndex;
+                break;
+            }
+        }
+        VERIFY_ARE_EQUAL(wantIndex, foundIndex);
+    }
+    QueryPerformanceCounter(&end);
+    double linearMicroseconds = ((end.QuadPart - start.QuadPart) * 1000000.0) / (frequency.QuadPart * NumLinearLookups);
+
+    QueryPerformanceCounter(&start);
+    for (int i = 0; i < numFiles; i++)
+    {
+        int wantIndex = 1 + ((i * 7919) % numFiles);
+        VERIFY_SUCCEEDED(pList->GetFilePath(wantIndex, &path));
+
+        int foundIndex = -1;
+        VERIFY(pList->TryGetFileIndex(path.GetRef(), &foundIndex));
+        VERIFY_ARE_EQUAL(wantIndex, foundIndex);
+    }
+    QueryPerformanceCounter(&end);
+    double hashedMicroseconds = ((end.QuadPart - start.QuadPart) * 1000000.0) / (frequency.QuadPart * numFiles);
+
+    Log::Comment(tmp.Format(
+        L"[ %d files: linear lookup %.2f us, hashed lookup %.2f us (including GetFilePath) ]", numFiles, linearMicroseconds, hashedMicroseconds));
+
+    delete pList;
+}
+
+} // namespace UnitTests
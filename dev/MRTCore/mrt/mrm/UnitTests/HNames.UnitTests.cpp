@@ -506,6 +506,55 @@ void CheckItems(__in const IHierarchicalNames* pNames)
     }
 }
 
+void CheckItemFilter(__in const HierarchicalNames* pNames)
+{
+    StringResult name;
+    WCHAR variant[MAX_PATH];
+
+    // The filter must never reject a name that Contains would find, including
+    // differently-cased names and names relative to an enclosing scope.
+    for (int itemIndex = 0; itemIndex < pNames->GetNumItems(); itemIndex++)
+    {
+        VERIFY(pNames->TryGetItemInfo(itemIndex, &name));
+        VERIFY(pNames->MayContainItem(0, name.GetRef()));
+
+        VERIFY_HRESULT(StringCchPrintf(variant, ARRAYSIZE(variant), L"/%s", name.GetRef()));
+        VERIFY(pNames->MayContainItem(0, variant));
+
+        VERIFY_HRESULT(StringCchCopy(variant, ARRAYSIZE(variant), name.GetRef()));
+        for (PWSTR pCh = variant; *pCh != L'\0'; pCh++)
+        {
+            *pCh = ((*pCh == L'/') ? L'\\' : towupper(*pCh));
+        }
+        VERIFY(pNames->MayContainItem(0, variant));
+
+        for (int scopeIndex = 1; scopeIndex < pNames->GetNumScopes(); scopeIndex++)
+        {
+            StringResult relativeName;
+            int foundItemIndex = -1;
+            if (pNames->TryGetRelativeItemName(scopeIndex, itemIndex, &relativeName) &&
+                pNames->Contains(relativeName.GetRef(), scopeIndex, nullptr, &foundItemIndex) && (foundItemIndex == itemIndex))
+            {
+                VERIFY(pNames->MayContainItem(scopeIndex, relativeName.GetRef()));
+            }
+        }
+    }
+
+    // Anything the filter rejects must also be rejected by Contains.
+    TestDataArray<String> unexpectedSpecs;
+    if (SUCCEEDED(TestData::TryGetValue(L"UnexpectedContents", unexpectedSpecs)))
+    {
+        for (size_t i = 0; i < unexpectedSpecs.GetSize(); i++)
+        {
+            int itemIndex = -1;
+            if (!pNames->MayContainItem(0, (PCWSTR)unexpectedSpecs[i]))
+            {
+                VERIFY(!pNames->Contains((PCWSTR)unexpectedSpecs[i], nullptr, &itemIndex) || (itemIndex < 0));
+            }
+        }
+    }
+}
+
 void HierarchicalNamesUnitTests::New_ParamChecks(void)
 {
     BYTE buf[1000];
@@ -610,6 +659,7 @@ static void SimpleBuilderReaderTestsInternal(_In_ UINT32 flags, _In_ const DEFFI
     CheckScopes(pReader);
     CheckScopeChildren(pReader);
     CheckItems(pReader);
+    CheckItemFilter(pReader);
 
     delete pReader;
     delete pBuilder;
@@ -786,7 +836,29 @@ void HierarchicalNamesUnitTests::LargeBuilderReaderTests(void)
                 Log::Error(tmp.Format(L"[ Expected name '%s' for item %d, got '%s' ]", nameBuf, iItem, name.GetRef()));
                 return;
             }
+
+            VERIFY(pReader->MayContainItem(0, nameBuf));
+        }
+
+        Log::Comment(L"[ Check item filter rejects missing names ]");
+        int numFalsePositives = 0;
+        for (int iItem = 0; iItem < numItems; iItem++)
+        {
+            hr = StringCchPrintf(nameBuf, ARRAYSIZE(nameBuf), L"Missing/%d", iItem);
+            if (FAILED(hr))
+            {
+                Log::Error(tmp.Format(L"[ Couldn't create item name (0x%x) ]", hr));
+                return;
+            }
+
+            if (pReader->MayContainItem(0, nameBuf))
+            {
+                numFalsePositives++;
+            }
         }
+
+        Log::Comment(tmp.Format(L"[ %d of %d missing names passed the item filter ]", numFalsePositives, numItems));
+        VERIFY(numFalsePositives <= (numItems / 20) + 1);
     }
     else
     {
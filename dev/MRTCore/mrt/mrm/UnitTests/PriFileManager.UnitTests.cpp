@@ -43,6 +43,14 @@ public:
     BEGIN_TEST_METHOD(SingleFileSectionDemandLoadTests)
         TEST_METHOD_PROPERTY(L"DataSource", L"Table:PriFileManager.UnitTests.xml#SingleFileTypedSectionTests")
     END_TEST_METHOD();
+
+    BEGIN_TEST_METHOD(PrefetchTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:PriFileManager.UnitTests.xml#BasicSingleFileTests")
+    END_TEST_METHOD();
+
+    BEGIN_TEST_METHOD(ValidatedFileCacheTests)
+        TEST_METHOD_PROPERTY(L"DataSource", L"Table:PriFileManager.UnitTests.xml#BasicSingleFileTests")
+    END_TEST_METHOD();
 };
 
 bool ModuleSetup() { return true; }
@@ -297,6 +305,209 @@ void PriFileManagerUnitTests::BasicSingleFileTests()
     // MethodCleanup cleans up our data
 }
 
+void PriFileManagerUnitTests::PrefetchTests()
+{
+    TestHPri pri;
+    String tmp;
+
+    if (!SetupTestMethodOutputFolder(L"PrefetchTests"))
+    {
+        return;
+    }
+
+    AutoDeletePtr<CoreProfile> pProfile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&pProfile));
+
+    if (FAILED(pri.InitFromTestVars(L"", NULL, pProfile, NULL)) || FAILED(pri.Build()))
+    {
+        Log::Error(L"Error building test PRI");
+        return;
+    }
+
+    String firstPath;
+    String secondPath;
+    String bogusPath;
+    String missingPath;
+    if ((GetOutputLongFilePath(L"first.pri", firstPath) == NULL) || (GetOutputLongFilePath(L"second.pri", secondPath) == NULL) ||
+        (GetOutputLongFilePath(L"bogus.pri", bogusPath) == NULL) || (GetOutputLongFilePath(L"missing.pri", missingPath) == NULL))
+    {
+        Log::Error(L"Unable to get output file paths");
+        return;
+    }
+
+    VERIFY_SUCCEEDED(pri.WriteToFile((PCWSTR)firstPath));
+    VERIFY_IS_TRUE(CopyFileW((PCWSTR)firstPath, (PCWSTR)secondPath, FALSE));
+
+    HANDLE hFile = INVALID_HANDLE_VALUE;
+    if (!CreateOutputFile(L"bogus.pri", &hFile))
+    {
+        Log::Error(L"Unable to create bogus.pri");
+        return;
+    }
+    DWORD cbBogusData = 0;
+    UINT32 bogusData = 0xdeadbeef;
+    VERIFY_IS_TRUE(WriteFile(hFile, &bogusData, sizeof(bogusData), &cbBogusData, NULL));
+    CloseHandle(hFile);
+
+    AutoDeletePtr<AtomPoolGroup> pAtoms;
+    VERIFY_SUCCEEDED(AtomPoolGroup::CreateInstance(&pAtoms));
+    AutoDeletePtr<UnifiedEnvironment> pEnvironment;
+    VERIFY_SUCCEEDED(UnifiedEnvironment::CreateInstance(pProfile, pAtoms, &pEnvironment));
+    AutoDeletePtr<PriFileManager> pManager;
+    VERIFY_SUCCEEDED(PriFileManager::CreateInstance(pEnvironment, &pManager));
+
+    // A file the manager already has is left alone, even though it isn't loaded
+    ManagedFile* pSecond;
+    VERIFY_SUCCEEDED(pManager->GetOrAddFile((PCWSTR)secondPath, nullptr, LoadPriFlags::Default, &pSecond));
+    VERIFY(!pSecond->IsLoaded());
+
+    PCWSTR paths[] = {(PCWSTR)bogusPath, (PCWSTR)firstPath, (PCWSTR)missingPath, (PCWSTR)secondPath, (PCWSTR)firstPath};
+    VERIFY_SUCCEEDED(pManager->PrefetchFiles(ARRAYSIZE(paths), paths, nullptr, LoadPriFlags::Default));
+
+    // Only first.pri is new and loads, and it's added once
+    VERIFY_ARE_EQUAL(2, pManager->GetNumFiles());
+    VERIFY(!pSecond->IsLoaded());
+
+    ManagedFile* pFirst;
+    VERIFY_SUCCEEDED(pManager->GetFile((PCWSTR)firstPath, &pFirst));
+    VERIFY(pFirst->IsLoaded());
+    VERIFY_ARE_EQUAL(1, pFirst->GetGlobalIndex());
+
+    ManagedFile* pFile;
+    VERIFY_SUCCEEDED(pManager->GetOrAddFile((PCWSTR)firstPath, nullptr, LoadPriFlags::Preload, &pFile));
+    VERIFY(pFile == pFirst);
+    VERIFY_ARE_EQUAL(2, pManager->GetNumFiles());
+
+    // Files that failed to prefetch still fail the same way when they are added
+    HRESULT hr = pManager->GetOrAddFile((PCWSTR)bogusPath, nullptr, LoadPriFlags::Preload, &pFile);
+    VERIFY(pFile == NULL);
+    VERIFY_ARE_EQUAL(hr, HRESULT_FROM_WIN32(ERROR_MRM_INVALID_PRI_FILE));
+
+    hr = pManager->GetOrAddFile((PCWSTR)missingPath, nullptr, LoadPriFlags::Preload, &pFile);
+    VERIFY(pFile == NULL);
+    VERIFY_ARE_EQUAL(hr, HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
+
+    VERIFY_ARE_EQUAL(2, pManager->GetNumFiles());
+
+    // MethodCleanup() cleans up our data
+}
+
+void PriFileManagerUnitTests::ValidatedFileCacheTests()
+{
+    TestHPri pri;
+
+    if (!SetupTestMethodOutputFolder(L"ValidatedFileCacheTests"))
+    {
+        return;
+    }
+
+    AutoDeletePtr<CoreProfile> pProfile;
+    VERIFY_SUCCEEDED(CoreProfile::ChooseDefaultProfile(&pProfile));
+
+    if (FAILED(pri.InitFromTestVars(L"", NULL, pProfile, NULL)) || FAILED(pri.Build()))
+    {
+        Log::Error(L"Error building test PRI");
+        return;
+    }
+
+    String priFilePath;
+    String cachePath;
+    if ((GetOutputLongFilePath(L"test.pri", priFilePath) == NULL) || (GetOutputLongFilePath(L"validated.cache", cachePath) == NULL))
+    {
+        Log::Error(L"Unable to get output file paths");
+        return;
+    }
+    VERIFY_SUCCEEDED(pri.WriteToFile((PCWSTR)priFilePath));
+
+    // The first load is fully validated and noted, the second one is trusted
+    {
+        AutoDeletePtr<ValidatedFileCache> pCache;
+        VERIFY_SUCCEEDED(ValidatedFileCache::CreateInstance((PCWSTR)cachePath, &pCache));
+        VERIFY_ARE_EQUAL(0, pCache->GetNumEntries());
+
+        AutoDeletePtr<BaseFile> pFile;
+        VERIFY_SUCCEEDED(BaseFile::CreateInstance(BaseFile::MapFileFlag, (PCWSTR)priFilePath, pCache, &pFile));
+        VERIFY(!pFile->IsTrustedLayout());
+        VERIFY_ARE_EQUAL(1, pCache->GetNumEntries());
+
+        AutoDeletePtr<BaseFile> pTrustedFile;
+        VERIFY_SUCCEEDED(BaseFile::CreateInstance(BaseFile::MapFileFlag, (PCWSTR)priFilePath, pCache, &pTrustedFile));
+        VERIFY(pTrustedFile->IsTrustedLayout());
+        VERIFY_ARE_EQUAL(1, pCache->GetNumEntries());
+
+        // Files opened without a cache are always fully validated
+        AutoDeletePtr<BaseFile> pUncachedFile;
+        VERIFY_SUCCEEDED(BaseFile::CreateInstance(BaseFile::MapFileFlag, (PCWSTR)priFilePath, &pUncachedFile));
+        VERIFY(!pUncachedFile->IsTrustedLayout());
+
+        VERIFY_SUCCEEDED(pCache->Save());
+    }
+
+    // The profile opts a manager in, and a new cache picks up the saved entry
+    VERIFY_SUCCEEDED(pProfile->SetValidatedFileCachePath((PCWSTR)cachePath));
+    {
+        AutoDeletePtr<AtomPoolGroup> pAtoms;
+        VERIFY_SUCCEEDED(AtomPoolGroup::CreateInstance(&pAtoms));
+        AutoDeletePtr<UnifiedEnvironment> pEnvironment;
+        VERIFY_SUCCEEDED(UnifiedEnvironment::CreateInstance(pProfile, pAtoms, &pEnvironment));
+        AutoDeletePtr<PriFileManager> pManager;
+        VERIFY_SUCCEEDED(PriFileManager::CreateInstance(pEnvironment, &pManager));
+        VERIFY(pManager->GetValidatedFileCache() != NULL);
+        VERIFY_ARE_EQUAL(1, pManager->GetValidatedFileCache()->GetNumEntries());
+
+        ManagedFile* pFile;
+        VERIFY_SUCCEEDED(pManager->GetOrAddFile((PCWSTR)priFilePath, nullptr, LoadPriFlags::Preload, &pFile));
+
+        const BaseFile* pBaseFile;
+        VERIFY_SUCCEEDED(pFile->GetBaseFile(&pBaseFile));
+        VERIFY(pBaseFile->IsTrustedLayout());
+    }
+
+    // Changing the file's timestamp invalidates its entry
+    {
+        wil::unique_handle hFile(CreateFileW((PCWSTR)priFilePath, FILE_WRITE_ATTRIBUTES, 0, NULL, OPEN_EXISTING, 0, NULL));
+        VERIFY_IS_TRUE(hFile.get() != INVALID_HANDLE_VALUE);
+
+        FILETIME lastWriteTime;
+        VERIFY_IS_TRUE(GetFileTime(hFile.get(), NULL, NULL, &lastWriteTime));
+        lastWriteTime.dwLowDateTime += 10000000;
+        if (lastWriteTime.dwLowDateTime < 10000000)
+        {
+            lastWriteTime.dwHighDateTime++;
+        }
+        VERIFY_IS_TRUE(SetFileTime(hFile.get(), NULL, NULL, &lastWriteTime));
+    }
+    {
+        AutoDeletePtr<ValidatedFileCache> pCache;
+        VERIFY_SUCCEEDED(ValidatedFileCache::CreateInstance((PCWSTR)cachePath, &pCache));
+
+        AutoDeletePtr<BaseFile> pFile;
+        VERIFY_SUCCEEDED(BaseFile::CreateInstance(BaseFile::MapFileFlag, (PCWSTR)priFilePath, pCache, &pFile));
+        VERIFY(!pFile->IsTrustedLayout());
+        VERIFY_ARE_EQUAL(1, pCache->GetNumEntries());
+    }
+
+    // A damaged cache file is ignored
+    String damagedCachePath;
+    HANDLE hFile = INVALID_HANDLE_VALUE;
+    if ((GetOutputLongFilePath(L"damaged.cache", damagedCachePath) == NULL) || !CreateOutputFile(L"damaged.cache", &hFile))
+    {
+        Log::Error(L"Unable to create damaged.cache");
+        return;
+    }
+    DWORD cbWritten = 0;
+    UINT32 bogusData[] = {0x4356524d, 1, 12, 0xdeadbeef};
+    VERIFY_IS_TRUE(WriteFile(hFile, bogusData, sizeof(bogusData), &cbWritten, NULL));
+    CloseHandle(hFile);
+    {
+        AutoDeletePtr<ValidatedFileCache> pCache;
+        VERIFY_SUCCEEDED(ValidatedFileCache::CreateInstance((PCWSTR)damagedCachePath, &pCache));
+        VERIFY_ARE_EQUAL(0, pCache->GetNumEntries());
+    }
+
+    // MethodCleanup() cleans up our data
+}
+
 void PriFileManagerUnitTests::BasicMultiFileTests()
 {
     String tmp;
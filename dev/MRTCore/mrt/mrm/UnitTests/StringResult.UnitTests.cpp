@@ -453,6 +453,7 @@ class StringResult_Buffer : public WEX::TestClass<StringResult_Buffer>, public S
     TEST_METHOD(Compare);
     TEST_METHOD(Concat);
     TEST_METHOD(Copy);
+    TEST_METHOD(InlineStorage);
 };
 
 void StringResult_Buffer::New(void)
@@ -716,4 +717,58 @@ void StringResult_Buffer::Copy(void)
     delete pCopy;
 }
 
+void StringResult_Buffer::InlineStorage(void)
+{
+    _DefEnableStatistics(TRUE);
+    UINT64 allocations = StringResult::GetBufferAllocationCount();
+
+    StringResult result;
+    VERIFY_SUCCEEDED(result.Init(shortStr, DefResultType_Buffer));
+    CHECK_STRINGRESULT_BUF(&result, shortStr);
+    PCWSTR pInline = result.GetRef();
+
+    // Short strings, and growing them, reuse the inline buffer.
+    VERIFY_SUCCEEDED(result.SetCopy(medStr));
+    CHECK_STRINGRESULT_BUF(&result, medStr);
+    VERIFY_SUCCEEDED(result.Concat(concatStr));
+    CHECK_STRINGRESULT_BUF(&result, endStr);
+    VERIFY(result.GetRef() == pInline);
+
+    StringResult copy;
+    VERIFY_SUCCEEDED(result.GetCopy(&copy));
+    CHECK_STRINGRESULT_BUF(&copy, endStr);
+    VERIFY_ARE_EQUAL(allocations, StringResult::GetBufferAllocationCount());
+
+    // Strings that don't fit go to the heap, and come back inline when they fit again.
+    WCHAR longBuf[200];
+    for (size_t i = 0; i < ARRAYSIZE(longBuf) - 1; i++)
+    {
+        longBuf[i] = L'a' + (i % 26);
+    }
+    longBuf[ARRAYSIZE(longBuf) - 1] = L'\0';
+
+    VERIFY_SUCCEEDED(result.SetCopy(longBuf));
+    CHECK_STRINGRESULT_BUF(&result, longBuf);
+    VERIFY(result.GetRef() != pInline);
+    VERIFY_ARE_EQUAL(allocations + 1, StringResult::GetBufferAllocationCount());
+
+    StringResult other;
+    VERIFY_SUCCEEDED(other.Init(shortStr, DefResultType_Buffer));
+    VERIFY_SUCCEEDED(other.SetContentsFromOther(&copy));
+    CHECK_STRINGRESULT_BUF(&other, endStr);
+    CHECK_STRINGRESULT_EMPTY(&copy);
+    VERIFY_ARE_EQUAL(allocations + 1, StringResult::GetBufferAllocationCount());
+
+    // Released contents must outlive the result, so inline contents are copied out.
+    PWSTR pReleased = nullptr;
+    size_t cchReleased = 0;
+    VERIFY_SUCCEEDED(other.ReleaseContents(&pReleased, &cchReleased));
+    CHECK_BUFFER(pReleased, cchReleased, endStr);
+    VERIFY(pReleased != other.GetStringResult()->pInline);
+    CHECK_STRINGRESULT_COMPLETELY_EMPTY(&other);
+    VERIFY_ARE_EQUAL(allocations + 2, StringResult::GetBufferAllocationCount());
+    Def_Free(pReleased);
+    _DefEnableStatistics(FALSE);
+}
+
 } // namespace UnitTests
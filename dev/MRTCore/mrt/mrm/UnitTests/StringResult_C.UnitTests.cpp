@@ -624,6 +624,7 @@ public:
     TEST_METHOD(Compare);
     TEST_METHOD(Concat);
     TEST_METHOD(Copy);
+    TEST_METHOD(SwapInline);
 };
 
 bool DefStringResultTests_Buffer::Setup(void) { return SetupBase(DefResultType_Buffer); }
@@ -1012,4 +1013,41 @@ void DefStringResultTests_Buffer::Copy()
     VERIFY_SUCCEEDED(DefStringResult_Clear(&copy2, true));
 }
 
+void DefStringResultTests_Buffer::SwapInline()
+{
+    WCHAR storage[16];
+    WCHAR otherStorage[16];
+    DEFSTRINGRESULT inlined, otherInlined;
+    VERIFY_SUCCEEDED(DefStringResult_InitWithStorage(&inlined, storage, ARRAYSIZE(storage)));
+    VERIFY_SUCCEEDED(DefStringResult_InitWithStorage(&otherInlined, otherStorage, ARRAYSIZE(otherStorage)));
+
+    VERIFY_SUCCEEDED(DefStringResult_SetCopy(&inlined, shortStr));
+    VERIFY(inlined.pBuf == storage);
+
+    // Inline contents are copied out, and the storage stays with its owner.
+    VERIFY_SUCCEEDED(_DefStringResult_Swap(&inlined, pSelf));
+    CHECK_STRINGRESULT_BUF(&inlined, medStr);
+    CHECK_STRINGRESULT_BUF(pSelf, shortStr);
+    VERIFY(pSelf->pBuf != storage);
+    VERIFY(inlined.pInline == storage);
+
+    // Both sides inline.
+    VERIFY_SUCCEEDED(DefStringResult_SetCopy(&inlined, shortStr));
+    VERIFY_SUCCEEDED(DefStringResult_SetCopy(&otherInlined, medStr));
+    VERIFY_SUCCEEDED(_DefStringResult_Swap(&inlined, &otherInlined));
+    CHECK_STRINGRESULT_BUF(&inlined, medStr);
+    CHECK_STRINGRESULT_BUF(&otherInlined, shortStr);
+    VERIFY(inlined.pBuf != otherStorage);
+    VERIFY(otherInlined.pBuf != storage);
+
+    // References to foreign strings are exchanged as they are.
+    VERIFY_SUCCEEDED(DefStringResult_SetRef(&otherInlined, longStr));
+    VERIFY_SUCCEEDED(_DefStringResult_Swap(&inlined, &otherInlined));
+    CHECK_STRINGRESULT_REF(&inlined, longStr);
+    CHECK_STRINGRESULT_BUF(&otherInlined, medStr);
+
+    VERIFY_SUCCEEDED(DefStringResult_Clear(&inlined, true));
+    VERIFY_SUCCEEDED(DefStringResult_Clear(&otherInlined, true));
+}
+
 }; // namespace UnitTests
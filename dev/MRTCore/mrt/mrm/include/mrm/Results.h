@@ -11,8 +11,12 @@ namespace Microsoft::Resources
 class StringResult : public DefObject
 {
 protected:
+    //! Strings of up to this many characters (including the terminator) are stored inline
+    static const size_t InlineBufferSizeInChars = 64;
+
     DEFSTRINGRESULT* m_pString;
     DEFSTRINGRESULT m_string;
+    WCHAR m_inlineBuffer[InlineBufferSizeInChars];
 
 public:
     HRESULT Init(_In_opt_ PCWSTR initialString, _In_ DEFRESULTTYPE type);
@@ -142,6 +146,9 @@ public:
     HRESULT Contains(_In_ PCWSTR str, _Out_ bool* result) const;
 
     bool Contains(_In_ PCWSTR str) const;
+
+    //! Returns the number of heap buffers allocated by string results in this process, for diagnostics.
+    static UINT64 GetBufferAllocationCount();
 };
 
 class BlobResult : public DefObject
@@ -191,6 +198,9 @@ public:
         _Out_writes_bytes_to_opt_(bufferSizeInBytes, *numBytesWritten) void* buffer,
         _Out_opt_ size_t* numBytesWritten);
 
+    //! Returns the number of heap buffers allocated by blob results in this process, for diagnostics.
+    static UINT64 GetBufferAllocationCount();
+
 private: //disabling copy constructor and assignment operator
     BlobResult(const BlobResult&);
     BlobResult& operator=(BlobResult&);
@@ -314,6 +314,9 @@ extern "C"
         UINT32 cchBuf; //!< The allocated size of the buffer
         PCWSTR pRef; /*!< The current pStr value of the string, which might
                                or might no be resident in buf. */
+        __ecount(cchInline) PWSTR pInline; /*!< Optional caller-owned storage used in place of a heap
+                               buffer for short strings.  Never freed by ::DEFSTRINGRESULT. */
+        UINT32 cchInline; //!< The size of the inline storage
     } DEFSTRINGRESULT;
 
     typedef DEFSTRINGRESULT* PDEFSTRINGRESULT;
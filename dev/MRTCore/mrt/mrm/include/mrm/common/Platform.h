@@ -79,6 +79,15 @@ extern "C"
         _In_ wchar_t listDelimiter,
         _Out_ double* closestDistance);
 
+    //! Returns how many times _DefGetDistanceOfClosestLanguageInList has been called in this process.
+    UINT64 _DefGetLanguageDistanceCallCount();
+
+    //! Turns the diagnostic counters (resolver statistics, language distance calls, buffer allocations) on or off for
+    //! this process. They are off by default so that resolution doesn't pay for interlocked updates nobody reads.
+    void _DefEnableStatistics(_In_ BOOLEAN enable);
+
+    BOOLEAN _DefAreStatisticsEnabled();
+
 #ifdef __cplusplus
 }
 #endif
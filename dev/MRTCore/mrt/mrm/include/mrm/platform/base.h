@@ -227,6 +227,26 @@ public:
     // Determines if a profile is allowed to load PRI files that might be unsafe. Default is true.
     virtual bool IsUnsafeLoadPriFileAllowed() const;
 
+    /*!
+     * Gets the path of the cache file used to remember PRI files that have already
+     * passed full validation, so that later loads can skip part of it.
+     *
+     * \param pCachePathOut
+     * Returns the path of the validated file cache, if one is set.
+     *
+     * \return bool
+     * Returns true if a cache path is set, false otherwise.
+     *
+     * \remarks
+     * The base implementation returns the path set by SetValidatedFileCachePath, and
+     * by default no path is set and every file is fully validated.
+     */
+    virtual bool TryGetValidatedFileCachePath(_Inout_ StringResult* pCachePathOut) const;
+
+    // Opts this profile in to the validated file cache.  Must be called before a
+    // PriFileManager is created for the profile.  Pass nullptr to opt out.
+    HRESULT SetValidatedFileCachePath(_In_opt_ PCWSTR pCachePath);
+
     // Determines if a supplied file magic number is supported
     // Default implementation supports only universal PRI files
     virtual bool IsSupportedFileMagicNumber(_In_ const DEFFILE_MAGIC& fileMagicNumber) const;
@@ -582,6 +602,7 @@ protected:
     const ENVIRONMENT_INITIALIZER* m_initializer;
     int m_defaultEnvironmentIndex;
     mutable StringResult m_cachedWindowsFolderName;
+    StringResult m_validatedFileCachePath;
 };
 
 /*! 
@@ -21,6 +21,7 @@ using unique_deffree_ptr = wistd::unique_ptr<T, deffree_deleter>;
 
 class BaseFile;
 class FileSectionResult;
+class ValidatedFileCache;
 
 /*!
      * Interface definition for section readers.  Each UID file section reader 
@@ -62,6 +63,7 @@ protected:
 
     // Internal values for "m_flags"
     static const UINT32 BaseFileOwnsDataFlag = 0x010000;
+    static const UINT32 TrustedLayoutFlag = 0x020000;
 
 public:
     typedef DEFFILE_SECTION_INDEX SectionIndex;
@@ -88,6 +90,17 @@ public:
 
     static HRESULT CreateInstance(__in UINT32 flags, __in PCWSTR pFileName, _Outptr_ BaseFile** newFile);
 
+    /*!
+         * Opens a file, skipping the section marker checks if pValidatedFiles shows that
+         * this exact file has already passed full validation.  Files that don't match are
+         * fully validated and, if valid, noted in pValidatedFiles.
+         */
+    static HRESULT CreateInstance(
+        __in UINT32 flags,
+        __in PCWSTR pFileName,
+        __in_opt ValidatedFileCache* pValidatedFiles,
+        _Outptr_ BaseFile** newFile);
+
     static HRESULT CreateInstance(
         __in UINT32 flags,
         __in_bcount(cbData) const BYTE* pData,
@@ -98,6 +111,8 @@ public:
 
     const DEFFILE_HEADER* GetFileHeader() const { return m_pHeader; }
 
+    bool IsTrustedLayout() const { return ((m_flags & TrustedLayoutFlag) != 0); }
+
     size_t GetFileSizeInBytes() const { return m_pHeader->cbTotal; }
 
     bool SectionIsPresent(__inout SectionIndex index) { return (index >= 0) && (index < m_pHeader->sizeToc); }
@@ -253,15 +268,77 @@ public:
 protected:
     BaseFile() : m_flags(0), m_pHeader(NULL), m_pToc(NULL), m_ppSections(NULL) {}
 
-    HRESULT Init(__in UINT32 flags, __in PCWSTR pFileName);
+    HRESULT Init(__in UINT32 flags, __in PCWSTR pFileName, __in_opt ValidatedFileCache* pValidatedFiles = nullptr);
 
     HRESULT Init(__in UINT32 flags, __in_bcount(cbData) const BYTE* pData, __in size_t cbData);
 
-    HRESULT InitFromData(__in_bcount(cbData) const void* pData, __in size_t cbData);
+    HRESULT InitFromData(__in_bcount(cbData) const void* pData, __in size_t cbData, __in bool trustedLayout = false);
 
     HRESULT UnmapFileData();
 
     static HRESULT ValidateTocEntryAgainstSectionData(__in const DEFFILE_TOC_ENTRY* pToc, __in const DEFFILE_SECTION_HEADER* pHeader);
+
+    static HRESULT ValidateStructure(__in_bcount(cbData) const void* pData, __in size_t cbData, __in bool validateTrailer);
+};
+
+/*!
+     * Remembers files that have passed full structural validation, keyed by path, size,
+     * last write time and a checksum of the file header and TOC.  Entries are read from
+     * and written to a small cache file.
+     *
+     * A file that matches an entry still gets every bounds check, but skips the file
+     * and section trailer checks, which page in the end of the file and of each section.
+     * The cache file must be somewhere only the application can write.
+     */
+class ValidatedFileCache : public DefObject
+{
+public:
+    static const int MaxEntries = 256;
+
+    static HRESULT CreateInstance(__in PCWSTR pCacheFilePath, _Outptr_ ValidatedFileCache** result);
+
+    virtual ~ValidatedFileCache();
+
+    int GetNumEntries() const { return m_numEntries; }
+
+    bool IsValidated(__in PCWSTR pFilePath, __in_bcount(cbData) const void* pData, __in size_t cbData) const;
+
+    HRESULT NoteValidated(__in PCWSTR pFilePath, __in_bcount(cbData) const void* pData, __in size_t cbData);
+
+    /*!
+         * Writes the cache file if any entries were added since it was loaded or last saved.
+         */
+    HRESULT Save();
+
+protected:
+    struct Entry
+    {
+        UINT64 cbFile;
+        UINT64 lastWriteTime;
+        UINT32 layoutChecksum;
+        UINT32 pathChecksum;
+        PWSTR pPath;
+    };
+
+    ValidatedFileCache() : m_pCacheFilePath(nullptr), m_pEntries(nullptr), m_numEntries(0), m_nextReplace(0), m_isDirty(false)
+    {
+        InitializeSRWLock(&m_lock);
+    }
+
+    HRESULT Init(__in PCWSTR pCacheFilePath);
+
+    HRESULT Load();
+
+    HRESULT AddEntry(__in const Entry* pKey, __in PCWSTR pFilePath);
+
+    static HRESULT ComputeKey(__in PCWSTR pFilePath, __in_bcount(cbData) const void* pData, __in size_t cbData, _Out_ Entry* pKeyOut);
+
+    PWSTR m_pCacheFilePath;
+    Entry* m_pEntries;
+    int m_numEntries;
+    int m_nextReplace;
+    bool m_isDirty;
+    mutable SRWLOCK m_lock;
 };
 
 class FileSectionBase : public IFileSection
@@ -331,6 +331,8 @@ protected:
     }
 };
 
+class FileListPathIndex;
+
 //! Represents a read-only file list, typically mapped in from a file.
 class FileFileList : public FileSectionBase, public IFileList
 {
@@ -348,6 +350,9 @@ private:
     // root folder.
     DEFFILE_FILELIST_FOLDER_ENTRY m_root;
 
+    // Hash of every absolute file and folder path, built on first lookup.
+    mutable FileListPathIndex* volatile m_pPathIndex;
+
 public:
     /*!
          * Creates and initializes a \ref FileFileList from a supplied read-only data blob.
@@ -386,7 +391,7 @@ public:
     /*! 
          * Delete a \ref FileFileList.
          */
-    virtual ~FileFileList() {}
+    virtual ~FileFileList();
 
     /*!
          * \name IFileList Implementation
@@ -432,6 +437,13 @@ public:
     //! \see IFileList::GetFolderPath
     HRESULT GetFolderPath(__in int folderIndex, __inout StringResult* pPathOut) const;
 
+    //! \see IFileList::TryGetFileIndex
+    //! The returned index is the one accepted by \ref GetFilePath.
+    bool TryGetFileIndex(__in PCWSTR pPath, __out int* pIndexOut) const;
+
+    //! \see IFileList::TryGetFolderIndex
+    bool TryGetFolderIndex(__in PCWSTR pPath, __out int* pIndexOut) const;
+
     /*!@}*/
 
     //! Gets the typeid for a file list section.
@@ -444,6 +456,18 @@ protected:
 
     static HRESULT Validate(__in_bcount(cbData) const void* pData, __in size_t cbData);
 
+    const FileListPathIndex* GetPathIndex() const;
+
+    HRESULT BuildPathIndex(_Outptr_ FileListPathIndex** result) const;
+
+    HRESULT HashNameSegment(_In_ UINT32 hash, _In_ int firstCharOffset, _In_ int cchName, _Out_ UINT32* pHashOut) const;
+
+    bool PathMatches(_In_reads_(cchPath) PCWSTR pPath, _In_ int cchPath, _In_ int firstCharOffset, _In_ int cchName, _In_ int parentFolderIndex) const;
+
+    bool FilePathMatches(_In_reads_(cchPath) PCWSTR pPath, _In_ int cchPath, _In_ int fileIndex) const;
+
+    bool FolderPathMatches(_In_reads_(cchPath) PCWSTR pPath, _In_ int cchPath, _In_ int folderIndex) const;
+
     HRESULT CopyNameSegment(_In_ UINT32 flags, _In_ int firstCharOffset, _In_ int cchName, _Out_writes_(cchName) WCHAR* pNameOut) const
     {
         if ((flags & DEFFILE_HNAMES_FLAGS_NAME_IS_ASCII) != 0)
@@ -52,6 +52,8 @@ protected:
     HierarchicalNamesConfig() {}
 };
 
+class HierarchicalItemNameFilter;
+
 class IHierarchicalNames : protected DefObject
 {
 public:
@@ -168,6 +170,11 @@ public:
 
     _Success_(return ) bool TryGetItemInfo(__in int itemIndex, __inout StringResult* pNameOut) const;
 
+    // Quick negative check for item lookups, backed by a bloom filter of item names that is
+    // built on first use.  Returns false only if no item matches pPath relative to the
+    // specified scope; a true result still has to be confirmed with Contains.
+    bool MayContainItem(__in int relativeToScope, __in PCWSTR pPath) const;
+
     _Success_(return ) bool TryGetItemLocalName(__in int itemIndex, __inout StringResult* pNameOut) const;
 
     static const DEFFILE_SECTION_TYPEID GetSectionTypeId();
@@ -207,6 +214,8 @@ private:
     IAtomPool* m_pScopeNames;
     IAtomPool* m_pItemNames;
 
+    mutable HierarchicalItemNameFilter* volatile m_pItemFilter;
+
     HierarchicalNames();
 
     HRESULT Init(
@@ -448,6 +448,15 @@ public:
 
     HRESULT AddFile(_In_ PCWSTR pPath, _In_opt_ PCWSTR pPackageRoot, _In_ bool fPreload, _Out_ ManagedFile** result);
 
+    // Loads any of the listed files that aren't already known to the manager, mapping and
+    // validating them in parallel, and adds the ones that load successfully.  Files that fail
+    // to load are not added, so a later GetOrAddFile reports the failure as usual.
+    HRESULT PrefetchFiles(
+        _In_ int numFiles,
+        _In_reads_(numFiles) const PCWSTR* ppPaths,
+        _In_opt_ PCWSTR pPackageRoot,
+        _In_ LoadPriFlags flags) const;
+
     HRESULT
     AddFile(_In_ const NormalizedFilePath* pNormalizedPath, _In_opt_ PCWSTR pPackageRoot, _In_ bool fPreload, _Out_ ManagedFile** result);
 
@@ -463,6 +472,10 @@ public:
 
     HRESULT SetDefaultFileFlags(_In_ UINT32 flags);
 
+    // Returns the validated file cache used when loading files, or nullptr if the
+    // profile hasn't opted in to it.
+    ValidatedFileCache* GetValidatedFileCache() const { return m_pValidatedFiles; }
+
     /*
          * IFileSectionResolver methods
          */
@@ -539,10 +552,11 @@ private:
     UINT32 m_defaultFileFlags;
     mutable DynamicArray<FileManagerFileInfo>* m_pFiles;
     mutable MrmFileResolver* m_pFileResolver;
+    ValidatedFileCache* m_pValidatedFiles;
 
     UnifiedEnvironment* m_pEnvironment;
 
-    PriFileManager() : m_pFiles(nullptr), m_pFileResolver(nullptr), m_pEnvironment(nullptr) {}
+    PriFileManager() : m_pFiles(nullptr), m_pFileResolver(nullptr), m_pValidatedFiles(nullptr), m_pEnvironment(nullptr) {}
 
     HRESULT Init(_In_ UnifiedEnvironment* pEnvironment);
 };
@@ -994,11 +1008,39 @@ public:
     virtual HRESULT GetQualifierProvider(_In_ PCWSTR qualifierName, _Out_ const IQualifierValueProvider** provider) const = 0;
 };
 
+/*!
+ * Cumulative counters describing the work done by a resolver and how effective its caches are.
+ * Cache misses are the difference between lookups and hits. Lock wait time is in QueryPerformanceCounter ticks.
+ */
+typedef struct _RESOLVER_STATISTICS
+{
+    UINT64 qualifierLookups;
+    UINT64 qualifierCacheHits;
+    UINT64 qualifierSetLookups;
+    UINT64 qualifierSetCacheHits;
+    UINT64 decisionLookups;
+    UINT64 decisionCacheHits;
+    UINT64 decisionEvaluations;
+    UINT64 cacheResets;
+    UINT64 lockWaitTicks;
+    UINT64 stringCopies;
+    UINT64 blobCopies;
+    UINT64 bytesCopied;
+} RESOLVER_STATISTICS;
+
 class ResolverBase : public IResolver
 {
 public:
     virtual ~ResolverBase();
 
+    void GetStatistics(_Out_ RESOLVER_STATISTICS* statistics) const;
+
+    void ResetStatistics();
+
+    //! Records a copy made on behalf of a caller of this resolver, e.g. when a result is handed out across the API boundary.
+    void NoteStringCopy(_In_ size_t bytesCopied) const;
+    void NoteBlobCopy(_In_ size_t bytesCopied) const;
+
     const UnifiedEnvironment* GetEnvironment() const { return m_pEnvironment; }
     const IDecisionInfo* GetDecisions() const { return m_pDecisions; }
 
@@ -1047,6 +1089,7 @@ protected:
     UINT64 m_generation;
 
     mutable DecisionInfoCache* m_pCache;
+    mutable RESOLVER_STATISTICS m_statistics;
     mutable SRWLOCK m_srwLock;
     mutable SRWLOCK m_srwQualifierSetLock;
     mutable SRWLOCK m_srwQualifierLock;
@@ -224,6 +224,10 @@ public:
         _Out_opt_ int* pScopeIndexOut = NULL,
         _Out_opt_ int* pItemIndexOut = NULL) const = 0;
 
+    // Returns false if no item matches path relative to the specified scope, without doing a
+    // full lookup.  Schemas that can't answer cheaply say every item might be present.
+    virtual bool MayContainItem(_In_ int /* relativeToScope */, _In_ PCWSTR /* path */) const { return true; }
+
     virtual bool TryGetScopeInfo(_In_ int scopeIndex, _Inout_ StringResult* pNameOut, _Out_opt_ int* pNumChildrenOut = NULL) const = 0;
 
     virtual bool TryGetScopeChild(
@@ -404,6 +408,8 @@ public:
         return m_pNames->Contains(path, relativeToScope, pScopeIndexOut, pItemIndexOut, pNameIndexOut);
     }
 
+    bool MayContainItem(_In_ int relativeToScope, _In_ PCWSTR path) const { return m_pNames->MayContainItem(relativeToScope, path); }
+
     int GetNumScopes() const { return m_pNames->GetNumScopes(); }
     IAtomPool* GetScopeNames() const { return m_pNames->GetScopeNames(); }
 
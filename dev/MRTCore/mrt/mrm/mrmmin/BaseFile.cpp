@@ -73,13 +73,13 @@ HRESULT BaseFile::GetFileSection(__in BaseFile::SectionIndex sectionIndex, __out
     return S_OK;
 }
 
-HRESULT BaseFile::InitFromData(__in_bcount(cbData) const void* pData, __in size_t cbData)
+HRESULT BaseFile::InitFromData(__in_bcount(cbData) const void* pData, __in size_t cbData, __in bool trustedLayout)
 {
     DEFFILE_HEADER* pHeader = (DEFFILE_HEADER*)pData;
     int i;
     BYTE* pSectionData;
 
-    RETURN_IF_FAILED(ValidateStructure(pData, cbData));
+    RETURN_IF_FAILED(ValidateStructure(pData, cbData, !trustedLayout));
 
     m_pHeader = pHeader;
     m_pToc = GetToc(pHeader);
@@ -168,13 +168,22 @@ HRESULT BaseFile::UnmapFileData()
 HRESULT BaseFile::CreateInstance(__in PCWSTR pFileName, _Outptr_ BaseFile** newFile) { return CreateInstance(0, pFileName, newFile); }
 
 HRESULT BaseFile::CreateInstance(__in UINT32 flags, __in PCWSTR pFileName, _Outptr_ BaseFile** newFile)
+{
+    return CreateInstance(flags, pFileName, nullptr, newFile);
+}
+
+HRESULT BaseFile::CreateInstance(
+    __in UINT32 flags,
+    __in PCWSTR pFileName,
+    __in_opt ValidatedFileCache* pValidatedFiles,
+    _Outptr_ BaseFile** newFile)
 {
     *newFile = nullptr;
 
     AutoDeletePtr<BaseFile> pRtrn = new BaseFile();
     RETURN_IF_NULL_ALLOC(pRtrn);
 
-    RETURN_IF_FAILED(pRtrn->Init(flags, pFileName));
+    RETURN_IF_FAILED(pRtrn->Init(flags, pFileName, pValidatedFiles));
 
     *newFile = pRtrn.Detach();
     return S_OK;
@@ -193,7 +202,7 @@ HRESULT BaseFile::CreateInstance(__in UINT32 flags, __in_bcount(cbData) const BY
     return S_OK;
 }
 
-HRESULT BaseFile::Init(__in UINT32 flags, __in PCWSTR pFileName)
+HRESULT BaseFile::Init(__in UINT32 flags, __in PCWSTR pFileName, __in_opt ValidatedFileCache* pValidatedFiles)
 {
     DEF_ASSERT((pFileName != NULL) && (pFileName[0] != L'\0'));
 
@@ -219,10 +228,18 @@ HRESULT BaseFile::Init(__in UINT32 flags, __in PCWSTR pFileName)
     HRESULT hr = (isMapped ? MapFileData(pFileName, &cbData, &data.pcData) : LoadFileData(pFileName, &cbData, &data.pData));
     RETURN_IF_FAILED(hr);
 
-    hr = InitFromData(data.pcData, cbData);
+    bool trustedLayout = ((pValidatedFiles != nullptr) && pValidatedFiles->IsValidated(pFileName, data.pcData, cbData));
+
+    hr = InitFromData(data.pcData, cbData, trustedLayout);
     if (SUCCEEDED(hr))
     {
-        m_flags = (flags | BaseFileOwnsDataFlag);
+        m_flags = (flags | BaseFileOwnsDataFlag | (trustedLayout ? TrustedLayoutFlag : 0));
+
+        if ((pValidatedFiles != nullptr) && !trustedLayout)
+        {
+            // Best effort; the file is still usable if we can't remember it
+            (void)pValidatedFiles->NoteValidated(pFileName, data.pcData, cbData);
+        }
     }
     else if (isMapped)
     {
@@ -392,6 +409,11 @@ bool BaseFile::AreIdentical(__in const BaseFile* pFile1, __in const BaseFile* pF
 }
 
 HRESULT BaseFile::ValidateStructure(__in_bcount(cbData) const void* pData, __in size_t cbData)
+{
+    return ValidateStructure(pData, cbData, true);
+}
+
+HRESULT BaseFile::ValidateStructure(__in_bcount(cbData) const void* pData, __in size_t cbData, __in bool validateTrailer)
 {
     DEFFILE_HEADER* pHeader = (DEFFILE_HEADER*)pData;
     DEFFILE_TRAILER* pTrailer = NULL;
@@ -411,12 +433,13 @@ HRESULT BaseFile::ValidateStructure(__in_bcount(cbData) const void* pData, __in
     RETURN_HR_IF(
         HRESULT_FROM_WIN32(ERROR_MRM_INVALID_PRI_FILE), (cbData < minSize) || (cbData < pHeader->cbTotal) || (pHeader->cbTotal < minSize));
 
-    // Header is potentially valid.  Look for a matching trailer.
+    // Header is potentially valid.  Look for a matching trailer, unless this file is already
+    // known to be good, in which case we avoid paging in the end of the file.
     pTrailer = GetFileTrailer(pHeader);
     RETURN_HR_IF(
         HRESULT_FROM_WIN32(ERROR_MRM_INVALID_PRI_FILE),
-        (pTrailer->marker != DEFFILE_FILE_END_MARKER) || (pHeader->magic.ullMagic != pTrailer->magic.ullMagic) ||
-            (pHeader->cbTotal != pTrailer->cbTotal));
+        validateTrailer && ((pTrailer->marker != DEFFILE_FILE_END_MARKER) || (pHeader->magic.ullMagic != pTrailer->magic.ullMagic) ||
+                            (pHeader->cbTotal != pTrailer->cbTotal)));
 
     // Okay, this sure _looks_ like a DEF file.  Do we have a TOC?
     size_t cbToc = sizeof(DEFFILE_TOC_ENTRY) * pHeader->sizeToc;
@@ -482,6 +505,18 @@ HRESULT BaseFile::ValidateSection(
 
     RETURN_HR_IF_NULL(HRESULT_FROM_WIN32(ERROR_MRM_INVALID_PRI_FILE), pHeader);
 
+    if (IsTrustedLayout())
+    {
+        // The TOC was bounds-checked when the file was opened and the section trailers were
+        // checked when the file was first validated, so skip the trailer and only make sure
+        // the header matches the TOC.
+        RETURN_HR_IF(
+            HRESULT_FROM_WIN32(ERROR_MRM_INVALID_PRI_FILE),
+            (!SectionTypesEqual(m_pToc[sectionIndex].type, pHeader->type)) ||
+                (m_pToc[sectionIndex].cbSectionTotal != pHeader->cbSectionTotal));
+        return S_OK;
+    }
+
     RETURN_IF_FAILED(ValidateTocEntryAgainstSectionData(&m_pToc[sectionIndex], pHeader));
 
     return S_OK;
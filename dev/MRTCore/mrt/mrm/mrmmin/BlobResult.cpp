@@ -122,4 +122,6 @@ _Use_decl_annotations_ HRESULT BlobResult::CopyToOutParams(size_t cbBuffer, void
     return S_OK;
 }
 
+UINT64 BlobResult::GetBufferAllocationCount() { return DefBlobResult_GetBufferAllocationCount(); }
+
 } // namespace Microsoft::Resources
@@ -44,6 +44,9 @@ HRESULT DefBlobResult_ReleaseContents(
     _Outptr_result_bytebuffer_(*pcbBufferOut) void** ppBufferOut,
     _Out_ size_t* pcbBufferOut);
 
+//! Returns the number of blob buffers allocated since the process started.
+UINT64 DefBlobResult_GetBufferAllocationCount();
+
 #define DefBlobResult_IsInvalid(SELF) \
     (((SELF) == NULL) || (((SELF)->pRef == (SELF)->pBuf) && \
                           (((((SELF)->pBuf == NULL) && ((SELF)->cbBuf > 0)) || (((SELF)->cbBuf == 0) && ((SELF)->pBuf != NULL))) || \
@@ -4,6 +4,22 @@
 #include "mrm/common/BaseInternal.h"
 #include "blobresult.h"
 
+// Number of blob buffers allocated by this module, for diagnostics.
+static volatile LONG64 s_blobBufferAllocations = 0;
+
+static void _DefBlobResult_NoteBufferAllocation()
+{
+    if (_DefAreStatisticsEnabled())
+    {
+        InterlockedIncrement64(&s_blobBufferAllocations);
+    }
+}
+
+UINT64 DefBlobResult_GetBufferAllocationCount()
+{
+    return static_cast<UINT64>(InterlockedCompareExchange64(&s_blobBufferAllocations, 0, 0));
+}
+
 static HRESULT _DefBlobResult_Alloc(_Outptr_ DEFBLOBRESULT** result)
 {
     *result = _DefAllocZeroed(DEFBLOBRESULT);
@@ -78,6 +94,7 @@ _DefBlobResult_InitEmpty(_Inout_ DEFBLOBRESULT* pSelf, _In_ size_t cbBuf)
     }
 
     // Not Empty
+    _DefBlobResult_NoteBufferAllocation();
     void* pTempBuf = _DefArray_AllocZeroed(BYTE, cbBuf);
     if (pTempBuf == nullptr)
     {
@@ -409,6 +426,7 @@ DefBlobResult_SetEmptyContents(
 
     if (!pSelf->pBuf)
     {
+        _DefBlobResult_NoteBufferAllocation();
         pSelf->pBuf = Def_Alloc(cbBufferMin);
         if (pSelf->pBuf == nullptr)
         {
@@ -57,6 +57,26 @@ bool CoreProfile::IsLoadResourceMapAllowed(
 // Determines if a profile is allowed to inspect other packages. Default is true.
 bool CoreProfile::IsUnsafeLoadPriFileAllowed() const { return true; }
 
+bool CoreProfile::TryGetValidatedFileCachePath(_Inout_ StringResult* pCachePathOut) const
+{
+    if (DefString_IsEmpty(m_validatedFileCachePath.GetRef()))
+    {
+        return false;
+    }
+
+    return SUCCEEDED(pCachePathOut->SetCopy(m_validatedFileCachePath.GetRef()));
+}
+
+HRESULT CoreProfile::SetValidatedFileCachePath(_In_opt_ PCWSTR pCachePath)
+{
+    if (DefString_IsEmpty(pCachePath))
+    {
+        return m_validatedFileCachePath.SetRef(nullptr);
+    }
+
+    return m_validatedFileCachePath.SetCopy(pCachePath);
+}
+
 bool CoreProfile::IsSupportedFileMagicNumber(_In_ const DEFFILE_MAGIC& fileMagicNumber) const
 {
     return (
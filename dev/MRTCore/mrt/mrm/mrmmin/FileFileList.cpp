@@ -124,6 +124,22 @@ bool IFileList::TryGetPrefixFolderIndex(__in PCWSTR pFullPath, __out int* pIndex
         cchUsed = 0;
         pLookingFor = pFullPath;
 
+        // Paths start with the root's own name, as GetFolderPath builds them.
+        Def_IfFailedReturnFalse(GetFolderName(root, &name));
+        size_t cchRootName;
+        name.GetLength(&cchRootName);
+        if (cchRootName > 0)
+        {
+            int cchName = static_cast<int>(cchRootName);
+            if ((cchName >= cchFullPath) || !DefString_IsPrefixI(name.GetRef(), pLookingFor) || (pLookingFor[cchName] != L'\\'))
+            {
+                continue;
+            }
+            lastMatchIndex = root;
+            pLookingFor += cchName + 1;
+            cchUsed += cchName + 1;
+        }
+
         while (IsValidFolderIndex(thisFolder))
         {
             int firstSubfolder = -1;
@@ -139,26 +155,22 @@ bool IFileList::TryGetPrefixFolderIndex(__in PCWSTR pFullPath, __out int* pIndex
             {
                 Def_IfFailedReturnFalse(GetFolderName(firstSubfolder + i, &name));
 
-                if (DefString_IsPrefixI(pLookingFor, name.GetRef()))
+                // The folder name must be a prefix of what's left of the path, followed by a
+                // backslash.
+                size_t localName;
+                name.GetLength(&localName);
+                int cchName = static_cast<int>(localName);
+                if ((cchName > 0) && (cchUsed + cchName < cchFullPath) && DefString_IsPrefixI(name.GetRef(), pLookingFor) &&
+                    (pLookingFor[cchName] == L'\\'))
                 {
-                    size_t localName;
-                    name.GetLength(&localName);
-                    int cchName = static_cast<int>(localName);
-                    if (cchUsed + cchName >= cchFullPath)
-                    {
-                        return false;
-                    }
-                    if (pLookingFor[cchName - 1] == '\\')
-                    {
-                        // This folder matches.  Note the index and skip over
-                        // the name.
-                        found = true;
-                        lastMatchIndex = firstSubfolder + i;
-                        pLookingFor += cchName;
-                        cchUsed += cchName;
-                        thisFolder = firstSubfolder + i;
-                        break;
-                    }
+                    // This folder matches.  Note the index and skip over
+                    // the name and its separator.
+                    found = true;
+                    lastMatchIndex = firstSubfolder + i;
+                    pLookingFor += cchName + 1;
+                    cchUsed += cchName + 1;
+                    thisFolder = firstSubfolder + i;
+                    break;
                 }
             }
             if (!found)
@@ -173,7 +185,8 @@ bool IFileList::TryGetPrefixFolderIndex(__in PCWSTR pFullPath, __out int* pIndex
         }
     }
 
-    if (cchUsed > GetLongestPath())
+    // cchUsed includes the separator after the last matched folder
+    if (cchUsed - 1 > GetLongestPath())
     {
         return false;
     }
@@ -189,12 +202,202 @@ bool IFileList::TryGetPrefixFolderIndex(__in PCWSTR pFullPath, __out int* pIndex
     return (cchUsed != 0);
 }
 
+// Hash tables mapping the absolute path of every file and folder in a file list to its
+// index, so that path lookups don't have to walk the tree one segment at a time.  Paths
+// are hashed with ASCII case folded; non-ASCII characters all hash alike, so that names
+// which compare equal under the OS casing tables always collide.  Each hit is only a
+// candidate and is confirmed against the names in the file list.
+class FileListPathIndex : public DefObject
+{
+public:
+    static const UINT32 InitialHash = 2166136261u;
+
+    static HRESULT CreateInstance(_In_ int numFolders, _In_ int numFiles, _Outptr_ FileListPathIndex** result);
+
+    ~FileListPathIndex()
+    {
+        if (m_pFolders != nullptr)
+        {
+            Def_Free(m_pFolders);
+        }
+        if (m_pFiles != nullptr)
+        {
+            Def_Free(m_pFiles);
+        }
+    }
+
+    // FNV-1a over a single path character.
+    static UINT32 HashChar(_In_ UINT32 hash, _In_ WCHAR ch)
+    {
+        if ((ch >= L'a') && (ch <= L'z'))
+        {
+            ch -= (L'a' - L'A');
+        }
+        else if (ch == 0x0131)
+        {
+            // Dotless i and long s are the only non-ASCII characters that
+            // uppercase to ASCII.
+            ch = L'I';
+        }
+        else if (ch == 0x017f)
+        {
+            ch = L'S';
+        }
+        else if (ch > 0x7f)
+        {
+            ch = 0x80;
+        }
+        return (hash ^ ch) * 16777619u;
+    }
+
+    static UINT32 HashPath(_In_reads_(cchPath) PCWSTR pPath, _In_ int cchPath)
+    {
+        UINT32 hash = InitialHash;
+        for (int i = 0; i < cchPath; i++)
+        {
+            hash = HashChar(hash, pPath[i]);
+        }
+        return hash;
+    }
+
+    void AddFolder(_In_ UINT32 hash, _In_ int folderIndex) { Add(m_pFolders, m_folderMask, hash, folderIndex); }
+    void AddFile(_In_ UINT32 hash, _In_ int fileIndex) { Add(m_pFiles, m_fileMask, hash, fileIndex); }
+
+    // Returns the next folder or file whose path has the specified hash, or -1 if there are
+    // no more candidates.  *pProbe must be initialized to the hash before the first call.
+    int GetNextFolder(_In_ UINT32 hash, _Inout_ UINT32* pProbe) const { return GetNext(m_pFolders, m_folderMask, hash, pProbe); }
+    int GetNextFile(_In_ UINT32 hash, _Inout_ UINT32* pProbe) const { return GetNext(m_pFiles, m_fileMask, hash, pProbe); }
+
+private:
+    struct Slot
+    {
+        UINT32 hash;
+        int index; // -1 if the slot is empty
+    };
+
+    _Field_size_(m_folderMask + 1) Slot* m_pFolders;
+    UINT32 m_folderMask;
+    _Field_size_(m_fileMask + 1) Slot* m_pFiles;
+    UINT32 m_fileMask;
+
+    FileListPathIndex() : m_pFolders(nullptr), m_folderMask(0), m_pFiles(nullptr), m_fileMask(0) {}
+
+    // Allocates a table with at most 50% occupancy, so probe sequences stay short and always
+    // end at an empty slot.
+    static HRESULT AllocTable(_In_ int numEntries, _Outptr_ Slot** ppSlotsOut, _Out_ UINT32* pMaskOut)
+    {
+        UINT32 numSlots = 16;
+        while (numSlots < static_cast<UINT32>(numEntries) * 2)
+        {
+            numSlots *= 2;
+        }
+
+        Slot* pSlots = _DefArray_AllocZeroed(Slot, numSlots);
+        RETURN_IF_NULL_ALLOC(pSlots);
+        for (UINT32 i = 0; i < numSlots; i++)
+        {
+            pSlots[i].index = -1;
+        }
+
+        *ppSlotsOut = pSlots;
+        *pMaskOut = numSlots - 1;
+        return S_OK;
+    }
+
+    static void Add(_Inout_ Slot* pSlots, _In_ UINT32 mask, _In_ UINT32 hash, _In_ int index)
+    {
+        UINT32 probe = hash;
+        while (pSlots[probe & mask].index >= 0)
+        {
+            probe++;
+        }
+        pSlots[probe & mask].hash = hash;
+        pSlots[probe & mask].index = index;
+    }
+
+    static int GetNext(_In_ const Slot* pSlots, _In_ UINT32 mask, _In_ UINT32 hash, _Inout_ UINT32* pProbe)
+    {
+        for (;; (*pProbe)++)
+        {
+            const Slot* pSlot = &pSlots[(*pProbe) & mask];
+            if (pSlot->index < 0)
+            {
+                return -1;
+            }
+            if (pSlot->hash == hash)
+            {
+                (*pProbe)++;
+                return pSlot->index;
+            }
+        }
+    }
+};
+
+HRESULT FileListPathIndex::CreateInstance(_In_ int numFolders, _In_ int numFiles, _Outptr_ FileListPathIndex** result)
+{
+    *result = nullptr;
+    RETURN_HR_IF(E_INVALIDARG, (numFolders < 0) || (numFiles < 0));
+
+    AutoDeletePtr<FileListPathIndex> pRtrn = new FileListPathIndex();
+    RETURN_IF_NULL_ALLOC(pRtrn);
+    RETURN_IF_FAILED(AllocTable(numFolders, &pRtrn->m_pFolders, &pRtrn->m_folderMask));
+    RETURN_IF_FAILED(AllocTable(numFiles, &pRtrn->m_pFiles, &pRtrn->m_fileMask));
+
+    *result = pRtrn.Detach();
+    return S_OK;
+}
+
+// Per-folder working storage for FileFileList::BuildPathIndex.
+struct FolderHashScratch
+{
+    UINT32* pHashes;
+    int* pPending;
+    bool* pHashed;
+
+    FolderHashScratch() : pHashes(nullptr), pPending(nullptr), pHashed(nullptr) {}
+
+    ~FolderHashScratch()
+    {
+        if (pHashes != nullptr)
+        {
+            Def_Free(pHashes);
+        }
+        if (pPending != nullptr)
+        {
+            Def_Free(pPending);
+        }
+        if (pHashed != nullptr)
+        {
+            Def_Free(pHashed);
+        }
+    }
+
+    HRESULT Init(_In_ int numFolders)
+    {
+        pHashes = _DefArray_AllocZeroed(UINT32, numFolders + 1);
+        RETURN_IF_NULL_ALLOC(pHashes);
+        pPending = _DefArray_AllocZeroed(int, numFolders + 1);
+        RETURN_IF_NULL_ALLOC(pPending);
+        pHashed = _DefArray_AllocZeroed(bool, numFolders + 1);
+        RETURN_IF_NULL_ALLOC(pHashed);
+        return S_OK;
+    }
+};
+
 const DEFFILE_SECTION_TYPEID FileFileList::GetSectionTypeId() { return gFileListSectionType; }
 
 FileFileList::FileFileList() :
-    FileSectionBase(), m_pHeader(NULL), m_pFolders(NULL), m_pFiles(NULL), m_pAsciiNames(NULL), m_pUtf16Names(NULL)
+    FileSectionBase(),
+    m_pHeader(NULL),
+    m_pFolders(NULL),
+    m_pFiles(NULL),
+    m_pAsciiNames(NULL),
+    m_pUtf16Names(NULL),
+    m_pPathIndex(nullptr)
 {}
 
+FileFileList::~FileFileList() { delete m_pPathIndex; }
+
 HRESULT FileFileList::Init(__in_opt const IFileSection* pSection, __in_bcount(cbData) const void* pData, __in int cbData)
 {
     RETURN_IF_FAILED(FileSectionBase::Init(pSection, pData, cbData));
@@ -467,6 +670,262 @@ HRESULT FileFileList::GetFolderPath(__in int folderIndex, __inout StringResult*
     return S_OK;
 }
 
+HRESULT FileFileList::HashNameSegment(_In_ UINT32 hash, _In_ int firstCharOffset, _In_ int cchName, _Out_ UINT32* pHashOut) const
+{
+    *pHashOut = hash;
+    if (cchName > 0)
+    {
+        PCWSTR pName;
+        RETURN_IF_FAILED(GetUtf16Name(firstCharOffset, cchName, &pName));
+        for (int i = 0; i < cchName; i++)
+        {
+            hash = FileListPathIndex::HashChar(hash, pName[i]);
+        }
+        *pHashOut = hash;
+    }
+    return S_OK;
+}
+
+HRESULT FileFileList::BuildPathIndex(_Outptr_ FileListPathIndex** result) const
+{
+    *result = nullptr;
+
+    const int numFolders = GetTotalNumFolders();
+    const int numFiles = GetTotalNumFiles();
+
+    AutoDeletePtr<FileListPathIndex> pIndex;
+    RETURN_IF_FAILED(FileListPathIndex::CreateInstance(numFolders, numFiles, &pIndex));
+
+    // Hash state after each folder's full path.  Paths are built the same way as
+    // GetFolderPath and GetFilePath: every name is preceded by a backslash except
+    // the outermost one.
+    FolderHashScratch scratch;
+    RETURN_IF_FAILED(scratch.Init(numFolders));
+    UINT32* pFolderHashes = scratch.pHashes;
+    int* pPending = scratch.pPending;
+    bool* pHashed = scratch.pHashed;
+
+    for (int folderIndex = 0; folderIndex < numFolders; folderIndex++)
+    {
+        // The builder emits parents before their subfolders, but don't depend on it.
+        // Collect any ancestors that haven't been hashed yet and hash them outermost first.
+        int numPending = 0;
+        for (int i = folderIndex; i >= 0; i = m_pFolders[i].parentFolderIndex)
+        {
+            RETURN_HR_IF(E_ABORT, i >= numFolders);
+            if (pHashed[i])
+            {
+                break;
+            }
+
+            RETURN_HR_IF(E_ABORT, numPending >= numFolders);
+            pPending[numPending++] = i;
+        }
+
+        while (numPending > 0)
+        {
+            const int i = pPending[--numPending];
+            const int parentIndex = m_pFolders[i].parentFolderIndex;
+            UINT32 hash = ((parentIndex >= 0) ? FileListPathIndex::HashChar(pFolderHashes[parentIndex], L'\\') : FileListPathIndex::InitialHash);
+            RETURN_IF_FAILED(HashNameSegment(hash, m_pFolders[i].nameOffset, m_pFolders[i].cchName, &pFolderHashes[i]));
+            pHashed[i] = true;
+        }
+
+        pIndex->AddFolder(pFolderHashes[folderIndex], folderIndex);
+    }
+
+    for (int fileBasedFileIndex = 0; fileBasedFileIndex < numFiles; fileBasedFileIndex++)
+    {
+        const DEFFILE_FILELIST_FILE_ENTRY* pFile = &m_pFiles[fileBasedFileIndex];
+        RETURN_HR_IF(E_ABORT, pFile->parentFolderIndex >= numFolders);
+
+        UINT32 hash =
+            ((pFile->parentFolderIndex >= 0) ? FileListPathIndex::HashChar(pFolderHashes[pFile->parentFolderIndex], L'\\') : FileListPathIndex::InitialHash);
+        RETURN_IF_FAILED(HashNameSegment(hash, pFile->nameOffset, pFile->cchName, &hash));
+
+        // File indices are 1-based outside of the file format; see GetFilePath.
+        pIndex->AddFile(hash, fileBasedFileIndex + 1);
+    }
+
+    *result = pIndex.Detach();
+    return S_OK;
+}
+
+const FileListPathIndex* FileFileList::GetPathIndex() const
+{
+    FileListPathIndex* pIndex =
+        static_cast<FileListPathIndex*>(InterlockedCompareExchangePointer(reinterpret_cast<PVOID volatile*>(&m_pPathIndex), nullptr, nullptr));
+
+    if (pIndex == nullptr)
+    {
+        FileListPathIndex* pNewIndex;
+        if (FAILED(BuildPathIndex(&pNewIndex)))
+        {
+            // Callers fall back to a linear search
+            return nullptr;
+        }
+
+        pIndex = static_cast<FileListPathIndex*>(
+            InterlockedCompareExchangePointer(reinterpret_cast<PVOID volatile*>(&m_pPathIndex), pNewIndex, nullptr));
+        if (pIndex == nullptr)
+        {
+            pIndex = pNewIndex;
+        }
+        else
+        {
+            // Another thread built the index first
+            delete pNewIndex;
+        }
+    }
+
+    return pIndex;
+}
+
+bool FileFileList::PathMatches(
+    _In_reads_(cchPath) PCWSTR pPath,
+    _In_ int cchPath,
+    _In_ int firstCharOffset,
+    _In_ int cchName,
+    _In_ int parentFolderIndex) const
+{
+    // Compare from back to front, one name at a time, the same way GetFilePath
+    // builds the path.
+    int cchRemaining = cchPath;
+    for (int depth = 0;; depth++)
+    {
+        if (cchName > cchRemaining)
+        {
+            return false;
+        }
+
+        cchRemaining -= cchName;
+        if (cchName > 0)
+        {
+            PCWSTR pName;
+            if (FAILED(GetUtf16Name(firstCharOffset, cchName, &pName)) ||
+                (CompareStringOrdinal(&pPath[cchRemaining], cchName, pName, cchName, TRUE) != CSTR_EQUAL))
+            {
+                return false;
+            }
+        }
+
+        if (parentFolderIndex < 0)
+        {
+            break;
+        }
+
+        if ((parentFolderIndex >= GetTotalNumFolders()) || (depth >= GetTotalNumFolders()) || (cchRemaining < 1) ||
+            (pPath[cchRemaining - 1] != L'\\'))
+        {
+            return false;
+        }
+
+        cchRemaining--;
+        const DEFFILE_FILELIST_FOLDER_ENTRY* pFolder = &m_pFolders[parentFolderIndex];
+        firstCharOffset = pFolder->nameOffset;
+        cchName = pFolder->cchName;
+        parentFolderIndex = pFolder->parentFolderIndex;
+    }
+
+    return (cchRemaining == 0);
+}
+
+bool FileFileList::FilePathMatches(_In_reads_(cchPath) PCWSTR pPath, _In_ int cchPath, _In_ int fileIndex) const
+{
+    const DEFFILE_FILELIST_FILE_ENTRY* pFile = &m_pFiles[fileIndex - 1];
+    return (pFile->cchFullPath == cchPath) && PathMatches(pPath, cchPath, pFile->nameOffset, pFile->cchName, pFile->parentFolderIndex);
+}
+
+bool FileFileList::FolderPathMatches(_In_reads_(cchPath) PCWSTR pPath, _In_ int cchPath, _In_ int folderIndex) const
+{
+    const DEFFILE_FILELIST_FOLDER_ENTRY* pFolder = &m_pFolders[folderIndex];
+    return (pFolder->cchFullPath == cchPath) && PathMatches(pPath, cchPath, pFolder->nameOffset, pFolder->cchName, pFolder->parentFolderIndex);
+}
+
+bool FileFileList::TryGetFileIndex(__in PCWSTR pPath, __out int* pIndexOut) const
+{
+    if ((pPath == nullptr) || (pIndexOut == nullptr))
+    {
+        return false;
+    }
+
+    *pIndexOut = -1;
+
+    size_t cchPath = wcslen(pPath);
+    if (cchPath > MAXUINT16)
+    {
+        return false;
+    }
+
+    const FileListPathIndex* pIndex = GetPathIndex();
+    if (pIndex != nullptr)
+    {
+        UINT32 hash = FileListPathIndex::HashPath(pPath, static_cast<int>(cchPath));
+        UINT32 probe = hash;
+        for (int fileIndex = pIndex->GetNextFile(hash, &probe); fileIndex >= 0; fileIndex = pIndex->GetNextFile(hash, &probe))
+        {
+            if (FilePathMatches(pPath, static_cast<int>(cchPath), fileIndex))
+            {
+                *pIndexOut = fileIndex;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    for (int fileIndex = 1; fileIndex <= GetTotalNumFiles(); fileIndex++)
+    {
+        if (FilePathMatches(pPath, static_cast<int>(cchPath), fileIndex))
+        {
+            *pIndexOut = fileIndex;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FileFileList::TryGetFolderIndex(__in PCWSTR pPath, __out int* pIndexOut) const
+{
+    if ((pPath == nullptr) || (pIndexOut == nullptr))
+    {
+        return false;
+    }
+
+    *pIndexOut = -1;
+
+    size_t cchPath = wcslen(pPath);
+    if (cchPath > MAXUINT16)
+    {
+        return false;
+    }
+
+    const FileListPathIndex* pIndex = GetPathIndex();
+    if (pIndex != nullptr)
+    {
+        UINT32 hash = FileListPathIndex::HashPath(pPath, static_cast<int>(cchPath));
+        UINT32 probe = hash;
+        for (int folderIndex = pIndex->GetNextFolder(hash, &probe); folderIndex >= 0; folderIndex = pIndex->GetNextFolder(hash, &probe))
+        {
+            if (FolderPathMatches(pPath, static_cast<int>(cchPath), folderIndex))
+            {
+                *pIndexOut = folderIndex;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    for (int folderIndex = 0; folderIndex < GetTotalNumFolders(); folderIndex++)
+    {
+        if (FolderPathMatches(pPath, static_cast<int>(cchPath), folderIndex))
+        {
+            *pIndexOut = folderIndex;
+            return true;
+        }
+    }
+    return false;
+}
+
 HRESULT FileFileList::Validate(__in_bcount(cbData) const void* pData, __in size_t cbData)
 {
     RETURN_HR_IF(E_INVALIDARG, (pData == nullptr) || (cbData < sizeof(DEFFILE_FILELIST_HEADER)));
@@ -343,6 +343,202 @@ protected:
     const T* m_pItems;
 };
 
+// Bloom filter over the full path of every item in a names section.  Paths are hashed
+// after folding case and separators the same way Contains compares them, so that any
+// name Contains would find is reported as present.  Case-insensitive comparison of
+// non-ASCII characters depends on OS casing tables, so the filter only covers ASCII:
+// a section with any non-ASCII scope or item name gets a disabled filter, and queries
+// with non-ASCII characters always fall through to the full lookup.
+class HierarchicalItemNameFilter : public DefObject
+{
+public:
+    static HRESULT CreateInstance(_In_ const HierarchicalNames* pNames, _Outptr_ HierarchicalItemNameFilter** result);
+
+    ~HierarchicalItemNameFilter() { Disable(); }
+
+    bool MayContain(_In_ int relativeToScope, _In_ PCWSTR pPath) const
+    {
+        if ((m_pBits == nullptr) || (relativeToScope < 0) || (relativeToScope >= m_numScopes) || (pPath == nullptr))
+        {
+            return true;
+        }
+
+        // Contains ignores a single leading separator
+        if ((pPath[0] == L'/') || (pPath[0] == L'\\'))
+        {
+            pPath++;
+        }
+
+        UINT64 hash = m_pScopeSeeds[relativeToScope];
+        if (!TryHashPath(pPath, &hash))
+        {
+            return true;
+        }
+
+        return Test(hash);
+    }
+
+private:
+    static const int NumProbes = 6;
+    static const int BitsPerItem = 12;
+    static const UINT32 MinBits = 256;
+    static const UINT32 MaxBits = 1u << 26;
+    static const UINT64 HashBasis = 14695981039346656037ULL;
+    static const UINT64 HashPrime = 1099511628211ULL;
+
+    // Null if the filter is disabled, in which case every name might be present.
+    _Field_size_((m_bitMask + 1) / 32) UINT32* m_pBits;
+    UINT32 m_bitMask;
+
+    // Hash state after the full path of each scope and a trailing separator, so that
+    // names relative to a scope hash the same as the item's full path.
+    _Field_size_(m_numScopes) UINT64* m_pScopeSeeds;
+    int m_numScopes;
+
+    HierarchicalItemNameFilter() : m_pBits(nullptr), m_bitMask(0), m_pScopeSeeds(nullptr), m_numScopes(0) {}
+
+    void Disable()
+    {
+        if (m_pBits != nullptr)
+        {
+            Def_Free(m_pBits);
+            m_pBits = nullptr;
+        }
+
+        if (m_pScopeSeeds != nullptr)
+        {
+            Def_Free(m_pScopeSeeds);
+            m_pScopeSeeds = nullptr;
+        }
+
+        m_bitMask = 0;
+        m_numScopes = 0;
+    }
+
+    // FNV-1a over the folded characters of pPath.  Fails if pPath contains a non-ASCII character.
+    static bool TryHashPath(_In_ PCWSTR pPath, _Inout_ UINT64* pHash)
+    {
+        UINT64 hash = *pHash;
+        for (; *pPath != L'\0'; pPath++)
+        {
+            WCHAR ch = *pPath;
+            if (ch >= 0x80)
+            {
+                return false;
+            }
+
+            if (ch == L'\\')
+            {
+                ch = L'/';
+            }
+            else if ((ch >= L'a') && (ch <= L'z'))
+            {
+                ch = static_cast<WCHAR>(ch - (L'a' - L'A'));
+            }
+
+            hash = (hash ^ ch) * HashPrime;
+        }
+
+        *pHash = hash;
+        return true;
+    }
+
+    bool ForEachProbe(_In_ UINT64 hash, _In_ bool set) const
+    {
+        // Finish with a 64-bit mix so both halves are usable for double hashing.
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ULL;
+        hash ^= hash >> 33;
+
+        UINT32 h1 = static_cast<UINT32>(hash);
+        UINT32 h2 = static_cast<UINT32>(hash >> 32) | 1;
+        for (int i = 0; i < NumProbes; i++)
+        {
+            UINT32 bit = (h1 + (i * h2)) & m_bitMask;
+            UINT32 mask = 1u << (bit & 31);
+            if (set)
+            {
+                m_pBits[bit >> 5] |= mask;
+            }
+            else if ((m_pBits[bit >> 5] & mask) == 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Add(_In_ UINT64 hash) { ForEachProbe(hash, true); }
+    bool Test(_In_ UINT64 hash) const { return ForEachProbe(hash, false); }
+};
+
+HRESULT HierarchicalItemNameFilter::CreateInstance(_In_ const HierarchicalNames* pNames, _Outptr_ HierarchicalItemNameFilter** result)
+{
+    *result = nullptr;
+
+    AutoDeletePtr<HierarchicalItemNameFilter> pRtrn = new HierarchicalItemNameFilter();
+    RETURN_IF_NULL_ALLOC(pRtrn);
+
+    int numScopes = pNames->GetNumScopes();
+    int numItems = pNames->GetNumItems();
+    if ((numScopes <= 0) || (numItems <= 0))
+    {
+        // Nothing to filter.  Leave it disabled and let Contains handle the lookup.
+        *result = pRtrn.Detach();
+        return S_OK;
+    }
+
+    UINT32 numBits = MinBits;
+    while ((numBits < MaxBits) && (numBits < static_cast<UINT64>(numItems) * BitsPerItem))
+    {
+        numBits <<= 1;
+    }
+
+    pRtrn->m_pScopeSeeds = _DefArray_AllocZeroed(UINT64, numScopes);
+    RETURN_IF_NULL_ALLOC(pRtrn->m_pScopeSeeds);
+    pRtrn->m_pBits = _DefArray_AllocZeroed(UINT32, numBits / 32);
+    RETURN_IF_NULL_ALLOC(pRtrn->m_pBits);
+    pRtrn->m_bitMask = numBits - 1;
+    pRtrn->m_numScopes = numScopes;
+
+    StringResult name;
+    for (int i = 0; i < numScopes; i++)
+    {
+        UINT64 hash = HashBasis;
+        PCWSTR pScopeName = (pNames->TryGetScopeInfo(i, &name) ? name.GetRef() : nullptr);
+        if ((pScopeName == nullptr) || !TryHashPath(pScopeName, &hash))
+        {
+            pRtrn->Disable();
+            *result = pRtrn.Detach();
+            return S_OK;
+        }
+
+        if (pScopeName[0] != L'\0')
+        {
+            hash = (hash ^ L'/') * HashPrime;
+        }
+        pRtrn->m_pScopeSeeds[i] = hash;
+    }
+
+    for (int i = 0; i < numItems; i++)
+    {
+        UINT64 hash = HashBasis;
+        PCWSTR pItemName = (pNames->TryGetItemInfo(i, &name) ? name.GetRef() : nullptr);
+        if ((pItemName == nullptr) || !TryHashPath(pItemName, &hash))
+        {
+            pRtrn->Disable();
+            *result = pRtrn.Detach();
+            return S_OK;
+        }
+        pRtrn->Add(hash);
+    }
+
+    *result = pRtrn.Detach();
+    return S_OK;
+}
+
 HierarchicalNames::HierarchicalNames() :
     m_pHeader(nullptr),
     m_pNodes(nullptr),
@@ -355,6 +551,7 @@ HierarchicalNames::HierarchicalNames() :
     m_pAsciiNames(nullptr),
     m_pScopeNames(nullptr),
     m_pItemNames(nullptr),
+    m_pItemFilter(nullptr),
     m_largeNode(false)
 {}
 
@@ -483,9 +680,11 @@ HierarchicalNames::~HierarchicalNames()
 {
     delete m_pScopeNames;
     delete m_pItemNames;
+    delete m_pItemFilter;
 
     m_pScopeNames = NULL;
     m_pItemNames = NULL;
+    m_pItemFilter = NULL;
 }
 
 _Success_(return ) bool HierarchicalNames::TryGetName(
@@ -1113,6 +1312,36 @@ _Success_(return ) bool HierarchicalNames::TryGetItemInfo(__in int itemIndex, __
     return TryGetName(m_largeNode ? m_pItemsLarge[itemIndex] : m_pItems[itemIndex], pNameOut);
 }
 
+bool HierarchicalNames::MayContainItem(__in int relativeToScope, __in PCWSTR pPath) const
+{
+    HierarchicalItemNameFilter* pFilter =
+        static_cast<HierarchicalItemNameFilter*>(InterlockedCompareExchangePointer(reinterpret_cast<PVOID volatile*>(&m_pItemFilter), nullptr, nullptr));
+
+    if (pFilter == nullptr)
+    {
+        HierarchicalItemNameFilter* pNewFilter;
+        if (FAILED(HierarchicalItemNameFilter::CreateInstance(this, &pNewFilter)))
+        {
+            // No filter means no answer, so let the caller do the full lookup.
+            return true;
+        }
+
+        pFilter = static_cast<HierarchicalItemNameFilter*>(
+            InterlockedCompareExchangePointer(reinterpret_cast<PVOID volatile*>(&m_pItemFilter), pNewFilter, nullptr));
+        if (pFilter == nullptr)
+        {
+            pFilter = pNewFilter;
+        }
+        else
+        {
+            // Another thread built the filter first
+            delete pNewFilter;
+        }
+    }
+
+    return pFilter->MayContain(relativeToScope, pPath);
+}
+
 _Success_(return ) bool HierarchicalNames::TryGetItemLocalName(__in int itemIndex, __inout StringResult* pNameOut) const
 {
     if (m_pHeader->numItems == 0)
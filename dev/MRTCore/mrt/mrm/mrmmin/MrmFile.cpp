@@ -353,6 +353,8 @@ public:
             RETURN_IF_FAILED(RemapUInt16::CreateInstance(pFileFileList->GetTotalNumFiles(), &m_pFileInfoToGlobalIndex));
         }
 
+        RETURN_IF_FAILED(PrefetchPreloadFiles(pFileFileList));
+
         StringResult strFilePath;
         int numFiles = pFileFileList->GetTotalNumFiles() + 1;
         for (int fileInfoIndex = 1; fileInfoIndex < numFiles; fileInfoIndex++)
@@ -392,6 +394,42 @@ public:
     }
 
 private:
+    // Loads the files marked for preload in parallel before they are added one at a time.
+    HRESULT PrefetchPreloadFiles(_In_ const FileFileList* pFileFileList)
+    {
+        int numFiles = pFileFileList->GetTotalNumFiles();
+        if (numFiles < 2)
+        {
+            return S_OK;
+        }
+
+        StringResult* pPaths = new StringResult[numFiles];
+        RETURN_IF_NULL_ALLOC(pPaths);
+        auto deletePaths = wil::scope_exit([&] { delete[] pPaths; });
+
+        PCWSTR* ppPaths = _DefArray_AllocZeroed(PCWSTR, numFiles);
+        RETURN_IF_NULL_ALLOC(ppPaths);
+        auto freePaths = wil::scope_exit([&] { Def_Free(ppPaths); });
+
+        int numPreload = 0;
+        for (int fileInfoIndex = 1; fileInfoIndex <= numFiles; fileInfoIndex++)
+        {
+            UINT16 flags = 0;
+            RETURN_IF_FAILED(pFileFileList->GetFilePath(fileInfoIndex, &pPaths[numPreload], &flags));
+            if ((flags & INPLACE_MERGE_PRELOAD) != 0)
+            {
+                ppPaths[numPreload] = pPaths[numPreload].GetRef();
+                numPreload++;
+            }
+        }
+
+        // Best effort; files that fail here are reported when they are added.
+        StringResult strPackageRoot;
+        (void)m_pPriFileManager->PrefetchFiles(numPreload, ppPaths, strPackageRoot.GetRef(), LoadPriFlags::Default);
+
+        return S_OK;
+    }
+
     PriFileManager* m_pPriFileManager;
     RemapUInt16* m_pFileInfoToGlobalIndex;
 };
@@ -475,7 +513,8 @@ HRESULT MrmFile::Init(_In_ PriFileManager* pManager, _In_ PCWSTR pPath)
     m_pPriFileManager = pManager;
     m_pEnvironment = pManager->GetUnifiedEnvironment();
 
-    RETURN_IF_FAILED(BaseFile::CreateInstance(m_pPriFileManager->GetDefaultFileFlags(), pPath, (BaseFile**)&m_pBaseFile));
+    RETURN_IF_FAILED(BaseFile::CreateInstance(
+        m_pPriFileManager->GetDefaultFileFlags(), pPath, m_pPriFileManager->GetValidatedFileCache(), (BaseFile**)&m_pBaseFile));
 
     m_pMyBaseFile = m_pBaseFile;
 
@@ -942,6 +942,12 @@ extern "C"
         return S_OK;
     }
 
+    UINT64 _DefGetLanguageDistanceCallCount()
+    {
+        // Language distance is not implemented at the RTL level, so it is never called.
+        return 0;
+    }
+
 #ifdef __cplusplus
 }
 #endif
@@ -1307,12 +1313,21 @@ extern "C"
         return TRUE;
     }
 
+    volatile LONG64 g_languageDistanceCalls = 0;
+
+    UINT64 _DefGetLanguageDistanceCallCount() { return static_cast<UINT64>(InterlockedCompareExchange64(&g_languageDistanceCalls, 0, 0)); }
+
     HRESULT _DefGetDistanceOfClosestLanguageInList(
         _In_ PCWSTR language,
         _In_ PCWSTR languagesList,
         _In_ wchar_t listDelimiter,
         _Out_ double* closestDistance)
     {
+        if (_DefAreStatisticsEnabled())
+        {
+            InterlockedIncrement64(&g_languageDistanceCalls);
+        }
+
         // Before new SDK is released, we need to use LoadLibrary/GetProcAddress
         InitializeBcp47Module();
 
@@ -1340,3 +1355,18 @@ extern "C"
 #endif
 
 #endif // !DEF_RTL
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    volatile LONG g_statisticsEnabled = 0;
+
+    void _DefEnableStatistics(_In_ BOOLEAN enable) { InterlockedExchange(&g_statisticsEnabled, enable ? 1 : 0); }
+
+    BOOLEAN _DefAreStatisticsEnabled() { return (g_statisticsEnabled != 0) ? TRUE : FALSE; }
+
+#ifdef __cplusplus
+}
+#endif
@@ -140,6 +140,146 @@ PriFileManager::GetOrAddFile(_In_ PCWSTR pPath, _In_opt_ PCWSTR pPackageRoot, _I
     return S_OK;
 }
 
+struct PrefetchFilesWork
+{
+    ManagedFile** ppFiles;
+    HRESULT* pResults;
+    LONG numFiles;
+    volatile LONG nextFile;
+};
+
+static void LoadPrefetchFiles(_Inout_ PrefetchFilesWork* pWork)
+{
+    for (LONG i = InterlockedIncrement(&pWork->nextFile) - 1; i < pWork->numFiles; i = InterlockedIncrement(&pWork->nextFile) - 1)
+    {
+        pWork->pResults[i] = pWork->ppFiles[i]->Load();
+    }
+}
+
+static void CALLBACK PrefetchFilesWorkCallback(_Inout_ PTP_CALLBACK_INSTANCE, _Inout_opt_ PVOID context, _Inout_ PTP_WORK)
+{
+    LoadPrefetchFiles(static_cast<PrefetchFilesWork*>(context));
+}
+
+HRESULT PriFileManager::PrefetchFiles(
+    _In_ int numFiles,
+    _In_reads_(numFiles) const PCWSTR* ppPaths,
+    _In_opt_ PCWSTR pPackageRoot,
+    _In_ LoadPriFlags flags) const
+{
+    RETURN_HR_IF(E_INVALIDARG, (numFiles < 0) || ((numFiles > 0) && (ppPaths == nullptr)));
+
+    if (numFiles < 2)
+    {
+        return S_OK;
+    }
+
+    ManagedFile** ppFiles = _DefArray_AllocZeroed(ManagedFile*, numFiles);
+    HRESULT* pResults = _DefArray_AllocZeroed(HRESULT, numFiles);
+    auto cleanup = wil::scope_exit([&] {
+        if (ppFiles != nullptr)
+        {
+            for (int i = 0; i < numFiles; i++)
+            {
+                delete ppFiles[i];
+            }
+            Def_Free(ppFiles);
+        }
+        if (pResults != nullptr)
+        {
+            Def_Free(pResults);
+        }
+    });
+    RETURN_IF_NULL_ALLOC(ppFiles);
+    RETURN_IF_NULL_ALLOC(pResults);
+
+    // Only files the manager doesn't know about yet are prefetched.  Nothing else can see
+    // them until they are added below, so they can be mapped and validated concurrently.
+    int numNewFiles = 0;
+    for (int i = 0; i < numFiles; i++)
+    {
+        NormalizedFilePath normalizedPath;
+        StringResult rootPath;
+        ManagedFile* pExisting;
+
+        if (DefString_IsEmpty(ppPaths[i]) || FAILED(normalizedPath.Init(ppPaths[i])) ||
+            SUCCEEDED(GetFile(&normalizedPath, &pExisting)) ||
+            FAILED(ManagedFile::NormalizePackageRoot(normalizedPath.GetRef(), pPackageRoot, &rootPath)))
+        {
+            continue;
+        }
+
+        bool isDuplicate = false;
+        for (int j = 0; (j < numNewFiles) && !isDuplicate; j++)
+        {
+            isDuplicate = (DefString_ICompare(normalizedPath.GetRef(), ppFiles[j]->GetPath()) == Def_Equal);
+        }
+
+        // Files that are missing are reported by the caller when it adds them, so don't log them here.
+        if (!isDuplicate &&
+            SUCCEEDED(ManagedFile::CreateInstance(
+                this,
+                -1,
+                &normalizedPath,
+                rootPath.GetRef(),
+                (flags & ~LoadPriFlags::Preload) | LoadPriFlags::ExcludeLogForFileNotFound,
+                &ppFiles[numNewFiles])))
+        {
+            numNewFiles++;
+        }
+    }
+
+    PrefetchFilesWork work = {ppFiles, pResults, numNewFiles, 0};
+    PTP_WORK pThreadpoolWork = nullptr;
+    if (numNewFiles > 1)
+    {
+        pThreadpoolWork = CreateThreadpoolWork(PrefetchFilesWorkCallback, &work, nullptr);
+    }
+
+    if (pThreadpoolWork != nullptr)
+    {
+        SYSTEM_INFO systemInfo;
+        GetSystemInfo(&systemInfo);
+
+        // The calling thread loads files too, so it counts as one of the workers.
+        int numWorkers = min(numNewFiles, static_cast<int>(systemInfo.dwNumberOfProcessors));
+        for (int i = 1; i < numWorkers; i++)
+        {
+            SubmitThreadpoolWork(pThreadpoolWork);
+        }
+
+        LoadPrefetchFiles(&work);
+
+        WaitForThreadpoolWorkCallbacks(pThreadpoolWork, FALSE);
+        CloseThreadpoolWork(pThreadpoolWork);
+    }
+    else
+    {
+        LoadPrefetchFiles(&work);
+    }
+
+    // Add the files that loaded, in the order they were requested.  Files that failed are
+    // dropped, so the caller's own GetOrAddFile reports the failure exactly as before.
+    for (int i = 0; i < numNewFiles; i++)
+    {
+        if (FAILED(pResults[i]))
+        {
+            continue;
+        }
+
+        FileManagerFileInfo finfo;
+        finfo.pFile = ppFiles[i];
+
+        int index = -1;
+        RETURN_IF_FAILED(m_pFiles->Add(finfo, &index));
+
+        ppFiles[i]->SetGlobalIndex(index);
+        ppFiles[i] = nullptr;
+    }
+
+    return S_OK;
+}
+
 HRESULT PriFileManager::AddFile(
     _In_ const NormalizedFilePath* pNormalizedPath,
     _In_opt_ PCWSTR pPackageRoot,
@@ -560,6 +700,13 @@ HRESULT PriFileManager::Init(_In_ UnifiedEnvironment* pEnvironment)
     m_defaultFileFlags = BaseFile::MapFileFlag;
     RETURN_IF_FAILED(DynamicArray<FileManagerFileInfo>::CreateInstance(DefaultInitialFilesSize, &m_pFiles));
 
+    StringResult cachePath;
+    if (pEnvironment->GetProfile()->TryGetValidatedFileCachePath(&cachePath))
+    {
+        // Without the cache, files are just fully validated every time
+        (void)ValidatedFileCache::CreateInstance(cachePath.GetRef(), &m_pValidatedFiles);
+    }
+
     return S_OK;
 }
 
@@ -583,6 +730,13 @@ PriFileManager::~PriFileManager()
         delete m_pFiles;
         m_pFiles = nullptr;
     }
+
+    if (m_pValidatedFiles != nullptr)
+    {
+        (void)m_pValidatedFiles->Save();
+        delete m_pValidatedFiles;
+        m_pValidatedFiles = nullptr;
+    }
 }
 
 } // namespace Microsoft::Resources
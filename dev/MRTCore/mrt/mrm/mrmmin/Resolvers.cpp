@@ -1095,8 +1095,57 @@ private:
     SRWLOCK m_srwLock;
 };
 
+// The statistics are diagnostic only, so they are updated with interlocked operations instead of under the resolver locks,
+// and only while statistics are enabled for the process.
+static void IncrementStatistic(_Inout_ UINT64* counter, _In_ UINT64 value = 1)
+{
+    if (!_DefAreStatisticsEnabled())
+    {
+        return;
+    }
+
+    InterlockedAdd64(reinterpret_cast<volatile LONG64*>(counter), static_cast<LONG64>(value));
+}
+
+static UINT64 ReadStatistic(_In_ const UINT64* counter)
+{
+    return static_cast<UINT64>(InterlockedCompareExchange64(reinterpret_cast<volatile LONG64*>(const_cast<UINT64*>(counter)), 0, 0));
+}
+
+// Exclusive lock holder that adds the time spent blocked on the lock to a statistics counter.
+// The uncontended case costs a single TryAcquire and doesn't query the performance counter, and nothing is timed while
+// statistics are disabled.
+class TimedAutoReaderWriterLock
+{
+public:
+    _Acquires_exclusive_lock_(*this->m_srwLock) TimedAutoReaderWriterLock(_In_ SRWLOCK* srwLock, _Inout_ UINT64* waitTicks) : m_srwLock(srwLock)
+    {
+        if (!_DefAreStatisticsEnabled())
+        {
+            ::AcquireSRWLockExclusive(m_srwLock);
+        }
+        else if (!::TryAcquireSRWLockExclusive(m_srwLock))
+        {
+            LARGE_INTEGER start;
+            LARGE_INTEGER end;
+            ::QueryPerformanceCounter(&start);
+            ::AcquireSRWLockExclusive(m_srwLock);
+            ::QueryPerformanceCounter(&end);
+            IncrementStatistic(waitTicks, static_cast<UINT64>(end.QuadPart - start.QuadPart));
+        }
+    }
+
+    _Releases_exclusive_lock_(*this->m_srwLock) ~TimedAutoReaderWriterLock() { ::ReleaseSRWLockExclusive(m_srwLock); }
+
+private:
+    TimedAutoReaderWriterLock(_In_ const TimedAutoReaderWriterLock&);
+    TimedAutoReaderWriterLock& operator=(_In_ const TimedAutoReaderWriterLock&);
+
+    SRWLOCK* m_srwLock;
+};
+
 ResolverBase::ResolverBase(_In_ const UnifiedEnvironment* pEnvironment, _In_ const IDecisionInfo* pDecisions) :
-    m_pEnvironment(pEnvironment), m_pDecisions(pDecisions), m_pCache(NULL)
+    m_pEnvironment(pEnvironment), m_pDecisions(pDecisions), m_pCache(NULL), m_statistics{}
 {
     ::InitializeSRWLock(&m_srwLock);
     ::InitializeSRWLock(&m_srwQualifierSetLock);
@@ -1112,12 +1161,51 @@ HRESULT ResolverBase::Init()
     return S_OK;
 }
 
+void ResolverBase::GetStatistics(_Out_ RESOLVER_STATISTICS* statistics) const
+{
+    statistics->qualifierLookups = ReadStatistic(&m_statistics.qualifierLookups);
+    statistics->qualifierCacheHits = ReadStatistic(&m_statistics.qualifierCacheHits);
+    statistics->qualifierSetLookups = ReadStatistic(&m_statistics.qualifierSetLookups);
+    statistics->qualifierSetCacheHits = ReadStatistic(&m_statistics.qualifierSetCacheHits);
+    statistics->decisionLookups = ReadStatistic(&m_statistics.decisionLookups);
+    statistics->decisionCacheHits = ReadStatistic(&m_statistics.decisionCacheHits);
+    statistics->decisionEvaluations = ReadStatistic(&m_statistics.decisionEvaluations);
+    statistics->cacheResets = ReadStatistic(&m_statistics.cacheResets);
+    statistics->lockWaitTicks = ReadStatistic(&m_statistics.lockWaitTicks);
+    statistics->stringCopies = ReadStatistic(&m_statistics.stringCopies);
+    statistics->blobCopies = ReadStatistic(&m_statistics.blobCopies);
+    statistics->bytesCopied = ReadStatistic(&m_statistics.bytesCopied);
+}
+
+void ResolverBase::ResetStatistics()
+{
+    UINT64* counters = reinterpret_cast<UINT64*>(&m_statistics);
+    for (size_t i = 0; i < sizeof(m_statistics) / sizeof(UINT64); i++)
+    {
+        InterlockedExchange64(reinterpret_cast<volatile LONG64*>(&counters[i]), 0);
+    }
+}
+
+void ResolverBase::NoteStringCopy(_In_ size_t bytesCopied) const
+{
+    IncrementStatistic(&m_statistics.stringCopies);
+    IncrementStatistic(&m_statistics.bytesCopied, bytesCopied);
+}
+
+void ResolverBase::NoteBlobCopy(_In_ size_t bytesCopied) const
+{
+    IncrementStatistic(&m_statistics.blobCopies);
+    IncrementStatistic(&m_statistics.bytesCopied, bytesCopied);
+}
+
 void ResolverBase::Reset()
 {
+    IncrementStatistic(&m_statistics.cacheResets);
+
     // Frequent reset during evalueDecision can corrupt the cache.
     // Order is important here, m_srwLock -> m_srwQualifierSetLock -> m_srwQualifierLock.
     // We consider to have separate scope for respective m_srwLock and m_srwQualifierSetLock in future.
-    AutoReaderWriterLock autoLock(&m_srwLock);
+    TimedAutoReaderWriterLock autoLock(&m_srwLock, &m_statistics.lockWaitTicks);
     {
         AutoReaderWriterLock autoQualifierSetLock(&m_srwQualifierSetLock); // protect pResults object for potential race condition
         {
@@ -1135,10 +1223,12 @@ HRESULT ResolverBase::Reset(__in_ecount(numQualifierNames) Atom* pQualifierNames
     RETURN_HR_IF(
         E_INVALIDARG, (pQualifierNames == nullptr) || (numQualifierNames < 1) || (numQualifierNames > m_pDecisions->GetNumQualifiers()));
 
+    IncrementStatistic(&m_statistics.cacheResets);
+
     // Frequent reset during evalueDecision can corrupt the cache.
     // Order is important here, m_srwLock -> m_srwQualifierSetLock -> m_srwQualifierLock.
     // We consider to have separate scope for respective m_srwLock and m_srwQualifierSetLock in future.
-    AutoReaderWriterLock autoLock(&m_srwLock);
+    TimedAutoReaderWriterLock autoLock(&m_srwLock, &m_statistics.lockWaitTicks);
     {
         AutoReaderWriterLock autoQualifierSetLock(&m_srwQualifierSetLock); // protect pResults object for potential race condition
         {
@@ -1167,9 +1257,12 @@ HRESULT ResolverBase::EvaluateQualifier(_In_ const IQualifier* pQualifier, _Out_
 
 HRESULT ResolverBase::EvaluateQualifier(_In_ const IQualifier* pQualifier, _Out_ UINT16* pScoreOut, _Out_ UINT16* pFallbackScoreOut) const
 {
+    IncrementStatistic(&m_statistics.qualifierLookups);
+
     // Have we seen this qualifier before?
     if (SUCCEEDED(m_pCache->GetQualifierScores(pQualifier, pScoreOut, pFallbackScoreOut)))
     {
+        IncrementStatistic(&m_statistics.qualifierCacheHits);
         return S_OK;
     }
 
@@ -1183,7 +1276,7 @@ HRESULT ResolverBase::EvaluateQualifier(_In_ const IQualifier* pQualifier, _Out_
     StringResult value;
 
     // The method can be called by (1) under m_srwLock and m_srwQualifierSetLock exclusive lock, or (2) no lock
-    AutoReaderWriterLock autoLock(&m_srwQualifierLock);
+    TimedAutoReaderWriterLock autoLock(&m_srwQualifierLock, &m_statistics.lockWaitTicks);
 
     HRESULT hr = pQualifier->GetOperand1Attribute(&qualifierName);
     if (SUCCEEDED(hr))
@@ -1224,9 +1317,12 @@ HRESULT ResolverBase::EvaluateQualifierSet(
     _Out_ bool* pbIsMatchOrDefaultOut,
     _Out_opt_ UINT16* pScoreOut = NULL) const
 {
+    IncrementStatistic(&m_statistics.qualifierSetLookups);
+
     // Have we seen this qualifier set before
     if (SUCCEEDED(m_pCache->GetQualifierSetResults(pQualifierSet, pbIsMatchOut, pbIsDefaultOut, pbIsMatchOrDefaultOut, pScoreOut)))
     {
+        IncrementStatistic(&m_statistics.qualifierSetCacheHits);
         return S_OK;
     }
 
@@ -1242,7 +1338,7 @@ HRESULT ResolverBase::EvaluateQualifierSet(
     int lastQualifierPriority = 0;
 
     // The method can be called by (1) under m_srwLock exclusive lock, or (2) no lock
-    AutoReaderWriterLock autoLock(&m_srwQualifierSetLock);
+    TimedAutoReaderWriterLock autoLock(&m_srwQualifierSetLock, &m_statistics.lockWaitTicks);
 
     int numQualifiers = pQualifierSet->GetNumQualifiers();
     if (numQualifiers > 0)
@@ -1317,12 +1413,17 @@ HRESULT ResolverBase::EvaluateDecision(
     _Out_writes_(numResults) int* pResultIndexesOut,
     _Out_writes_(numResults) int* pResultSetIndexesOut) const
 {
-    AutoReaderWriterLock autoLock(&m_srwLock); // protect pResults object for potential race condition
+    IncrementStatistic(&m_statistics.decisionLookups);
+
+    TimedAutoReaderWriterLock autoLock(&m_srwLock, &m_statistics.lockWaitTicks); // protect pResults object for potential race condition
 
     if (SUCCEEDED(m_pCache->GetDecisionResults(pDecision, numResults, pResultIndexesOut, pResultSetIndexesOut)))
     {
+        IncrementStatistic(&m_statistics.decisionCacheHits);
         return S_OK;
     }
+
+    IncrementStatistic(&m_statistics.decisionEvaluations);
     int numSets = 0;
     DecisionInfoCache::DecisionPerSetInfo* pResults;
     RETURN_IF_FAILED(m_pCache->BeginSetDecisionResults(pDecision, &pResults, &numSets));
@@ -1076,7 +1076,8 @@ HRESULT ResourceMapSubtree::GetResource(_In_ PCWSTR pPath, _Inout_ NamedResource
 
     RETURN_HR_IF_EXPECTED(E_INVALIDARG, (pPath == nullptr) || (*pPath == 0));
 
-    if (!m_pSchema->Contains(pPath, m_scopeIndex, &schemaScopeIndex, &schemaItemIndex))
+    // Names that are known to be missing don't need to walk the schema.
+    if (!m_pSchema->MayContainItem(m_scopeIndex, pPath) || !m_pSchema->Contains(pPath, m_scopeIndex, &schemaScopeIndex, &schemaItemIndex))
     {
         return HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND);
     }
@@ -1435,7 +1436,7 @@ HRESULT ResourceMapBase::GetResource(_In_ PCWSTR pPath, _Inout_ NamedResourceRes
 
     RETURN_HR_IF_EXPECTED(E_INVALIDARG, (pPath == nullptr) || (*pPath == 0));
 
-    if (!m_pSchema->Contains(pPath, 0, &schemaScopeIndex, &schemaItemIndex))
+    if (!m_pSchema->MayContainItem(0, pPath) || !m_pSchema->Contains(pPath, 0, &schemaScopeIndex, &schemaItemIndex))
     {
         return HRESULT_FROM_WIN32(ERROR_MRM_NAMED_RESOURCE_NOT_FOUND);
     }
@@ -11,7 +11,7 @@ namespace Microsoft::Resources
 // Constructors
 StringResult::StringResult()
 {
-    DefStringResult_InitBuf(&m_string, NULL);
+    DefStringResult_InitWithStorage(&m_string, m_inlineBuffer, ARRAYSIZE(m_inlineBuffer));
     m_pString = &m_string;
 }
 
@@ -70,16 +70,26 @@ _Use_decl_annotations_ HRESULT StringResult::CreateInstance(DEFSTRINGRESULT* pSt
     return S_OK;
 }
 
+// The Init variants set contents in place rather than calling DefStringResult_Init*,
+// which would detach the result from its inline buffer.
 _Use_decl_annotations_ HRESULT StringResult::Init(PCWSTR pStr, DEFRESULTTYPE type)
 {
     m_pString = &m_string;
-    return DefStringResult_Init(&m_string, pStr, type);
+    if (type == DefResultType_Reference)
+    {
+        return DefStringResult_SetRef(&m_string, pStr);
+    }
+    if (type == DefResultType_Buffer)
+    {
+        return DefStringResult_SetCopy(&m_string, pStr);
+    }
+    return E_INVALIDARG;
 }
 
 _Use_decl_annotations_ HRESULT StringResult::Init(PCWSTR pStr)
 {
     m_pString = &m_string;
-    return DefStringResult_InitRef(&m_string, pStr);
+    return DefStringResult_SetRef(&m_string, pStr);
 }
 
 // Deep Copy
@@ -116,6 +126,13 @@ _Use_decl_annotations_ HRESULT StringResult::SetContentsFromOther(StringResult*
         RETURN_IF_FAILED(SetRef(pOther->GetRef()));
         RETURN_IF_FAILED(pOther->SetRef(NULL));
     }
+    else if ((pOther->GetType() == DEFRESULTTYPE::DefResultType_Buffer) && (pOther->GetRef() == pOther->m_inlineBuffer))
+    {
+        // pOther's contents live in its inline buffer, which can't be moved. Copying is
+        // cheaper than releasing, which would need a heap copy anyway.
+        RETURN_IF_FAILED(SetCopy(pOther->GetRef()));
+        RETURN_IF_FAILED(pOther->SetRef(NULL));
+    }
     else if (pOther->GetType() == DEFRESULTTYPE::DefResultType_Buffer)
     {
         // pOther has an internal buffer.
@@ -497,4 +514,6 @@ size_t StringResult::GetLength() const
     return length;
 }
 
+UINT64 StringResult::GetBufferAllocationCount() { return DefStringResult_GetBufferAllocationCount(); }
+
 } // namespace Microsoft::Resources
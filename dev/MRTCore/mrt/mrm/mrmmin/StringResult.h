@@ -15,6 +15,10 @@ HRESULT DefStringResult_InitRef(_Inout_ DEFSTRINGRESULT* pSelf, _In_opt_ PCWSTR
 
 HRESULT DefStringResult_InitBuf(_Inout_ DEFSTRINGRESULT* pSelf, _In_opt_ PCWSTR pInitStr);
 
+// Initializes an empty result that keeps contents of up to cchStorage characters in
+// pStorage and only allocates for longer strings.  pStorage must outlive pSelf.
+HRESULT DefStringResult_InitWithStorage(_Inout_ DEFSTRINGRESULT* pSelf, _Inout_updates_opt_(cchStorage) PWSTR pStorage, _In_ size_t cchStorage);
+
 // Returns a read-only ref to the result's contents.
 HRESULT DefStringResult_GetRef(_In_ const DEFSTRINGRESULT* pSelf, _Out_ PCWSTR* ref);
 
@@ -104,6 +108,10 @@ HRESULT DefStringResult_SetEmptyContents(_Inout_ DEFSTRINGRESULT* pSelf, _In_ si
  */
 HRESULT DefStringResult_ReleaseContents(_Inout_ DEFSTRINGRESULT* pSelf, _Outptr_result_buffer_(*pcchBufferOut) PWSTR* ppBufferOut, _Out_ size_t* pcchBufferOut);
 
+// Exchanges the contents of two results.  Each result keeps its own inline storage, so
+// contents held there are moved to a heap buffer first; fails only if that allocation fails.
+HRESULT _DefStringResult_Swap(_Inout_ DEFSTRINGRESULT* pSelf, _Inout_ DEFSTRINGRESULT* pOther);
+
 /*! Concatenates a str to the referenced str.
  * 
  * If the referenced str is external, it is first copied to an internal buffer.
@@ -200,6 +208,9 @@ HRESULT DefStringResult_ReplaceAll(_In_ DEFSTRINGRESULT* pSelf, _In_ WCHAR charT
  */
 HRESULT DefStringResult_SetCopyInteger(_In_ DEFSTRINGRESULT* pSelf, _In_ UINT32 nValue);
 
+//! Returns the number of string buffers allocated since the process started.
+UINT64 DefStringResult_GetBufferAllocationCount();
+
 #define DefStringResult_IsInvalid(SELF) \
         (((SELF) == NULL) || ((((SELF)->pBuf == NULL) && ((SELF)->cchBuf > 0)) || (((SELF)->cchBuf == 0) && ((SELF)->pBuf != NULL))) || \
          ((SELF)->cchBuf > DEFRESULT_MAX))
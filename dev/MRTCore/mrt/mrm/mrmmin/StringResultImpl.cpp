@@ -20,6 +20,46 @@ void* _Def_Inspect(__in void* pSelf, __in PCWSTR typeStr, Def_DescribeCallback d
     return pSelf;
 }
 
+// Number of string buffers allocated by this module, for diagnostics.
+static volatile LONG64 s_stringBufferAllocations = 0;
+
+static PWSTR _DefStringResult_AllocHeapBuffer(_In_ size_t cchBuf)
+{
+    if (_DefAreStatisticsEnabled())
+    {
+        InterlockedIncrement64(&s_stringBufferAllocations);
+    }
+    return _DefArray_AllocZeroed(WCHAR, cchBuf);
+}
+
+// Returns a buffer of at least cchBuf characters.  Uses the inline storage of pSelf
+// whenever it is big enough, which might mean returning the current buffer, and
+// allocates otherwise.
+static PWSTR _DefStringResult_AllocBuffer(_In_ const DEFSTRINGRESULT* pSelf, _In_ size_t cchBuf)
+{
+    if ((pSelf->pInline != nullptr) && (cchBuf <= pSelf->cchInline))
+    {
+        return pSelf->pInline;
+    }
+
+    return _DefStringResult_AllocHeapBuffer(cchBuf);
+}
+
+// Frees a buffer obtained from _DefStringResult_AllocBuffer.  Inline storage is owned
+// by the caller and is never freed.
+static void _DefStringResult_FreeBuffer(_In_ const DEFSTRINGRESULT* pSelf, _In_opt_ PWSTR pBuf)
+{
+    if ((pBuf != nullptr) && (pBuf != pSelf->pInline))
+    {
+        _DefFree(pBuf);
+    }
+}
+
+UINT64 DefStringResult_GetBufferAllocationCount()
+{
+    return static_cast<UINT64>(InterlockedCompareExchange64(&s_stringBufferAllocations, 0, 0));
+}
+
 HRESULT _DefStringResult_Alloc(_Outptr_ DEFSTRINGRESULT** result)
 {
     *result = _DefAllocZeroed(DEFSTRINGRESULT);
@@ -134,7 +174,7 @@ static HRESULT _DefStringResult_EnsureEmptyBuffer(_Inout_ DEFSTRINGRESULT* pSelf
         pOldBuf = pSelf->pBuf;
     }
 
-    pNewBuf = _DefArray_AllocZeroed(WCHAR, cchMinBufferSize);
+    pNewBuf = _DefStringResult_AllocBuffer(pSelf, cchMinBufferSize);
     if (pNewBuf == nullptr)
     {
         return E_OUTOFMEMORY;
@@ -145,9 +185,9 @@ static HRESULT _DefStringResult_EnsureEmptyBuffer(_Inout_ DEFSTRINGRESULT* pSelf
     pSelf->pBuf = pNewBuf;
     pSelf->cchBuf = (UINT32)cchMinBufferSize;
     pSelf->pRef = pSelf->pBuf;
-    if (pOldBuf)
+    if (pOldBuf != pNewBuf)
     {
-        Def_Free(pOldBuf);
+        _DefStringResult_FreeBuffer(pSelf, pOldBuf);
     }
 #pragma prefast(suppress : 26045, "_DefArray_AllocZeroed ensures len(pNewBuf) == cchMinBufferSize")
     return S_OK;
@@ -210,22 +250,24 @@ static HRESULT _DefStringResult_EnsureBuffer(_Inout_ DEFSTRINGRESULT* pSelf, _In
         return S_OK;
     }
 
-    pNewBuf = _DefArray_AllocZeroed(WCHAR, cchMinBufferSize);
+    pNewBuf = _DefStringResult_AllocBuffer(pSelf, cchMinBufferSize);
     if (pNewBuf == nullptr)
     {
         return E_OUTOFMEMORY;
     }
 
-    pNewBuf[0] = L'\0';
-
-    // Copy the previous contents
-    if (pSelf->pRef && pSelf->pRef[0])
+    // Copy the previous contents, unless the inline storage is being grown in place
+    if (pSelf->pRef != pNewBuf)
     {
-        hr = _DefStringCchCopy(pNewBuf, cchMinBufferSize, pSelf->pRef);
-        if (FAILED(hr))
+        pNewBuf[0] = L'\0';
+        if (pSelf->pRef && pSelf->pRef[0])
         {
-            Def_Free(pNewBuf);
-            return hr;
+            hr = _DefStringCchCopy(pNewBuf, cchMinBufferSize, pSelf->pRef);
+            if (FAILED(hr))
+            {
+                _DefStringResult_FreeBuffer(pSelf, pNewBuf);
+                return hr;
+            }
         }
     }
 
@@ -233,9 +275,9 @@ static HRESULT _DefStringResult_EnsureBuffer(_Inout_ DEFSTRINGRESULT* pSelf, _In
     pSelf->cchBuf = (UINT32)cchMinBufferSize;
     pSelf->pRef = pNewBuf;
 
-    if (pOldBuf)
+    if (pOldBuf != pNewBuf)
     {
-        Def_Free(pOldBuf);
+        _DefStringResult_FreeBuffer(pSelf, pOldBuf);
     }
 #pragma prefast(suppress : 26045, "_DefArray_AllocZeroed ensures len(pNewBuf) == cchMinBufferSize")
     return S_OK;
@@ -261,7 +303,7 @@ static HRESULT _DefStringResult_InitEmpty(_Inout_ DEFSTRINGRESULT* pSelf, _In_ s
     }
 
     // Not Empty
-    pTempStr = _DefArray_AllocZeroed(wchar_t, cchBuf);
+    pTempStr = _DefStringResult_AllocBuffer(pSelf, cchBuf);
     if (pTempStr == nullptr)
     {
         return E_OUTOFMEMORY;
@@ -283,6 +325,9 @@ DefStringResult_InitRef(_Inout_ DEFSTRINGRESULT* pSelf, _In_opt_ PCWSTR pStr)
         return E_INVALIDARG;
     }
 
+    pSelf->pInline = nullptr;
+    pSelf->cchInline = 0;
+
     HRESULT hr = _DefStringResult_InitEmpty(pSelf, 0);
     if (FAILED(hr))
     {
@@ -301,6 +346,9 @@ DefStringResult_InitBuf(_Inout_ DEFSTRINGRESULT* pSelf, _In_opt_ PCWSTR pInitStr
         return E_INVALIDARG;
     }
 
+    pSelf->pInline = nullptr;
+    pSelf->cchInline = 0;
+
     if (pInitStr == nullptr)
     {
         _DefStringResult_InitEmpty(pSelf, 0);
@@ -323,7 +371,7 @@ DefStringResult_InitBuf(_Inout_ DEFSTRINGRESULT* pSelf, _In_opt_ PCWSTR pInitStr
         else
         {
             // Alloc new buffer
-            PWSTR pNewBuf = _DefArray_AllocZeroed(wchar_t, cchInitStr);
+            PWSTR pNewBuf = _DefStringResult_AllocBuffer(pSelf, cchInitStr);
             if (pNewBuf == nullptr)
             {
                 return E_OUTOFMEMORY;
@@ -332,7 +380,7 @@ DefStringResult_InitBuf(_Inout_ DEFSTRINGRESULT* pSelf, _In_opt_ PCWSTR pInitStr
             hr = _DefStringCchCopy(pNewBuf, cchInitStr, pInitStr);
             if (FAILED(hr))
             {
-                _DefFree(pNewBuf);
+                _DefStringResult_FreeBuffer(pSelf, pNewBuf);
                 return hr;
             }
 
@@ -346,6 +394,19 @@ DefStringResult_InitBuf(_Inout_ DEFSTRINGRESULT* pSelf, _In_opt_ PCWSTR pInitStr
     return S_OK;
 }
 
+HRESULT
+DefStringResult_InitWithStorage(_Inout_ DEFSTRINGRESULT* pSelf, _Inout_updates_opt_(cchStorage) PWSTR pStorage, _In_ size_t cchStorage)
+{
+    if ((pSelf == nullptr) || ((pStorage == nullptr) && (cchStorage > 0)) || (cchStorage > DEFRESULT_MAX))
+    {
+        return E_INVALIDARG;
+    }
+
+    pSelf->pInline = ((cchStorage > 0) ? pStorage : nullptr);
+    pSelf->cchInline = (UINT32)cchStorage;
+    return _DefStringResult_InitEmpty(pSelf, 0);
+}
+
 HRESULT
 DefStringResult_GetCopy(_In_ const DEFSTRINGRESULT* pSelf, _Inout_ DEFSTRINGRESULT* pStringOut)
 {
@@ -692,8 +753,25 @@ DefStringResult_ReleaseContents(
         return E_INVALIDARG;
     }
 
-    *ppBufferOut = pSelf->pBuf;
-    *pcchBufferOut = pSelf->cchBuf;
+    if (pSelf->pBuf == pSelf->pInline)
+    {
+        // Inline storage belongs to the caller of InitWithStorage, so hand out a heap copy.
+        PWSTR pCopy = _DefStringResult_AllocHeapBuffer(pSelf->cchBuf);
+        if (pCopy == nullptr)
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        memcpy(pCopy, pSelf->pBuf, pSelf->cchBuf * sizeof(WCHAR));
+
+        *ppBufferOut = pCopy;
+        *pcchBufferOut = pSelf->cchBuf;
+    }
+    else
+    {
+        *ppBufferOut = pSelf->pBuf;
+        *pcchBufferOut = pSelf->cchBuf;
+    }
 
     return _DefStringResult_InitEmpty(pSelf, 0);
 }
@@ -706,6 +784,9 @@ _DefResultBuffer_Init(_Inout_ DEFSTRINGRESULT* pSelf, _In_opt_ PCWSTR pInitStr,
         return E_INVALIDARG;
     }
 
+    pSelf->pInline = nullptr;
+    pSelf->cchInline = 0;
+
     HRESULT hr = _DefStringResult_InitEmpty(pSelf, cchBuf);
     if (FAILED(hr))
     {
@@ -740,19 +821,42 @@ _DefStringResult_Swap(_Inout_ DEFSTRINGRESULT* pSelf, _Inout_ DEFSTRINGRESULT* p
         return S_OK;
     }
 
-    DEFSTRINGRESULT temp;
+    // Inline storage stays with the result that owns it, so contents that live there are
+    // copied to the heap before anything is exchanged.
+    DEFSTRINGRESULT temp[2] = { *pSelf, *pOther };
+    for (int i = 0; i < 2; i++)
+    {
+        DEFSTRINGRESULT* pResult = &temp[i];
+        if ((pResult->pBuf == nullptr) || (pResult->pBuf != pResult->pInline))
+        {
+            continue;
+        }
 
-    temp.cchBuf = pSelf->cchBuf;
-    temp.pBuf = pSelf->pBuf;
-    temp.pRef = pSelf->pRef;
+        PWSTR pCopy = _DefStringResult_AllocHeapBuffer(pResult->cchBuf);
+        if (pCopy == nullptr)
+        {
+            if ((i > 0) && (temp[0].pBuf != pSelf->pBuf))
+            {
+                _DefFree(temp[0].pBuf);
+            }
+            return E_OUTOFMEMORY;
+        }
+
+        memcpy(pCopy, pResult->pBuf, pResult->cchBuf * sizeof(WCHAR));
+        if ((pResult->pRef >= pResult->pBuf) && (pResult->pRef < pResult->pBuf + pResult->cchBuf))
+        {
+            pResult->pRef = pCopy + (pResult->pRef - pResult->pBuf);
+        }
+        pResult->pBuf = pCopy;
+    }
 
-    pSelf->cchBuf = pOther->cchBuf;
-    pSelf->pBuf = pOther->pBuf;
-    pSelf->pRef = pOther->pRef;
+    pSelf->cchBuf = temp[1].cchBuf;
+    pSelf->pBuf = temp[1].pBuf;
+    pSelf->pRef = temp[1].pRef;
 
-    pOther->cchBuf = temp.cchBuf;
-    pOther->pBuf = temp.pBuf;
-    pOther->pRef = temp.pRef;
+    pOther->cchBuf = temp[0].cchBuf;
+    pOther->pBuf = temp[0].pBuf;
+    pOther->pRef = temp[0].pRef;
 
     return S_OK;
 }
@@ -976,7 +1080,7 @@ DefStringResult_Clear(_Inout_ DEFSTRINGRESULT* pSelf, _In_ __BOOL releaseBuffer)
     pSelf->pRef = nullptr;
     if (pSelf->pBuf && releaseBuffer)
     {
-        _DefFree(pSelf->pBuf);
+        _DefStringResult_FreeBuffer(pSelf, pSelf->pBuf);
         pSelf->pBuf = nullptr;
         pSelf->cchBuf = 0;
     }
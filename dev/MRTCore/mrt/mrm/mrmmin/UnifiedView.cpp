@@ -461,6 +461,27 @@ HRESULT UnifiedResourceView::LoadPriFiles(
         pUnifiedViewFileInfoCollection = nullptr;
     });
 
+    if (uiNumPriFiles > 1)
+    {
+        // Map and validate all of the new files up front, in parallel.  This is best effort;
+        // any file that fails is loaded (and its failure reported) by GetOrAddFile below.
+        PCWSTR* ppPaths = _DefArray_AllocZeroed(PCWSTR, uiNumPriFiles);
+        if (ppPaths != nullptr)
+        {
+            for (UINT uItr = 0; uItr < uiNumPriFiles; uItr++)
+            {
+                StringResult* pStrFilePath;
+                if (SUCCEEDED(pFilePathsCollection->Get(uItr, &pStrFilePath)) && (pStrFilePath != nullptr))
+                {
+                    ppPaths[uItr] = pStrFilePath->GetRef();
+                }
+            }
+
+            (void)m_pFileManager->PrefetchFiles(static_cast<int>(uiNumPriFiles), ppPaths, nullptr, flags);
+            Def_Free(ppPaths);
+        }
+    }
+
     HRESULT hr = S_OK;
     for (UINT uItr = 0; uItr < uiNumPriFiles; uItr++)
     {
@@ -0,0 +1,340 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "StdAfx.h"
+
+namespace Microsoft::Resources
+{
+
+// Cache file layout: a VALIDATED_FILE_CACHE_HEADER followed by numEntries
+// VALIDATED_FILE_CACHE_ENTRY structures, each followed by cchPath characters
+// of path (not null-terminated).
+static const UINT32 ValidatedFileCacheMagic = 0x4356524d; // "MRVC"
+static const UINT32 ValidatedFileCacheVersion = 1;
+static const UINT32 MaxValidatedFilePathChars = 32767;
+
+typedef struct _VALIDATED_FILE_CACHE_HEADER
+{
+    UINT32 magic;
+    UINT32 version;
+    UINT32 numEntries;
+    UINT32 cbTotal;
+} VALIDATED_FILE_CACHE_HEADER;
+
+typedef struct _VALIDATED_FILE_CACHE_ENTRY
+{
+    UINT64 cbFile;
+    UINT64 lastWriteTime;
+    UINT32 layoutChecksum;
+    UINT32 cchPath;
+} VALIDATED_FILE_CACHE_ENTRY;
+
+HRESULT ValidatedFileCache::CreateInstance(__in PCWSTR pCacheFilePath, _Outptr_ ValidatedFileCache** result)
+{
+    *result = nullptr;
+    RETURN_HR_IF(E_INVALIDARG, DefString_IsEmpty(pCacheFilePath));
+
+    AutoDeletePtr<ValidatedFileCache> pRtrn = new ValidatedFileCache();
+    RETURN_IF_NULL_ALLOC(pRtrn);
+    RETURN_IF_FAILED(pRtrn->Init(pCacheFilePath));
+
+    *result = pRtrn.Detach();
+    return S_OK;
+}
+
+HRESULT ValidatedFileCache::Init(__in PCWSTR pCacheFilePath)
+{
+    RETURN_IF_FAILED(DefString_Dup(pCacheFilePath, &m_pCacheFilePath));
+
+    m_pEntries = _DefArray_AllocZeroed(Entry, MaxEntries);
+    RETURN_IF_NULL_ALLOC(m_pEntries);
+
+    // A missing or damaged cache just means every file gets fully validated again.
+    HRESULT hr = Load();
+    if (FAILED(hr))
+    {
+        for (int i = 0; i < m_numEntries; i++)
+        {
+            Def_Free(m_pEntries[i].pPath);
+            m_pEntries[i].pPath = nullptr;
+        }
+        m_numEntries = 0;
+        m_nextReplace = 0;
+        RETURN_HR_IF(hr, hr == E_OUTOFMEMORY);
+    }
+
+    return S_OK;
+}
+
+ValidatedFileCache::~ValidatedFileCache()
+{
+    if (m_pEntries != nullptr)
+    {
+        for (int i = 0; i < m_numEntries; i++)
+        {
+            Def_Free(m_pEntries[i].pPath);
+        }
+        Def_Free(m_pEntries);
+        m_pEntries = nullptr;
+    }
+
+    if (m_pCacheFilePath != nullptr)
+    {
+        Def_Free(m_pCacheFilePath);
+        m_pCacheFilePath = nullptr;
+    }
+}
+
+HRESULT ValidatedFileCache::ComputeKey(
+    __in PCWSTR pFilePath,
+    __in_bcount(cbData) const void* pData,
+    __in size_t cbData,
+    _Out_ Entry* pKeyOut)
+{
+    *pKeyOut = {};
+
+    RETURN_HR_IF(E_INVALIDARG, DefString_IsEmpty(pFilePath) || (pData == nullptr));
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_MRM_INVALID_PRI_FILE), cbData < sizeof(DEFFILE_HEADER));
+
+    // The key covers the header and TOC, which are already paged in to open the file.
+    const DEFFILE_HEADER* pHeader = static_cast<const DEFFILE_HEADER*>(pData);
+    UINT64 cbToc = static_cast<UINT64>(sizeof(DEFFILE_TOC_ENTRY)) * pHeader->sizeToc;
+    RETURN_HR_IF(
+        HRESULT_FROM_WIN32(ERROR_MRM_INVALID_PRI_FILE),
+        (pHeader->tocOffset < sizeof(DEFFILE_HEADER)) || ((pHeader->tocOffset + cbToc) > cbData));
+
+    WIN32_FILE_ATTRIBUTE_DATA attributes = {0};
+    RETURN_IF_WIN32_BOOL_FALSE_EXPECTED(GetFileAttributesExW(pFilePath, GetFileExInfoStandard, &attributes));
+
+    ULARGE_INTEGER tmp;
+    tmp.u.LowPart = attributes.nFileSizeLow;
+    tmp.u.HighPart = attributes.nFileSizeHigh;
+    pKeyOut->cbFile = tmp.QuadPart;
+
+    // The file changed between mapping it and reading its attributes
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_MRM_INVALID_PRI_FILE), pKeyOut->cbFile != cbData);
+
+    tmp.u.LowPart = attributes.ftLastWriteTime.dwLowDateTime;
+    tmp.u.HighPart = attributes.ftLastWriteTime.dwHighDateTime;
+    pKeyOut->lastWriteTime = tmp.QuadPart;
+
+    const BYTE* pBytes = static_cast<const BYTE*>(pData);
+    pKeyOut->layoutChecksum = DefChecksum::ComputeChecksum(0, pBytes, sizeof(DEFFILE_HEADER));
+    pKeyOut->layoutChecksum =
+        DefChecksum::ComputeChecksum(pKeyOut->layoutChecksum, &pBytes[pHeader->tocOffset], static_cast<UINT32>(cbToc));
+
+    RETURN_IF_FAILED(DefChecksum::ComputeStringChecksum(0, true, pFilePath, &pKeyOut->pathChecksum));
+
+    return S_OK;
+}
+
+bool ValidatedFileCache::IsValidated(__in PCWSTR pFilePath, __in_bcount(cbData) const void* pData, __in size_t cbData) const
+{
+    Entry key;
+    if (FAILED(ComputeKey(pFilePath, pData, cbData, &key)))
+    {
+        return false;
+    }
+
+    AcquireSRWLockShared(&m_lock);
+    auto releaseLock = wil::scope_exit([&] { ReleaseSRWLockShared(&m_lock); });
+
+    for (int i = 0; i < m_numEntries; i++)
+    {
+        const Entry* pEntry = &m_pEntries[i];
+        if ((pEntry->pathChecksum == key.pathChecksum) && (DefString_ICompare(pEntry->pPath, pFilePath) == Def_Equal))
+        {
+            return (pEntry->cbFile == key.cbFile) && (pEntry->lastWriteTime == key.lastWriteTime) &&
+                   (pEntry->layoutChecksum == key.layoutChecksum);
+        }
+    }
+
+    return false;
+}
+
+HRESULT ValidatedFileCache::NoteValidated(__in PCWSTR pFilePath, __in_bcount(cbData) const void* pData, __in size_t cbData)
+{
+    Entry key;
+    RETURN_IF_FAILED(ComputeKey(pFilePath, pData, cbData, &key));
+
+    AcquireSRWLockExclusive(&m_lock);
+    auto releaseLock = wil::scope_exit([&] { ReleaseSRWLockExclusive(&m_lock); });
+
+    RETURN_IF_FAILED(AddEntry(&key, pFilePath));
+    m_isDirty = true;
+
+    return S_OK;
+}
+
+// Caller must hold the lock exclusively.
+HRESULT ValidatedFileCache::AddEntry(__in const Entry* pKey, __in PCWSTR pFilePath)
+{
+    Entry* pEntry = nullptr;
+    for (int i = 0; (i < m_numEntries) && (pEntry == nullptr); i++)
+    {
+        if ((m_pEntries[i].pathChecksum == pKey->pathChecksum) && (DefString_ICompare(m_pEntries[i].pPath, pFilePath) == Def_Equal))
+        {
+            pEntry = &m_pEntries[i];
+        }
+    }
+
+    if (pEntry == nullptr)
+    {
+        PWSTR pPath;
+        RETURN_IF_FAILED(DefString_Dup(pFilePath, &pPath));
+
+        if (m_numEntries < MaxEntries)
+        {
+            pEntry = &m_pEntries[m_numEntries++];
+        }
+        else
+        {
+            // Full, so replace the oldest entry
+            pEntry = &m_pEntries[m_nextReplace];
+            m_nextReplace = (m_nextReplace + 1) % MaxEntries;
+            Def_Free(pEntry->pPath);
+        }
+        pEntry->pPath = pPath;
+    }
+
+    pEntry->cbFile = pKey->cbFile;
+    pEntry->lastWriteTime = pKey->lastWriteTime;
+    pEntry->layoutChecksum = pKey->layoutChecksum;
+    pEntry->pathChecksum = pKey->pathChecksum;
+
+    return S_OK;
+}
+
+HRESULT ValidatedFileCache::Load()
+{
+    WIN32_FILE_ATTRIBUTE_DATA attributes = {0};
+    if (!GetFileAttributesExW(m_pCacheFilePath, GetFileExInfoStandard, &attributes))
+    {
+        // No cache yet
+        return S_OK;
+    }
+
+    size_t cbData = 0;
+    VOID* pData = nullptr;
+    RETURN_IF_FAILED(BaseFile::LoadFileData(m_pCacheFilePath, &cbData, &pData));
+    unique_deffree_ptr<VOID> data(pData);
+
+    const BYTE* pBytes = static_cast<const BYTE*>(pData);
+    VALIDATED_FILE_CACHE_HEADER header;
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), cbData < sizeof(header));
+    memcpy(&header, pBytes, sizeof(header));
+
+    if ((header.magic != ValidatedFileCacheMagic) || (header.version != ValidatedFileCacheVersion))
+    {
+        // Written by a different version; it will be replaced on the next save.
+        return S_OK;
+    }
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), (header.cbTotal != cbData) || (header.numEntries > MaxEntries));
+
+    size_t offset = sizeof(header);
+    for (UINT32 i = 0; i < header.numEntries; i++)
+    {
+        VALIDATED_FILE_CACHE_ENTRY fileEntry;
+        RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), (cbData - offset) < sizeof(fileEntry));
+        memcpy(&fileEntry, &pBytes[offset], sizeof(fileEntry));
+        offset += sizeof(fileEntry);
+
+        size_t cbPath = fileEntry.cchPath * sizeof(WCHAR);
+        RETURN_HR_IF(
+            HRESULT_FROM_WIN32(ERROR_INVALID_DATA),
+            (fileEntry.cchPath == 0) || (fileEntry.cchPath > MaxValidatedFilePathChars) || ((cbData - offset) < cbPath));
+
+        PWSTR pPath = _DefArray_AllocZeroed(WCHAR, fileEntry.cchPath + 1);
+        RETURN_IF_NULL_ALLOC(pPath);
+        memcpy(pPath, &pBytes[offset], cbPath);
+        offset += cbPath;
+
+        Entry* pEntry = &m_pEntries[m_numEntries++];
+        pEntry->pPath = pPath;
+        pEntry->cbFile = fileEntry.cbFile;
+        pEntry->lastWriteTime = fileEntry.lastWriteTime;
+        pEntry->layoutChecksum = fileEntry.layoutChecksum;
+        RETURN_IF_FAILED(DefChecksum::ComputeStringChecksum(0, true, pPath, &pEntry->pathChecksum));
+    }
+
+    RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_INVALID_DATA), offset != cbData);
+
+    return S_OK;
+}
+
+HRESULT ValidatedFileCache::Save()
+{
+    AcquireSRWLockExclusive(&m_lock);
+    auto releaseLock = wil::scope_exit([&] { ReleaseSRWLockExclusive(&m_lock); });
+
+    if (!m_isDirty)
+    {
+        return S_OK;
+    }
+
+    size_t cbTotal = sizeof(VALIDATED_FILE_CACHE_HEADER);
+    for (int i = 0; i < m_numEntries; i++)
+    {
+        cbTotal += sizeof(VALIDATED_FILE_CACHE_ENTRY) + (wcslen(m_pEntries[i].pPath) * sizeof(WCHAR));
+    }
+    RETURN_HR_IF(E_INVALIDARG, cbTotal > MAXDWORD);
+
+    unique_deffree_ptr<BYTE> data(static_cast<BYTE*>(_DefBlob_AllocZeroed(cbTotal)));
+    RETURN_IF_NULL_ALLOC(data.get());
+
+    VALIDATED_FILE_CACHE_HEADER header = {ValidatedFileCacheMagic, ValidatedFileCacheVersion, 0, 0};
+    size_t offset = sizeof(header);
+    for (int i = 0; i < m_numEntries; i++)
+    {
+        const Entry* pEntry = &m_pEntries[i];
+        size_t cchPath = wcslen(pEntry->pPath);
+        if ((cchPath == 0) || (cchPath > MaxValidatedFilePathChars))
+        {
+            // Load would reject the whole cache, so leave this one out
+            continue;
+        }
+
+        VALIDATED_FILE_CACHE_ENTRY fileEntry = {pEntry->cbFile, pEntry->lastWriteTime, pEntry->layoutChecksum, static_cast<UINT32>(cchPath)};
+        memcpy(&data.get()[offset], &fileEntry, sizeof(fileEntry));
+        offset += sizeof(fileEntry);
+        memcpy(&data.get()[offset], pEntry->pPath, cchPath * sizeof(WCHAR));
+        offset += cchPath * sizeof(WCHAR);
+        header.numEntries++;
+    }
+    header.cbTotal = static_cast<UINT32>(offset);
+    memcpy(data.get(), &header, sizeof(header));
+
+    // Write a temporary file and move it into place, so that a reader never sees
+    // a partially written cache.
+    StringResult tempPath;
+    RETURN_IF_FAILED(tempPath.SetCopy(m_pCacheFilePath));
+    RETURN_IF_FAILED(tempPath.Concat(L".tmp"));
+
+    {
+        wil::unique_handle hfile(CreateFileW(tempPath.GetRef(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL));
+        RETURN_LAST_ERROR_IF(hfile.get() == INVALID_HANDLE_VALUE);
+
+        auto cleanupOnFailure = wil::scope_exit([&] {
+            hfile.reset();
+            DeleteFileW(tempPath.GetRef());
+        });
+
+        DWORD cbWritten = 0;
+        RETURN_LAST_ERROR_IF(WriteFile(hfile.get(), data.get(), header.cbTotal, &cbWritten, NULL) == 0);
+        RETURN_HR_IF(HRESULT_FROM_WIN32(ERROR_WRITE_FAULT), cbWritten != header.cbTotal);
+
+        cleanupOnFailure.release();
+    }
+
+    if (!MoveFileExW(tempPath.GetRef(), m_pCacheFilePath, MOVEFILE_REPLACE_EXISTING))
+    {
+        HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+        DeleteFileW(tempPath.GetRef());
+        return hr;
+    }
+
+    m_isDirty = false;
+    return S_OK;
+}
+
+} // namespace Microsoft::Resources
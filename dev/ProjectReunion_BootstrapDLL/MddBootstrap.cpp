@@ -7,6 +7,7 @@
 #include "MddBootstrapTest.h"
 
 #include "MsixDynamicDependency.h"
+#include "MddPackageGraphUpdate.h"
 
 #include "IDynamicDependencyLifetimeManager.h"
 
@@ -82,6 +83,12 @@ STDAPI MddBootstrapInitialize(
     wil::unique_process_heap_string packageDependencyId;
     THROW_IF_FAILED(MddTryCreatePackageDependency(nullptr, frameworkPackageInfo->packageFamilyName, minVersion, architectureFilter, lifetimeKind, nullptr, createOptions, &packageDependencyId));
     //
+    // Defer the package graph's PATH update until our temporary path addition is removed.
+    // PATH is then as the package graph last set it, so later adds can splice rather than rebuild it
+    MDD_PACKAGEGRAPHUPDATE_CONTEXT packageGraphUpdateContext{};
+    THROW_IF_FAILED(MddBeginPackageGraphUpdate(&packageGraphUpdateContext));
+    auto endPackageGraphUpdate{ wil::scope_exit([&]() { MddEndPackageGraphUpdate(packageGraphUpdateContext); }) };
+    //
     const MddAddPackageDependencyOptions addOptions{};
     MDD_PACKAGEDEPENDENCY_CONTEXT packageDependencyContext{};
     THROW_IF_FAILED(MddAddPackageDependency(packageDependencyId.get(), MDD_PACKAGE_DEPENDENCY_RANK_DEFAULT, addOptions, &packageDependencyContext, nullptr));
@@ -89,6 +96,7 @@ STDAPI MddBootstrapInitialize(
     // Remove out temporary path addition
     RemoveFrameworkFromPath(frameworkPackageInfo->path);
     dllDirectoryCookie.reset();
+    endPackageGraphUpdate.reset();
 
     g_lifetimeManager = lifetimeManager.detach();
     g_projectReunionDll = std::move(projectReunionDll);
@@ -17,6 +17,7 @@
 #include <thread>
 #include <mutex>
 #include <list>
+#include <memory>
 #include <stdexcept>
 
 #include <filesystem>
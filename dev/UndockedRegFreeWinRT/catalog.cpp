@@ -5,13 +5,18 @@
 
 #include "catalog.h"
 #include "TypeResolution.h"
+#include "frozenstringmap.h"
 
 #include <activation.h>
 #include <shlwapi.h>
 
+#include <deque>
+#include <unordered_set>
+
 #include <wrl.h>
 
 #include <../DynamicDependency/MddWinRT.h>
+#include <../DynamicDependency/PackageGraphManager.h>
 
 using namespace std;
 using namespace Microsoft::WRL;
@@ -23,8 +28,8 @@ extern "C"
     typedef HRESULT(__stdcall* activation_factory_type)(HSTRING, IActivationFactory**);
 }
 
-// Intentionally no class factory cache here. That would be excessive since
-// other layers already cache.
+// Agile factories are cached. Every RoGetActivationFactory in the process goes through the
+// detour, so avoiding a DllGetActivationFactory call per activation of a class pays off.
 struct component
 {
     wstring module_name;
@@ -32,9 +37,12 @@ struct component
     HMODULE handle = nullptr;
     activation_factory_type get_activation_factory;
     ABI::Windows::Foundation::ThreadingType threading_model;
+    wil::srwlock lock;
+    ComPtr<IActivationFactory> agile_factory;
 
     ~component()
     {
+        agile_factory.Reset();
         if (handle)
         {
             FreeLibrary(handle);
@@ -61,21 +69,95 @@ struct component
 
     HRESULT GetActivationFactory(HSTRING className, REFIID  iid, void** factory)
     {
-        RETURN_IF_FAILED(LoadModule());
-
-        IActivationFactory* ifactory = nullptr;
-        HRESULT hr = this->get_activation_factory(className, &ifactory);
-        // optimize for IActivationFactory?
-        if (SUCCEEDED(hr))
+        ComPtr<IActivationFactory> ifactory;
         {
-            hr = ifactory->QueryInterface(iid, factory);
-            ifactory->Release();
+            auto sharedLock = lock.lock_shared();
+            ifactory = agile_factory;
         }
-        return hr;
+        if (!ifactory)
+        {
+            activation_factory_type get_factory = nullptr;
+            {
+                auto exclusiveLock = lock.lock_exclusive();
+                RETURN_IF_FAILED(LoadModule());
+                get_factory = this->get_activation_factory;
+            }
+            RETURN_IF_FAILED(get_factory(className, &ifactory));
+
+            // Only agile factories can be shared across apartments
+            ComPtr<IAgileObject> agileObject;
+            if (SUCCEEDED(ifactory.As(&agileObject)))
+            {
+                auto exclusiveLock = lock.lock_exclusive();
+                if (!agile_factory)
+                {
+                    agile_factory = ifactory;
+                }
+            }
+        }
+        return ifactory->QueryInterface(iid, factory);
     }
 };
 
+// Activatable classes defined by the SxS manifests. Filled while the manifests are loaded, then
+// frozen into g_catalog which serves all lookups.
 static unordered_map<wstring, shared_ptr<component>> g_types;
+static UndockedRegFreeWinRT::FrozenStringMap<shared_ptr<component>> g_catalog;
+
+// Classes defined by neither the package graph nor the SxS manifests, e.g. OS classes outside the
+// Windows namespace. These would otherwise search both on every activation. The SxS catalog never
+// changes after it's frozen, so entries are only valid for the package graph's generation they
+// were found missing in.
+class UnregisteredClassCache
+{
+public:
+    bool Contains(std::wstring_view activatableClassId, UINT32 generationId)
+    {
+        auto sharedLock = m_lock.lock_shared();
+        return (m_generationId == generationId) && (m_classes.find(activatableClassId) != m_classes.end());
+    }
+
+    void Add(std::wstring_view activatableClassId, UINT32 generationId) noexcept try
+    {
+        auto exclusiveLock = m_lock.lock_exclusive();
+        if ((m_generationId != generationId) || (m_classes.size() >= c_maxClasses))
+        {
+            m_classes.clear();
+            m_storage.clear();
+            m_generationId = generationId;
+        }
+        if (m_classes.find(activatableClassId) == m_classes.end())
+        {
+            // m_classes refers to the strings in m_storage, which never move
+            m_storage.emplace_back(activatableClassId);
+            m_classes.insert(m_storage.back());
+        }
+    }
+    CATCH_LOG();
+
+private:
+    static constexpr size_t c_maxClasses = 4096;
+
+    wil::srwlock m_lock;
+    UINT32 m_generationId = 0;
+    std::unordered_set<std::wstring_view> m_classes;
+    std::deque<std::wstring> m_storage;
+};
+static UnregisteredClassCache g_unregisteredClasses;
+
+static std::wstring_view GetStringView(HSTRING value)
+{
+    UINT32 length = 0;
+    auto buffer = WindowsGetStringRawBuffer(value, &length);
+    return std::wstring_view(buffer, length);
+}
+
+void WinRTFreezeCatalog()
+{
+    std::vector<std::pair<std::wstring, shared_ptr<component>>> entries(g_types.begin(), g_types.end());
+    g_types.clear();
+    g_catalog = UndockedRegFreeWinRT::FrozenStringMap<shared_ptr<component>>(std::move(entries));
+}
 
 HRESULT LoadManifestFromPath(std::wstring path)
 {
@@ -299,10 +381,21 @@ HRESULT ParseActivatableClassTag(IXmlReader* xmlReader, PCWSTR fileName)
 
 HRESULT WinRTGetThreadingModel(HSTRING activatableClassId, ABI::Windows::Foundation::ThreadingType* threading_model)
 {
+    // Read the generation before searching so a concurrent package graph change invalidates what we find
+    const auto generationId{ MddCore::PackageGraphManager::GetGenerationId() };
+    if (g_unregisteredClasses.Contains(GetStringView(activatableClassId), generationId))
+    {
+        return REGDB_E_CLASSNOTREG;
+    }
+
     HRESULT hr{ WinRTGetThreadingModel_PackageGraph(activatableClassId, threading_model) };
     if (hr == REGDB_E_CLASSNOTREG)  // Not found
     {
         hr = WinRTGetThreadingModel_SxS(activatableClassId, threading_model);
+        if (hr == REGDB_E_CLASSNOTREG)
+        {
+            g_unregisteredClasses.Add(GetStringView(activatableClassId), generationId);
+        }
     }
     return hr;
 }
@@ -314,11 +407,10 @@ HRESULT WinRTGetThreadingModel_PackageGraph(HSTRING activatableClassId, ABI::Win
 
 HRESULT WinRTGetThreadingModel_SxS(HSTRING activatableClassId, ABI::Windows::Foundation::ThreadingType* threading_model)
 {
-    auto raw_class_name = WindowsGetStringRawBuffer(activatableClassId, nullptr);
-    auto component_iter = g_types.find(raw_class_name);
-    if (component_iter != g_types.end())
+    auto this_component = g_catalog.Find(GetStringView(activatableClassId));
+    if (this_component != nullptr)
     {
-        *threading_model = component_iter->second->threading_model;
+        *threading_model = (*this_component)->threading_model;
         return S_OK;
     }
     return REGDB_E_CLASSNOTREG;
@@ -329,13 +421,23 @@ HRESULT WinRTGetActivationFactory(
     REFIID iid,
     void** factory)
 {
+    const auto generationId{ MddCore::PackageGraphManager::GetGenerationId() };
+    if (g_unregisteredClasses.Contains(GetStringView(activatableClassId), generationId))
+    {
+        return REGDB_E_CLASSNOTREG;
+    }
+
     RETURN_IF_FAILED(WinRTGetActivationFactory_PackageGraph(activatableClassId, iid, factory));
     if (*factory == nullptr)    // Not found
     {
-        RETURN_IF_FAILED(WinRTGetActivationFactory_SxS(activatableClassId, iid, factory));
+        const HRESULT hr{ WinRTGetActivationFactory_SxS(activatableClassId, iid, factory) };
+        if (hr == REGDB_E_CLASSNOTREG)
+        {
+            g_unregisteredClasses.Add(GetStringView(activatableClassId), generationId);
+        }
+        RETURN_IF_FAILED(hr);
     }
     return S_OK;
-
 }
 
 HRESULT WinRTGetActivationFactory_PackageGraph(
@@ -352,11 +454,10 @@ HRESULT WinRTGetActivationFactory_SxS(
     REFIID iid,
     void** factory)
 {
-    auto raw_class_name = WindowsGetStringRawBuffer(activatableClassId, nullptr);
-    auto component_iter = g_types.find(raw_class_name);
-    if (component_iter != g_types.end())
+    auto this_component = g_catalog.Find(GetStringView(activatableClassId));
+    if (this_component != nullptr)
     {
-        return component_iter->second->GetActivationFactory(activatableClassId, iid, factory);
+        return (*this_component)->GetActivationFactory(activatableClassId, iid, factory);
     }
     return REGDB_E_CLASSNOTREG;
 }
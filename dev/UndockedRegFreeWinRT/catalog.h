@@ -15,6 +15,9 @@ HRESULT WinRTLoadComponentFromFilePath(PCWSTR manifestPath);
 
 HRESULT WinRTLoadComponentFromString(std::string_view xmlStringValue);
 
+// Build the lookup table from the loaded manifests. Call once, after all manifests are loaded.
+void WinRTFreezeCatalog();
+
 HRESULT ParseRootManifestFromXmlReaderInput(IUnknown* pInput);
 
 HRESULT ParseFileTag(IXmlReader* xmlReader);
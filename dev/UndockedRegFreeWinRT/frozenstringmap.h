@@ -0,0 +1,168 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace UndockedRegFreeWinRT
+{
+    // Immutable string-keyed map, built once and then only read. Keys are placed with a perfect hash
+    // (hash and displace: keys are grouped into buckets by one hash, then each bucket gets a seed
+    // for a second hash that sends all its keys to free slots) so a lookup is one string hash, two
+    // table reads and a single key comparison, with no allocation and no locking.
+    //
+    // Keys are case sensitive. Only uses the C++ standard library.
+    template <typename TValue>
+    class FrozenStringMap
+    {
+    public:
+        FrozenStringMap() = default;
+
+        // Keys must be unique.
+        explicit FrozenStringMap(std::vector<std::pair<std::wstring, TValue>>&& entries) :
+            m_entries(std::move(entries))
+        {
+            if (m_entries.empty())
+            {
+                return;
+            }
+
+            // A little slack (~80% load) keeps the seed search short
+            size_t slotCount = m_entries.size() + m_entries.size() / 4 + 1;
+            while (!TryBuild(slotCount))
+            {
+                slotCount += slotCount / 2;
+            }
+        }
+
+        const TValue* Find(std::wstring_view key) const
+        {
+            if (m_slots.empty())
+            {
+                return nullptr;
+            }
+            const uint64_t hash = Hash(key);
+            const auto seed = m_seeds[hash % m_seeds.size()];
+            const auto entryIndex = m_slots[Mix(hash, seed) % m_slots.size()];
+            if ((entryIndex == c_emptySlot) || (m_entries[entryIndex].first != key))
+            {
+                return nullptr;
+            }
+            return &m_entries[entryIndex].second;
+        }
+
+        size_t Size() const
+        {
+            return m_entries.size();
+        }
+
+        static uint64_t Hash(std::wstring_view key)
+        {
+            // 64-bit FNV-1a over the characters
+            uint64_t hash = 0xCBF29CE484222325ull;
+            for (const auto c : key)
+            {
+                hash ^= static_cast<uint64_t>(c);
+                hash *= 0x100000001B3ull;
+            }
+            return hash;
+        }
+
+    private:
+        static uint64_t Mix(uint64_t hash, uint32_t seed)
+        {
+            hash ^= static_cast<uint64_t>(seed) * 0x9E3779B97F4A7C15ull;
+            hash ^= hash >> 33;
+            hash *= 0xFF51AFD7ED558CCDull;
+            hash ^= hash >> 33;
+            return hash;
+        }
+
+        bool TryBuild(const size_t slotCount)
+        {
+            constexpr uint32_t c_maxSeed = 0x10000;
+
+            std::vector<uint64_t> hashes(m_entries.size());
+            for (size_t index = 0; index < m_entries.size(); ++index)
+            {
+                hashes[index] = Hash(m_entries[index].first);
+            }
+
+            // Place the biggest buckets first, while there's the most room
+            const size_t bucketCount = (m_entries.size() + 3) / 4;
+            std::vector<std::vector<uint32_t>> buckets(bucketCount);
+            for (size_t index = 0; index < m_entries.size(); ++index)
+            {
+                buckets[hashes[index] % bucketCount].push_back(static_cast<uint32_t>(index));
+            }
+            std::vector<size_t> bucketOrder(bucketCount);
+            for (size_t index = 0; index < bucketCount; ++index)
+            {
+                bucketOrder[index] = index;
+            }
+            std::stable_sort(bucketOrder.begin(), bucketOrder.end(),
+                [&](size_t left, size_t right) { return buckets[left].size() > buckets[right].size(); });
+
+            std::vector<uint32_t> seeds(bucketCount);
+            std::vector<uint32_t> slots(slotCount, c_emptySlot);
+            std::vector<size_t> candidateSlots;
+            for (const auto bucketIndex : bucketOrder)
+            {
+                const auto& bucket = buckets[bucketIndex];
+                if (bucket.empty())
+                {
+                    break;
+                }
+
+                uint32_t seed = 0;
+                for (; seed < c_maxSeed; ++seed)
+                {
+                    candidateSlots.clear();
+                    bool isPlaced = true;
+                    for (const auto entryIndex : bucket)
+                    {
+                        const auto slot = static_cast<size_t>(Mix(hashes[entryIndex], seed) % slotCount);
+                        if ((slots[slot] != c_emptySlot) ||
+                            (std::find(candidateSlots.begin(), candidateSlots.end(), slot) != candidateSlots.end()))
+                        {
+                            isPlaced = false;
+                            break;
+                        }
+                        candidateSlots.push_back(slot);
+                    }
+                    if (isPlaced)
+                    {
+                        break;
+                    }
+                }
+                if (seed == c_maxSeed)
+                {
+                    return false;
+                }
+
+                seeds[bucketIndex] = seed;
+                for (size_t index = 0; index < bucket.size(); ++index)
+                {
+                    slots[candidateSlots[index]] = bucket[index];
+                }
+            }
+
+            m_seeds = std::move(seeds);
+            m_slots = std::move(slots);
+            return true;
+        }
+
+    private:
+        static constexpr uint32_t c_emptySlot = UINT32_MAX;
+
+        std::vector<std::pair<std::wstring, TValue>> m_entries;
+        std::vector<uint32_t> m_seeds;
+        std::vector<uint32_t> m_slots;      // Index into m_entries, or c_emptySlot
+    };
+}
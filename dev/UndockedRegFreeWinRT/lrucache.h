@@ -0,0 +1,169 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace UndockedRegFreeWinRT
+{
+    // Thread safe least recently used cache. Keys are hashed to one of a fixed number of shards, each
+    // with its own lock, list (most recently used first) and index into the list, so lookups,
+    // promotion and eviction are O(1) and threads only contend when they hit the same shard.
+    // The capacity is split evenly across the shards and so is approximate when the keys aren't.
+    //
+    // Values are destroyed when evicted (e.g. a ComPtr releases its object) so they should be
+    // cheap to copy. Only uses the C++ standard library.
+    template <typename TKey, typename TValue, typename THash = std::hash<TKey>, typename TKeyEqual = std::equal_to<TKey>>
+    class LruCache
+    {
+    public:
+        struct Statistics
+        {
+            uint64_t hits;
+            uint64_t misses;
+            uint64_t evictions;
+        };
+
+        LruCache(size_t capacity, size_t shardCount = 8) :
+            m_shards(shardCount == 0 ? 1 : shardCount)
+        {
+            SetCapacity(capacity);
+        }
+
+        // Values beyond the new capacity are evicted (least recently used first).
+        void SetCapacity(size_t capacity)
+        {
+            const auto shardCapacity = (capacity + m_shards.size() - 1) / m_shards.size();
+            for (auto& shard : m_shards)
+            {
+                std::lock_guard<std::mutex> lock(shard.lock);
+                shard.capacity = shardCapacity;
+                TrimToCapacity(shard);
+            }
+        }
+
+        // Returns true and the value (now the most recently used) if the key is cached.
+        bool TryGet(const TKey& key, TValue& value)
+        {
+            auto& shard = GetShard(key);
+            std::lock_guard<std::mutex> lock(shard.lock);
+            const auto found = shard.index.find(key);
+            if (found == shard.index.end())
+            {
+                m_misses.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+            value = found->second->second;
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Cache the value unless the key's already cached (e.g. added by another thread after a
+        // TryGet miss). Returns the cached value either way.
+        TValue GetOrAdd(const TKey& key, const TValue& value)
+        {
+            auto& shard = GetShard(key);
+            std::lock_guard<std::mutex> lock(shard.lock);
+            const auto found = shard.index.find(key);
+            if (found != shard.index.end())
+            {
+                shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+                return found->second->second;
+            }
+            if (shard.capacity == 0)
+            {
+                return value;
+            }
+
+            shard.entries.emplace_front(key, value);
+            shard.index.emplace(key, shard.entries.begin());
+            TrimToCapacity(shard);
+            return value;
+        }
+
+        bool Remove(const TKey& key)
+        {
+            auto& shard = GetShard(key);
+            std::lock_guard<std::mutex> lock(shard.lock);
+            const auto found = shard.index.find(key);
+            if (found == shard.index.end())
+            {
+                return false;
+            }
+            shard.entries.erase(found->second);
+            shard.index.erase(found);
+            return true;
+        }
+
+        void Clear()
+        {
+            for (auto& shard : m_shards)
+            {
+                std::lock_guard<std::mutex> lock(shard.lock);
+                shard.index.clear();
+                shard.entries.clear();
+            }
+        }
+
+        size_t Size() const
+        {
+            size_t size = 0;
+            for (auto& shard : m_shards)
+            {
+                std::lock_guard<std::mutex> lock(shard.lock);
+                size += shard.entries.size();
+            }
+            return size;
+        }
+
+        Statistics GetStatistics() const
+        {
+            return Statistics{ m_hits.load(std::memory_order_relaxed),
+                               m_misses.load(std::memory_order_relaxed),
+                               m_evictions.load(std::memory_order_relaxed) };
+        }
+
+    private:
+        using Entries = std::list<std::pair<TKey, TValue>>;
+
+        struct Shard
+        {
+            mutable std::mutex lock;
+            size_t capacity{};
+            Entries entries;
+            std::unordered_map<TKey, typename Entries::iterator, THash, TKeyEqual> index;
+        };
+
+        Shard& GetShard(const TKey& key)
+        {
+            // The shard's index hashes the same key, so use the upper half of the hash for the shard
+            // and leave the lower bits (which the index's buckets use) evenly distributed
+            const size_t hash = THash{}(key);
+            return m_shards[(hash >> (sizeof(hash) * 4)) % m_shards.size()];
+        }
+
+        void TrimToCapacity(Shard& shard)
+        {
+            while (shard.entries.size() > shard.capacity)
+            {
+                shard.index.erase(shard.entries.back().first);
+                shard.entries.pop_back();
+                m_evictions.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        std::vector<Shard> m_shards;
+        std::atomic<uint64_t> m_hits{};
+        std::atomic<uint64_t> m_misses{};
+        std::atomic<uint64_t> m_evictions{};
+    };
+}
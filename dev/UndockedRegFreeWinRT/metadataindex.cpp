@@ -0,0 +1,365 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include <pch.h>
+
+#include "metadataindex.h"
+
+namespace
+{
+    constexpr uint32_t c_tdVisibilityMask{ 0x00000007 };
+    constexpr uint32_t c_tdPublic{ 0x00000001 };
+    constexpr uint32_t c_tdWindowsRuntime{ 0x00004000 };
+    constexpr std::string_view c_metadataFileExtension{ ".winmd" };
+
+    char ToLowerAscii(const char c)
+    {
+        return ((c >= 'A') && (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    bool StartsWithIgnoreCase(
+        std::string_view value,
+        std::string_view prefix)
+    {
+        if (value.size() < prefix.size())
+        {
+            return false;
+        }
+        for (size_t index=0; index < prefix.size(); ++index)
+        {
+            if (ToLowerAscii(value[index]) != ToLowerAscii(prefix[index]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool EqualsIgnoreCase(
+        std::string_view left,
+        std::string_view right)
+    {
+        return (left.size() == right.size()) && StartsWithIgnoreCase(left, right);
+    }
+
+    bool IsLess(
+        const UndockedRegFreeWinRT::MetadataIndex::Type& left,
+        const UndockedRegFreeWinRT::MetadataIndex::Type& right)
+    {
+        return left.fullName < right.fullName;
+    }
+
+    void AppendString(
+        std::string& strings,
+        const std::string& value,
+        uint32_t& offset,
+        uint32_t& length)
+    {
+        offset = static_cast<uint32_t>(strings.size());
+        length = static_cast<uint32_t>(value.size());
+        strings += value;
+    }
+
+    bool ReadString(
+        const char* strings,
+        const uint32_t stringsLength,
+        const uint32_t offset,
+        const uint32_t length,
+        std::string& value)
+    {
+        if ((offset > stringsLength) || (length > stringsLength - offset))
+        {
+            return false;
+        }
+        value.assign(strings + offset, length);
+        return true;
+    }
+}
+
+void UndockedRegFreeWinRT::MetadataIndex::AddFile(
+    const FileKey& key,
+    const uint8_t* data,
+    const size_t dataSize)
+{
+    std::vector<MetadataTypeDefinition> typeDefinitions;
+    if (!ReadMetadataTypeDefinitions(data, dataSize, typeDefinitions))
+    {
+        AddFile(key, false, {});
+        return;
+    }
+
+    std::vector<Type> types;
+    for (auto& typeDefinition : typeDefinitions)
+    {
+        if (((typeDefinition.flags & c_tdWindowsRuntime) != 0) &&
+            ((typeDefinition.flags & c_tdVisibilityMask) <= c_tdPublic))
+        {
+            types.push_back(Type{ std::move(typeDefinition.fullName), typeDefinition.token });
+        }
+    }
+    std::sort(types.begin(), types.end(), IsLess);
+    AddFile(key, true, std::move(types));
+}
+
+void UndockedRegFreeWinRT::MetadataIndex::AddFile(
+    const FileKey& key,
+    bool indexed,
+    std::vector<Type>&& types)
+{
+    File file;
+    file.key = key;
+    file.stemLength = key.name.size();
+    if ((key.name.size() >= c_metadataFileExtension.size()) &&
+        EqualsIgnoreCase(std::string_view(key.name).substr(key.name.size() - c_metadataFileExtension.size()), c_metadataFileExtension))
+    {
+        file.stemLength -= c_metadataFileExtension.size();
+    }
+    file.indexed = indexed;
+    file.types = std::move(types);
+    m_files.push_back(std::move(file));
+}
+
+UndockedRegFreeWinRT::MetadataIndex::FindResult UndockedRegFreeWinRT::MetadataIndex::Find(
+    std::string_view fullName,
+    size_t& fileIndex,
+    uint32_t& token) const
+{
+    fileIndex = 0;
+    token = 0;
+
+    // To resolve type SomeNamespace.B.C look in SomeNamespace.B.C.winmd, SomeNamespace.B.winmd and SomeNamespace.winmd
+    std::string_view stem{ fullName };
+    for (;;)
+    {
+        const auto file{ FindFileByStem(stem) };
+        if (file)
+        {
+            if (!file->indexed)
+            {
+                return FindResult::Unknown;
+            }
+            if (FindType(*file, fullName, token))
+            {
+                fileIndex = static_cast<size_t>(file - m_files.data());
+                return FindResult::Found;
+            }
+        }
+
+        const auto lastDot{ stem.rfind('.') };
+        if (lastDot == std::string_view::npos)
+        {
+            break;
+        }
+        stem = stem.substr(0, lastDot);
+    }
+
+    // Not a type, but it might be a namespace in a down-level file i.e. SomeNamespace.B.C*.winmd
+    bool isUnknown{};
+    for (const auto& file : m_files)
+    {
+        if (StartsWithIgnoreCase(std::string_view(file.key.name).substr(0, file.stemLength), fullName))
+        {
+            if (!file.indexed)
+            {
+                isUnknown = true;
+            }
+            else if (HasNamespace(file, fullName))
+            {
+                return FindResult::Namespace;
+            }
+        }
+    }
+    return isUnknown ? FindResult::Unknown : FindResult::NotFound;
+}
+
+bool UndockedRegFreeWinRT::MetadataIndex::IsCurrent(const std::vector<FileKey>& files) const
+{
+    if (files.size() != m_files.size())
+    {
+        return false;
+    }
+    for (size_t index=0; index < files.size(); ++index)
+    {
+        const auto& key{ m_files[index].key };
+        if ((files[index].name != key.name) ||
+            (files[index].size != key.size) ||
+            (files[index].lastWriteTime != key.lastWriteTime))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<uint8_t> UndockedRegFreeWinRT::MetadataIndex::Serialize() const
+{
+    std::string strings;
+    std::vector<IndexFileRecord> fileRecords;
+    std::vector<IndexTypeRecord> typeRecords;
+    fileRecords.reserve(m_files.size());
+    for (const auto& file : m_files)
+    {
+        IndexFileRecord fileRecord{};
+        fileRecord.size = file.key.size;
+        fileRecord.lastWriteTime = file.key.lastWriteTime;
+        AppendString(strings, file.key.name, fileRecord.nameOffset, fileRecord.nameLength);
+        fileRecord.firstType = static_cast<uint32_t>(typeRecords.size());
+        fileRecord.typeCount = static_cast<uint32_t>(file.types.size());
+        fileRecord.indexed = file.indexed ? 1 : 0;
+        fileRecords.push_back(fileRecord);
+
+        for (const auto& type : file.types)
+        {
+            IndexTypeRecord typeRecord{};
+            AppendString(strings, type.fullName, typeRecord.fullNameOffset, typeRecord.fullNameLength);
+            typeRecord.token = type.token;
+            typeRecords.push_back(typeRecord);
+        }
+    }
+
+    IndexHeader header{};
+    header.magic = c_magic;
+    header.version = c_version;
+    header.fileCount = static_cast<uint32_t>(fileRecords.size());
+    header.typeCount = static_cast<uint32_t>(typeRecords.size());
+    header.stringsLength = static_cast<uint32_t>(strings.size());
+
+    const size_t fileRecordsSize{ fileRecords.size() * sizeof(IndexFileRecord) };
+    const size_t typeRecordsSize{ typeRecords.size() * sizeof(IndexTypeRecord) };
+    std::vector<uint8_t> data(sizeof(header) + fileRecordsSize + typeRecordsSize + strings.size());
+    auto position{ data.data() };
+    memcpy(position, &header, sizeof(header));
+    position += sizeof(header);
+    if (fileRecordsSize > 0)
+    {
+        memcpy(position, fileRecords.data(), fileRecordsSize);
+        position += fileRecordsSize;
+    }
+    if (typeRecordsSize > 0)
+    {
+        memcpy(position, typeRecords.data(), typeRecordsSize);
+        position += typeRecordsSize;
+    }
+    if (!strings.empty())
+    {
+        memcpy(position, strings.data(), strings.size());
+    }
+    return data;
+}
+
+bool UndockedRegFreeWinRT::MetadataIndex::Deserialize(
+    const uint8_t* data,
+    const size_t dataSize,
+    MetadataIndex& index)
+{
+    index.m_files.clear();
+
+    IndexHeader header{};
+    if (dataSize < sizeof(header))
+    {
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if ((header.magic != c_magic) || (header.version != c_version))
+    {
+        return false;
+    }
+
+    // Does the layout fit the data?
+    size_t availableSize{ dataSize - sizeof(header) };
+    if (header.fileCount > availableSize / sizeof(IndexFileRecord))
+    {
+        return false;
+    }
+    const size_t fileRecordsSize{ static_cast<size_t>(header.fileCount) * sizeof(IndexFileRecord) };
+    availableSize -= fileRecordsSize;
+    if (header.typeCount > availableSize / sizeof(IndexTypeRecord))
+    {
+        return false;
+    }
+    const size_t typeRecordsSize{ static_cast<size_t>(header.typeCount) * sizeof(IndexTypeRecord) };
+    if (header.stringsLength != availableSize - typeRecordsSize)
+    {
+        return false;
+    }
+    const auto fileRecords{ data + sizeof(header) };
+    const auto typeRecords{ fileRecords + fileRecordsSize };
+    const auto strings{ reinterpret_cast<const char*>(typeRecords + typeRecordsSize) };
+
+    MetadataIndex loadedIndex;
+    for (uint32_t fileIndex=0; fileIndex < header.fileCount; ++fileIndex)
+    {
+        IndexFileRecord fileRecord{};
+        memcpy(&fileRecord, fileRecords + static_cast<size_t>(fileIndex) * sizeof(fileRecord), sizeof(fileRecord));
+
+        FileKey key;
+        key.size = fileRecord.size;
+        key.lastWriteTime = fileRecord.lastWriteTime;
+        if (!ReadString(strings, header.stringsLength, fileRecord.nameOffset, fileRecord.nameLength, key.name) ||
+            key.name.empty() ||
+            (fileRecord.firstType > header.typeCount) ||
+            (fileRecord.typeCount > header.typeCount - fileRecord.firstType))
+        {
+            return false;
+        }
+
+        std::vector<Type> types(fileRecord.typeCount);
+        for (uint32_t typeIndex=0; typeIndex < fileRecord.typeCount; ++typeIndex)
+        {
+            IndexTypeRecord typeRecord{};
+            memcpy(&typeRecord, typeRecords + static_cast<size_t>(fileRecord.firstType + typeIndex) * sizeof(typeRecord), sizeof(typeRecord));
+
+            auto& type{ types[typeIndex] };
+            type.token = typeRecord.token;
+            if (!ReadString(strings, header.stringsLength, typeRecord.fullNameOffset, typeRecord.fullNameLength, type.fullName) ||
+                type.fullName.empty() ||
+                ((typeIndex > 0) && IsLess(type, types[typeIndex - 1])))
+            {
+                return false;
+            }
+        }
+        loadedIndex.AddFile(key, fileRecord.indexed != 0, std::move(types));
+    }
+
+    index = std::move(loadedIndex);
+    return true;
+}
+
+const UndockedRegFreeWinRT::MetadataIndex::File* UndockedRegFreeWinRT::MetadataIndex::FindFileByStem(std::string_view stem) const
+{
+    for (const auto& file : m_files)
+    {
+        if (EqualsIgnoreCase(std::string_view(file.key.name).substr(0, file.stemLength), stem))
+        {
+            return &file;
+        }
+    }
+    return nullptr;
+}
+
+bool UndockedRegFreeWinRT::MetadataIndex::FindType(
+    const File& file,
+    std::string_view fullName,
+    uint32_t& token)
+{
+    const auto iterator{ std::lower_bound(file.types.begin(), file.types.end(), fullName,
+        [](const Type& type, std::string_view name) { return type.fullName < name; }) };
+    if ((iterator == file.types.end()) || (iterator->fullName != fullName))
+    {
+        return false;
+    }
+    token = iterator->token;
+    return true;
+}
+
+bool UndockedRegFreeWinRT::MetadataIndex::HasNamespace(
+    const File& file,
+    std::string_view fullName)
+{
+    // Types in the namespace sort together, immediately after its name and a '.'
+    std::string prefix{ fullName };
+    prefix += '.';
+    const auto iterator{ std::lower_bound(file.types.begin(), file.types.end(), prefix,
+        [](const Type& type, const std::string& name) { return type.fullName < name; }) };
+    return (iterator != file.types.end()) && (iterator->fullName.compare(0, prefix.size(), prefix) == 0);
+}
@@ -0,0 +1,135 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <string_view>
+
+#include "metadatareader.h"
+
+namespace UndockedRegFreeWinRT
+{
+    // Index of the Windows Runtime types defined by the .winmd files in a directory, so a type name
+    // can be resolved to its file and TypeDef without probing and opening candidate files.
+    //
+    // Find() follows the same rules as FindTypeInDirectory:
+    //   1. A type A.B.C is only looked up in A.B.C.winmd, A.B.winmd and A.winmd, in that order
+    //   2. Failing that, A.B.C is a namespace if any A.B.C*.winmd defines a type in it
+    // Only top-level types flagged tdWindowsRuntime are indexed; the others never match either rule.
+    //
+    // The index is identified by the files' names, sizes and last write times. Names are UTF-8 and
+    // file names compare case-insensitively for ASCII only, which covers .winmd naming in practice.
+    // Serialize() and Deserialize() only use the C++ standard library.
+    class MetadataIndex
+    {
+    public:
+        struct FileKey
+        {
+            std::string name;           // UTF-8 filename, without the directory
+            uint64_t size{};
+            uint64_t lastWriteTime{};
+        };
+
+        struct Type
+        {
+            std::string fullName;
+            uint32_t token{};
+        };
+
+        enum class FindResult
+        {
+            Found,
+            Namespace,
+            NotFound,
+            Unknown     // A candidate file couldn't be indexed. Search the directory instead
+        };
+
+        // Index a file. If data can't be read as metadata the file is recorded as not indexed,
+        // so lookups it could affect report FindResult::Unknown.
+        void AddFile(
+            const FileKey& key,
+            const uint8_t* data,
+            const size_t dataSize);
+
+        // fileIndex is the file's position in AddFile() order.
+        FindResult Find(
+            std::string_view fullName,
+            size_t& fileIndex,
+            uint32_t& token) const;
+
+        // True if the index was built from exactly these files, in this order.
+        bool IsCurrent(const std::vector<FileKey>& files) const;
+
+        size_t FileCount() const
+        {
+            return m_files.size();
+        }
+
+        std::vector<uint8_t> Serialize() const;
+
+        static bool Deserialize(
+            const uint8_t* data,
+            const size_t dataSize,
+            MetadataIndex& index);
+
+    private:
+        struct File
+        {
+            FileKey key;
+            size_t stemLength{};        // key.name without the .winmd extension
+            bool indexed{};
+            std::vector<Type> types;    // Sorted by fullName
+        };
+
+        void AddFile(
+            const FileKey& key,
+            bool indexed,
+            std::vector<Type>&& types);
+
+        const File* FindFileByStem(std::string_view stem) const;
+
+        static bool FindType(
+            const File& file,
+            std::string_view fullName,
+            uint32_t& token);
+
+        static bool HasNamespace(
+            const File& file,
+            std::string_view fullName);
+
+    private:
+        static constexpr uint32_t c_magic{ 0x5849444D };    // 'MDIX'
+        static constexpr uint32_t c_version{ 1 };
+
+        struct IndexHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t fileCount;
+            uint32_t typeCount;
+            uint32_t stringsLength;
+            uint32_t reserved;
+        };
+
+        struct IndexFileRecord
+        {
+            uint64_t size;
+            uint64_t lastWriteTime;
+            uint32_t nameOffset;
+            uint32_t nameLength;
+            uint32_t firstType;
+            uint32_t typeCount;
+            uint32_t indexed;
+            uint32_t reserved;
+        };
+
+        struct IndexTypeRecord
+        {
+            uint32_t fullNameOffset;
+            uint32_t fullNameLength;
+            uint32_t token;
+        };
+
+        std::vector<File> m_files;
+    };
+}
@@ -0,0 +1,395 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include <pch.h>
+
+#include "metadatareader.h"
+
+namespace
+{
+    // ECMA-335 II.22 metadata table ids
+    enum MetadataTable : uint32_t
+    {
+        Module = 0x00,
+        TypeRef = 0x01,
+        TypeDef = 0x02,
+        Field = 0x04,
+        MethodDef = 0x06,
+        ModuleRef = 0x1A,
+        TypeSpec = 0x1B,
+        AssemblyRef = 0x23,
+        TableCount = 0x40
+    };
+
+    constexpr uint32_t c_peCliHeaderDirectory{ 14 };
+    constexpr uint32_t c_metadataSignature{ 0x424A5342 };   // 'BSJB'
+    constexpr uint8_t c_heapSizesLargeStrings{ 0x01 };
+    constexpr uint8_t c_heapSizesLargeGuids{ 0x02 };
+    constexpr uint8_t c_heapSizesExtraData{ 0x40 };
+
+    // Bounds checked little-endian view of a byte range
+    class ByteReader
+    {
+    public:
+        ByteReader(const uint8_t* data, const size_t dataSize) :
+            m_data(data),
+            m_dataSize(dataSize)
+        {
+        }
+
+        bool Contains(const size_t offset, const size_t size) const
+        {
+            return (offset <= m_dataSize) && (size <= m_dataSize - offset);
+        }
+
+        template <typename T>
+        bool Read(const size_t offset, T& value) const
+        {
+            static_assert(std::is_unsigned<T>::value, "Unsigned integers only");
+            if (!Contains(offset, sizeof(T)))
+            {
+                return false;
+            }
+            value = 0;
+            for (size_t index=0; index < sizeof(T); ++index)
+            {
+                value |= static_cast<T>(static_cast<T>(m_data[offset + index]) << (8 * index));
+            }
+            return true;
+        }
+
+        // 2 or 4 byte table/heap index
+        bool ReadIndex(const size_t offset, const uint32_t indexSize, uint32_t& value) const
+        {
+            if (indexSize == 2)
+            {
+                uint16_t value16{};
+                if (!Read(offset, value16))
+                {
+                    return false;
+                }
+                value = value16;
+                return true;
+            }
+            return Read(offset, value);
+        }
+
+        ByteReader Slice(const size_t offset, const size_t size) const
+        {
+            return Contains(offset, size) ? ByteReader(m_data + offset, size) : ByteReader(nullptr, 0);
+        }
+
+        const uint8_t* Data() const
+        {
+            return m_data;
+        }
+
+        size_t Size() const
+        {
+            return m_dataSize;
+        }
+
+    private:
+        const uint8_t* m_data;
+        size_t m_dataSize;
+    };
+
+    // Map a relative virtual address to its offset in the file
+    bool RvaToOffset(
+        const ByteReader& image,
+        const size_t sectionHeadersOffset,
+        const uint16_t sectionCount,
+        const uint32_t rva,
+        size_t& offset)
+    {
+        constexpr size_t c_sectionHeaderSize{ 40 };
+        for (uint16_t index=0; index < sectionCount; ++index)
+        {
+            const auto sectionHeaderOffset{ sectionHeadersOffset + index * c_sectionHeaderSize };
+            uint32_t virtualSize{};
+            uint32_t virtualAddress{};
+            uint32_t sizeOfRawData{};
+            uint32_t pointerToRawData{};
+            if (!image.Read(sectionHeaderOffset + 8, virtualSize) ||
+                !image.Read(sectionHeaderOffset + 12, virtualAddress) ||
+                !image.Read(sectionHeaderOffset + 16, sizeOfRawData) ||
+                !image.Read(sectionHeaderOffset + 20, pointerToRawData))
+            {
+                return false;
+            }
+            const auto sectionSize{ (std::max)(virtualSize, sizeOfRawData) };
+            if ((rva >= virtualAddress) && (rva - virtualAddress < sectionSize))
+            {
+                offset = static_cast<size_t>(pointerToRawData) + (rva - virtualAddress);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Find the metadata root (ECMA-335 II.24.2.1) in a PE/COFF image
+    bool FindMetadataRoot(
+        const ByteReader& image,
+        ByteReader& metadata)
+    {
+        uint16_t dosSignature{};
+        uint32_t peHeaderOffset{};
+        if (!image.Read(0, dosSignature) || (dosSignature != 0x5A4D) ||     // 'MZ'
+            !image.Read(0x3C, peHeaderOffset))
+        {
+            return false;
+        }
+
+        uint32_t peSignature{};
+        uint16_t sectionCount{};
+        uint16_t optionalHeaderSize{};
+        if (!image.Read(peHeaderOffset, peSignature) || (peSignature != 0x00004550) ||   // 'PE\0\0'
+            !image.Read(peHeaderOffset + 6, sectionCount) ||
+            !image.Read(peHeaderOffset + 20, optionalHeaderSize))
+        {
+            return false;
+        }
+
+        const size_t optionalHeaderOffset{ static_cast<size_t>(peHeaderOffset) + 24 };
+        uint16_t optionalHeaderMagic{};
+        if (!image.Read(optionalHeaderOffset, optionalHeaderMagic))
+        {
+            return false;
+        }
+        size_t dataDirectoriesOffset{};
+        size_t dataDirectoryCountOffset{};
+        if (optionalHeaderMagic == 0x10B)           // PE32
+        {
+            dataDirectoryCountOffset = optionalHeaderOffset + 92;
+            dataDirectoriesOffset = optionalHeaderOffset + 96;
+        }
+        else if (optionalHeaderMagic == 0x20B)      // PE32+
+        {
+            dataDirectoryCountOffset = optionalHeaderOffset + 108;
+            dataDirectoriesOffset = optionalHeaderOffset + 112;
+        }
+        else
+        {
+            return false;
+        }
+
+        uint32_t dataDirectoryCount{};
+        uint32_t cliHeaderRva{};
+        if (!image.Read(dataDirectoryCountOffset, dataDirectoryCount) || (dataDirectoryCount <= c_peCliHeaderDirectory) ||
+            !image.Read(dataDirectoriesOffset + c_peCliHeaderDirectory * 8, cliHeaderRva) || (cliHeaderRva == 0))
+        {
+            return false;
+        }
+
+        const size_t sectionHeadersOffset{ optionalHeaderOffset + optionalHeaderSize };
+        size_t cliHeaderOffset{};
+        uint32_t metadataRva{};
+        uint32_t metadataSize{};
+        size_t metadataOffset{};
+        if (!RvaToOffset(image, sectionHeadersOffset, sectionCount, cliHeaderRva, cliHeaderOffset) ||
+            !image.Read(cliHeaderOffset + 8, metadataRva) ||
+            !image.Read(cliHeaderOffset + 12, metadataSize) ||
+            !RvaToOffset(image, sectionHeadersOffset, sectionCount, metadataRva, metadataOffset) ||
+            !image.Contains(metadataOffset, metadataSize))
+        {
+            return false;
+        }
+
+        metadata = image.Slice(metadataOffset, metadataSize);
+        uint32_t metadataSignature{};
+        return metadata.Read(0, metadataSignature) && (metadataSignature == c_metadataSignature);
+    }
+
+    // Find the #~ and #Strings streams (ECMA-335 II.24.2.2)
+    bool FindMetadataStreams(
+        const ByteReader& metadata,
+        ByteReader& tables,
+        ByteReader& strings)
+    {
+        uint32_t versionLength{};
+        if (!metadata.Read(12, versionLength) || (versionLength > metadata.Size()))
+        {
+            return false;
+        }
+        size_t offset{ 16 + static_cast<size_t>(versionLength) };
+        uint16_t streamCount{};
+        if (!metadata.Read(offset + 2, streamCount))
+        {
+            return false;
+        }
+        offset += 4;
+
+        bool foundTables{};
+        bool foundStrings{};
+        for (uint16_t index=0; index < streamCount; ++index)
+        {
+            uint32_t streamOffset{};
+            uint32_t streamSize{};
+            if (!metadata.Read(offset, streamOffset) || !metadata.Read(offset + 4, streamSize))
+            {
+                return false;
+            }
+            offset += 8;
+
+            // Null terminated ASCII name, padded to a multiple of 4 bytes
+            std::string name;
+            for (;; ++offset)
+            {
+                uint8_t c{};
+                if (!metadata.Read(offset, c))
+                {
+                    return false;
+                }
+                if (c == 0)
+                {
+                    break;
+                }
+                name += static_cast<char>(c);
+            }
+            offset = (offset + 4) & ~static_cast<size_t>(3);
+
+            if (!metadata.Contains(streamOffset, streamSize))
+            {
+                return false;
+            }
+            if ((name == "#~") || (name == "#-"))
+            {
+                tables = metadata.Slice(streamOffset, streamSize);
+                foundTables = true;
+            }
+            else if (name == "#Strings")
+            {
+                strings = metadata.Slice(streamOffset, streamSize);
+                foundStrings = true;
+            }
+        }
+        return foundTables && foundStrings;
+    }
+
+    bool ReadString(
+        const ByteReader& strings,
+        const uint32_t index,
+        std::string& value)
+    {
+        if (index >= strings.Size())
+        {
+            return false;
+        }
+        const auto begin{ reinterpret_cast<const char*>(strings.Data()) + index };
+        const auto end{ static_cast<const char*>(memchr(begin, '\0', strings.Size() - index)) };
+        if (!end)
+        {
+            return false;
+        }
+        value.assign(begin, end);
+        return true;
+    }
+
+    uint32_t GetIndexSize(
+        const uint32_t (&rowCounts)[MetadataTable::TableCount],
+        const MetadataTable table)
+    {
+        return rowCounts[table] < 0x10000 ? 2 : 4;
+    }
+
+    uint32_t GetCodedIndexSize(
+        const uint32_t (&rowCounts)[MetadataTable::TableCount],
+        std::initializer_list<MetadataTable> tables)
+    {
+        uint32_t tagBits{};
+        while ((1u << tagBits) < tables.size())
+        {
+            ++tagBits;
+        }
+        uint32_t maxRowCount{};
+        for (auto table : tables)
+        {
+            maxRowCount = (std::max)(maxRowCount, rowCounts[table]);
+        }
+        return maxRowCount < (1u << (16 - tagBits)) ? 2 : 4;
+    }
+}
+
+bool UndockedRegFreeWinRT::ReadMetadataTypeDefinitions(
+    const uint8_t* data,
+    const size_t dataSize,
+    std::vector<MetadataTypeDefinition>& typeDefinitions)
+{
+    typeDefinitions.clear();
+
+    ByteReader metadata{ nullptr, 0 };
+    ByteReader tables{ nullptr, 0 };
+    ByteReader strings{ nullptr, 0 };
+    if (!FindMetadataRoot(ByteReader(data, dataSize), metadata) ||
+        !FindMetadataStreams(metadata, tables, strings))
+    {
+        return false;
+    }
+
+    // #~ stream header (ECMA-335 II.24.2.6)
+    uint8_t heapSizes{};
+    uint64_t validTables{};
+    if (!tables.Read(6, heapSizes) || !tables.Read(8, validTables))
+    {
+        return false;
+    }
+    uint32_t rowCounts[MetadataTable::TableCount]{};
+    size_t offset{ 24 };
+    for (uint32_t table=0; table < MetadataTable::TableCount; ++table)
+    {
+        if ((validTables & (1ull << table)) != 0)
+        {
+            if (!tables.Read(offset, rowCounts[table]))
+            {
+                return false;
+            }
+            offset += 4;
+        }
+    }
+    if ((heapSizes & c_heapSizesExtraData) != 0)
+    {
+        offset += 4;
+    }
+
+    // Tables are stored in id order so TypeDef follows Module and TypeRef
+    const uint32_t stringIndexSize{ (heapSizes & c_heapSizesLargeStrings) != 0 ? 4u : 2u };
+    const uint32_t guidIndexSize{ (heapSizes & c_heapSizesLargeGuids) != 0 ? 4u : 2u };
+    const uint32_t moduleRowSize{ 2 + stringIndexSize + 3 * guidIndexSize };
+    const uint32_t typeRefRowSize{ GetCodedIndexSize(rowCounts, { MetadataTable::Module, MetadataTable::ModuleRef, MetadataTable::AssemblyRef, MetadataTable::TypeRef }) +
+                                   2 * stringIndexSize };
+    const uint32_t typeDefRowSize{ 4 + 2 * stringIndexSize +
+                                   GetCodedIndexSize(rowCounts, { MetadataTable::TypeDef, MetadataTable::TypeRef, MetadataTable::TypeSpec }) +
+                                   GetIndexSize(rowCounts, MetadataTable::Field) +
+                                   GetIndexSize(rowCounts, MetadataTable::MethodDef) };
+    offset += static_cast<size_t>(rowCounts[MetadataTable::Module]) * moduleRowSize;
+    offset += static_cast<size_t>(rowCounts[MetadataTable::TypeRef]) * typeRefRowSize;
+
+    const auto typeDefCount{ rowCounts[MetadataTable::TypeDef] };
+    if (!tables.Contains(offset, static_cast<size_t>(typeDefCount) * typeDefRowSize))
+    {
+        return false;
+    }
+
+    std::vector<MetadataTypeDefinition> definitions(typeDefCount);
+    std::string name;
+    std::string typeNamespace;
+    for (uint32_t row=0; row < typeDefCount; ++row, offset += typeDefRowSize)
+    {
+        auto& definition{ definitions[row] };
+        uint32_t nameIndex{};
+        uint32_t namespaceIndex{};
+        if (!tables.Read(offset, definition.flags) ||
+            !tables.ReadIndex(offset + 4, stringIndexSize, nameIndex) ||
+            !tables.ReadIndex(offset + 4 + stringIndexSize, stringIndexSize, namespaceIndex) ||
+            !ReadString(strings, nameIndex, name) ||
+            !ReadString(strings, namespaceIndex, typeNamespace))
+        {
+            return false;
+        }
+        definition.token = (static_cast<uint32_t>(MetadataTable::TypeDef) << 24) | (row + 1);
+        definition.fullName = typeNamespace.empty() ? name : typeNamespace + "." + name;
+    }
+
+    typeDefinitions = std::move(definitions);
+    return true;
+}
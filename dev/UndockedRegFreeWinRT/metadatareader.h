@@ -0,0 +1,30 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace UndockedRegFreeWinRT
+{
+    // A TypeDef row of an ECMA-335 metadata file (e.g. a .winmd).
+    struct MetadataTypeDefinition
+    {
+        std::string fullName;   // UTF-8 "Namespace.Name" (or just "Name" if it has no namespace)
+        uint32_t token{};       // mdTypeDef
+        uint32_t flags{};       // CorTypeAttr
+    };
+
+    // Minimal reader for the TypeDef table of an ECMA-335 (CLI) image, i.e. the PE/COFF file ->
+    // CLI header -> metadata root -> #~ and #Strings streams. It's a substitute for opening an
+    // IMetaDataImport2 scope when all that's needed is the list of type names, so it only uses
+    // the C++ standard library and can be exercised against any .winmd off Windows.
+    //
+    // data is the entire file as laid out on disk. Returns false if it isn't a well formed image.
+    bool ReadMetadataTypeDefinitions(
+        const uint8_t* data,
+        const size_t dataSize,
+        std::vector<MetadataTypeDefinition>& typeDefinitions);
+}
@@ -5,7 +5,9 @@
 
 #include "TypeResolution.h"
 #include "catalog.h"
+#include "metadataindex.h"
 
+#include <shlobj.h>
 #include <wrl.h>
 
 #define METADATA_FILE_EXTENSION L"winmd"
@@ -56,6 +58,280 @@ namespace UndockedRegFreeWinRT
         return S_OK;
     }
 
+    // The .winmd files in the exe directory, indexed by type name. Built (or loaded from the index
+    // persisted by a previous process) on first use and kept for the lifetime of the process.
+    struct ExeDirMetadataIndex
+    {
+        std::wstring directoryPath;             // Terminated by a backslash
+        std::vector<std::wstring> filenames;    // In MetadataIndex file order
+        MetadataIndex index;
+    };
+    static ExeDirMetadataIndex* g_exeDirMetadataIndex;
+
+    // Indexes bigger than this aren't ours.
+    static const uint64_t c_maxMetadataIndexFileSize = 64 * 1024 * 1024;
+
+    std::string ToUtf8(_In_ PCWSTR value)
+    {
+        const int valueLength = static_cast<int>(wcslen(value));
+        if (valueLength == 0)
+        {
+            return std::string();
+        }
+        const int length = WideCharToMultiByte(CP_UTF8, 0, value, valueLength, nullptr, 0, nullptr, nullptr);
+        THROW_LAST_ERROR_IF(length == 0);
+        std::string utf8(length, '\0');
+        THROW_LAST_ERROR_IF(WideCharToMultiByte(CP_UTF8, 0, value, valueLength, utf8.data(), length, nullptr, nullptr) == 0);
+        return utf8;
+    }
+
+    // 64-bit FNV-1a. Only used to name the index file, so it needn't be stable across versions.
+    uint64_t HashDirectoryPath(const std::wstring& directoryPath)
+    {
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for (const auto c : directoryPath)
+        {
+            hash ^= static_cast<uint64_t>(c);
+            hash *= 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    std::filesystem::path GetMetadataIndexFilename(const std::wstring& directoryPath)
+    {
+        wil::unique_cotaskmem_ptr<WCHAR[]> folderPath;
+        THROW_IF_FAILED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, nullptr, wil::out_param(folderPath)));
+
+        // Paths are case insensitive
+        std::wstring directory{ directoryPath };
+        CharLowerBuffW(directory.data(), static_cast<DWORD>(directory.length()));
+        const auto directoryHash = HashDirectoryPath(directory);
+
+        std::filesystem::path path{ folderPath.get() };
+        path /= L"Microsoft\\ProjectReunion\\WinRTMetadataIndex";
+        path /= wil::str_printf<std::wstring>(L"%016I64X.bin", directoryHash);
+        return path;
+    }
+
+    bool TryLoadMetadataIndex(
+        const std::filesystem::path& indexFilename,
+        const std::vector<MetadataIndex::FileKey>& files,
+        MetadataIndex& index) noexcept try
+    {
+        wil::unique_hfile file{ CreateFileW(indexFilename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        if (!file)
+        {
+            // Not indexed (yet)
+            return false;
+        }
+
+        LARGE_INTEGER fileSize{};
+        THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &fileSize));
+        if ((fileSize.QuadPart == 0) || (static_cast<uint64_t>(fileSize.QuadPart) > c_maxMetadataIndexFileSize))
+        {
+            return false;
+        }
+
+        wil::unique_handle mapping{ CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr) };
+        THROW_LAST_ERROR_IF_NULL(mapping);
+        wil::unique_mapview_ptr<uint8_t> view{ static_cast<uint8_t*>(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0)) };
+        THROW_LAST_ERROR_IF_NULL(view);
+
+        // Stale or damaged indexes are rebuilt by the caller
+        return MetadataIndex::Deserialize(view.get(), static_cast<size_t>(fileSize.QuadPart), index) && index.IsCurrent(files);
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        return false;
+    }
+
+    void SaveMetadataIndex(
+        const std::filesystem::path& indexFilename,
+        const MetadataIndex& index) noexcept try
+    {
+        const auto data = index.Serialize();
+        std::filesystem::create_directories(indexFilename.parent_path());
+
+        // Write to a temporary file then move it into place so readers never see a partial index
+        auto tempFilename{ indexFilename };
+        tempFilename += wil::str_printf<std::wstring>(L".%u.%u.tmp", GetCurrentProcessId(), GetCurrentThreadId());
+        {
+            wil::unique_hfile file{ CreateFileW(tempFilename.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr) };
+            THROW_LAST_ERROR_IF_MSG(!file, "%ls", tempFilename.c_str());
+
+            DWORD bytesWritten{};
+            THROW_IF_WIN32_BOOL_FALSE_MSG(WriteFile(file.get(), data.data(), static_cast<DWORD>(data.size()), &bytesWritten, nullptr), "%ls", tempFilename.c_str());
+        }
+        if (!MoveFileExW(tempFilename.c_str(), indexFilename.c_str(), MOVEFILE_REPLACE_EXISTING))
+        {
+            // Most likely another process has the index mapped. It'll be refreshed next time
+            const auto lastError = GetLastError();
+            DeleteFileW(tempFilename.c_str());
+            THROW_WIN32_MSG(lastError, "Error %d replacing %ls", lastError, indexFilename.c_str());
+        }
+    }
+    CATCH_LOG();
+
+    void AddMetadataFileToIndex(
+        const std::wstring& filename,
+        const MetadataIndex::FileKey& key,
+        MetadataIndex& index) noexcept try
+    {
+        wil::unique_hfile file{ CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+        THROW_LAST_ERROR_IF_MSG(!file, "%ls", filename.c_str());
+
+        // The file can change between enumerating the directory and opening it. Nobody can write
+        // it while we hold it open, so the handle's size is what the view covers. If it doesn't
+        // match the key the index would describe a file that's no longer there.
+        LARGE_INTEGER fileSize{};
+        THROW_IF_WIN32_BOOL_FALSE(GetFileSizeEx(file.get(), &fileSize));
+        THROW_HR_IF_MSG(E_CHANGED_STATE, static_cast<uint64_t>(fileSize.QuadPart) != key.size, "%ls", filename.c_str());
+        THROW_HR_IF_MSG(RO_E_INVALID_METADATA_FILE, (fileSize.QuadPart == 0) || (static_cast<uint64_t>(fileSize.QuadPart) > SIZE_MAX), "%ls", filename.c_str());
+
+        wil::unique_handle mapping{ CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr) };
+        THROW_LAST_ERROR_IF_NULL(mapping);
+        wil::unique_mapview_ptr<uint8_t> view{ static_cast<uint8_t*>(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0)) };
+        THROW_LAST_ERROR_IF_NULL(view);
+
+        index.AddFile(key, view.get(), static_cast<size_t>(fileSize.QuadPart));
+    }
+    catch (...)
+    {
+        // Record the file as not indexed so lookups that could involve it search the directory instead
+        LOG_CAUGHT_EXCEPTION();
+        index.AddFile(key, nullptr, 0);
+    }
+
+    std::unique_ptr<ExeDirMetadataIndex> LoadExeDirMetadataIndex()
+    {
+        PCWSTR exeDir = nullptr;
+        THROW_IF_FAILED(GetProcessExeDir(&exeDir));
+
+        auto metadataIndex = std::make_unique<ExeDirMetadataIndex>();
+        metadataIndex->directoryPath = exeDir;
+        if (metadataIndex->directoryPath.empty() || (metadataIndex->directoryPath.back() != L'\\'))
+        {
+            metadataIndex->directoryPath += L'\\';
+        }
+
+        // The index is identified by the metadata files' names, sizes and timestamps
+        std::vector<std::pair<MetadataIndex::FileKey, std::wstring>> files;
+        const auto searchTemplate = metadataIndex->directoryPath + L"*." METADATA_FILE_EXTENSION;
+        WIN32_FIND_DATAW fd{};
+        wil::unique_hfind findFile{ FindFirstFileExW(searchTemplate.c_str(), FindExInfoBasic, &fd, FindExSearchNameMatch, nullptr, 0) };
+        if (findFile)
+        {
+            do
+            {
+                if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                {
+                    continue;
+                }
+
+                MetadataIndex::FileKey key;
+                key.name = ToUtf8(fd.cFileName);
+                key.size = (static_cast<uint64_t>(fd.nFileSizeHigh) << 32) | fd.nFileSizeLow;
+                key.lastWriteTime = (static_cast<uint64_t>(fd.ftLastWriteTime.dwHighDateTime) << 32) | fd.ftLastWriteTime.dwLowDateTime;
+                files.emplace_back(std::move(key), fd.cFileName);
+            } while (FindNextFileW(findFile.get(), &fd));
+        }
+        std::sort(files.begin(), files.end(), [](const auto& left, const auto& right) { return left.first.name < right.first.name; });
+
+        std::vector<MetadataIndex::FileKey> keys;
+        keys.reserve(files.size());
+        for (const auto& file : files)
+        {
+            keys.push_back(file.first);
+            metadataIndex->filenames.push_back(file.second);
+        }
+
+        const auto indexFilename = GetMetadataIndexFilename(metadataIndex->directoryPath);
+        if (!TryLoadMetadataIndex(indexFilename, keys, metadataIndex->index))
+        {
+            metadataIndex->index = MetadataIndex();
+            for (const auto& file : files)
+            {
+                AddMetadataFileToIndex(metadataIndex->directoryPath + file.second, file.first, metadataIndex->index);
+            }
+            SaveMetadataIndex(indexFilename, metadataIndex->index);
+        }
+        return metadataIndex;
+    }
+
+    BOOL CALLBACK GetExeDirMetadataIndexInitOnceCallback(
+        _Inout_     PINIT_ONCE,
+        _Inout_opt_ PVOID,
+        _Out_opt_   PVOID*)
+    {
+        // Without an index type resolution searches the directory, so a failure here isn't fatal
+        try
+        {
+            g_exeDirMetadataIndex = LoadExeDirMetadataIndex().release();
+        }
+        CATCH_LOG();
+        return TRUE;
+    }
+
+    // Resolve the type via the index of the exe directory's metadata files. Returns S_FALSE if the
+    // index didn't find the type, and the caller should then search the directory itself. Misses
+    // aren't trusted because the index is only checked against the directory once per process.
+    HRESULT FindTypeInExeDirMetadataIndex(
+        _In_ IMetaDataDispenserEx* pMetaDataDispenser,
+        _In_ PCWSTR pszFullName,
+        _Out_opt_ HSTRING* phstrMetaDataFilePath,
+        _COM_Outptr_opt_result_maybenull_ IMetaDataImport2** ppMetaDataImport,
+        _Out_opt_ mdTypeDef* pmdTypeDef) try
+    {
+        static INIT_ONCE ExeDirMetadataIndexInitOnce = INIT_ONCE_STATIC_INIT;
+        RETURN_IF_WIN32_BOOL_FALSE(InitOnceExecuteOnce(&ExeDirMetadataIndexInitOnce, GetExeDirMetadataIndexInitOnceCallback, nullptr, nullptr));
+        const auto metadataIndex = g_exeDirMetadataIndex;
+        if (metadataIndex == nullptr)
+        {
+            return S_FALSE;
+        }
+
+        size_t fileIndex = 0;
+        mdTypeDef typeDef = mdTypeDefNil;
+        if (metadataIndex->index.Find(ToUtf8(pszFullName), fileIndex, typeDef) != MetadataIndex::FindResult::Found)
+        {
+            return S_FALSE;
+        }
+
+        const auto metaDataFilePath = metadataIndex->directoryPath + metadataIndex->filenames[fileIndex];
+        Microsoft::WRL::ComPtr<IMetaDataImport2> spMetaDataImport;
+        MetaDataImportersLRUCache* pMetaDataImporterCache = MetaDataImportersLRUCache::GetMetaDataImportersLRUCacheInstance();
+        RETURN_IF_NULL_ALLOC(pMetaDataImporterCache);
+        if (FAILED_LOG(pMetaDataImporterCache->GetMetaDataImporter(pMetaDataDispenser, metaDataFilePath.c_str(), &spMetaDataImport)))
+        {
+            return S_FALSE;
+        }
+
+        // The index is only validated when the process first uses it. Make sure the file hasn't
+        // been replaced since then, even if the caller only wants the path or token.
+        wchar_t pszRetrievedName[g_uiMaxTypeName];
+        if (FAILED(spMetaDataImport->GetTypeDefProps(typeDef, pszRetrievedName, ARRAYSIZE(pszRetrievedName), nullptr, nullptr, nullptr)) ||
+            (wcscmp(pszRetrievedName, pszFullName) != 0))
+        {
+            return S_FALSE;
+        }
+
+        if (ppMetaDataImport != nullptr)
+        {
+            *ppMetaDataImport = spMetaDataImport.Detach();
+        }
+        if (pmdTypeDef != nullptr)
+        {
+            *pmdTypeDef = typeDef;
+        }
+        if (phstrMetaDataFilePath != nullptr)
+        {
+            RETURN_IF_FAILED(WindowsCreateString(metaDataFilePath.c_str(), static_cast<UINT32>(metaDataFilePath.length()), phstrMetaDataFilePath));
+        }
+        return S_OK;
+    }
+    CATCH_RETURN();
+
     HRESULT FindTypeInMetaDataFile(
         _In_ IMetaDataDispenserEx* pMetaDataDispenser,
         _In_ PCWSTR pszFullName,
@@ -441,13 +717,22 @@ namespace UndockedRegFreeWinRT
             PCWSTR exeDir = nullptr;  // Never freed; owned by process global.
             RETURN_IF_FAILED(GetProcessExeDir(&exeDir));
 
-            hr = FindTypeInDirectoryWithNormalization(
+            hr = FindTypeInExeDirMetadataIndex(
                 pMetaDataDispenser,
                 pszFullName,
-                exeDir,
                 phstrMetaDataFilePath,
                 ppMetaDataImport,
                 pmdTypeDef);
+            if (hr == S_FALSE)
+            {
+                hr = FindTypeInDirectoryWithNormalization(
+                    pMetaDataDispenser,
+                    pszFullName,
+                    exeDir,
+                    phstrMetaDataFilePath,
+                    ppMetaDataImport,
+                    pmdTypeDef);
+            }
 
             if (hr == RO_E_METADATA_NAME_NOT_FOUND)
             {
@@ -493,7 +778,7 @@ namespace UndockedRegFreeWinRT
 
         if (s_pMetaDataImportersLRUCacheInstance == nullptr)
         {
-            s_pMetaDataImportersLRUCacheInstance = new MetaDataImportersLRUCache();
+            s_pMetaDataImportersLRUCacheInstance = new (std::nothrow) MetaDataImportersLRUCache(g_dwMetaDataImportersLRUCacheSize);
 
             if (s_pMetaDataImportersLRUCacheInstance == nullptr)
             {
@@ -507,168 +792,32 @@ namespace UndockedRegFreeWinRT
     HRESULT MetaDataImportersLRUCache::GetMetaDataImporter(
         _In_ IMetaDataDispenserEx* pMetaDataDispenser,
         _In_ PCWSTR pszCandidateFilePath,
-        _Outptr_opt_ IMetaDataImport2** ppMetaDataImporter)
+        _Outptr_opt_ IMetaDataImport2** ppMetaDataImporter) try
     {
         if (ppMetaDataImporter == nullptr)
         {
             return ERROR_BAD_ARGUMENTS;
         }
 
-        HRESULT hr = S_OK;
         *ppMetaDataImporter = nullptr;
 
-        EnterCriticalSection(&_csCacheLock);
-
-        if (IsFilePathCached(pszCandidateFilePath))
+        const std::wstring filePath(pszCandidateFilePath);
+        Microsoft::WRL::ComPtr<IMetaDataImport2> spMetaDataImporter;
+        if (!_metadataImporters.TryGet(filePath, spMetaDataImporter))
         {
-            // Get metadata importer from cache.
-            *ppMetaDataImporter = _metadataImportersMap[pszCandidateFilePath];
-            IMetaDataImport2* value = *ppMetaDataImporter;
-            if (value != nullptr)
-            {
-                value->AddRef();
-            }
-        }
-        else
-        {
-            // Importer was not found in cache.
-            hr = GetNewMetaDataImporter(
-                pMetaDataDispenser,
+            // Importer was not found in cache. Open the file without holding the cache's lock;
+            // if another thread beats us to it, use theirs.
+            RETURN_IF_FAILED(pMetaDataDispenser->OpenScope(
                 pszCandidateFilePath,
-                ppMetaDataImporter);
-        }
-
-        LeaveCriticalSection(&_csCacheLock);
-
-        return hr;
-    }
+                ofReadOnly,
+                IID_IMetaDataImport2,
+                reinterpret_cast<IUnknown**>(spMetaDataImporter.GetAddressOf())));
 
-    HRESULT MetaDataImportersLRUCache::GetNewMetaDataImporter(
-        _In_ IMetaDataDispenserEx* pMetaDataDispenser,
-        _In_ PCWSTR pszCandidateFilePath,
-        _Outptr_opt_ IMetaDataImport2** ppMetaDataImporter)
-    {
-        if (ppMetaDataImporter == nullptr)
-        {
-            return ERROR_BAD_ARGUMENTS;
-        }
-
-        HRESULT hr;
-
-        hr = pMetaDataDispenser->OpenScope(
-            pszCandidateFilePath,
-            ofReadOnly,
-            IID_IMetaDataImport2,
-            reinterpret_cast<IUnknown**>(ppMetaDataImporter));
-
-        if (SUCCEEDED(hr))
-        {
-           _metadataImportersMap.emplace(
-                pszCandidateFilePath,
-                *ppMetaDataImporter);
-           IMetaDataImport2* value = *ppMetaDataImporter;
-           if (value != nullptr)
-           {
-               value->AddRef();
-           }
-        }
-
-        if (SUCCEEDED(hr))
-        {
-            hr = AddNewFilePathToList(pszCandidateFilePath);
+            spMetaDataImporter = _metadataImporters.GetOrAdd(filePath, spMetaDataImporter);
         }
 
-        return hr;
-    }
-
-    HRESULT MetaDataImportersLRUCache::AddNewFilePathToList(PCWSTR pszFilePath)
-    {
-        HRESULT hr = RemoveLeastRecentlyUsedItemIfListIsFull();
-
-        if (SUCCEEDED(hr))
-        {
-            // Make room for new element.
-            for (int i = g_dwMetaDataImportersLRUCacheSize - 2; i >= 0; i--)
-            {
-                _arFilePaths[i + 1] = _arFilePaths[i];
-            }
-
-            _arFilePaths[0] = AllocateAndCopyString(pszFilePath);
-
-            if (_arFilePaths[0] == nullptr)
-            {
-                hr = E_OUTOFMEMORY;
-            }
-        }
-
-        return hr;
-    }
-
-    bool MetaDataImportersLRUCache::IsFilePathCached(PCWSTR pszFilePath)
-    {
-        int filePathIndex = GetFilePathIndex(pszFilePath);
-
-        if (filePathIndex != -1)
-        {
-            MoveElementToFrontOfList(filePathIndex);
-            return true;
-        }
-        else
-        {
-            return false;
-        }
-    }
-
-    int MetaDataImportersLRUCache::GetFilePathIndex(PCWSTR pszFilePath)
-    {
-        int filePathIndex = -1;
-
-        for (int i = 0; (i < g_dwMetaDataImportersLRUCacheSize) && (_arFilePaths[i] != nullptr); i++)
-        {
-            if (wcscmp(pszFilePath, _arFilePaths[i]) == 0)
-            {
-                filePathIndex = i;
-                break;
-            }
-        }
-
-        return filePathIndex;
-    }
-
-    void MetaDataImportersLRUCache::MoveElementToFrontOfList(int elementIndex)
-    {
-        PWSTR pszFoundFilePath = _arFilePaths[elementIndex];
-
-        for (int i = elementIndex - 1; i >= 0; i--)
-        {
-            _arFilePaths[i + 1] = _arFilePaths[i];
-        }
-
-        _arFilePaths[0] = pszFoundFilePath;
-    }
-
-    HRESULT MetaDataImportersLRUCache::RemoveLeastRecentlyUsedItemIfListIsFull()
-    {
-        HRESULT hr = S_OK;
-        PWSTR pszLastFilePathInList = _arFilePaths[g_dwMetaDataImportersLRUCacheSize - 1];
-
-        if (pszLastFilePathInList != nullptr)
-        {
-            IMetaDataImport2* value = _metadataImportersMap[pszLastFilePathInList];
-            if (value != nullptr)
-            {
-                value->Release();
-                value = nullptr;
-            }
-            if (!_metadataImportersMap.erase(pszLastFilePathInList))
-            {
-                hr = E_UNEXPECTED;
-            }
-
-            delete[] pszLastFilePathInList;
-            _arFilePaths[g_dwMetaDataImportersLRUCacheSize - 1] = nullptr;
-        }
-
-        return hr;
+        *ppMetaDataImporter = spMetaDataImporter.Detach();
+        return S_OK;
     }
+    CATCH_RETURN();
 }
@@ -4,6 +4,9 @@
 #pragma once
 
 #include <RoMetadataApi.h>
+#include <wrl/client.h>
+
+#include "lrucache.h"
 
 namespace UndockedRegFreeWinRT
 {
@@ -49,27 +52,10 @@ namespace UndockedRegFreeWinRT
         _COM_Outptr_opt_result_maybenull_ IMetaDataImport2** ppMetaDataImport,
         _Out_opt_ mdTypeDef* pmdTypeDef);
 
-    inline PWSTR AllocateAndCopyString(_In_ PCWSTR pszKey)
-    {
-        size_t length = wcslen(pszKey);
-        PWSTR pszKeyCopy = nullptr;
-
-        if (length <= MAX_PATH)
-        {
-            pszKeyCopy = new WCHAR[length + 1];
-            if (pszKeyCopy != nullptr)
-            {
-                SUCCEEDED(StringCchCopyW(pszKeyCopy, length + 1, pszKey));
-            }
-        }
-
-        return pszKeyCopy;
-    }
-
     //
     // Metada importers LRU cache. Singleton.
     //
-    const DWORD g_dwMetaDataImportersLRUCacheSize = 5;
+    const DWORD g_dwMetaDataImportersLRUCacheSize = 64;
 
     class MetaDataImportersLRUCache
     {
@@ -82,47 +68,20 @@ namespace UndockedRegFreeWinRT
             _Outptr_opt_ IMetaDataImport2** ppMetaDataImporter);
 
     private:
-        MetaDataImportersLRUCache()
+        MetaDataImportersLRUCache(DWORD dwCapacity) :
+            _metadataImporters(dwCapacity)
         {
-            InitializeCriticalSection(&_csCacheLock);
-            ZeroMemory(_arFilePaths, sizeof(_arFilePaths));
         }
 
-        ~MetaDataImportersLRUCache()
-        {
-            _metadataImportersMap.clear();
-            for (int i = 0; i < g_dwMetaDataImportersLRUCacheSize; i++)
-            {
-                if (_arFilePaths[i] != nullptr)
-                {
-                    delete[] _arFilePaths[i];
-                    _arFilePaths[i] = nullptr;
-                }
-            }
-
-            DeleteCriticalSection(&_csCacheLock);
-        }
+        ~MetaDataImportersLRUCache() = default;
 
         static BOOL CALLBACK ConstructLRUCacheIfNecessary(
             PINIT_ONCE /*initOnce*/,
             PVOID /*parameter*/,
             PVOID* /*context*/);
 
-        HRESULT GetNewMetaDataImporter(
-            _In_ IMetaDataDispenserEx* pMetaDataDispenser,
-            _In_ PCWSTR pszCandidateFilePath,
-            _Outptr_opt_ IMetaDataImport2** ppMetaDataImporter);
-
-        bool IsFilePathCached(PCWSTR pszFilePath);
-        int GetFilePathIndex(PCWSTR pszFilePath);
-        void MoveElementToFrontOfList(int elementIndex);
-        HRESULT AddNewFilePathToList(PCWSTR pszFilePath);
-        HRESULT RemoveLeastRecentlyUsedItemIfListIsFull();
-
         static INIT_ONCE s_initOnce;
         static MetaDataImportersLRUCache* s_pMetaDataImportersLRUCacheInstance;
-        std::unordered_map<std::wstring, IMetaDataImport2*> _metadataImportersMap;
-        PWSTR _arFilePaths[g_dwMetaDataImportersLRUCacheSize];
-        CRITICAL_SECTION _csCacheLock;
+        LruCache<std::wstring, Microsoft::WRL::ComPtr<IMetaDataImport2>> _metadataImporters;
     };
 }
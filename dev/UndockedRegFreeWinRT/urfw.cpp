@@ -441,6 +441,15 @@ HRESULT UrfwInitialize() noexcept
     DetourAttach(&(PVOID&)TrueRoResolveNamespace, RoResolveNamespaceDetour);
     try
     {
+        // Lookups only see the frozen catalog, so freeze whatever loaded even if a manifest failed
+        auto freezeCatalogOnExit = wil::scope_exit([]
+        {
+            try
+            {
+                WinRTFreezeCatalog();
+            }
+            CATCH_LOG();
+        });
         ExtRoLoadCatalog();
     }
     catch (...)
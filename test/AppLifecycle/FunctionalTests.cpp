@@ -265,6 +265,40 @@ namespace Test::AppLifecycle
             WaitForEvent(protocolActivationEvent, m_failed);
         }
 
+        TEST_METHOD(BatchedActivationTest_Win32)
+        {
+            // Create a named event for communicating with test app.
+            auto protocolActivationEvent{ CreateTestEvent(c_testProtocolPhaseEventName) };
+            auto batchedEvent{ CreateTestEvent(c_testBatchedActivationPhaseEventName) };
+
+            // Cleanup any leftover data from previous runs i.e. ensure we running with a clean slate
+            try
+            {
+                Execute(L"AppLifecycleTestApp.exe", L"/UnregisterProtocol", g_deploymentDir);
+                WaitForEvent(protocolActivationEvent, m_failed);
+            }
+            catch (...)
+            {
+                //TODO:Unregister should not fail if ERROR_FILE_NOT_FOUND | ERROR_PATH_NOT_FOUND
+            }
+
+            // Register the protocol
+            Execute(L"AppLifecycleTestApp.exe", L"/RegisterProtocol", g_deploymentDir);
+            WaitForEvent(protocolActivationEvent, m_failed);
+
+            // Launch the key instance. It has several activations redirected to it while handling the first,
+            // and checks they arrive in a single ActivatedBatch, in order, minus one that can't be unmarshaled,
+            // and that Activated isn't raised
+            Uri launchUri{ c_testProtocolScheme + L"://" + c_genericTestMoniker + L"?TestName=" + TESTNAME() };
+            auto launchResult{ Launcher::LaunchUriAsync(launchUri).get() };
+            VERIFY_IS_TRUE(launchResult);
+            WaitForEvent(batchedEvent, m_failed);
+
+            // Deregister the protocol
+            Execute(L"AppLifecycleTestApp.exe", L"/UnregisterProtocol", g_deploymentDir);
+            WaitForEvent(protocolActivationEvent, m_failed);
+        }
+
         TEST_METHOD(SingleInstanceTest_PackagedWin32)
         {
             // Create a named event for communicating with test app.
@@ -0,0 +1,183 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include <thread>
+
+#include "../../dev/AppLifecycle/RedirectionRequestQueue.h"
+
+using namespace winrt::Microsoft::Windows::AppLifecycle::implementation;
+
+namespace Test::AppLifecycle
+{
+    class RedirectionRequestQueueTests
+    {
+    public:
+        BEGIN_TEST_CLASS(RedirectionRequestQueueTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        TEST_METHOD(EnqueueDequeue)
+        {
+            RedirectionRequestQueue queue;
+            queue.Init(GetQueueName(L"EnqueueDequeue"));
+
+            GUID id{};
+            VERIFY_SUCCEEDED(CoCreateGuid(&id));
+            VERIFY_IS_TRUE(queue.TryEnqueue(id));
+            VERIFY_IS_TRUE(queue.TryEnqueue(GUID_NULL, L"payload"));
+
+            GUID dequeuedId{};
+            std::wstring payload;
+            VERIFY_IS_TRUE(queue.TryDequeue(dequeuedId, payload));
+            VERIFY_IS_TRUE(dequeuedId == id);
+            VERIFY_IS_TRUE(payload.empty());
+            VERIFY_IS_TRUE(queue.TryDequeue(dequeuedId, payload));
+            VERIFY_IS_TRUE(dequeuedId == GUID_NULL);
+            VERIFY_ARE_EQUAL(std::wstring(L"payload"), payload);
+            VERIFY_IS_FALSE(queue.TryDequeue(dequeuedId, payload));
+        }
+
+        TEST_METHOD(Full)
+        {
+            RedirectionRequestQueue queue;
+            queue.Init(GetQueueName(L"Full"));
+
+            for (uint64_t index = 0; index < c_redirectionRequestQueueCapacity; index++)
+            {
+                VERIFY_IS_TRUE(queue.TryEnqueue(GUID_NULL, std::to_wstring(index)));
+            }
+            VERIFY_IS_FALSE(queue.TryEnqueue(GUID_NULL, L"overflow"));
+
+            // Making room lets the next one in, and order's preserved across the wrap
+            GUID id{};
+            std::wstring payload;
+            VERIFY_IS_TRUE(queue.TryDequeue(id, payload));
+            VERIFY_ARE_EQUAL(std::wstring(L"0"), payload);
+            VERIFY_IS_TRUE(queue.TryEnqueue(GUID_NULL, L"last"));
+            for (uint64_t index = 1; index < c_redirectionRequestQueueCapacity; index++)
+            {
+                VERIFY_IS_TRUE(queue.TryDequeue(id, payload));
+                VERIFY_ARE_EQUAL(std::to_wstring(index), payload);
+            }
+            VERIFY_IS_TRUE(queue.TryDequeue(id, payload));
+            VERIFY_ARE_EQUAL(std::wstring(L"last"), payload);
+            VERIFY_IS_FALSE(queue.TryDequeue(id, payload));
+        }
+
+        TEST_METHOD(EnqueueWhenFullGivesUp)
+        {
+            RedirectionRequestQueue queue;
+            queue.Init(GetQueueName(L"EnqueueWhenFullGivesUp"));
+            FillQueue(queue);
+
+            // Nobody's draining it, so the producer wakes the consumer on every retry then gives up
+            DWORD wakeCount{};
+            const auto start{ GetTickCount64() };
+            VERIFY_THROWS_SPECIFIC(queue.Enqueue(GUID_NULL, L"overflow", [&] { wakeCount++; }),
+                wil::ResultException, [](const wil::ResultException& e) { return e.GetErrorCode() == E_OUTOFMEMORY; });
+            const auto elapsed{ GetTickCount64() - start };
+            VERIFY_ARE_EQUAL(c_maxEnqueueRetries, wakeCount);
+            VERIFY_IS_GREATER_THAN_OR_EQUAL(elapsed, static_cast<ULONGLONG>(c_maxEnqueueRetries * c_enqueueRetryDelayInMilliseconds) / 2);
+
+            // The queue's unchanged
+            GUID id{};
+            std::wstring payload;
+            for (uint64_t index = 0; index < c_redirectionRequestQueueCapacity; index++)
+            {
+                VERIFY_IS_TRUE(queue.TryDequeue(id, payload));
+                VERIFY_ARE_EQUAL(std::to_wstring(index), payload);
+            }
+            VERIFY_IS_FALSE(queue.TryDequeue(id, payload));
+        }
+
+        TEST_METHOD(EnqueueWhenFullWaitsForConsumer)
+        {
+            RedirectionRequestQueue queue;
+            queue.Init(GetQueueName(L"EnqueueWhenFullWaitsForConsumer"));
+            FillQueue(queue);
+
+            // The consumer drains one request when woken (a few retries in)
+            wil::unique_event wake(wil::EventOptions::None);
+            std::thread consumer([&]
+            {
+                VERIFY_IS_TRUE(wake.wait(10000));
+                GUID id{};
+                std::wstring payload;
+                VERIFY_IS_TRUE(queue.TryDequeue(id, payload));
+                VERIFY_ARE_EQUAL(std::wstring(L"0"), payload);
+            });
+
+            DWORD wakeCount{};
+            queue.Enqueue(GUID_NULL, L"last", [&]
+            {
+                if (++wakeCount == 3)
+                {
+                    wake.SetEvent();
+                }
+            });
+            consumer.join();
+            VERIFY_IS_GREATER_THAN_OR_EQUAL(wakeCount, 3ul);
+            VERIFY_IS_LESS_THAN(wakeCount, c_maxEnqueueRetries);
+
+            GUID id{};
+            std::wstring payload;
+            for (uint64_t index = 1; index < c_redirectionRequestQueueCapacity; index++)
+            {
+                VERIFY_IS_TRUE(queue.TryDequeue(id, payload));
+            }
+            VERIFY_IS_TRUE(queue.TryDequeue(id, payload));
+            VERIFY_ARE_EQUAL(std::wstring(L"last"), payload);
+        }
+
+        TEST_METHOD(ProducerDiesMidEnqueue)
+        {
+            const auto name{ GetQueueName(L"ProducerDiesMidEnqueue") };
+            RedirectionRequestQueue queue;
+            queue.Init(name);
+            VERIFY_IS_TRUE(queue.TryEnqueue(GUID_NULL, L"first"));
+
+            // A producer takes the queue's lock, writes half its request and dies (abandoning the lock)
+            std::thread producer([&name]
+            {
+                wil::unique_mutex mutex;
+                mutex.open((name + L"_Mutex").c_str());
+                VERIFY_ARE_EQUAL(static_cast<DWORD>(WAIT_OBJECT_0), WaitForSingleObject(mutex.get(), INFINITE));
+
+                SharedMemory<RedirectionRequestQueueData> data;
+                data.Open(name);
+                auto& cell = data->cells[data->enqueuePosition & (c_redirectionRequestQueueCapacity - 1)];
+                cell.payloadLength = 4;
+                cell.payload[0] = L'X';
+            });
+            producer.join();
+
+            // The queue carries on. The dead producer's request was never enqueued
+            VERIFY_IS_TRUE(queue.TryEnqueue(GUID_NULL, L"second"));
+
+            GUID id{};
+            std::wstring payload;
+            VERIFY_IS_TRUE(queue.TryDequeue(id, payload));
+            VERIFY_ARE_EQUAL(std::wstring(L"first"), payload);
+            VERIFY_IS_TRUE(queue.TryDequeue(id, payload));
+            VERIFY_ARE_EQUAL(std::wstring(L"second"), payload);
+            VERIFY_IS_FALSE(queue.TryDequeue(id, payload));
+        }
+
+    private:
+        static void FillQueue(RedirectionRequestQueue& queue)
+        {
+            for (uint64_t index = 0; index < c_redirectionRequestQueueCapacity; index++)
+            {
+                VERIFY_IS_TRUE(queue.TryEnqueue(GUID_NULL, std::to_wstring(index)));
+            }
+            VERIFY_IS_FALSE(queue.TryEnqueue(GUID_NULL, L"overflow"));
+        }
+
+        static std::wstring GetQueueName(PCWSTR testName)
+        {
+            return wil::str_printf<std::wstring>(L"RedirectionRequestQueueTests_%s_%u", testName, GetCurrentProcessId());
+        }
+    };
+}
@@ -0,0 +1,149 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "../../dev/AppLifecycle/RegistrationState.h"
+
+using namespace winrt::Microsoft::Windows::AppLifecycle::implementation;
+
+namespace Test::AppLifecycle
+{
+    static PCWSTR c_testKeyPath{ LR"(Software\Microsoft\ProjectReunion\Test\RegistrationState)" };
+
+    // Counts reads and writes so tests can check what Commit touched.
+    struct InMemoryRegistryStore : RegistryStore
+    {
+        bool TryReadKey(const std::wstring& keyPath, RegistryValueMap& values) override
+        {
+            ++reads;
+            auto key = keys.find(keyPath);
+            if (key == keys.end())
+            {
+                values.clear();
+                return false;
+            }
+            values = key->second;
+            return true;
+        }
+
+        void WriteKey(const std::wstring& keyPath, const RegistryValueMap& values) override
+        {
+            ++writes;
+            auto& key = keys[keyPath];
+            for (auto& [name, data] : values)
+            {
+                key[name] = data;
+            }
+        }
+
+        std::map<std::wstring, RegistryValueMap, RegistryNameLess> keys;
+        size_t reads{};
+        size_t writes{};
+    };
+
+    class RegistrationStateTests
+    {
+    public:
+        BEGIN_TEST_CLASS(RegistrationStateTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        TEST_METHOD_SETUP(MethodInit)
+        {
+            ::RegDeleteTree(GetRegistrationRoot(), c_testKeyPath);
+            return true;
+        }
+
+        TEST_METHOD_CLEANUP(MethodUninit)
+        {
+            ::RegDeleteTree(GetRegistrationRoot(), c_testKeyPath);
+            return true;
+        }
+
+        TEST_METHOD(CommitWritesOnlyChanges)
+        {
+            InMemoryRegistryStore store;
+            store.keys[L"Unchanged"][L"Name"] = L"Data";
+            store.keys[L"Changed"][L"Name"] = L"Old";
+
+            RegistrationState state{ store };
+            state.AddValue(L"Unchanged", L"Name", L"Data");
+            state.AddValue(L"Changed", L"Name", L"New");
+            state.AddKey(L"Created");
+            VERIFY_ARE_EQUAL(size_t{ 2 }, state.Commit());
+            VERIFY_ARE_EQUAL(size_t{ 2 }, store.writes);
+            VERIFY_ARE_EQUAL(std::wstring(L"New"), store.keys[L"Changed"][L"Name"]);
+            VERIFY_IS_TRUE(store.keys.find(L"Created") != store.keys.end());
+
+            // Registering the same thing again writes nothing
+            state.AddValue(L"Unchanged", L"Name", L"Data");
+            state.AddValue(L"Changed", L"Name", L"New");
+            state.AddKey(L"Created");
+            VERIFY_ARE_EQUAL(size_t{ 0 }, state.Commit());
+            VERIFY_ARE_EQUAL(size_t{ 2 }, store.writes);
+        }
+
+        TEST_METHOD(ReadsEachKeyOnce)
+        {
+            InMemoryRegistryStore store;
+            store.keys[L"Key"][L"Name"] = L"Data";
+
+            RegistrationState state{ store };
+            VERIFY_IS_TRUE(state.KeyExists(L"key"));
+            VERIFY_IS_TRUE(state.ValueExists(L"KEY", L"NAME"));
+            VERIFY_IS_FALSE(state.ValueExists(L"Key", L"Other"));
+            VERIFY_IS_FALSE(state.KeyExists(L"Missing"));
+            VERIFY_IS_FALSE(state.KeyExists(L"Missing"));
+            state.AddValue(L"Key", L"Name", L"Data");
+            VERIFY_ARE_EQUAL(size_t{ 0 }, state.Commit());
+            VERIFY_ARE_EQUAL(size_t{ 2 }, store.reads);
+        }
+
+        TEST_METHOD(RegistryStoreRoundTrip)
+        {
+            CurrentUserRegistryStore store;
+            RegistryValueMap values;
+            VERIFY_IS_FALSE(store.TryReadKey(c_testKeyPath, values));
+
+            RegistryValueMap written;
+            written[L""] = L"Default";
+            written[L"Name"] = L"Data";
+            written[L"Long"] = std::wstring(4096, L'x');
+            store.WriteKey(c_testKeyPath, written);
+
+            // Values that aren't strings are left out
+            DWORD number{ 42 };
+            VERIFY_WIN32_SUCCEEDED(::RegSetKeyValue(GetRegistrationRoot(), c_testKeyPath, L"Number", REG_DWORD,
+                &number, sizeof(number)));
+
+            VERIFY_IS_TRUE(store.TryReadKey(c_testKeyPath, values));
+            VERIFY_ARE_EQUAL(written.size(), values.size());
+            for (auto& [name, data] : written)
+            {
+                VERIFY_IS_TRUE(values[name] == data);
+            }
+        }
+
+        TEST_METHOD(RegistryStoreCommit)
+        {
+            CurrentUserRegistryStore store;
+            {
+                RegistrationState state{ store };
+                state.AddValue(c_testKeyPath, L"Name", L"Data");
+                VERIFY_ARE_EQUAL(size_t{ 1 }, state.Commit());
+            }
+            {
+                RegistrationState state{ store };
+                state.AddValue(c_testKeyPath, L"Name", L"Data");
+                VERIFY_ARE_EQUAL(size_t{ 0 }, state.Commit());
+                state.AddValue(c_testKeyPath, L"Name", L"Changed");
+                VERIFY_ARE_EQUAL(size_t{ 1 }, state.Commit());
+            }
+
+            RegistryValueMap values;
+            VERIFY_IS_TRUE(store.TryReadKey(c_testKeyPath, values));
+            VERIFY_ARE_EQUAL(std::wstring(L"Changed"), values[L"Name"]);
+        }
+    };
+}
@@ -0,0 +1,156 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "../../dev/AppLifecycle/SharedProcessList.h"
+
+using namespace winrt::Microsoft::Windows::AppLifecycle::implementation;
+
+namespace Test::AppLifecycle
+{
+    const DWORD c_maxInstances{ static_cast<DWORD>(c_maxInstanceCount) };
+
+    class SharedProcessListTests
+    {
+    public:
+        BEGIN_TEST_CLASS(SharedProcessListTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        TEST_METHOD(InsertRemove)
+        {
+            SharedProcessList list;
+            list.Init(GetListName(L"InsertRemove"));
+
+            list.Insert(4, 1);
+            list.Insert(8, 2);
+            VERIFY_THROWS_SPECIFIC(list.Insert(4, 1),
+                wil::ResultException, [](const wil::ResultException& e) { return e.GetErrorCode() == E_UNEXPECTED; });
+            VERIFY_ARE_EQUAL(static_cast<size_t>(2), list.GetAll().size());
+
+            // Only the instance with the given start time is removed
+            list.Remove(4, 3);
+            VERIFY_ARE_EQUAL(static_cast<size_t>(2), list.GetAll().size());
+            list.Remove(4, 1);
+            list.Remove(8);
+            VERIFY_IS_TRUE(list.GetAll().empty());
+        }
+
+        TEST_METHOD(ProcessIdReused)
+        {
+            SharedProcessList list;
+            list.Init(GetListName(L"ProcessIdReused"));
+
+            // A later process given the id of one that's gone (but still listed) replaces it
+            list.Insert(4, 1);
+            list.Insert(4, 2);
+            auto records{ list.GetAll() };
+            VERIFY_ARE_EQUAL(static_cast<size_t>(1), records.size());
+            VERIFY_ARE_EQUAL(2ull, records[0].startTime);
+        }
+
+        TEST_METHOD(Full)
+        {
+            SharedProcessList list;
+            list.Init(GetListName(L"Full"));
+
+            for (DWORD index = 1; index <= c_maxInstances; index++)
+            {
+                list.Insert(index * 4, index);
+            }
+            VERIFY_THROWS_SPECIFIC(list.Insert((c_maxInstances + 1) * 4, 1),
+                wil::ResultException, [](const wil::ResultException& e) { return e.GetErrorCode() == E_OUTOFMEMORY; });
+
+            list.Remove(4);
+            list.Insert((c_maxInstances + 1) * 4, 1);
+            VERIFY_ARE_EQUAL(static_cast<size_t>(c_maxInstances), list.GetAll().size());
+        }
+
+        TEST_METHOD(RemoveLeavesNoTrace)
+        {
+            const auto name{ GetListName(L"RemoveLeavesNoTrace") };
+            SharedProcessList list;
+            list.Init(name);
+
+            // Many instances come and go, each probing past the others
+            for (DWORD round = 0; round < 16; round++)
+            {
+                for (DWORD index = 1; index <= c_maxInstances; index++)
+                {
+                    list.Insert((round * c_maxInstances + index) * 4, round);
+                }
+                for (DWORD index = 1; index <= c_maxInstances; index += 2)
+                {
+                    list.Remove((round * c_maxInstances + index) * 4);
+                }
+                for (DWORD index = 2; index <= c_maxInstances; index += 2)
+                {
+                    list.Remove((round * c_maxInstances + index) * 4);
+                }
+            }
+
+            // Every entry's free again so probes are as short as when the list was new
+            SharedMemory<SharedProcessListData> data;
+            data.Open(name);
+            VERIFY_ARE_EQUAL(0u, data->count);
+            for (const auto& entry : data->entries)
+            {
+                VERIFY_ARE_EQUAL(0u, entry.processId);
+            }
+        }
+
+        TEST_METHOD(InstanceDiesMidUpdate)
+        {
+            const auto name{ GetListName(L"InstanceDiesMidUpdate") };
+            SharedProcessList list;
+            list.Init(name);
+            list.Insert(4, 1);
+
+            // An instance takes the list's lock, writes its entry (not counting it) and a duplicate of
+            // another then dies (abandoning the lock)
+            std::thread instance([&name]
+            {
+                wil::unique_mutex mutex;
+                mutex.open((name + L"_Mutex").c_str());
+                VERIFY_ARE_EQUAL(static_cast<DWORD>(WAIT_OBJECT_0), WaitForSingleObject(mutex.get(), INFINITE));
+
+                SharedMemory<SharedProcessListData> data;
+                data.Open(name);
+                auto entry{ std::find_if(std::begin(data->entries), std::end(data->entries), [](const auto& entry) { return entry.processId == 0; }) };
+                entry->startTime = 2;
+                entry->processId = 8;
+                auto duplicate{ std::find_if(std::begin(data->entries), std::end(data->entries), [](const auto& entry) { return entry.processId == 0; }) };
+                *duplicate = *std::find_if(std::begin(data->entries), std::end(data->entries), [](const auto& entry) { return entry.processId == 4; });
+            });
+            instance.join();
+
+            // The list carries on with both entries, each once
+            auto records{ list.GetAll() };
+            VERIFY_ARE_EQUAL(static_cast<size_t>(2), records.size());
+
+            // And they're counted, so there's room for exactly the rest
+            for (DWORD index = 3; index <= c_maxInstances; index++)
+            {
+                list.Insert(index * 4, index);
+            }
+            VERIFY_THROWS_SPECIFIC(list.Insert((c_maxInstances + 1) * 4, 1),
+                wil::ResultException, [](const wil::ResultException& e) { return e.GetErrorCode() == E_OUTOFMEMORY; });
+
+            list.Remove(4);
+            list.Remove(8);
+            records = list.GetAll();
+            VERIFY_ARE_EQUAL(static_cast<size_t>(c_maxInstances - 2), records.size());
+            VERIFY_IS_TRUE(std::none_of(records.begin(), records.end(), [](const auto& record) { return (record.processId == 4) || (record.processId == 8); }));
+        }
+
+    private:
+        static std::wstring GetListName(PCWSTR testName)
+        {
+            return wil::str_printf<std::wstring>(L"SharedProcessListTests_%s_%u", testName, GetCurrentProcessId());
+        }
+    };
+}
@@ -0,0 +1,227 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "../../../dev/DynamicDependency/DataStoreLog.h"
+
+namespace Test::DynamicDependency
+{
+    class DataStoreLogTests
+    {
+    public:
+        BEGIN_TEST_CLASS(DataStoreLogTests)
+            TEST_CLASS_PROPERTY(L"IsolationLevel", L"Method")
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        TEST_METHOD_SETUP(MethodSetup)
+        {
+            m_path = std::filesystem::temp_directory_path() / L"Test-DataStoreLog";
+            std::filesystem::remove_all(m_path);
+            std::filesystem::create_directories(m_path);
+            return true;
+        }
+
+        TEST_METHOD_CLEANUP(MethodCleanup)
+        {
+            std::error_code errorCode;
+            std::filesystem::remove_all(m_path, errorCode);
+            return true;
+        }
+
+        TEST_METHOD(EncodeDecode)
+        {
+            const std::vector<uint8_t> payload1{ 1, 2, 3 };
+            const std::vector<uint8_t> payload2{ 4, 5, 6, 7, 8 };
+            auto data{ MddCore::DataStoreLog::EncodeRecord(MddCore::DataStoreLog::RecordType::Put, payload1) };
+            const auto record2{ MddCore::DataStoreLog::EncodeRecord(MddCore::DataStoreLog::RecordType::Delete, payload2) };
+            data.insert(data.end(), record2.begin(), record2.end());
+
+            std::vector<MddCore::DataStoreLog::RecordType> types;
+            std::vector<std::vector<uint8_t>> payloads;
+            size_t recordsSize{};
+            const auto decodedSize{ MddCore::DataStoreLog::DecodeRecords(data.data(), data.size(),
+                [&](MddCore::DataStoreLog::RecordType type, const uint8_t* payload, size_t payloadSize, size_t recordSize)
+                {
+                    types.push_back(type);
+                    payloads.emplace_back(payload, payload + payloadSize);
+                    recordsSize += recordSize;
+                }) };
+            VERIFY_ARE_EQUAL(data.size(), decodedSize);
+            VERIFY_ARE_EQUAL(data.size(), recordsSize);
+            VERIFY_ARE_EQUAL(2u, types.size());
+            VERIFY_IS_TRUE(types[0] == MddCore::DataStoreLog::RecordType::Put);
+            VERIFY_IS_TRUE(types[1] == MddCore::DataStoreLog::RecordType::Delete);
+            VERIFY_IS_TRUE(payloads[0] == payload1);
+            VERIFY_IS_TRUE(payloads[1] == payload2);
+        }
+
+        TEST_METHOD(DecodeTornTail)
+        {
+            const std::vector<uint8_t> payload{ 1, 2, 3 };
+            auto data{ MddCore::DataStoreLog::EncodeRecord(MddCore::DataStoreLog::RecordType::Put, payload) };
+            const auto firstRecordSize{ data.size() };
+            const auto record2{ MddCore::DataStoreLog::EncodeRecord(MddCore::DataStoreLog::RecordType::Put, payload) };
+            data.insert(data.end(), record2.begin(), record2.end() - 1);
+
+            size_t count{};
+            const auto decodedSize{ MddCore::DataStoreLog::DecodeRecords(data.data(), data.size(),
+                [&](MddCore::DataStoreLog::RecordType, const uint8_t*, size_t, size_t) { ++count; }) };
+            VERIFY_ARE_EQUAL(firstRecordSize, decodedSize);
+            VERIFY_ARE_EQUAL(1u, count);
+        }
+
+        TEST_METHOD(DecodeBadChecksum)
+        {
+            const std::vector<uint8_t> payload{ 1, 2, 3 };
+            auto data{ MddCore::DataStoreLog::EncodeRecord(MddCore::DataStoreLog::RecordType::Put, payload) };
+            data.back() ^= 0xFF;
+
+            size_t count{};
+            const auto decodedSize{ MddCore::DataStoreLog::DecodeRecords(data.data(), data.size(),
+                [&](MddCore::DataStoreLog::RecordType, const uint8_t*, size_t, size_t) { ++count; }) };
+            VERIFY_ARE_EQUAL(0u, decodedSize);
+            VERIFY_ARE_EQUAL(0u, count);
+        }
+
+        TEST_METHOD(Replay)
+        {
+            const auto filename{ m_path / L"PackageDependencies.log" };
+            const auto a{ MakePackageDependency(L"A") };
+            const auto b{ MakePackageDependency(L"B") };
+            {
+                MddCore::DataStoreLog log(filename);
+                log.Put(a);
+                log.Put(b);
+                VERIFY_IS_TRUE(log.Delete(a.Id().c_str()));
+                VERIFY_IS_FALSE(log.Delete(a.Id().c_str()));
+            }
+
+            // A new log (e.g. another process) replays the file
+            MddCore::DataStoreLog log(filename);
+            VERIFY_IS_FALSE(!!log.Find(a.Id().c_str()));
+            const auto found{ log.Find(b.Id().c_str()) };
+            VERIFY_IS_TRUE(!!found);
+            VERIFY_ARE_EQUAL(b.PackageFamilyName(), found.PackageFamilyName());
+            VERIFY_ARE_EQUAL(1u, log.GetAll().size());
+        }
+
+        TEST_METHOD(ReplayIgnoresTornTail)
+        {
+            const auto filename{ m_path / L"PackageDependencies.log" };
+            const auto a{ MakePackageDependency(L"A") };
+            {
+                MddCore::DataStoreLog log(filename);
+                log.Put(a);
+            }
+
+            // Simulate power lost mid-append
+            {
+                wil::unique_hfile file{ ::CreateFileW(filename.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+                VERIFY_IS_TRUE(!!file);
+                const uint8_t garbage[]{ 1, 0, 0, 0, 0xFF, 0xFF };
+                DWORD bytesWritten{};
+                VERIFY_WIN32_BOOL_SUCCEEDED(::WriteFile(file.get(), garbage, sizeof(garbage), &bytesWritten, nullptr));
+            }
+
+            MddCore::DataStoreLog log(filename);
+            VERIFY_IS_TRUE(!!log.Find(a.Id().c_str()));
+
+            // The next append discards the torn tail
+            const auto b{ MakePackageDependency(L"B") };
+            log.Put(b);
+            MddCore::DataStoreLog log2(filename);
+            VERIFY_ARE_EQUAL(2u, log2.GetAll().size());
+        }
+
+        TEST_METHOD(Compact)
+        {
+            const auto filename{ m_path / L"PackageDependencies.log" };
+
+            // Another process' handle on the log mustn't block compaction
+            MddCore::DataStoreLog log(filename);
+            const auto a{ MakePackageDependency(L"A") };
+            log.Put(a);
+            wil::unique_hfile otherFile{ ::CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+            VERIFY_IS_TRUE(!!otherFile);
+            const auto fileId{ GetFileId(otherFile.get()) };
+
+            // Rewrite the same package dependency until superseded records trigger compaction
+            const std::wstring lifetimeArtifact(1024, L'x');
+            auto b{ MakePackageDependency(L"B", lifetimeArtifact.c_str()) };
+            uint64_t maxFileSize{};
+            bool compacted{};
+            for (int index=0; (index < 1000) && !compacted; ++index)
+            {
+                log.Put(b);
+
+                const auto fileSize{ std::filesystem::file_size(filename) };
+                compacted = (fileSize < maxFileSize);
+                maxFileSize = std::max(maxFileSize, fileSize);
+            }
+            VERIFY_IS_TRUE(compacted);
+
+            wil::unique_hfile file{ ::CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+            VERIFY_IS_TRUE(!!file);
+            VERIFY_ARE_NOT_EQUAL(fileId, GetFileId(file.get()));
+            VERIFY_IS_FALSE(std::filesystem::exists(std::filesystem::path(filename) += L".tmp"));
+
+            // Compaction keeps live records (and only them)
+            MddCore::DataStoreLog log2(filename);
+            VERIFY_ARE_EQUAL(2u, log2.GetAll().size());
+            VERIFY_IS_TRUE(!!log2.Find(a.Id().c_str()));
+            VERIFY_ARE_EQUAL(lifetimeArtifact, log2.Find(b.Id().c_str()).LifetimeArtifact());
+
+            // ...and the original log carries on appending to the compacted file
+            VERIFY_IS_TRUE(log.Delete(a.Id().c_str()));
+            MddCore::DataStoreLog log3(filename);
+            VERIFY_ARE_EQUAL(1u, log3.GetAll().size());
+        }
+
+        TEST_METHOD(IdsAreCaseInsensitive)
+        {
+            const auto filename{ m_path / L"PackageDependencies.log" };
+
+            // Ids fold case independent of the CRT's locale, non-ASCII characters included
+            const auto previousLocale{ _wsetlocale(LC_ALL, nullptr) };
+            const std::wstring savedLocale{ previousLocale ? previousLocale : L"C" };
+            auto restoreLocale{ wil::scope_exit([&]() { _wsetlocale(LC_ALL, savedLocale.c_str()); }) };
+            _wsetlocale(LC_ALL, L"C");
+
+            MddCore::DataStoreLog log(filename);
+            log.Put(MakePackageDependency(L"Abc\u00e9"));
+            VERIFY_IS_TRUE(!!log.Find(L"ABC\u00c9"));
+            VERIFY_IS_TRUE(!!log.Find(L"abc\u00e9"));
+            VERIFY_IS_FALSE(!!log.Find(L"ABCE"));
+
+            _wsetlocale(LC_ALL, L"tr-TR");
+            MddCore::DataStoreLog log2(filename);
+            VERIFY_IS_TRUE(!!log2.Find(L"aBC\u00c9"));
+            VERIFY_IS_TRUE(log2.Delete(L"ABC\u00e9"));
+            VERIFY_ARE_EQUAL(0u, log2.GetAll().size());
+        }
+
+    private:
+        static MddCore::PackageDependency MakePackageDependency(
+            PCWSTR id,
+            PCWSTR lifetimeArtifact = L"C:\\Test\\LifetimeArtifact")
+        {
+            MddCore::PackageDependency packageDependency(nullptr, L"Test.DataStoreLog_8wekyb3d8bbwe", PACKAGE_VERSION{},
+                MddPackageDependencyProcessorArchitectures::None, MddPackageDependencyLifetimeKind::FilePath, lifetimeArtifact,
+                MddCreatePackageDependencyOptions::DoNotVerifyDependencyResolution);
+            packageDependency.Id(id);
+            return packageDependency;
+        }
+
+        static uint64_t GetFileId(HANDLE file)
+        {
+            BY_HANDLE_FILE_INFORMATION fileInformation{};
+            VERIFY_WIN32_BOOL_SUCCEEDED(::GetFileInformationByHandle(file, &fileInformation));
+            return (static_cast<uint64_t>(fileInformation.nFileIndexHigh) << 32) | fileInformation.nFileIndexLow;
+        }
+
+    private:
+        std::filesystem::path m_path;
+    };
+}
@@ -0,0 +1,234 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "../../../dev/Detours/detours.h"
+
+#include <chrono>
+
+namespace Test::Detours
+{
+    class DetoursTests
+    {
+    public:
+        BEGIN_TEST_CLASS(DetoursTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+#if defined(DETOURS_X64) || defined(DETOURS_X86)
+        TEST_METHOD(CopyInstruction)
+        {
+            // Common prologue and epilogue instructions with their expected lengths.
+            struct Instruction
+            {
+                BYTE length;
+                BYTE bytes[15];
+                PCWSTR disassembly;
+            };
+            const Instruction instructions[]
+            {
+#if defined(DETOURS_X64)
+                { 1, { 0x55 }, L"push rbp" },
+                { 2, { 0x40, 0x53 }, L"push rbx" },
+                { 2, { 0x41, 0x56 }, L"push r14" },
+                { 5, { 0x48, 0x89, 0x5c, 0x24, 0x08 }, L"mov [rsp+8],rbx" },
+                { 5, { 0x4c, 0x89, 0x44, 0x24, 0x18 }, L"mov [rsp+18h],r8" },
+                { 3, { 0x48, 0x8b, 0xc4 }, L"mov rax,rsp" },
+                { 3, { 0x4c, 0x8b, 0xdc }, L"mov r11,rsp" },
+                { 4, { 0x48, 0x83, 0xec, 0x28 }, L"sub rsp,28h" },
+                { 7, { 0x48, 0x81, 0xec, 0x00, 0x01, 0x00, 0x00 }, L"sub rsp,100h" },
+                { 5, { 0x48, 0x8d, 0x6c, 0x24, 0xf9 }, L"lea rbp,[rsp-7]" },
+                { 7, { 0x48, 0x8b, 0x05, 0x00, 0x00, 0x00, 0x00 }, L"mov rax,[rip]" },
+                { 7, { 0x48, 0x8d, 0x0d, 0x00, 0x00, 0x00, 0x00 }, L"lea rcx,[rip]" },
+                { 10, { 0x48, 0xb8, 1, 2, 3, 4, 5, 6, 7, 8 }, L"mov rax,imm64" },
+                { 9, { 0x65, 0x48, 0x8b, 0x04, 0x25, 0x30, 0x00, 0x00, 0x00 }, L"mov rax,gs:[30h]" },
+                { 3, { 0x45, 0x33, 0xc9 }, L"xor r9d,r9d" },
+                { 5, { 0xb8, 0x01, 0x00, 0x00, 0x00 }, L"mov eax,1" },
+                { 6, { 0x66, 0x0f, 0x1f, 0x44, 0x00, 0x00 }, L"nop word [rax+rax]" },
+                { 4, { 0xf3, 0x0f, 0x1e, 0xfa }, L"endbr64" },
+                { 3, { 0xc5, 0xf8, 0x77 }, L"vzeroupper" },
+                { 2, { 0xff, 0xe0 }, L"jmp rax" },
+                { 4, { 0x48, 0x83, 0xc4, 0x28 }, L"add rsp,28h" },
+#else
+                { 2, { 0x8b, 0xff }, L"mov edi,edi" },
+                { 1, { 0x55 }, L"push ebp" },
+                { 2, { 0x8b, 0xec }, L"mov ebp,esp" },
+                { 3, { 0x83, 0xec, 0x10 }, L"sub esp,10h" },
+                { 6, { 0x81, 0xec, 0x00, 0x01, 0x00, 0x00 }, L"sub esp,100h" },
+                { 2, { 0x6a, 0x00 }, L"push 0" },
+                { 5, { 0x68, 0x00, 0x00, 0x00, 0x00 }, L"push imm32" },
+                { 3, { 0x8d, 0x45, 0xf8 }, L"lea eax,[ebp-8]" },
+                { 6, { 0x64, 0xa1, 0x00, 0x00, 0x00, 0x00 }, L"mov eax,fs:[0]" },
+                { 3, { 0x66, 0x8b, 0xc1 }, L"mov ax,cx" },
+                { 3, { 0xc2, 0x04, 0x00 }, L"ret 4" },
+#endif
+                { 1, { 0xc3 }, L"ret" },
+                { 1, { 0xcc }, L"int 3" },
+                { 1, { 0x90 }, L"nop" },
+                { 2, { 0x33, 0xc0 }, L"xor eax,eax" },
+                { 2, { 0xeb, 0x00 }, L"jmp short" },
+                { 2, { 0x74, 0x00 }, L"je short" },
+                { 5, { 0xe8, 0x00, 0x00, 0x00, 0x00 }, L"call" },
+                { 5, { 0xe9, 0x00, 0x00, 0x00, 0x00 }, L"jmp" },
+                { 6, { 0x0f, 0x84, 0x00, 0x00, 0x00, 0x00 }, L"je near" },
+                { 5, { 0x0f, 0x1f, 0x44, 0x00, 0x00 }, L"multi-byte nop" },
+            };
+
+            for (const auto& instruction : instructions)
+            {
+                PVOID target{};
+                LONG extra{};
+                const auto next{ static_cast<PBYTE>(DetourCopyInstruction(nullptr, nullptr, const_cast<PBYTE>(instruction.bytes), &target, &extra)) };
+                VERIFY_ARE_EQUAL(static_cast<ptrdiff_t>(instruction.length), next - instruction.bytes, instruction.disassembly);
+            }
+        }
+
+        TEST_METHOD(AttachDetachManySharingPages)
+        {
+            // Targets 117 bytes apart fill 3 pages, with targets 35 and 70 straddling the page boundaries.
+            // The middle page is writable, so each of those targets spans pages of different protection.
+            const ULONG c_targetCount{ 100 };
+            const ULONG c_threadCount{ 50 };
+            const size_t c_stubStride{ 117 };
+            const ULONG c_detoured{ 1000 };
+
+            // Target i returns i and its detour returns i + c_detoured
+            auto targets{ AllocateStubs(c_targetCount, c_stubStride, 0) };
+            auto releaseTargets{ wil::scope_exit([&] { VirtualFree(targets, 0, MEM_RELEASE); }) };
+            auto detours{ AllocateStubs(c_targetCount, c_stubStride, c_detoured) };
+            auto releaseDetours{ wil::scope_exit([&] { VirtualFree(detours, 0, MEM_RELEASE); }) };
+
+            SYSTEM_INFO systemInfo{};
+            GetSystemInfo(&systemInfo);
+            const size_t pageSize{ systemInfo.dwPageSize };
+            const size_t pageCount{ ((c_targetCount * c_stubStride) + pageSize - 1) / pageSize };
+            DWORD oldProtection{};
+            VERIFY_WIN32_BOOL_SUCCEEDED(VirtualProtect(targets + pageSize, pageSize, PAGE_EXECUTE_READWRITE, &oldProtection));
+            const auto protections{ GetProtections(targets, pageCount, pageSize) };
+
+            // Threads call the targets throughout, so some are suspended in or about to enter them
+            std::atomic<bool> stop{};
+            std::atomic<ULONG> running{};
+            std::atomic<ULONG> misrouted{};
+            std::vector<std::thread> threads;
+            auto joinThreads{ wil::scope_exit([&]
+            {
+                stop = true;
+                for (auto& thread : threads)
+                {
+                    thread.join();
+                }
+            }) };
+            for (ULONG index = 0; index < c_threadCount; index++)
+            {
+                threads.emplace_back([&]
+                {
+                    running++;
+                    while (!stop)
+                    {
+                        for (ULONG target = 0; target < c_targetCount; target++)
+                        {
+                            const auto result{ reinterpret_cast<Stub>(targets + target * c_stubStride)() };
+                            if ((result != target) && (result != target + c_detoured))
+                            {
+                                misrouted++;
+                            }
+                        }
+                    }
+                });
+            }
+            while (running < c_threadCount)
+            {
+                Sleep(1);
+            }
+
+            std::vector<PVOID> real(c_targetCount);
+            auto start{ std::chrono::steady_clock::now() };
+            VERIFY_ARE_EQUAL(NO_ERROR, DetourTransactionBegin());
+            for (auto& thread : threads)
+            {
+                VERIFY_ARE_EQUAL(NO_ERROR, DetourUpdateThread(thread.native_handle()));
+            }
+            for (ULONG target = 0; target < c_targetCount; target++)
+            {
+                real[target] = targets + target * c_stubStride;
+                VERIFY_ARE_EQUAL(NO_ERROR, DetourAttach(&real[target], detours + target * c_stubStride));
+            }
+            VERIFY_ARE_EQUAL(NO_ERROR, DetourTransactionCommit());
+            const auto attachTime{ std::chrono::steady_clock::now() - start };
+
+            VERIFY_IS_TRUE(protections == GetProtections(targets, pageCount, pageSize));
+            for (ULONG target = 0; target < c_targetCount; target++)
+            {
+                VERIFY_ARE_EQUAL(target + c_detoured, reinterpret_cast<Stub>(targets + target * c_stubStride)());
+                VERIFY_ARE_EQUAL(target, reinterpret_cast<Stub>(real[target])());
+            }
+
+            start = std::chrono::steady_clock::now();
+            VERIFY_ARE_EQUAL(NO_ERROR, DetourTransactionBegin());
+            for (auto& thread : threads)
+            {
+                VERIFY_ARE_EQUAL(NO_ERROR, DetourUpdateThread(thread.native_handle()));
+            }
+            for (ULONG target = 0; target < c_targetCount; target++)
+            {
+                VERIFY_ARE_EQUAL(NO_ERROR, DetourDetach(&real[target], detours + target * c_stubStride));
+            }
+            VERIFY_ARE_EQUAL(NO_ERROR, DetourTransactionCommit());
+            const auto detachTime{ std::chrono::steady_clock::now() - start };
+
+            VERIFY_IS_TRUE(protections == GetProtections(targets, pageCount, pageSize));
+            for (ULONG target = 0; target < c_targetCount; target++)
+            {
+                VERIFY_ARE_EQUAL(target, reinterpret_cast<Stub>(targets + target * c_stubStride)());
+            }
+
+            joinThreads.reset();
+            VERIFY_ARE_EQUAL(0ul, misrouted.load());
+
+            WEX::Logging::Log::Comment(WEX::Common::String().Format(L"%u targets on %u pages, %u threads: attach %lldus detach %lldus",
+                c_targetCount, static_cast<ULONG>(pageCount), c_threadCount,
+                static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(attachTime).count()),
+                static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(detachTime).count())));
+        }
+
+    private:
+        using Stub = ULONG (WINAPI*)();
+
+        // Executable stubs, stride bytes apart, the i'th returning firstResult + i ("mov eax,imm32; ret").
+        static PBYTE AllocateStubs(ULONG count, size_t stride, ULONG firstResult)
+        {
+            const auto size{ count * stride };
+            auto stubs{ static_cast<PBYTE>(VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE)) };
+            VERIFY_IS_NOT_NULL(stubs);
+            memset(stubs, 0xcc, size);
+            for (ULONG index = 0; index < count; index++)
+            {
+                const auto result{ firstResult + index };
+                auto stub{ stubs + index * stride };
+                stub[0] = 0xb8;
+                memcpy(stub + 1, &result, sizeof(result));
+                stub[5] = 0xc3;
+            }
+
+            DWORD oldProtection{};
+            VERIFY_WIN32_BOOL_SUCCEEDED(VirtualProtect(stubs, size, PAGE_EXECUTE_READ, &oldProtection));
+            VERIFY_WIN32_BOOL_SUCCEEDED(FlushInstructionCache(GetCurrentProcess(), stubs, size));
+            return stubs;
+        }
+
+        static std::vector<DWORD> GetProtections(PBYTE address, size_t pageCount, size_t pageSize)
+        {
+            std::vector<DWORD> protections;
+            for (size_t page = 0; page < pageCount; page++)
+            {
+                MEMORY_BASIC_INFORMATION info{};
+                VERIFY_ARE_EQUAL(sizeof(info), VirtualQuery(address + page * pageSize, &info, sizeof(info)));
+                protections.push_back(info.Protect);
+            }
+            return protections;
+        }
+#endif
+    };
+}
@@ -0,0 +1,80 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "../../../dev/UndockedRegFreeWinRT/frozenstringmap.h"
+
+using UndockedRegFreeWinRT::FrozenStringMap;
+
+namespace Test::DynamicDependency
+{
+    class FrozenStringMapTests
+    {
+    public:
+        BEGIN_TEST_CLASS(FrozenStringMapTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        TEST_METHOD(Empty)
+        {
+            FrozenStringMap<int> map;
+            VERIFY_ARE_EQUAL(size_t{ 0 }, map.Size());
+            VERIFY_IS_NULL(map.Find(L"Contoso.Widget"));
+            VERIFY_IS_NULL(map.Find(L""));
+
+            FrozenStringMap<int> built{ std::vector<std::pair<std::wstring, int>>() };
+            VERIFY_ARE_EQUAL(size_t{ 0 }, built.Size());
+            VERIFY_IS_NULL(built.Find(L"Contoso.Widget"));
+        }
+
+        TEST_METHOD(Find)
+        {
+            std::vector<std::pair<std::wstring, int>> entries;
+            entries.emplace_back(L"Contoso.Widget", 1);
+            entries.emplace_back(L"Contoso.Gadget", 2);
+            entries.emplace_back(L"", 3);
+            FrozenStringMap<int> map{ std::move(entries) };
+            VERIFY_ARE_EQUAL(size_t{ 3 }, map.Size());
+
+            auto value{ map.Find(L"Contoso.Widget") };
+            VERIFY_IS_NOT_NULL(value);
+            VERIFY_ARE_EQUAL(1, *value);
+            value = map.Find(L"Contoso.Gadget");
+            VERIFY_IS_NOT_NULL(value);
+            VERIFY_ARE_EQUAL(2, *value);
+            value = map.Find(L"");
+            VERIFY_IS_NOT_NULL(value);
+            VERIFY_ARE_EQUAL(3, *value);
+
+            // Keys are case sensitive and must match exactly
+            VERIFY_IS_NULL(map.Find(L"contoso.widget"));
+            VERIFY_IS_NULL(map.Find(L"Contoso.Widget2"));
+            VERIFY_IS_NULL(map.Find(L"Contoso"));
+        }
+
+        TEST_METHOD(FindMany)
+        {
+            // Enough keys that the perfect hash needs many buckets, with lots of common prefixes
+            const int c_count{ 10000 };
+            std::vector<std::pair<std::wstring, int>> entries;
+            for (int index = 0; index < c_count; ++index)
+            {
+                entries.emplace_back(L"Contoso.Namespace.Type" + std::to_wstring(index), index);
+            }
+            FrozenStringMap<int> map{ std::move(entries) };
+            VERIFY_ARE_EQUAL(static_cast<size_t>(c_count), map.Size());
+
+            for (int index = 0; index < c_count; ++index)
+            {
+                const auto value{ map.Find(L"Contoso.Namespace.Type" + std::to_wstring(index)) };
+                VERIFY_IS_NOT_NULL(value);
+                VERIFY_ARE_EQUAL(index, *value);
+            }
+            for (int index = c_count; index < 2 * c_count; ++index)
+            {
+                VERIFY_IS_NULL(map.Find(L"Contoso.Namespace.Type" + std::to_wstring(index)));
+            }
+        }
+    };
+}
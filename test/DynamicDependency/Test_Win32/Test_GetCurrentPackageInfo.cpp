@@ -149,6 +149,9 @@ namespace Test::DynamicDependency
             VerifyGetCurrentPackageInfo123(PACKAGE_FILTER_HEAD | PACKAGE_FILTER_DIRECT | PACKAGE_FILTER_IS_IN_RELATED_SET | PACKAGE_FILTER_DYNAMIC, HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER), 1, 1, HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER), 1, 1);
             VerifyGetCurrentPackageInfo123(PACKAGE_FILTER_HEAD | PACKAGE_FILTER_DIRECT | PACKAGE_FILTER_IS_IN_RELATED_SET | PACKAGE_FILTER_STATIC | PACKAGE_FILTER_DYNAMIC, HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER), 1, 1, HRESULT_FROM_WIN32(ERROR_INSUFFICIENT_BUFFER), 1, 1);
 
+            // Verify repeated calls fill independent buffers
+            VerifyGetCurrentPackageInfoBuffers(PACKAGE_FILTER_DIRECT | PACKAGE_FILTER_DYNAMIC, 1);
+
             // Verify GetCurrentPackageInfo for GenerationId
             VerifyGenerationId(1, S_OK);
 
@@ -159,6 +162,109 @@ namespace Test::DynamicDependency
             MddDeletePackageDependency(packageDependencyId_FrameworkMathAdd.get());
         }
 
+        // Readers of the package graph shouldn't block behind changes to it. Measure GetCurrentPackageInfo()
+        // throughput and worst case latency across 16 threads while the package graph is updated periodically.
+        TEST_METHOD(Unpackaged_PackageGraph_ReaderContention)
+        {
+            const PACKAGE_VERSION minVersion{};
+            const MddPackageDependencyProcessorArchitectures architectures{};
+            const auto lifetimeKind{ MddPackageDependencyLifetimeKind::Process };
+            PCWSTR lifetimeArtifact{};
+            const MddCreatePackageDependencyOptions createOptions{};
+            wil::unique_process_heap_string packageDependencyId_FrameworkMathAdd;
+            VERIFY_ARE_EQUAL(S_OK, MddTryCreatePackageDependency(nullptr, TP::FrameworkMathAdd::c_PackageFamilyName, minVersion, architectures, lifetimeKind, lifetimeArtifact, createOptions, &packageDependencyId_FrameworkMathAdd));
+
+            // Keep one package in the package graph so readers always have something to serialize
+            const auto rank{ MDD_PACKAGE_DEPENDENCY_RANK_DEFAULT };
+            const MddAddPackageDependencyOptions addOptions{};
+            MDD_PACKAGEDEPENDENCY_CONTEXT packageDependencyContext_FrameworkMathAdd{};
+            VERIFY_ARE_EQUAL(S_OK, MddAddPackageDependency(packageDependencyId_FrameworkMathAdd.get(), rank, addOptions, &packageDependencyContext_FrameworkMathAdd, nullptr));
+
+            const UINT32 c_readerThreadsCount{ 16 };
+            const UINT32 c_updatesCount{ 32 };
+            const DWORD c_updateIntervalInMilliseconds{ 10 };
+            const UINT32 flags{ PACKAGE_FILTER_DIRECT | PACKAGE_FILTER_DYNAMIC };
+
+            LARGE_INTEGER frequency{};
+            QueryPerformanceFrequency(&frequency);
+
+            std::atomic<bool> done{ false };
+            std::atomic<UINT32> readerErrors{};
+            std::vector<UINT64> readerCalls(c_readerThreadsCount);
+            std::vector<LONGLONG> readerMaxTicks(c_readerThreadsCount);
+            std::vector<std::thread> readers;
+            for (UINT32 reader=0; reader < c_readerThreadsCount; ++reader)
+            {
+                readers.emplace_back([&, reader]()
+                {
+                    std::vector<BYTE> buffer;
+                    while (!done)
+                    {
+                        LARGE_INTEGER start{};
+                        QueryPerformanceCounter(&start);
+
+                        // The usual size-then-fill pattern
+                        UINT32 bufferSize{};
+                        UINT32 count{};
+                        LONG rc{ GetCurrentPackageInfo(flags, &bufferSize, nullptr, &count) };
+                        if (rc == ERROR_INSUFFICIENT_BUFFER)
+                        {
+                            buffer.resize(bufferSize);
+                            rc = GetCurrentPackageInfo(flags, &bufferSize, buffer.data(), &count);
+                        }
+                        if ((rc != ERROR_SUCCESS) && (rc != ERROR_INSUFFICIENT_BUFFER))
+                        {
+                            ++readerErrors;
+                        }
+
+                        LARGE_INTEGER end{};
+                        QueryPerformanceCounter(&end);
+                        readerMaxTicks[reader] = (std::max)(readerMaxTicks[reader], end.QuadPart - start.QuadPart);
+                        ++readerCalls[reader];
+                    }
+                });
+            }
+
+            LARGE_INTEGER start{};
+            QueryPerformanceCounter(&start);
+            for (UINT32 update=0; update < c_updatesCount; ++update)
+            {
+                Sleep(c_updateIntervalInMilliseconds);
+
+                MDD_PACKAGEDEPENDENCY_CONTEXT packageDependencyContext{};
+                VERIFY_ARE_EQUAL(S_OK, MddAddPackageDependency(packageDependencyId_FrameworkMathAdd.get(), rank, addOptions, &packageDependencyContext, nullptr));
+                MddRemovePackageDependency(packageDependencyContext);
+            }
+            done = true;
+            for (auto& reader : readers)
+            {
+                reader.join();
+            }
+            LARGE_INTEGER end{};
+            QueryPerformanceCounter(&end);
+
+            const double elapsedSeconds{ static_cast<double>(end.QuadPart - start.QuadPart) / frequency.QuadPart };
+            UINT64 totalCalls{};
+            LONGLONG maxTicks{};
+            for (UINT32 reader=0; reader < c_readerThreadsCount; ++reader)
+            {
+                totalCalls += readerCalls[reader];
+                maxTicks = (std::max)(maxTicks, readerMaxTicks[reader]);
+            }
+            auto message{ wil::str_printf<wil::unique_process_heap_string>(L"%u readers, %u updates: %.0f reads/sec, max read latency %.1f us\n",
+                                                                           c_readerThreadsCount, c_updatesCount, totalCalls / elapsedSeconds,
+                                                                           (maxTicks * 1000000.0) / frequency.QuadPart) };
+            VERIFY_IS_TRUE(true, message.get());
+            OutputDebugStringW(message.get());
+            VERIFY_ARE_EQUAL(0u, readerErrors.load());
+
+            // -- Remove
+            MddRemovePackageDependency(packageDependencyContext_FrameworkMathAdd);
+
+            // -- Delete
+            MddDeletePackageDependency(packageDependencyId_FrameworkMathAdd.get());
+        }
+
         void VerifyGetCurrentPackageInfo1(
             const UINT32 flags,
             const HRESULT expectedHR = HRESULT_FROM_WIN32(APPMODEL_ERROR_NO_PACKAGE),
@@ -227,6 +333,54 @@ namespace Test::DynamicDependency
             VerifyGetCurrentPackageInfo3(flags, expectedHR3, minExpectedBufferSize3, expectedCount3);
         }
 
+        // Results may be served from a cached copy so every PWSTR in the returned PACKAGE_INFO[] must point into the caller's buffer
+        void VerifyPackageInfoStringsInBuffer(
+            PCWSTR s,
+            const BYTE* buffer,
+            const UINT32 bufferSize)
+        {
+            if (s)
+            {
+                const auto p{ reinterpret_cast<const BYTE*>(s) };
+                VERIFY_IS_TRUE((p >= buffer) && (p < buffer + bufferSize));
+            }
+        }
+
+        void VerifyGetCurrentPackageInfoBuffers(
+            const UINT32 flags,
+            const UINT32 expectedCount)
+        {
+            UINT32 bufferSize{};
+            UINT32 count{};
+            VERIFY_ARE_EQUAL(static_cast<LONG>(ERROR_INSUFFICIENT_BUFFER), GetCurrentPackageInfo(flags, &bufferSize, nullptr, &count));
+            VERIFY_ARE_EQUAL(expectedCount, count);
+
+            std::unique_ptr<BYTE[]> buffer1{ new BYTE[bufferSize] };
+            std::unique_ptr<BYTE[]> buffer2{ new BYTE[bufferSize] };
+            UINT32 bufferSize1{ bufferSize };
+            UINT32 bufferSize2{ bufferSize };
+            VERIFY_ARE_EQUAL(static_cast<LONG>(ERROR_SUCCESS), GetCurrentPackageInfo(flags, &bufferSize1, buffer1.get(), &count));
+            VERIFY_ARE_EQUAL(expectedCount, count);
+            VERIFY_ARE_EQUAL(static_cast<LONG>(ERROR_SUCCESS), GetCurrentPackageInfo(flags, &bufferSize2, buffer2.get(), &count));
+            VERIFY_ARE_EQUAL(expectedCount, count);
+            VERIFY_ARE_EQUAL(bufferSize, bufferSize1);
+            VERIFY_ARE_EQUAL(bufferSize, bufferSize2);
+
+            const auto packageInfo1{ reinterpret_cast<const PACKAGE_INFO*>(buffer1.get()) };
+            const auto packageInfo2{ reinterpret_cast<const PACKAGE_INFO*>(buffer2.get()) };
+            for (UINT32 index=0; index < count; ++index)
+            {
+                VERIFY_ARE_EQUAL(std::wstring(packageInfo1[index].packageFullName), std::wstring(packageInfo2[index].packageFullName));
+                VERIFY_ARE_EQUAL(std::wstring(packageInfo1[index].path), std::wstring(packageInfo2[index].path));
+                VerifyPackageInfoStringsInBuffer(packageInfo1[index].path, buffer1.get(), bufferSize);
+                VerifyPackageInfoStringsInBuffer(packageInfo1[index].packageFullName, buffer1.get(), bufferSize);
+                VerifyPackageInfoStringsInBuffer(packageInfo1[index].packageId.name, buffer1.get(), bufferSize);
+                VerifyPackageInfoStringsInBuffer(packageInfo2[index].path, buffer2.get(), bufferSize);
+                VerifyPackageInfoStringsInBuffer(packageInfo2[index].packageFullName, buffer2.get(), bufferSize);
+                VerifyPackageInfoStringsInBuffer(packageInfo2[index].packageId.name, buffer2.get(), bufferSize);
+            }
+        }
+
         void VerifyGenerationId(
             const UINT32 expectedGenerationId,
             const HRESULT expectedHR = HRESULT_FROM_WIN32(APPMODEL_ERROR_NO_PACKAGE))
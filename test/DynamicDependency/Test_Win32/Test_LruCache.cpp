@@ -0,0 +1,104 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "../../../dev/UndockedRegFreeWinRT/lrucache.h"
+
+using UndockedRegFreeWinRT::LruCache;
+
+namespace Test::DynamicDependency
+{
+    class LruCacheTests
+    {
+    public:
+        BEGIN_TEST_CLASS(LruCacheTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        TEST_METHOD(EvictsLeastRecentlyUsed)
+        {
+            // One shard so the capacity is exact
+            LruCache<std::wstring, int> cache(2, 1);
+            VERIFY_ARE_EQUAL(1, cache.GetOrAdd(L"a", 1));
+            VERIFY_ARE_EQUAL(2, cache.GetOrAdd(L"b", 2));
+
+            // Using a makes b the least recently used
+            int value{};
+            VERIFY_IS_TRUE(cache.TryGet(L"a", value));
+            VERIFY_ARE_EQUAL(1, value);
+            VERIFY_ARE_EQUAL(3, cache.GetOrAdd(L"c", 3));
+            VERIFY_ARE_EQUAL(size_t{ 2 }, cache.Size());
+            VERIFY_IS_FALSE(cache.TryGet(L"b", value));
+            VERIFY_IS_TRUE(cache.TryGet(L"a", value));
+            VERIFY_IS_TRUE(cache.TryGet(L"c", value));
+            VERIFY_ARE_EQUAL(3, value);
+
+            const auto statistics{ cache.GetStatistics() };
+            VERIFY_ARE_EQUAL(3ull, statistics.hits);
+            VERIFY_ARE_EQUAL(1ull, statistics.misses);
+            VERIFY_ARE_EQUAL(1ull, statistics.evictions);
+        }
+
+        TEST_METHOD(GetOrAddKeepsCachedValue)
+        {
+            LruCache<std::wstring, int> cache(2, 1);
+            VERIFY_ARE_EQUAL(1, cache.GetOrAdd(L"a", 1));
+            VERIFY_ARE_EQUAL(1, cache.GetOrAdd(L"a", 2));
+
+            // and refreshes it
+            cache.GetOrAdd(L"b", 2);
+            cache.GetOrAdd(L"a", 0);
+            cache.GetOrAdd(L"c", 3);
+            int value{};
+            VERIFY_IS_TRUE(cache.TryGet(L"a", value));
+            VERIFY_IS_FALSE(cache.TryGet(L"b", value));
+        }
+
+        TEST_METHOD(SetCapacity)
+        {
+            LruCache<std::wstring, int> cache(4, 1);
+            for (int index = 0; index < 4; ++index)
+            {
+                cache.GetOrAdd(std::to_wstring(index), index);
+            }
+
+            // Shrinking evicts the least recently used
+            cache.SetCapacity(1);
+            VERIFY_ARE_EQUAL(size_t{ 1 }, cache.Size());
+            int value{};
+            VERIFY_IS_TRUE(cache.TryGet(L"3", value));
+            VERIFY_ARE_EQUAL(3ull, cache.GetStatistics().evictions);
+
+            // Nothing's cached at zero capacity, but the value's still returned
+            cache.SetCapacity(0);
+            VERIFY_ARE_EQUAL(size_t{ 0 }, cache.Size());
+            VERIFY_ARE_EQUAL(5, cache.GetOrAdd(L"5", 5));
+            VERIFY_ARE_EQUAL(size_t{ 0 }, cache.Size());
+        }
+
+        TEST_METHOD(RemoveAndClear)
+        {
+            LruCache<std::wstring, int> cache(4);
+            cache.GetOrAdd(L"a", 1);
+            cache.GetOrAdd(L"b", 2);
+            VERIFY_IS_TRUE(cache.Remove(L"a"));
+            VERIFY_IS_FALSE(cache.Remove(L"a"));
+            VERIFY_ARE_EQUAL(size_t{ 1 }, cache.Size());
+            cache.Clear();
+            VERIFY_ARE_EQUAL(size_t{ 0 }, cache.Size());
+        }
+
+        TEST_METHOD(ShardedCapacity)
+        {
+            // Each shard holds its share of the capacity, so the total never exceeds it
+            LruCache<int, int> cache(16, 4);
+            for (int index = 0; index < 1000; ++index)
+            {
+                cache.GetOrAdd(index, index);
+                VERIFY_IS_TRUE(cache.Size() <= 16);
+            }
+            VERIFY_ARE_EQUAL(1000ull, cache.GetStatistics().evictions + cache.Size());
+        }
+    };
+}
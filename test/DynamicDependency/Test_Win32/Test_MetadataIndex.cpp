@@ -0,0 +1,140 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include <fstream>
+
+#include "../../../dev/UndockedRegFreeWinRT/metadataindex.h"
+
+using UndockedRegFreeWinRT::MetadataIndex;
+
+namespace Test::DynamicDependency
+{
+    class MetadataIndexTests
+    {
+    public:
+        BEGIN_TEST_CLASS(MetadataIndexTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        TEST_CLASS_SETUP(ClassSetup)
+        {
+            // Every Windows 10 install has the system .winmds, so there's no need to check one in
+            WCHAR systemDirectory[MAX_PATH]{};
+            VERIFY_ARE_NOT_EQUAL(0u, GetSystemDirectoryW(systemDirectory, ARRAYSIZE(systemDirectory)));
+            std::filesystem::path path{ systemDirectory };
+            path /= L"WinMetadata\\Windows.Foundation.winmd";
+            std::ifstream file{ path, std::ios::binary };
+            VERIFY_IS_TRUE(file.good());
+            m_windowsFoundation.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            VERIFY_IS_FALSE(m_windowsFoundation.empty());
+            return true;
+        }
+
+        TEST_METHOD(Find)
+        {
+            const auto index{ MakeIndex() };
+
+            size_t fileIndex{};
+            uint32_t token{};
+            VERIFY_IS_TRUE(MetadataIndex::FindResult::Found == index.Find("Windows.Foundation.Uri", fileIndex, token));
+            VERIFY_ARE_EQUAL(size_t{ 0 }, fileIndex);
+            VERIFY_ARE_EQUAL(0x02000000u, token & 0xFF000000u);
+            VERIFY_IS_TRUE(MetadataIndex::FindResult::Namespace == index.Find("Windows.Foundation", fileIndex, token));
+            VERIFY_IS_TRUE(MetadataIndex::FindResult::NotFound == index.Find("Windows.Foundation.NoSuchType", fileIndex, token));
+        }
+
+        TEST_METHOD(FindUnindexedFile)
+        {
+            MetadataIndex index;
+            const uint8_t notMetadata[]{ 'M', 'Z', 0, 0 };
+            index.AddFile(MakeKey("Contoso.winmd", sizeof(notMetadata)), notMetadata, sizeof(notMetadata));
+            index.AddFile(MakeKey("Fabrikam.winmd", 0), nullptr, 0);
+
+            // Lookups that could involve a file that couldn't be read can't be answered
+            size_t fileIndex{};
+            uint32_t token{};
+            VERIFY_IS_TRUE(MetadataIndex::FindResult::Unknown == index.Find("Contoso.Widget", fileIndex, token));
+            VERIFY_IS_TRUE(MetadataIndex::FindResult::Unknown == index.Find("Fabrikam", fileIndex, token));
+        }
+
+        TEST_METHOD(SerializeRoundTrip)
+        {
+            const auto index{ MakeIndex() };
+            const auto data{ index.Serialize() };
+
+            MetadataIndex loaded;
+            VERIFY_IS_TRUE(MetadataIndex::Deserialize(data.data(), data.size(), loaded));
+            VERIFY_ARE_EQUAL(index.FileCount(), loaded.FileCount());
+
+            size_t fileIndex{};
+            uint32_t token{};
+            uint32_t loadedToken{};
+            VERIFY_IS_TRUE(MetadataIndex::FindResult::Found == index.Find("Windows.Foundation.Uri", fileIndex, token));
+            VERIFY_IS_TRUE(MetadataIndex::FindResult::Found == loaded.Find("Windows.Foundation.Uri", fileIndex, loadedToken));
+            VERIFY_ARE_EQUAL(token, loadedToken);
+            VERIFY_IS_TRUE(MetadataIndex::FindResult::Unknown == loaded.Find("Contoso.Widget", fileIndex, token));
+        }
+
+        TEST_METHOD(IsCurrent)
+        {
+            const auto index{ MakeIndex() };
+            VERIFY_IS_TRUE(index.IsCurrent(MakeKeys()));
+
+            auto keys{ MakeKeys() };
+            keys[0].lastWriteTime++;
+            VERIFY_IS_FALSE(index.IsCurrent(keys));
+
+            keys = MakeKeys();
+            keys.pop_back();
+            VERIFY_IS_FALSE(index.IsCurrent(keys));
+        }
+
+        TEST_METHOD(DeserializeRejectsDamage)
+        {
+            const auto data{ MakeIndex().Serialize() };
+
+            MetadataIndex loaded;
+            for (size_t size=0; size < data.size(); ++size)
+            {
+                VERIFY_IS_FALSE(MetadataIndex::Deserialize(data.data(), size, loaded));
+            }
+
+            auto badMagic{ data };
+            badMagic[0] ^= 0xFF;
+            VERIFY_IS_FALSE(MetadataIndex::Deserialize(badMagic.data(), badMagic.size(), loaded));
+
+            auto extra{ data };
+            extra.push_back(0);
+            VERIFY_IS_FALSE(MetadataIndex::Deserialize(extra.data(), extra.size(), loaded));
+        }
+
+    private:
+        static MetadataIndex::FileKey MakeKey(const char* name, uint64_t size)
+        {
+            MetadataIndex::FileKey key;
+            key.name = name;
+            key.size = size;
+            key.lastWriteTime = 1;
+            return key;
+        }
+
+        std::vector<MetadataIndex::FileKey> MakeKeys() const
+        {
+            return { MakeKey("Windows.Foundation.winmd", m_windowsFoundation.size()), MakeKey("Contoso.winmd", 0) };
+        }
+
+        MetadataIndex MakeIndex() const
+        {
+            const auto keys{ MakeKeys() };
+            MetadataIndex index;
+            index.AddFile(keys[0], m_windowsFoundation.data(), m_windowsFoundation.size());
+            index.AddFile(keys[1], nullptr, 0);
+            return index;
+        }
+
+    private:
+        std::vector<uint8_t> m_windowsFoundation;
+    };
+}
@@ -0,0 +1,195 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include "../../../dev/DynamicDependency/PackageBestFit.h"
+#include "../../../dev/DynamicDependency/SystemPackageCatalog.h"
+
+namespace TP = ::Test::Packages;
+
+namespace Test::DynamicDependency
+{
+    // Synthetic packages, so best fit can be tested without registering them
+    class InMemoryPackageCatalog : public MddCore::PackageCatalog
+    {
+    public:
+        void Add(PCWSTR packageFullName, const UINT64 version, const MddCore::Architecture architecture, const bool isStatusOK = true)
+        {
+            m_candidates.push_back(MddCore::PackageCandidate{ packageFullName, version, architecture });
+            if (!isStatusOK)
+            {
+                m_statusNotOK.push_back(packageFullName);
+            }
+        }
+
+        std::vector<MddCore::PackageCandidate> FindPackagesByFamily(
+            const std::wstring& /*packageFamilyName*/) override
+        {
+            return m_candidates;
+        }
+
+        bool IsPackageStatusOK(
+            const MddCore::PackageCandidate& candidate) override
+        {
+            ++m_statusChecks;
+            return std::find(m_statusNotOK.begin(), m_statusNotOK.end(), candidate.packageFullName) == m_statusNotOK.end();
+        }
+
+        size_t StatusChecks() const
+        {
+            return m_statusChecks;
+        }
+
+    private:
+        std::vector<MddCore::PackageCandidate> m_candidates;
+        std::vector<std::wstring> m_statusNotOK;
+        size_t m_statusChecks{};
+    };
+
+    class PackageBestFitTests
+    {
+    public:
+        BEGIN_TEST_CLASS(PackageBestFitTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        TEST_METHOD(HighestVersion)
+        {
+            InMemoryPackageCatalog packageCatalog;
+            packageCatalog.Add(L"A_1", 0x0001000000000000ull, MddCore::Architecture::Neutral);
+            packageCatalog.Add(L"A_3", 0x0003000000000000ull, MddCore::Architecture::Neutral);
+            packageCatalog.Add(L"A_2", 0x0002000000000000ull, MddCore::Architecture::Neutral);
+
+            VERIFY_ARE_EQUAL(std::wstring(L"A_3"), MddCore::PackageBestFit::Find(packageCatalog, MakePackageDependency(0), MddCore::Architecture::X64));
+            VERIFY_ARE_EQUAL(1u, packageCatalog.StatusChecks());
+        }
+
+        TEST_METHOD(MinVersion)
+        {
+            InMemoryPackageCatalog packageCatalog;
+            packageCatalog.Add(L"A_1", 0x0001000000000000ull, MddCore::Architecture::Neutral);
+
+            VERIFY_ARE_EQUAL(std::wstring(L"A_1"), MddCore::PackageBestFit::Find(packageCatalog, MakePackageDependency(0x0001000000000000ull), MddCore::Architecture::X64));
+            VERIFY_IS_TRUE(MddCore::PackageBestFit::Find(packageCatalog, MakePackageDependency(0x0001000000000001ull), MddCore::Architecture::X64).empty());
+        }
+
+        TEST_METHOD(Architecture)
+        {
+            InMemoryPackageCatalog packageCatalog;
+            packageCatalog.Add(L"A_neutral", 0x0001000000000000ull, MddCore::Architecture::Neutral);
+            packageCatalog.Add(L"A_x64", 0x0001000000000000ull, MddCore::Architecture::X64);
+            packageCatalog.Add(L"A_arm64", 0x0001000000000000ull, MddCore::Architecture::Arm64);
+
+            // No architecture filter prefers the current architecture over neutral, and ignores any other
+            VERIFY_ARE_EQUAL(std::wstring(L"A_x64"), MddCore::PackageBestFit::Find(packageCatalog, MakePackageDependency(0), MddCore::Architecture::X64));
+            VERIFY_ARE_EQUAL(std::wstring(L"A_neutral"), MddCore::PackageBestFit::Find(packageCatalog, MakePackageDependency(0), MddCore::Architecture::X86));
+
+            // An explicit filter is just that
+            VERIFY_ARE_EQUAL(std::wstring(L"A_arm64"), MddCore::PackageBestFit::Find(packageCatalog, MakePackageDependency(0, MddPackageDependencyProcessorArchitectures::Arm64), MddCore::Architecture::X64));
+        }
+
+        TEST_METHOD(StatusNotOK)
+        {
+            InMemoryPackageCatalog packageCatalog;
+            packageCatalog.Add(L"A_1", 0x0001000000000000ull, MddCore::Architecture::Neutral);
+            packageCatalog.Add(L"A_2", 0x0002000000000000ull, MddCore::Architecture::Neutral, false);
+            packageCatalog.Add(L"A_3", 0x0003000000000000ull, MddCore::Architecture::Neutral, false);
+
+            VERIFY_ARE_EQUAL(std::wstring(L"A_1"), MddCore::PackageBestFit::Find(packageCatalog, MakePackageDependency(0), MddCore::Architecture::X64));
+            VERIFY_ARE_EQUAL(3u, packageCatalog.StatusChecks());
+        }
+
+        TEST_METHOD(Deterministic)
+        {
+            // Thousands of candidates, lots of ties, in different orders. Always the same winner
+            const size_t c_count{ 5000 };
+            std::wstring expected;
+            for (int pass=0; pass < 2; ++pass)
+            {
+                InMemoryPackageCatalog packageCatalog;
+                for (size_t index=0; index < c_count; ++index)
+                {
+                    const auto n{ (pass == 0) ? index : (c_count - 1 - index) };
+                    const auto packageFullName{ L"A_" + std::to_wstring(n) };
+                    const auto architecture{ (n % 2 == 0) ? MddCore::Architecture::Neutral : MddCore::Architecture::X64 };
+                    packageCatalog.Add(packageFullName.c_str(), 0x0001000000000000ull + (n % 10), architecture);
+                }
+
+                const auto bestFit{ MddCore::PackageBestFit::Find(packageCatalog, MakePackageDependency(0), MddCore::Architecture::X64) };
+                VERIFY_IS_FALSE(bestFit.empty());
+                if (pass == 0)
+                {
+                    expected = bestFit;
+                }
+                VERIFY_ARE_EQUAL(expected, bestFit);
+            }
+
+            // Highest version (9) and architecture-specific (odd n), then lowest package full name
+            VERIFY_ARE_EQUAL(std::wstring(L"A_1009"), expected);
+        }
+
+    private:
+        static MddCore::PackageDependency MakePackageDependency(
+            const UINT64 minVersion,
+            const MddPackageDependencyProcessorArchitectures architectures = MddPackageDependencyProcessorArchitectures::None)
+        {
+            return MddCore::PackageDependency(nullptr, L"A_8wekyb3d8bbwe", PACKAGE_VERSION{ minVersion }, architectures,
+                MddPackageDependencyLifetimeKind::Process, nullptr, MddCreatePackageDependencyOptions::None);
+        }
+    };
+
+    class SystemPackageCatalogTests
+    {
+    public:
+        BEGIN_TEST_CLASS(SystemPackageCatalogTests)
+            TEST_CLASS_PROPERTY(L"ThreadingModel", L"MTA")
+        END_TEST_CLASS()
+
+        TEST_CLASS_SETUP(Setup)
+        {
+            TP::RemovePackage_FrameworkMathAdd();
+            return true;
+        }
+
+        TEST_CLASS_CLEANUP(Cleanup)
+        {
+            TP::RemovePackage_FrameworkMathAdd();
+            return true;
+        }
+
+        TEST_METHOD(FindPackagesByFamily_InstallUninstall)
+        {
+            auto& packageCatalog{ MddCore::SystemPackageCatalog::Instance() };
+            VERIFY_ARE_EQUAL(0u, packageCatalog.FindPackagesByFamily(TP::FrameworkMathAdd::c_PackageFamilyName).size());
+
+            // Installing (or uninstalling) a package invalidates anything cached for its family
+            TP::AddPackage_FrameworkMathAdd();
+            const auto candidates{ WaitForPackagesByFamily(TP::FrameworkMathAdd::c_PackageFamilyName, 1) };
+            VERIFY_ARE_EQUAL(1u, candidates.size());
+            VERIFY_ARE_EQUAL(std::wstring(TP::FrameworkMathAdd::c_PackageFullName), candidates[0].packageFullName);
+            VERIFY_IS_TRUE(candidates[0].architecture == MddCore::Architecture::Neutral);
+            VERIFY_IS_TRUE(packageCatalog.IsPackageStatusOK(candidates[0]));
+
+            TP::RemovePackage_FrameworkMathAdd();
+            VERIFY_ARE_EQUAL(0u, WaitForPackagesByFamily(TP::FrameworkMathAdd::c_PackageFamilyName, 0).size());
+            VERIFY_IS_FALSE(packageCatalog.IsPackageStatusOK(candidates[0]));
+        }
+
+    private:
+        static std::vector<MddCore::PackageCandidate> WaitForPackagesByFamily(
+            PCWSTR packageFamilyName,
+            const size_t expectedCount)
+        {
+            // Package change notifications are asynchronous
+            auto& packageCatalog{ MddCore::SystemPackageCatalog::Instance() };
+            auto candidates{ packageCatalog.FindPackagesByFamily(packageFamilyName) };
+            for (int retry=0; (retry < 100) && (candidates.size() != expectedCount); ++retry)
+            {
+                Sleep(100);
+                candidates = packageCatalog.FindPackagesByFamily(packageFamilyName);
+            }
+            return candidates;
+        }
+    };
+}
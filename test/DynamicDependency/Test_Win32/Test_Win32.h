@@ -31,6 +31,9 @@ namespace Test::DynamicDependency
         TEST_METHOD(Add_Rank_B0prepend_A0);
         TEST_METHOD(Add_Rank_Bneg10_A0);
 
+        TEST_METHOD(Add_PathChangedByApp);
+        TEST_METHOD(Add_Batch);
+
         TEST_METHOD(Create_FilePathLifetime_NoExist);
         TEST_METHOD(Create_RegistryLifetime_NoExist);
         TEST_METHOD(Create_DoNotVerifyDependencyResolution);
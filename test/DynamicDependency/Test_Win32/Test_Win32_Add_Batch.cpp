@@ -0,0 +1,84 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include <MsixDynamicDependency.h>
+#include <MddPackageGraphUpdate.h>
+
+#include "Test_Win32.h"
+
+namespace TF = ::Test::FileSystem;
+namespace TP = ::Test::Packages;
+
+void Test::DynamicDependency::Test_Win32::Add_Batch()
+{
+    // Setup our dynamic dependencies
+
+    std::wstring expectedPackageFullName_ProjectReunionFramework{ TP::ProjectReunionFramework::c_PackageFullName };
+    std::wstring expectedPackageFullName_FrameworkMathAdd{ TP::FrameworkMathAdd::c_PackageFullName };
+
+    VerifyPackageInPackageGraph(expectedPackageFullName_ProjectReunionFramework, S_OK);
+    VerifyPackageNotInPackageGraph(expectedPackageFullName_FrameworkMathAdd, S_OK);
+    auto pathEnvironmentVariable{ GetPathEnvironmentVariableMinusProjectReunionFramework() };
+    auto packagePath_ProjectReunionFramework{ TP::GetPackagePath(expectedPackageFullName_ProjectReunionFramework) };
+    VerifyPathEnvironmentVariable(packagePath_ProjectReunionFramework, pathEnvironmentVariable.c_str());
+
+    // -- TryCreate
+
+    wil::unique_process_heap_string packageDependencyId_FrameworkMathAdd{ Mdd_TryCreate_FrameworkMathAdd() };
+
+    // -- Add (batched)
+
+    // PATH isn't written until the batch ends, and then only once
+    const auto pathBeforeAdd{ GetPathEnvironmentVariable() };
+    MDD_PACKAGEDEPENDENCY_CONTEXT packageDependencyContext_FrameworkMathAdd1{};
+    MDD_PACKAGEDEPENDENCY_CONTEXT packageDependencyContext_FrameworkMathAdd2{};
+    {
+        MDD_PACKAGEGRAPHUPDATE_CONTEXT packageGraphUpdateContext{};
+        VERIFY_SUCCEEDED(MddBeginPackageGraphUpdate(&packageGraphUpdateContext));
+        auto endPackageGraphUpdate{ wil::scope_exit([&]() { MddEndPackageGraphUpdate(packageGraphUpdateContext); }) };
+
+        wil::unique_process_heap_string packageFullName_FrameworkMathAdd;
+        packageDependencyContext_FrameworkMathAdd1 = Mdd_Add(packageDependencyId_FrameworkMathAdd.get(), 10, packageFullName_FrameworkMathAdd);
+        VerifyPackageInPackageGraph(expectedPackageFullName_FrameworkMathAdd, S_OK);
+        VERIFY_ARE_EQUAL(pathBeforeAdd, GetPathEnvironmentVariable());
+
+        packageDependencyContext_FrameworkMathAdd2 = Mdd_Add(packageDependencyId_FrameworkMathAdd.get(), 20, packageFullName_FrameworkMathAdd);
+        VERIFY_ARE_EQUAL(pathBeforeAdd, GetPathEnvironmentVariable());
+    }
+
+    auto packagePath_FrameworkMathAdd{ TP::GetPackagePath(expectedPackageFullName_FrameworkMathAdd) };
+    VerifyPathEnvironmentVariable(packagePath_ProjectReunionFramework, packagePath_FrameworkMathAdd, packagePath_FrameworkMathAdd, pathEnvironmentVariable.c_str());
+
+    // -- Remove (batched, ended by an exception)
+
+    const auto pathBeforeRemove{ GetPathEnvironmentVariable() };
+    try
+    {
+        MDD_PACKAGEGRAPHUPDATE_CONTEXT packageGraphUpdateContext{};
+        VERIFY_SUCCEEDED(MddBeginPackageGraphUpdate(&packageGraphUpdateContext));
+        auto endPackageGraphUpdate{ wil::scope_exit([&]() { MddEndPackageGraphUpdate(packageGraphUpdateContext); }) };
+
+        MddRemovePackageDependency(packageDependencyContext_FrameworkMathAdd1);
+        MddRemovePackageDependency(packageDependencyContext_FrameworkMathAdd2);
+        VerifyPackageNotInPackageGraph(expectedPackageFullName_FrameworkMathAdd, S_OK);
+        VERIFY_ARE_EQUAL(pathBeforeRemove, GetPathEnvironmentVariable());
+
+        THROW_HR(E_ABORT);
+    }
+    catch (...)
+    {
+    }
+
+    VerifyPackageInPackageGraph(expectedPackageFullName_ProjectReunionFramework, S_OK);
+    VerifyPackageNotInPackageGraph(expectedPackageFullName_FrameworkMathAdd, S_OK);
+    VerifyPathEnvironmentVariable(packagePath_ProjectReunionFramework, pathEnvironmentVariable.c_str());
+
+    // -- Delete
+
+    MddDeletePackageDependency(packageDependencyId_FrameworkMathAdd.get());
+
+    VerifyPackageNotInPackageGraph(expectedPackageFullName_FrameworkMathAdd, S_OK);
+    VerifyPackageDependency(packageDependencyId_FrameworkMathAdd.get(), HRESULT_FROM_WIN32(ERROR_NOT_FOUND));
+}
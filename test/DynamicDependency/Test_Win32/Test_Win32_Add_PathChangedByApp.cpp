@@ -0,0 +1,66 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+
+#include "pch.h"
+
+#include <MsixDynamicDependency.h>
+
+#include <Math.Add.h>
+#include <Math.Multiply.h>
+
+#include "Test_Win32.h"
+
+namespace TF = ::Test::FileSystem;
+namespace TP = ::Test::Packages;
+
+void Test::DynamicDependency::Test_Win32::Add_PathChangedByApp()
+{
+    // Setup our dynamic dependencies
+
+    std::wstring expectedPackageFullName_ProjectReunionFramework{ TP::ProjectReunionFramework::c_PackageFullName };
+    std::wstring expectedPackageFullName_FrameworkMathAdd{ TP::FrameworkMathAdd::c_PackageFullName };
+
+    VerifyPackageInPackageGraph(expectedPackageFullName_ProjectReunionFramework, S_OK);
+    VerifyPackageNotInPackageGraph(expectedPackageFullName_FrameworkMathAdd, S_OK);
+    auto pathEnvironmentVariable{ GetPathEnvironmentVariableMinusProjectReunionFramework() };
+    auto packagePath_ProjectReunionFramework{ TP::GetPackagePath(expectedPackageFullName_ProjectReunionFramework) };
+    VerifyPathEnvironmentVariable(packagePath_ProjectReunionFramework, pathEnvironmentVariable.c_str());
+    const auto originalPath{ GetPathEnvironmentVariable() };
+
+    // -- TryCreate
+
+    wil::unique_process_heap_string packageDependencyId_FrameworkMathAdd{ Mdd_TryCreate_FrameworkMathAdd() };
+
+    // -- Add
+
+    wil::unique_process_heap_string packageFullName_FrameworkMathAdd;
+    MDD_PACKAGEDEPENDENCY_CONTEXT packageDependencyContext_FrameworkMathAdd{ Mdd_Add(packageDependencyId_FrameworkMathAdd.get(), packageFullName_FrameworkMathAdd) };
+    VERIFY_IS_NOT_NULL(packageFullName_FrameworkMathAdd.get());
+
+    auto packagePath_FrameworkMathAdd{ TP::GetPackagePath(expectedPackageFullName_FrameworkMathAdd) };
+    VerifyPathEnvironmentVariable(packagePath_ProjectReunionFramework, packagePath_FrameworkMathAdd, pathEnvironmentVariable.c_str());
+
+    // -- The app changes PATH
+
+    // Our pathlist is no longer PATH's prefix so it has to be found (rather than spliced) and moved back to the front
+    const std::wstring appPath{ L"C:\\Test\\PathChangedByApp" };
+    const auto appChangedPath{ appPath + L";" + GetPathEnvironmentVariable() };
+    VERIFY_WIN32_BOOL_SUCCEEDED(::SetEnvironmentVariableW(L"PATH", appChangedPath.c_str()));
+
+    // -- Remove
+
+    MddRemovePackageDependency(packageDependencyContext_FrameworkMathAdd);
+
+    VerifyPackageInPackageGraph(expectedPackageFullName_ProjectReunionFramework, S_OK);
+    VerifyPackageNotInPackageGraph(expectedPackageFullName_FrameworkMathAdd, S_OK);
+    VerifyPathEnvironmentVariable(packagePath_ProjectReunionFramework, appPath, pathEnvironmentVariable.c_str());
+
+    // -- Delete
+
+    MddDeletePackageDependency(packageDependencyId_FrameworkMathAdd.get());
+
+    VerifyPackageNotInPackageGraph(expectedPackageFullName_FrameworkMathAdd, S_OK);
+    VerifyPackageDependency(packageDependencyId_FrameworkMathAdd.get(), HRESULT_FROM_WIN32(ERROR_NOT_FOUND));
+
+    VERIFY_WIN32_BOOL_SUCCEEDED(::SetEnvironmentVariableW(L"PATH", originalPath.c_str()));
+}
@@ -23,7 +23,9 @@
 #include <winrt/Windows.Management.Core.h>
 #include <winrt/Windows.Management.Deployment.h>
 
+#include <atomic>
 #include <filesystem>
+#include <thread>
 
 #include <MsixDynamicDependency.h>
 
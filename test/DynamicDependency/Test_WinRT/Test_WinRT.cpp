@@ -219,6 +219,29 @@ void Test::DynamicDependency::Test_WinRT::WinRT_RoGetActivationFactory_NotFound(
     VERIFY_IS_NULL(doesNotExist);
 }
 
+void Test::DynamicDependency::Test_WinRT::WinRT_RoGetActivationFactory_AddRemoveAdd()
+{
+    // The framework's manifest was parsed when it was added to the package graph at startup. Adding the package
+    // again (which is served from the in-memory manifest cache) must still provide its activatable classes,
+    // including after it's been removed and re-added.
+    auto packageDependency{ _Create_ProjectReunionFramework() };
+    for (int i=0; i < 2; ++i)
+    {
+        auto packageDependencyContext{ packageDependency.Add() };
+
+        IInspectable* activationRegistrationManager{};
+        {
+            auto acid{ wil::make_unique_string < wil::unique_hstring>(L"Microsoft.Windows.AppLifecycle.ActivationRegistrationManager") };
+            VERIFY_SUCCEEDED(::RoGetActivationFactory(acid.get(), IID_PPV_ARGS(&activationRegistrationManager)));
+        }
+        VERIFY_IS_NOT_NULL(activationRegistrationManager);
+        activationRegistrationManager->Release();
+
+        packageDependencyContext.Remove();
+    }
+    packageDependency.Delete();
+}
+
 void Test::DynamicDependency::Test_WinRT::VerifyPackageDependency(
     PCWSTR packageDependencyId,
     const HRESULT expectedHR,
@@ -41,6 +41,7 @@ namespace Test::DynamicDependency
         TEST_METHOD(WinRT_RoGetActivationFactory_1);
         TEST_METHOD(WinRT_RoGetActivationFactory_2);
         TEST_METHOD(WinRT_RoGetActivationFactory_NotFound);
+        TEST_METHOD(WinRT_RoGetActivationFactory_AddRemoveAdd);
 
     private:
         static void VerifyPackageDependency(
@@ -0,0 +1,148 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#include "pch.h"
+#include "Helpers.h"
+#include <TestDef.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+#include "../../../dev/AppLifecycle/RedirectionRequestQueue.h"
+
+using namespace winrt;
+using namespace winrt::Windows::System;
+using namespace winrt::Windows::Foundation;
+using namespace winrt::Windows::Foundation::Collections;
+using namespace winrt::Windows::ApplicationModel::Activation;
+using namespace winrt::Microsoft::Windows::AppLifecycle;
+
+// Redirected to the key instance in this order, while it's busy handling the priming redirection.
+// The "bad" one enqueues a request that can't be unmarshaled, which must be dropped from the batch.
+static const std::vector<std::wstring> c_redirectionIndexes{ L"0", L"1", L"bad", L"2" };
+static const std::vector<std::wstring> c_expectedIndexes{ L"0", L"1", L"2" };
+static const std::wstring c_primeIndex{ L"prime" };
+
+static std::wstring GetIndex(const AppActivationArguments& args)
+{
+    auto uri = args.Data().as<IProtocolActivatedEventArgs>().Uri();
+    return uri.QueryParsed().GetFirstValueByName(L"Index").c_str();
+}
+
+static std::wstring GetRedirectionQueueName(uint32_t processId)
+{
+    // The queue is named after the instance, which is named after the app's module path
+    // (see ComputeAppId() and AppInstance::AppInstance()).
+    std::hash<std::wstring> hasher;
+    auto hash = hasher(wil::GetModuleFileNameW<std::wstring>(nullptr));
+    return wil::str_printf<std::wstring>(L"App.%I64x_%d_RedirectionQueue2", hash, processId);
+}
+
+static void LaunchRedirection(const std::wstring& index, const wil::unique_event& redirected)
+{
+    Uri launchUri{ c_testProtocolScheme + L"://" + c_genericTestMoniker + L"?TestName=BatchedActivationTest_Win32&Index=" + index };
+    THROW_HR_IF(E_FAIL, !Launcher::LaunchUriAsync(launchUri).get());
+
+    // Wait until it's redirected so requests are queued in order.
+    THROW_HR_IF(HRESULT_FROM_WIN32(ERROR_TIMEOUT), !redirected.wait(c_phaseTimeout));
+}
+
+static bool Redirect(const AppInstance& keyInstance, const AppActivationArguments& args)
+{
+    if (GetIndex(args) == L"bad")
+    {
+        // Enqueue inline arguments that aren't a valid URI, as a broken redirector might.
+        winrt::Microsoft::Windows::AppLifecycle::implementation::RedirectionRequestQueue queue;
+        queue.Init(GetRedirectionQueueName(keyInstance.ProcessId()));
+        if (!queue.TryEnqueue(GUID_NULL, L"not a valid URI"))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        keyInstance.RedirectActivationToAsync(args).get();
+    }
+
+    SignalPhase(c_testBatchedActivationRedirectedEventName);
+    return true;
+}
+
+bool BatchedActivationTestSucceeded(const AppActivationArguments& args)
+{
+    auto keyInstance = AppInstance::FindOrRegisterForKey(c_testBatchedActivationPhaseEventName);
+    if (!keyInstance)
+    {
+        return false;
+    }
+
+    if (!keyInstance.IsCurrent())
+    {
+        return Redirect(keyInstance, args);
+    }
+
+    wil::unique_event redirected;
+    redirected.create(wil::EventOptions::None, c_testBatchedActivationRedirectedEventName.c_str());
+    wil::unique_event done;
+    done.create(wil::EventOptions::ManualReset);
+
+    std::atomic<bool> activatedRaised{ false };
+    std::atomic<bool> succeeded{ false };
+    std::mutex batchesLock;
+    std::vector<std::vector<std::wstring>> batches;
+
+    // ActivatedBatch takes precedence. Activated mustn't be raised.
+    auto activatedToken = keyInstance.Activated(auto_revoke, [&](const auto&, const AppActivationArguments&)
+    {
+        activatedRaised = true;
+    });
+
+    auto activatedBatchToken = keyInstance.ActivatedBatch(auto_revoke, [&](const auto&, const IVectorView<AppActivationArguments>& batch)
+    {
+        try
+        {
+            std::vector<std::wstring> indexes;
+            for (const auto& item : batch)
+            {
+                indexes.push_back(GetIndex(item));
+            }
+
+            std::unique_lock<std::mutex> lock(batchesLock);
+            batches.push_back(std::move(indexes));
+            if (batches.size() == 1)
+            {
+                // Redirect the rest while we're still handling this batch. They're delivered
+                // together, in one batch, once we return.
+                lock.unlock();
+                for (const auto& index : c_redirectionIndexes)
+                {
+                    LaunchRedirection(index, redirected);
+                }
+                return;
+            }
+
+            succeeded = (batches.size() == 2) &&
+                        (batches[0] == std::vector<std::wstring>{ c_primeIndex }) &&
+                        (batches[1] == c_expectedIndexes);
+        }
+        CATCH_LOG();
+        done.SetEvent();
+    });
+
+    LaunchRedirection(c_primeIndex, redirected);
+    if (!done.wait(c_phaseTimeout))
+    {
+        return false;
+    }
+
+    // Anything else (e.g. a stray Activated or another batch) would follow right behind.
+    Sleep(1000);
+    std::unique_lock<std::mutex> lock(batchesLock);
+    if (!succeeded || activatedRaised || (batches.size() != 2))
+    {
+        return false;
+    }
+
+    SignalPhase(c_testBatchedActivationPhaseEventName);
+    return true;
+}
@@ -0,0 +1,5 @@
+﻿// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License. See LICENSE in the project root for license information.
+#pragma once
+
+bool BatchedActivationTestSucceeded(const winrt::Microsoft::Windows::AppLifecycle::AppActivationArguments& args);
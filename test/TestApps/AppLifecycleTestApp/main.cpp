@@ -4,6 +4,7 @@
 #include <testdef.h>
 #include "Helpers.h"
 #include "SingleInstanceTest.h"
+#include "BatchedActivationTest.h"
 
 using namespace winrt::Microsoft::Windows::AppLifecycle;
 using namespace winrt;
@@ -41,6 +42,11 @@ bool ProtocolLaunchSucceeded(const AppActivationArguments& appArgs)
         return true;
     }
 
+    if ((actualTestName.compare(L"BatchedActivationTest_Win32") == 0) && BatchedActivationTestSucceeded(appArgs))
+    {
+        return true;
+    }
+
     return false;
 }
 
@@ -16,6 +16,8 @@ static const std::wstring c_testFilePhaseEventName = L"ReunionTestFilePhaseEvent
 
 static const std::wstring c_testStartupPhaseEventName = L"ReunionTestStartupPhaseEventName";
 static const std::wstring c_testInstanceRedirectedPhaseEventName = L"ReunionTestInstanceRedirectedPhaseEventName";
+static const std::wstring c_testBatchedActivationPhaseEventName = L"ReunionTestBatchedActivationPhaseEventName";
+static const std::wstring c_testBatchedActivationRedirectedEventName = L"ReunionTestBatchedActivationRedirectedEventName";
 
 inline const winrt::hstring c_rawNotificationPayload = L"<toast></toast>";
 inline IID c_comServerId = winrt::guid("ccd2ae3f-764f-4ae3-be45-9804761b28b2"); // Value from PushNotificationsTestAppPackage ComActivator in appxmanifest.